@@ -0,0 +1,171 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+
+#include <assert.h>
+
+#include "base/Constants.hpp"
+#include "block/ServiceList.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+const int32_t AbstractAnalysisBlock::kUnknownThread;
+const size_t AbstractAnalysisBlock::kDefaultTopSize;
+
+AbstractAnalysisBlock::AbstractAnalysisBlock(const std::string& name)
+    : _name(name),
+      _reportSink(nullptr),
+      _currentState(nullptr)
+{
+}
+
+void AbstractAnalysisBlock::LoadServices(const block::ServiceList& serviceList)
+{
+    serviceList.QueryService(kCurrentStateServiceName,
+                             reinterpret_cast<void**>(&_currentState));
+
+    // Get constant quarks.
+    Q_LINUX = State()->Quark(kStateLinux);
+    Q_CPUS = State()->Quark(kStateCpus);
+    Q_CUR_THREAD = State()->Quark(kStateCurThread);
+}
+
+void AbstractAnalysisBlock::GetNotificationSinks(notification::NotificationCenter* notificationCenter)
+{
+    _reportSink = notificationCenter->GetSink({
+        Token(kAnalysisNotificationPrefix), Token(_name)
+    });
+}
+
+void AbstractAnalysisBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AddKernelObserver<AbstractAnalysisBlock, &AbstractAnalysisBlock::onSchedProcessFork>(notificationCenter, Token("sched_process_fork"), this);
+    AddKernelObserver<AbstractAnalysisBlock, &AbstractAnalysisBlock::onSchedProcessFree>(notificationCenter, Token("sched_process_free"), this);
+    AddKernelObserver<AbstractAnalysisBlock, &AbstractAnalysisBlock::onLttngStatedumpProcessState>(notificationCenter, Token("lttng_statedump_process_state"), this);
+}
+
+void AbstractAnalysisBlock::Stop()
+{
+    if (_reportSink == nullptr || !_reportSink->HasObservers())
+        return;
+
+    auto report = GetReport();
+    _reportSink->PostNotification(report.get());
+}
+
+size_t AbstractAnalysisBlock::GetTopSize(const value::Value* parameters)
+{
+    uint64_t topSize = kDefaultTopSize;
+    const value::Value* top = nullptr;
+    if (parameters != nullptr && parameters->GetField("top", &top))
+        top->AsULong(&topSize);
+    return static_cast<size_t>(topSize);
+}
+
+uint32_t AbstractAnalysisBlock::GetEventCpu(const trace::EventValue& event)
+{
+    auto packetContext = value::StructValueBase::Cast(event.getStreamPacketContext());
+    assert(packetContext);
+
+    auto classKey = GetEventClassKey(event);
+    auto look = _cpuIdFieldIndexes.find(classKey);
+    if (look == _cpuIdFieldIndexes.end())
+    {
+        size_t index = 0;
+        for (auto it = packetContext->fields_begin(); it != packetContext->fields_end(); ++it)
+        {
+            if (it->first == "cpu_id")
+                break;
+            ++index;
+        }
+        look = _cpuIdFieldIndexes.insert(std::make_pair(classKey, index)).first;
+    }
+
+    assert(look->second < packetContext->Length());
+    return packetContext->at(look->second)->AsUInteger();
+}
+
+int32_t AbstractAnalysisBlock::GetCurrentThread(uint32_t cpu)
+{
+    while (cpu >= _currentThreadAttributes.size())
+    {
+        auto qCpu = State()->IntQuark(_currentThreadAttributes.size());
+        _currentThreadAttributes.push_back(
+            State()->GetAttributeKey({Q_LINUX, Q_CPUS, qCpu, Q_CUR_THREAD}));
+    }
+
+    auto tid = State()->GetAttributeValue(_currentThreadAttributes[cpu]);
+    if (tid == nullptr)
+        return kUnknownThread;
+    return tid->AsInteger();
+}
+
+std::string AbstractAnalysisBlock::GetThreadName(int32_t tid) const
+{
+    return State()->CurrentNameForThread(tid);
+}
+
+int32_t AbstractAnalysisBlock::GetProcessId(int32_t tid) const
+{
+    auto look = _processes.find(tid);
+    if (look == _processes.end())
+        return tid;
+    return look->second;
+}
+
+void AbstractAnalysisBlock::onSchedProcessFork(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    auto childTid = fields->GetField("child_tid")->AsInteger();
+    auto parentTid = fields->GetField("parent_tid")->AsInteger();
+
+    // The child is in the process of its parent, unless it is the first
+    // thread of a new process.
+    auto childPid = fields->GetField("child_pid");
+    if (childPid == nullptr)
+        return;
+    auto pid = childPid->AsInteger();
+    _processes[childTid] = pid;
+
+    if (pid != childTid && _processes.find(parentTid) == _processes.end())
+        _processes[parentTid] = pid;
+}
+
+void AbstractAnalysisBlock::onSchedProcessFree(const trace::EventValue& event)
+{
+    auto tid = event.getFields()->GetField("tid")->AsInteger();
+    _processes.erase(tid);
+}
+
+void AbstractAnalysisBlock::onLttngStatedumpProcessState(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    auto pid = fields->GetField("pid");
+    if (pid != nullptr)
+        _processes[fields->GetField("tid")->AsInteger()] = pid->AsInteger();
+}
+
+}
+}
@@ -0,0 +1,135 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_ABSTRACTANALYSISBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_ABSTRACTANALYSISBLOCK_HPP
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "block/AbstractBlock.hpp"
+#include "notification/NotificationSink.hpp"
+#include "quark/Quark.hpp"
+#include "state/AttributeKey.hpp"
+#include "state/CurrentState.hpp"
+#include "trace/value/EventValue.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * An abstract analysis block.
+ *
+ * An analysis block computes statistics from kernel events in a single
+ * pass over a trace. The thread running on each CPU and the name of each
+ * thread are read from the current state, so the CurrentStateBlock and
+ * the LinuxSchedStateBlock must run with the analysis block. State
+ * observers receive an event before analysis observers, so the current
+ * thread of a CPU is up-to-date when an analysis block receives an event.
+ * When the block is stopped, its report is posted on the
+ * "analysis/<name>" notification path.
+ *
+ * The state doesn't know the process of a thread: it is tracked by the
+ * observers added by AddObservers(), which derived blocks must call.
+ *
+ * @author Francois Doray
+ */
+class AbstractAnalysisBlock : public block::AbstractBlock
+{
+public:
+    explicit AbstractAnalysisBlock(const std::string& name);
+
+    virtual void LoadServices(const block::ServiceList& serviceList) override;
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+    virtual void Stop() override;
+
+    /**
+     * Returns the results of the analysis.
+     */
+    virtual value::Value::UP GetReport() const = 0;
+
+    const std::string& name() const { return _name; }
+
+protected:
+    static const int32_t kUnknownThread = -1;
+
+    // Number of outliers kept by default.
+    static const size_t kDefaultTopSize = 10;
+
+    // Returns the "top" parameter, or kDefaultTopSize.
+    static size_t GetTopSize(const value::Value* parameters);
+
+    // Returns the CPU on which an event occurred. The position of the
+    // "cpu_id" field in the packet context is looked up once per class
+    // of event.
+    uint32_t GetEventCpu(const trace::EventValue& event);
+
+    // Returns a key that identifies the class of an event across traces,
+    // used to cache information derived from the name of the event.
+    static uint64_t GetEventClassKey(const trace::EventValue& event)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(event.getTraceId())) << 32) |
+               static_cast<uint32_t>(event.getId());
+    }
+
+    // Returns the thread running on a CPU, or kUnknownThread.
+    int32_t GetCurrentThread(uint32_t cpu);
+
+    // Returns the name of a thread, or an empty string.
+    std::string GetThreadName(int32_t tid) const;
+
+    // Returns the process of a thread. Threads whose process is unknown
+    // are considered to be their own process.
+    int32_t GetProcessId(int32_t tid) const;
+
+    state::CurrentState* State() const { return _currentState; }
+
+private:
+    void onSchedProcessFork(const trace::EventValue& event);
+    void onSchedProcessFree(const trace::EventValue& event);
+    void onLttngStatedumpProcessState(const trace::EventValue& event);
+
+    std::string _name;
+    const notification::NotificationSink* _reportSink;
+    state::CurrentState* _currentState;
+
+    // Constant quarks.
+    quark::Quark Q_LINUX;
+    quark::Quark Q_CPUS;
+    quark::Quark Q_CUR_THREAD;
+
+    // Current thread attribute of each CPU.
+    std::vector<state::AttributeKey> _currentThreadAttributes;
+
+    // Position of the "cpu_id" field in the packet context, by class of
+    // event.
+    std::unordered_map<uint64_t, size_t> _cpuIdFieldIndexes;
+
+    // Process of each thread.
+    std::unordered_map<int32_t, int32_t> _processes;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_ABSTRACTANALYSISBLOCK_HPP
@@ -0,0 +1,267 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/BlockIoBlock.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+const timestamp_t kNoTimestamp = static_cast<timestamp_t>(-1);
+
+const uint64_t kSectorSize = 512;
+
+// Bit of the integer rwbs field of LTTng for writes.
+const uint32_t kRwbsFlagWrite = 1 << 0;
+
+// Whether a request is a write. Older tracers record rwbs as a string
+// ("W", "WS", "R", ...), newer ones as flags.
+bool IsWrite(const value::Value* rwbs)
+{
+    if (rwbs == nullptr)
+        return false;
+
+    uint32_t flags = 0;
+    if (rwbs->AsUInteger(&flags))
+        return (flags & kRwbsFlagWrite) != 0;
+
+    std::string str;
+    if (rwbs->AsString(&str))
+        return str.find('W') != std::string::npos;
+    return false;
+}
+
+// A device number is major << 20 | minor.
+uint32_t DeviceMajor(uint32_t dev)
+{
+    return dev >> 20;
+}
+
+uint32_t DeviceMinor(uint32_t dev)
+{
+    return dev & ((1 << 20) - 1);
+}
+
+}  // namespace
+
+BlockIoBlock::BlockIoBlock()
+    : AbstractAnalysisBlock("block-io"),
+      _maxInFlight(0)
+{
+}
+
+void BlockIoBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<BlockIoBlock, &BlockIoBlock::onBlockRqInsert>(notificationCenter, Token("block_rq_insert"), this);
+    AddKernelObserver<BlockIoBlock, &BlockIoBlock::onBlockRqIssue>(notificationCenter, Token("block_rq_issue"), this);
+    AddKernelObserver<BlockIoBlock, &BlockIoBlock::onBlockRqComplete>(notificationCenter, Token("block_rq_complete"), this);
+    AddKernelObserver<BlockIoBlock, &BlockIoBlock::onBlockRqRequeue>(notificationCenter, Token("block_rq_requeue"), this);
+    AddKernelObserver<BlockIoBlock, &BlockIoBlock::onBlockRqAbort>(notificationCenter, Token("block_rq_abort"), this);
+}
+
+void BlockIoBlock::onBlockRqInsert(const trace::EventValue& event)
+{
+    Request request;
+    request.insert = event.getTimestamp();
+    request.issue = kNoTimestamp;
+    request.tid = GetSubmitter(event);
+
+    // A request for the same sector replaces a request that was never
+    // completed.
+    *_requests.Insert(GetRequestKey(event), request).first = request;
+    UpdateMaxInFlight();
+}
+
+void BlockIoBlock::onBlockRqIssue(const trace::EventValue& event)
+{
+    auto key = GetRequestKey(event);
+    Request* request = _requests.Find(key);
+    if (request == nullptr)
+    {
+        // The request bypassed the I/O scheduler, or was inserted before
+        // the beginning of the trace.
+        Request newRequest;
+        newRequest.insert = kNoTimestamp;
+        newRequest.issue = kNoTimestamp;
+        newRequest.tid = GetSubmitter(event);
+        request = _requests.Insert(key, newRequest).first;
+        UpdateMaxInFlight();
+    }
+
+    request->issue = event.getTimestamp();
+    if (request->insert == kNoTimestamp || request->issue < request->insert)
+        return;
+
+    uint64_t latency = request->issue - request->insert;
+    _queue.Record(latency);
+    _devices[key.dev].queue.Record(latency);
+}
+
+void BlockIoBlock::onBlockRqComplete(const trace::EventValue& event)
+{
+    auto key = GetRequestKey(event);
+    const Request* found = _requests.Find(key);
+    if (found == nullptr)
+        return;
+    Request request = *found;
+    _requests.Erase(key);
+
+    auto fields = event.getFields();
+    uint64_t bytes = fields->GetField("nr_sector")->AsULong() * kSectorSize;
+    bool write = IsWrite(fields->GetField("rwbs"));
+
+    DeviceStats& device = _devices[key.dev];
+    (write ? device.writeBytes : device.readBytes) += bytes;
+
+    ProcessStats* process = nullptr;
+    if (request.tid != kUnknownThread)
+    {
+        auto pid = GetProcessId(request.tid);
+        process = &_processes[pid];
+        if (process->name.empty())
+            process->name = GetThreadName(pid);
+        ++process->requests;
+        (write ? process->writeBytes : process->readBytes) += bytes;
+    }
+
+    if (request.issue == kNoTimestamp || event.getTimestamp() < request.issue)
+        return;
+
+    uint64_t latency = event.getTimestamp() - request.issue;
+    _service.Record(latency);
+    device.service.Record(latency);
+    if (process != nullptr)
+        process->service.Record(latency);
+}
+
+void BlockIoBlock::onBlockRqRequeue(const trace::EventValue& event)
+{
+    // The request goes back to the queue.
+    Request* request = _requests.Find(GetRequestKey(event));
+    if (request == nullptr)
+        return;
+    request->insert = event.getTimestamp();
+    request->issue = kNoTimestamp;
+}
+
+void BlockIoBlock::onBlockRqAbort(const trace::EventValue& event)
+{
+    _requests.Erase(GetRequestKey(event));
+}
+
+BlockIoBlock::RequestKey BlockIoBlock::GetRequestKey(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    return RequestKey(fields->GetField("dev")->AsUInteger(),
+                      fields->GetField("sector")->AsULong());
+}
+
+int32_t BlockIoBlock::GetSubmitter(const trace::EventValue& event)
+{
+    auto tid = GetCurrentThread(GetEventCpu(event));
+    if (tid != kUnknownThread)
+        return tid;
+
+    // Recent tracers record the submitter in the event.
+    const value::Value* tidField = event.getFields()->GetField("tid");
+    if (tidField != nullptr)
+        return tidField->AsInteger();
+    return kUnknownThread;
+}
+
+void BlockIoBlock::UpdateMaxInFlight()
+{
+    _maxInFlight = std::max(_maxInFlight, _requests.size());
+}
+
+const BlockIoBlock::DeviceStats* BlockIoBlock::GetDeviceStats(uint32_t dev) const
+{
+    auto look = _devices.find(dev);
+    if (look == _devices.end())
+        return nullptr;
+    return &look->second;
+}
+
+const BlockIoBlock::ProcessStats* BlockIoBlock::GetProcessStats(int32_t pid) const
+{
+    auto look = _processes.find(pid);
+    if (look == _processes.end())
+        return nullptr;
+    return &look->second;
+}
+
+value::Value::UP BlockIoBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField("queue", _queue.ToValue());
+    report->AddField("service", _service.ToValue());
+    report->AddField<value::ULongValue>("max_in_flight", _maxInFlight);
+
+    value::ArrayValue::UP devicesValue {new value::ArrayValue};
+    for (const auto& device : _devices)
+    {
+        value::StructValue::UP deviceValue {new value::StructValue};
+        deviceValue->AddField<value::UIntValue>("dev", device.first);
+        deviceValue->AddField<value::UIntValue>("major", DeviceMajor(device.first));
+        deviceValue->AddField<value::UIntValue>("minor", DeviceMinor(device.first));
+        deviceValue->AddField("queue", device.second.queue.ToValue());
+        deviceValue->AddField("service", device.second.service.ToValue());
+        deviceValue->AddField<value::ULongValue>("read_bytes", device.second.readBytes);
+        deviceValue->AddField<value::ULongValue>("write_bytes", device.second.writeBytes);
+        devicesValue->Append(std::move(deviceValue));
+    }
+    report->AddField("devices", std::move(devicesValue));
+
+    std::vector<int32_t> pids;
+    for (const auto& process : _processes)
+        pids.push_back(process.first);
+    std::sort(pids.begin(), pids.end());
+
+    value::ArrayValue::UP processesValue {new value::ArrayValue};
+    for (auto pid : pids)
+    {
+        const ProcessStats& process = _processes.at(pid);
+        value::StructValue::UP processValue {new value::StructValue};
+        processValue->AddField<value::IntValue>("pid", pid);
+        processValue->AddField<value::StringValue>("name", process.name);
+        processValue->AddField<value::ULongValue>("requests", process.requests);
+        processValue->AddField<value::ULongValue>("read_bytes", process.readBytes);
+        processValue->AddField<value::ULongValue>("write_bytes", process.writeBytes);
+        processValue->AddField("service", process.service.ToValue());
+        processesValue->Append(std::move(processValue));
+    }
+    report->AddField("processes", std::move(processesValue));
+
+    return std::move(report);
+}
+
+}
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_BLOCKIOBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_BLOCKIOBLOCK_HPP
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "base/OpenHashMap.hpp"
+#include "stats/Histogram.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that measures the latency of block I/O requests.
+ *
+ * Requests are matched by (device, sector) between block_rq_insert,
+ * block_rq_issue and block_rq_complete. The queue latency goes from the
+ * insertion to the issue of a request and the service latency from its
+ * issue to its completion. A request is attributed to the thread that
+ * runs on the CPU where it is inserted (or issued, if it bypasses the
+ * I/O scheduler).
+ *
+ * In-flight requests are kept in an open addressing table, which
+ * doesn't allocate per request and grows to the peak number of
+ * in-flight requests.
+ *
+ * @author Francois Doray
+ */
+class BlockIoBlock : public AbstractAnalysisBlock
+{
+public:
+    struct DeviceStats
+    {
+        DeviceStats() : readBytes(0), writeBytes(0) {}
+        stats::Histogram queue;
+        stats::Histogram service;
+        uint64_t readBytes;
+        uint64_t writeBytes;
+    };
+
+    struct ProcessStats
+    {
+        ProcessStats() : requests(0), readBytes(0), writeBytes(0) {}
+        std::string name;
+        uint64_t requests;
+        uint64_t readBytes;
+        uint64_t writeBytes;
+        stats::Histogram service;
+    };
+
+    BlockIoBlock();
+
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    const stats::Histogram& queueLatency() const { return _queue; }
+    const stats::Histogram& serviceLatency() const { return _service; }
+
+    // Returns the statistics of a device or process, or nullptr.
+    const DeviceStats* GetDeviceStats(uint32_t dev) const;
+    const ProcessStats* GetProcessStats(int32_t pid) const;
+
+    size_t maxInFlight() const { return _maxInFlight; }
+    size_t inFlight() const { return _requests.size(); }
+
+private:
+    void onBlockRqInsert(const trace::EventValue& event);
+    void onBlockRqIssue(const trace::EventValue& event);
+    void onBlockRqComplete(const trace::EventValue& event);
+    void onBlockRqRequeue(const trace::EventValue& event);
+    void onBlockRqAbort(const trace::EventValue& event);
+
+    struct RequestKey
+    {
+        RequestKey() : dev(0), sector(0) {}
+        RequestKey(uint32_t dev, uint64_t sector) : dev(dev), sector(sector) {}
+
+        bool operator==(const RequestKey& other) const
+        {
+            return dev == other.dev && sector == other.sector;
+        }
+
+        uint32_t dev;
+        uint64_t sector;
+    };
+
+    struct RequestKeyHash
+    {
+        size_t operator()(const RequestKey& key) const
+        {
+            return static_cast<size_t>(key.sector ^ (static_cast<uint64_t>(key.dev) << 40));
+        }
+    };
+
+    struct Request
+    {
+        timestamp_t insert;
+        timestamp_t issue;
+        int32_t tid;
+    };
+
+    static RequestKey GetRequestKey(const trace::EventValue& event);
+
+    // Returns the thread that submits a request.
+    int32_t GetSubmitter(const trace::EventValue& event);
+
+    void UpdateMaxInFlight();
+
+    base::OpenHashMap<RequestKey, Request, RequestKeyHash> _requests;
+    size_t _maxInFlight;
+
+    stats::Histogram _queue;
+    stats::Histogram _service;
+    std::map<uint32_t, DeviceStats> _devices;
+    std::unordered_map<int32_t, ProcessStats> _processes;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_BLOCKIOBLOCK_HPP
@@ -0,0 +1,276 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/BlockIoBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+#include "trace_gen/CtfWriter.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+namespace
+{
+
+namespace bfs = boost::filesystem;
+
+using trace_gen::CtfWriter;
+using trace_gen::FieldType;
+
+// Devices sda and sdb.
+const uint32_t kSda = (8 << 20) | 0;
+const uint32_t kSdb = (8 << 20) | 16;
+
+const uint32_t kRead = 0;
+const uint32_t kWrite = 1;
+
+const int32_t kReaderTid = 100;
+const int32_t kWriterTid = 200;
+
+class BlockIoTraceWriter
+{
+public:
+    explicit BlockIoTraceWriter(const bfs::path& directory)
+        : _writer(directory, 2, CtfWriter::kDefaultPacketSize, 0)
+    {
+    }
+
+    bool Open()
+    {
+        if (!_writer.Open())
+            return false;
+
+        _schedSwitch = _writer.AddEventClass("sched_switch", {
+            {"prev_comm", FieldType::kComm},
+            {"prev_tid", FieldType::kInt32},
+            {"prev_prio", FieldType::kInt32},
+            {"prev_state", FieldType::kInt64},
+            {"next_comm", FieldType::kComm},
+            {"next_tid", FieldType::kInt32},
+            {"next_prio", FieldType::kInt32},
+        });
+
+        trace_gen::FieldDeclarations requestFields {
+            {"dev", FieldType::kUInt32},
+            {"sector", FieldType::kUInt64},
+            {"nr_sector", FieldType::kUInt32},
+            {"rwbs", FieldType::kUInt32},
+        };
+        _insert = _writer.AddEventClass("block_rq_insert", requestFields);
+        _issue = _writer.AddEventClass("block_rq_issue", requestFields);
+        _complete = _writer.AddEventClass("block_rq_complete", requestFields);
+        _requeue = _writer.AddEventClass("block_rq_requeue", requestFields);
+        _abort = _writer.AddEventClass("block_rq_abort", requestFields);
+        return true;
+    }
+
+    void SchedSwitch(uint32_t cpu, timestamp_t ts, int32_t nextTid, const std::string& nextComm)
+    {
+        _writer.BeginEvent(cpu, ts, _schedSwitch);
+        _writer.AddComm("swapper");
+        _writer.AddInt32(0);
+        _writer.AddInt32(20);
+        _writer.AddInt64(0);
+        _writer.AddComm(nextComm);
+        _writer.AddInt32(nextTid);
+        _writer.AddInt32(20);
+        _writer.EndEvent();
+    }
+
+    void Insert(uint32_t cpu, timestamp_t ts, uint32_t dev, uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        Request(_insert, cpu, ts, dev, sector, nrSector, rwbs);
+    }
+
+    void Issue(uint32_t cpu, timestamp_t ts, uint32_t dev, uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        Request(_issue, cpu, ts, dev, sector, nrSector, rwbs);
+    }
+
+    void Complete(uint32_t cpu, timestamp_t ts, uint32_t dev, uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        Request(_complete, cpu, ts, dev, sector, nrSector, rwbs);
+    }
+
+    void Requeue(uint32_t cpu, timestamp_t ts, uint32_t dev, uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        Request(_requeue, cpu, ts, dev, sector, nrSector, rwbs);
+    }
+
+    void Abort(uint32_t cpu, timestamp_t ts, uint32_t dev, uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        Request(_abort, cpu, ts, dev, sector, nrSector, rwbs);
+    }
+
+    bool Close()
+    {
+        return _writer.Close();
+    }
+
+private:
+    void Request(uint32_t eventClass, uint32_t cpu, timestamp_t ts, uint32_t dev,
+                 uint64_t sector, uint32_t nrSector, uint32_t rwbs)
+    {
+        _writer.BeginEvent(cpu, ts, eventClass);
+        _writer.AddUInt32(dev);
+        _writer.AddUInt64(sector);
+        _writer.AddUInt32(nrSector);
+        _writer.AddUInt32(rwbs);
+        _writer.EndEvent();
+    }
+
+    CtfWriter _writer;
+    uint32_t _schedSwitch;
+    uint32_t _insert;
+    uint32_t _issue;
+    uint32_t _complete;
+    uint32_t _requeue;
+    uint32_t _abort;
+};
+
+}  // namespace
+
+TEST(BlockIoBlock, BlockIoBlock)
+{
+    bfs::path directory =
+        bfs::temp_directory_path() / bfs::unique_path("tibee-%%%%-%%%%");
+
+    // The reader runs on CPU 0 and the writer on CPU 1. The events of a
+    // CPU are written in timestamp order.
+    BlockIoTraceWriter trace(directory);
+    ASSERT_TRUE(trace.Open());
+
+    trace.SchedSwitch(0, 1000, kReaderTid, "reader");
+    // Read of 8 sectors: queued for 500 ns, serviced in 2000 ns.
+    trace.Insert(0, 10000, kSda, 100, 8, kRead);
+    trace.Issue(0, 10500, kSda, 100, 8, kRead);
+    trace.Complete(0, 12500, kSda, 100, 8, kRead);
+    // Aborted read: its completion is ignored.
+    trace.Insert(0, 15000, kSda, 300, 8, kRead);
+    trace.Abort(0, 16000, kSda, 300, 8, kRead);
+    trace.Complete(0, 18000, kSda, 300, 8, kRead);
+    // Read that bypasses the I/O scheduler: no queue latency, serviced
+    // in 1000 ns.
+    trace.Issue(0, 19000, kSdb, 400, 8, kRead);
+    trace.Complete(0, 20000, kSdb, 400, 8, kRead);
+
+    trace.SchedSwitch(1, 1000, kWriterTid, "writer");
+    // Write of 16 sectors: queued for 2000 ns, requeued after 1000 ns
+    // of service, queued again for 300 ns and serviced in 3000 ns.
+    trace.Insert(1, 11000, kSda, 200, 16, kWrite);
+    trace.Issue(1, 13000, kSda, 200, 16, kWrite);
+    trace.Requeue(1, 14000, kSda, 200, 16, kWrite);
+    trace.Issue(1, 14300, kSda, 200, 16, kWrite);
+    trace.Complete(1, 17300, kSda, 200, 16, kWrite);
+
+    ASSERT_TRUE(trace.Close());
+
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>(directory.string());
+    traceParams.AddField("traces", std::move(traceList));
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    BlockIoBlock blockIoBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&blockIoBlock, nullptr);
+    blockRunner.Run();
+
+    // The read and the write were in flight together, as were the write
+    // and the aborted read.
+    EXPECT_EQ(0u, blockIoBlock.inFlight());
+    EXPECT_EQ(2u, blockIoBlock.maxInFlight());
+
+    const stats::Histogram& queue = blockIoBlock.queueLatency();
+    EXPECT_EQ(3u, queue.count());
+    EXPECT_EQ(500u + 2000u + 300u, queue.sum());
+    EXPECT_EQ(300u, queue.min());
+    EXPECT_EQ(2000u, queue.max());
+
+    const stats::Histogram& service = blockIoBlock.serviceLatency();
+    EXPECT_EQ(3u, service.count());
+    EXPECT_EQ(2000u + 3000u + 1000u, service.sum());
+    EXPECT_EQ(1000u, service.min());
+    EXPECT_EQ(3000u, service.max());
+
+    const BlockIoBlock::DeviceStats* sda = blockIoBlock.GetDeviceStats(kSda);
+    ASSERT_NE(nullptr, sda);
+    EXPECT_EQ(3u, sda->queue.count());
+    EXPECT_EQ(2u, sda->service.count());
+    EXPECT_EQ(2000u + 3000u, sda->service.sum());
+    EXPECT_EQ(8u * 512, sda->readBytes);
+    EXPECT_EQ(16u * 512, sda->writeBytes);
+
+    const BlockIoBlock::DeviceStats* sdb = blockIoBlock.GetDeviceStats(kSdb);
+    ASSERT_NE(nullptr, sdb);
+    EXPECT_EQ(0u, sdb->queue.count());
+    EXPECT_EQ(1u, sdb->service.count());
+    EXPECT_EQ(1000u, sdb->service.max());
+    EXPECT_EQ(8u * 512, sdb->readBytes);
+    EXPECT_EQ(0u, sdb->writeBytes);
+
+    const BlockIoBlock::ProcessStats* reader = blockIoBlock.GetProcessStats(kReaderTid);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_EQ("reader", reader->name);
+    EXPECT_EQ(2u, reader->requests);
+    EXPECT_EQ(2u * 8 * 512, reader->readBytes);
+    EXPECT_EQ(0u, reader->writeBytes);
+    EXPECT_EQ(2000u + 1000u, reader->service.sum());
+
+    const BlockIoBlock::ProcessStats* writer = blockIoBlock.GetProcessStats(kWriterTid);
+    ASSERT_NE(nullptr, writer);
+    EXPECT_EQ("writer", writer->name);
+    EXPECT_EQ(1u, writer->requests);
+    EXPECT_EQ(0u, writer->readBytes);
+    EXPECT_EQ(16u * 512, writer->writeBytes);
+    EXPECT_EQ(3000u, writer->service.sum());
+
+    // The report lists the devices and processes in order.
+    auto report = blockIoBlock.GetReport();
+    EXPECT_EQ(2u, report->GetField("max_in_flight")->AsULong());
+    const value::ArrayValueBase* devices =
+        value::ArrayValueBase::Cast(report->GetField("devices"));
+    ASSERT_NE(nullptr, devices);
+    ASSERT_EQ(2u, devices->Length());
+    EXPECT_EQ(8u, (*devices)[1]->GetField("major")->AsUInteger());
+    EXPECT_EQ(16u, (*devices)[1]->GetField("minor")->AsUInteger());
+    const value::ArrayValueBase* processes =
+        value::ArrayValueBase::Cast(report->GetField("processes"));
+    ASSERT_NE(nullptr, processes);
+    ASSERT_EQ(2u, processes->Length());
+    EXPECT_EQ(kWriterTid, (*processes)[1]->GetField("pid")->AsInteger());
+    EXPECT_EQ(16u * 512, (*processes)[1]->GetField("write_bytes")->AsULong());
+
+    boost::system::error_code error;
+    bfs::remove_all(directory, error);
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
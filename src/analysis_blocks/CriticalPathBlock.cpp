@@ -0,0 +1,218 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/CriticalPathBlock.hpp"
+
+#include <algorithm>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+typedef ExecutionGraph::EdgeState EdgeState;
+
+namespace
+{
+
+// The idle threads of all CPUs share this TID: they aren't part of the
+// graph.
+const int32_t kIdleThread = 0;
+
+// prev_state of a thread that is still runnable when it is switched out.
+const int64_t kTaskRunning = 0;
+
+const timestamp_t kNoTimestamp = static_cast<timestamp_t>(-1);
+
+}  // namespace
+
+CriticalPathBlock::CriticalPathBlock()
+    : AbstractAnalysisBlock("critical-path"),
+      _tid(kUnknownThread),
+      _begin(0),
+      _end(kNoTimestamp),
+      _firstTs(kNoTimestamp),
+      _lastTs(0)
+{
+}
+
+void CriticalPathBlock::Start(const value::Value* parameters)
+{
+    if (parameters == nullptr)
+        return;
+
+    const value::Value* tid = nullptr;
+    if (parameters->GetField("tid", &tid))
+        tid->AsInteger(&_tid);
+
+    const value::Value* begin = nullptr;
+    if (parameters->GetField("begin", &begin))
+        begin->AsULong(&_begin);
+
+    const value::Value* end = nullptr;
+    if (parameters->GetField("end", &end))
+        end->AsULong(&_end);
+}
+
+void CriticalPathBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onSchedSwitch>(notificationCenter, Token("sched_switch"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onSchedWakeup>(notificationCenter, Token("sched_wakeup"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onSchedWakeup>(notificationCenter, Token("sched_wakeup_new"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onIrqHandlerEntry>(notificationCenter, Token("irq_handler_entry"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onInterruptExit>(notificationCenter, Token("irq_handler_exit"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onSoftIrqEntry>(notificationCenter, Token("softirq_entry"), this);
+    AddKernelObserver<CriticalPathBlock, &CriticalPathBlock::onInterruptExit>(notificationCenter, Token("softirq_exit"), this);
+}
+
+void CriticalPathBlock::onSchedSwitch(const trace::EventValue& event)
+{
+    UpdateTimestamps(event);
+
+    auto fields = event.getFields();
+    auto ts = event.getTimestamp();
+
+    auto prevTid = fields->GetField("prev_tid")->AsInteger();
+    if (prevTid != kIdleThread)
+    {
+        bool preempted = fields->GetField("prev_state")->AsLong() == kTaskRunning;
+        _graph.SetThreadState(ts, prevTid, preempted ? EdgeState::kPreempted : EdgeState::kBlocked);
+    }
+
+    auto nextTid = fields->GetField("next_tid")->AsInteger();
+    if (nextTid != kIdleThread)
+        _graph.SetThreadState(ts, nextTid, EdgeState::kRunning);
+}
+
+void CriticalPathBlock::onSchedWakeup(const trace::EventValue& event)
+{
+    UpdateTimestamps(event);
+
+    auto tid = event.getFields()->GetField("tid")->AsInteger();
+    if (tid == kIdleThread)
+        return;
+
+    auto cpu = GetEventCpu(event);
+    const InterruptStack& interrupts = GetInterruptStack(cpu);
+    if (!interrupts.empty())
+    {
+        const Interrupt& interrupt = interrupts.back();
+        _graph.AddInterruptWakeup(event.getTimestamp(), interrupt.handler, interrupt.number, tid);
+        return;
+    }
+
+    auto waker = GetCurrentThread(cpu);
+    if (waker == kIdleThread || waker == kUnknownThread)
+        waker = ExecutionGraph::kUnknownThread;
+    _graph.AddWakeup(event.getTimestamp(), waker, tid);
+}
+
+void CriticalPathBlock::onIrqHandlerEntry(const trace::EventValue& event)
+{
+    UpdateTimestamps(event);
+
+    Interrupt interrupt;
+    interrupt.handler = EdgeState::kInterrupt;
+    interrupt.number = event.getFields()->GetField("irq")->AsUInteger();
+    GetInterruptStack(GetEventCpu(event)).push_back(interrupt);
+}
+
+void CriticalPathBlock::onSoftIrqEntry(const trace::EventValue& event)
+{
+    UpdateTimestamps(event);
+
+    Interrupt interrupt;
+    interrupt.handler = EdgeState::kSoftIrq;
+    interrupt.number = event.getFields()->GetField("vec")->AsUInteger();
+    GetInterruptStack(GetEventCpu(event)).push_back(interrupt);
+}
+
+void CriticalPathBlock::onInterruptExit(const trace::EventValue& event)
+{
+    UpdateTimestamps(event);
+
+    // The entry may precede the beginning of the trace.
+    InterruptStack& interrupts = GetInterruptStack(GetEventCpu(event));
+    if (!interrupts.empty())
+        interrupts.pop_back();
+}
+
+void CriticalPathBlock::UpdateTimestamps(const trace::EventValue& event)
+{
+    auto ts = event.getTimestamp();
+    if (_firstTs == kNoTimestamp)
+        _firstTs = ts;
+    _lastTs = std::max(_lastTs, ts);
+}
+
+CriticalPathBlock::InterruptStack& CriticalPathBlock::GetInterruptStack(uint32_t cpu)
+{
+    if (cpu >= _interrupts.size())
+        _interrupts.resize(cpu + 1);
+    return _interrupts[cpu];
+}
+
+void CriticalPathBlock::ComputeCriticalPath(int32_t tid, timestamp_t begin, timestamp_t end,
+                                            ExecutionGraph::Path* path) const
+{
+    _graph.ComputeCriticalPath(tid, begin, end, path);
+}
+
+value::Value::UP CriticalPathBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField<value::ULongValue>("nodes", _graph.size());
+
+    if (_tid == kUnknownThread || _firstTs == kNoTimestamp)
+        return std::move(report);
+
+    timestamp_t begin = std::max(_begin, _firstTs);
+    timestamp_t end = std::min(_end, _lastTs);
+
+    ExecutionGraph::Path path;
+    _graph.ComputeCriticalPath(_tid, begin, end, &path);
+
+    report->AddField<value::IntValue>("tid", _tid);
+    report->AddField<value::ULongValue>("begin", begin);
+    report->AddField<value::ULongValue>("end", end);
+
+    value::ArrayValue::UP pathValue {new value::ArrayValue};
+    for (const auto& segment : path)
+    {
+        value::StructValue::UP segmentValue {new value::StructValue};
+        segmentValue->AddField<value::IntValue>("tid", segment.tid);
+        segmentValue->AddField<value::StringValue>("name", GetThreadName(segment.tid));
+        segmentValue->AddField<value::ULongValue>("begin", segment.begin);
+        segmentValue->AddField<value::ULongValue>("end", segment.end);
+        segmentValue->AddField<value::StringValue>("state", ExecutionGraph::EdgeStateName(segment.state));
+        if (segment.state == EdgeState::kInterrupt || segment.state == EdgeState::kSoftIrq)
+            segmentValue->AddField<value::UIntValue>("interrupt", segment.interrupt);
+        pathValue->Append(std::move(segmentValue));
+    }
+    report->AddField("path", std::move(pathValue));
+
+    return std::move(report);
+}
+
+}
+}
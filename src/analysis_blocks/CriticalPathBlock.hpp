@@ -0,0 +1,106 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_CRITICALPATHBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_CRITICALPATHBLOCK_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "analysis_blocks/ExecutionGraph.hpp"
+#include "base/BasicTypes.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that computes the critical path of a thread.
+ *
+ * The execution graph of all threads is built from sched_switch,
+ * sched_wakeup, sched_wakeup_new and the IRQ and softirq events during
+ * the pass over the trace. A wakeup that occurs in an interrupt handler
+ * is attributed to the interrupt, otherwise to the thread running on
+ * the CPU of the wakeup. The critical path is computed backward from
+ * the end of the target interval when the report is requested.
+ *
+ * Parameters:
+ *   tid: Optional. Thread whose critical path is reported.
+ *   begin: Optional. Beginning of the target interval (default: first
+ *          event of the trace).
+ *   end: Optional. End of the target interval (default: last event of
+ *        the trace).
+ *
+ * @author Francois Doray
+ */
+class CriticalPathBlock : public AbstractAnalysisBlock
+{
+public:
+    CriticalPathBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    const ExecutionGraph& graph() const { return _graph; }
+
+    // Computes the critical path of a thread in the graph built so far.
+    void ComputeCriticalPath(int32_t tid, timestamp_t begin, timestamp_t end,
+                             ExecutionGraph::Path* path) const;
+
+    timestamp_t firstTimestamp() const { return _firstTs; }
+    timestamp_t lastTimestamp() const { return _lastTs; }
+
+private:
+    void onSchedSwitch(const trace::EventValue& event);
+    void onSchedWakeup(const trace::EventValue& event);
+    void onIrqHandlerEntry(const trace::EventValue& event);
+    void onSoftIrqEntry(const trace::EventValue& event);
+    void onInterruptExit(const trace::EventValue& event);
+
+    void UpdateTimestamps(const trace::EventValue& event);
+
+    struct Interrupt
+    {
+        ExecutionGraph::EdgeState handler;
+        uint32_t number;
+    };
+    typedef std::vector<Interrupt> InterruptStack;
+
+    InterruptStack& GetInterruptStack(uint32_t cpu);
+
+    ExecutionGraph _graph;
+
+    // Interrupt handlers running on each CPU, innermost last.
+    std::vector<InterruptStack> _interrupts;
+
+    // Target of the report.
+    int32_t _tid;
+    timestamp_t _begin;
+    timestamp_t _end;
+
+    timestamp_t _firstTs;
+    timestamp_t _lastTs;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_CRITICALPATHBLOCK_HPP
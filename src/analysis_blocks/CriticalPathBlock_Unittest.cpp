@@ -0,0 +1,114 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/CriticalPathBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+#include "trace_gen/KernelTraceGenerator.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+namespace
+{
+
+namespace bfs = boost::filesystem;
+
+// First thread of the synthetic traces.
+const int32_t kFirstTid = 1000;
+
+}  // namespace
+
+TEST(CriticalPathBlock, CriticalPathBlock)
+{
+    bfs::path directory =
+        bfs::temp_directory_path() / bfs::unique_path("tibee-%%%%-%%%%");
+
+    trace_gen::KernelTraceConfig config;
+    config.numCpus = 2;
+    config.numThreads = 6;
+    config.durationNs = 20000000;
+    config.eventRate = 50000;
+    config.forkRate = 500;
+    ASSERT_TRUE(trace_gen::GenerateKernelTrace(config, directory, nullptr));
+
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>(directory.string());
+    traceParams.AddField("traces", std::move(traceList));
+
+    value::StructValue criticalPathParams;
+    criticalPathParams.AddField<value::IntValue>("tid", kFirstTid);
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    CriticalPathBlock criticalPathBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&criticalPathBlock, &criticalPathParams);
+    blockRunner.Run();
+
+    EXPECT_LT(0u, criticalPathBlock.graph().size());
+
+    // The path covers the whole interval, without gaps.
+    timestamp_t begin = criticalPathBlock.firstTimestamp();
+    timestamp_t end = criticalPathBlock.lastTimestamp();
+    ExecutionGraph::Path path;
+    criticalPathBlock.ComputeCriticalPath(kFirstTid, begin, end, &path);
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(begin, path.front().begin);
+    EXPECT_EQ(end, path.back().end);
+    for (size_t i = 0; i < path.size(); ++i)
+        EXPECT_LT(path[i].begin, path[i].end);
+    for (size_t i = 1; i < path.size(); ++i)
+        EXPECT_EQ(path[i - 1].end, path[i].begin);
+
+    // The target thread runs, and other threads appear on its path.
+    bool running = false;
+    bool otherThread = false;
+    for (const auto& segment : path)
+    {
+        if (segment.tid == kFirstTid && segment.state == ExecutionGraph::EdgeState::kRunning)
+            running = true;
+        if (segment.tid != kFirstTid)
+            otherThread = true;
+    }
+    EXPECT_TRUE(running);
+    EXPECT_TRUE(otherThread);
+
+    auto report = criticalPathBlock.GetReport();
+    EXPECT_EQ(kFirstTid, report->GetField("tid")->AsInteger());
+    EXPECT_EQ(path.size(),
+              value::ArrayValueBase::Cast(report->GetField("path"))->Length());
+
+    boost::system::error_code error;
+    bfs::remove_all(directory, error);
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,215 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/ExecutionGraph.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+const int32_t ExecutionGraph::kUnknownThread;
+const uint32_t ExecutionGraph::kNoNode;
+
+ExecutionGraph::ExecutionGraph()
+{
+}
+
+void ExecutionGraph::SetThreadState(timestamp_t ts, int32_t tid, EdgeState state)
+{
+    Thread* thread = &_threads[tid];
+    AddNode(ts, tid, thread, thread->state, kNoNode);
+    thread->state = state;
+}
+
+void ExecutionGraph::AddWakeup(timestamp_t ts, int32_t waker, int32_t wakee)
+{
+    Thread* wakeeThread = &_threads[wakee];
+    if (!CanBeWokenUp(wakeeThread->state))
+        return;
+
+    uint32_t wakerNode = kNoNode;
+    if (waker != kUnknownThread && waker != wakee)
+    {
+        Thread* wakerThread = &_threads[waker];
+        wakerNode = AddNode(ts, waker, wakerThread, wakerThread->state, kNoNode);
+    }
+
+    AddNode(ts, wakee, wakeeThread, EdgeState::kBlocked, wakerNode);
+    wakeeThread->state = EdgeState::kRunnable;
+}
+
+void ExecutionGraph::AddInterruptWakeup(timestamp_t ts, EdgeState handler, uint32_t interrupt, int32_t wakee)
+{
+    assert(handler == EdgeState::kInterrupt || handler == EdgeState::kSoftIrq);
+
+    Thread* wakeeThread = &_threads[wakee];
+    if (!CanBeWokenUp(wakeeThread->state))
+        return;
+
+    AddNode(ts, wakee, wakeeThread, handler, interrupt);
+    wakeeThread->state = EdgeState::kRunnable;
+}
+
+uint32_t ExecutionGraph::AddNode(timestamp_t ts, int32_t tid, Thread* thread, EdgeState edgeState, uint32_t source)
+{
+    assert(_nodes.empty() || _nodes.back().ts <= ts);
+
+    Node node;
+    node.ts = ts;
+    node.prev = thread->lastNode;
+    node.source = source;
+    node.tid = tid;
+    node.state = edgeState;
+
+    uint32_t index = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back(node);
+    thread->lastNode = index;
+    return index;
+}
+
+bool ExecutionGraph::CanBeWokenUp(EdgeState state)
+{
+    return state == EdgeState::kBlocked || state == EdgeState::kUnknown;
+}
+
+void ExecutionGraph::ComputeCriticalPath(int32_t tid, timestamp_t begin, timestamp_t end, Path* path) const
+{
+    assert(path != nullptr);
+    path->clear();
+
+    auto look = _threads.find(tid);
+    if (look == _threads.end() || look->second.lastNode == kNoNode || begin >= end)
+        return;
+
+    // Segments are found from the end to the beginning of the interval.
+    Path reversed;
+    auto emit = [&] (int32_t segmentTid, timestamp_t segmentBegin, timestamp_t segmentEnd,
+                     EdgeState state, uint32_t interrupt) {
+        if (segmentBegin >= segmentEnd)
+            return;
+        if (!reversed.empty() && reversed.back().tid == segmentTid &&
+            reversed.back().state == state && reversed.back().begin == segmentEnd &&
+            reversed.back().interrupt == interrupt)
+        {
+            reversed.back().begin = segmentBegin;
+            return;
+        }
+        reversed.push_back(Segment {segmentTid, segmentBegin, segmentEnd, state, interrupt});
+    };
+
+    // After the last node of the thread, the thread is in its current
+    // state.
+    const Thread& thread = look->second;
+    const Node& lastNode = _nodes[thread.lastNode];
+    if (lastNode.ts < end)
+        emit(tid, std::max(lastNode.ts, begin), end, thread.state, 0);
+
+    // Walk the graph backward. A frame explains the interval
+    // [lowerBound, upperBound] from the edges that end at or before
+    // |node|. The stack replaces recursion, since chains of wakeups can
+    // be very long.
+    struct Frame
+    {
+        uint32_t node;
+        timestamp_t lowerBound;
+        timestamp_t upperBound;
+    };
+    std::vector<Frame> stack;
+    stack.push_back(Frame {thread.lastNode, begin, std::min(end, lastNode.ts)});
+
+    while (!stack.empty())
+    {
+        Frame frame = stack.back();
+        const Node& node = _nodes[frame.node];
+
+        if (node.ts <= frame.lowerBound || frame.lowerBound >= frame.upperBound)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        if (node.prev == kNoNode)
+        {
+            if (node.state == EdgeState::kBlocked && node.source != kNoNode)
+            {
+                // The thread didn't exist before it was woken up for the
+                // first time (e.g. after a fork): continue on its waker.
+                stack.back().node = node.source;
+                stack.back().upperBound = std::min(frame.upperBound, node.ts);
+            }
+            else
+            {
+                emit(node.tid, frame.lowerBound, std::min(node.ts, frame.upperBound),
+                     EdgeState::kUnknown, 0);
+                stack.pop_back();
+            }
+            continue;
+        }
+
+        const Node& prev = _nodes[node.prev];
+        timestamp_t segmentBegin = std::max(prev.ts, frame.lowerBound);
+        timestamp_t segmentEnd = std::min(node.ts, frame.upperBound);
+        stack.back().node = node.prev;
+
+        if (segmentBegin >= segmentEnd)
+            continue;
+
+        if (node.state == EdgeState::kBlocked && node.source != kNoNode)
+        {
+            // The waker explains why the thread was blocked.
+            stack.push_back(Frame {node.source, segmentBegin, segmentEnd});
+        }
+        else
+        {
+            bool isInterrupt = node.state == EdgeState::kInterrupt ||
+                               node.state == EdgeState::kSoftIrq;
+            emit(node.tid, segmentBegin, segmentEnd, node.state,
+                 isInterrupt ? node.source : 0);
+        }
+    }
+
+    path->assign(reversed.rbegin(), reversed.rend());
+}
+
+const char* ExecutionGraph::EdgeStateName(EdgeState state)
+{
+    switch (state)
+    {
+        case EdgeState::kUnknown:
+            return "unknown";
+        case EdgeState::kRunning:
+            return "running";
+        case EdgeState::kPreempted:
+            return "preempted";
+        case EdgeState::kRunnable:
+            return "runnable";
+        case EdgeState::kBlocked:
+            return "blocked";
+        case EdgeState::kInterrupt:
+            return "interrupt";
+        case EdgeState::kSoftIrq:
+            return "softirq";
+    }
+    return "unknown";
+}
+
+}
+}
@@ -0,0 +1,161 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_EXECUTIONGRAPH_HPP
+#define _TIBEE_ANALYSISBLOCKS_EXECUTIONGRAPH_HPP
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "base/BasicTypes.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * Execution graph of the threads of a system.
+ *
+ * Each thread is a chain of nodes ordered by time. The horizontal edge
+ * that ends at a node tells what the thread was doing since its previous
+ * node; a blocked edge can also point to the node of the thread that
+ * woke it up (vertical edge). Edges are stored inside the nodes, which
+ * are 24 bytes each and kept in a single array, so a graph built from
+ * millions of events fits in a few tens of megabytes.
+ *
+ * Nodes must be added in timestamp order.
+ *
+ * @author Francois Doray
+ */
+class ExecutionGraph
+{
+public:
+    enum class EdgeState : uint8_t
+    {
+        kUnknown,
+        kRunning,
+        // Runnable after being preempted.
+        kPreempted,
+        // Runnable after being woken up.
+        kRunnable,
+        kBlocked,
+        // Blocked, then woken up by an interrupt handler.
+        kInterrupt,
+        // Blocked, then woken up by a softirq handler.
+        kSoftIrq,
+    };
+
+    /**
+     * Segment of a critical path: |tid| was in |state| from |begin| to
+     * |end|. |interrupt| is the IRQ line or softirq vector of kInterrupt
+     * and kSoftIrq segments.
+     */
+    struct Segment
+    {
+        int32_t tid;
+        timestamp_t begin;
+        timestamp_t end;
+        EdgeState state;
+        uint32_t interrupt;
+    };
+    typedef std::vector<Segment> Path;
+
+    static const int32_t kUnknownThread = -1;
+
+    ExecutionGraph();
+
+    /**
+     * Sets the state of a thread. Adds a node that ends the edge of the
+     * previous state.
+     */
+    void SetThreadState(timestamp_t ts, int32_t tid, EdgeState state);
+
+    /**
+     * Records that |wakee| was woken up by |waker|, which may be
+     * kUnknownThread. Wakeups of threads that are running or runnable
+     * are ignored.
+     */
+    void AddWakeup(timestamp_t ts, int32_t waker, int32_t wakee);
+
+    /**
+     * Records that |wakee| was woken up by an interrupt (kInterrupt) or
+     * softirq (kSoftIrq) handler.
+     */
+    void AddInterruptWakeup(timestamp_t ts, EdgeState handler, uint32_t interrupt, int32_t wakee);
+
+    /**
+     * Computes the critical path of a thread between two timestamps,
+     * i.e. what the thread was waiting for during that interval. The
+     * graph is walked backward from |end|: when the thread is blocked,
+     * the walk continues on the thread that woke it up, until the time
+     * at which it blocked. Adjacent segments of a same thread and state
+     * are merged.
+     *
+     * @param tid The thread.
+     * @param begin Beginning of the interval.
+     * @param end End of the interval.
+     * @param path Critical path, ordered by time.
+     */
+    void ComputeCriticalPath(int32_t tid, timestamp_t begin, timestamp_t end, Path* path) const;
+
+    size_t size() const { return _nodes.size(); }
+
+    static const char* EdgeStateName(EdgeState state);
+
+private:
+    static const uint32_t kNoNode = static_cast<uint32_t>(-1);
+
+    struct Node
+    {
+        timestamp_t ts;
+
+        // Previous node of the same thread.
+        uint32_t prev;
+
+        // Node of the thread that woke up this thread, for a kBlocked
+        // edge, or number of the interrupt for a kInterrupt or kSoftIrq
+        // edge.
+        uint32_t source;
+
+        int32_t tid;
+
+        // State of the thread between |prev| and this node.
+        EdgeState state;
+    };
+
+    struct Thread
+    {
+        Thread() : lastNode(kNoNode), state(EdgeState::kUnknown) {}
+        uint32_t lastNode;
+        EdgeState state;
+    };
+
+    uint32_t AddNode(timestamp_t ts, int32_t tid, Thread* thread, EdgeState edgeState, uint32_t source);
+
+    // Whether a thread in |state| can be woken up.
+    static bool CanBeWokenUp(EdgeState state);
+
+    std::vector<Node> _nodes;
+    std::unordered_map<int32_t, Thread> _threads;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_EXECUTIONGRAPH_HPP
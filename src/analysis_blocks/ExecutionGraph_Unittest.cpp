@@ -0,0 +1,130 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "analysis_blocks/ExecutionGraph.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+namespace
+{
+
+typedef ExecutionGraph::EdgeState EdgeState;
+
+void ExpectSegment(const ExecutionGraph::Segment& segment, int32_t tid,
+                   timestamp_t begin, timestamp_t end, EdgeState state)
+{
+    EXPECT_EQ(tid, segment.tid);
+    EXPECT_EQ(begin, segment.begin);
+    EXPECT_EQ(end, segment.end);
+    EXPECT_EQ(state, segment.state);
+}
+
+// Thread 1 runs until 10 and blocks. Thread 2 runs from 10 and wakes up
+// thread 1 at 25. Thread 1 runs from 30 to 40.
+void BuildWakeupGraph(ExecutionGraph* graph)
+{
+    graph->SetThreadState(0, 1, EdgeState::kRunning);
+    graph->SetThreadState(10, 1, EdgeState::kBlocked);
+    graph->SetThreadState(10, 2, EdgeState::kRunning);
+    graph->AddWakeup(25, 2, 1);
+    graph->SetThreadState(30, 2, EdgeState::kPreempted);
+    graph->SetThreadState(30, 1, EdgeState::kRunning);
+    graph->SetThreadState(40, 1, EdgeState::kBlocked);
+}
+
+}  // namespace
+
+TEST(ExecutionGraph, Wakeup)
+{
+    ExecutionGraph graph;
+    BuildWakeupGraph(&graph);
+    EXPECT_EQ(8u, graph.size());
+
+    ExecutionGraph::Path path;
+    graph.ComputeCriticalPath(1, 0, 40, &path);
+    ASSERT_EQ(4u, path.size());
+    ExpectSegment(path[0], 1, 0, 10, EdgeState::kRunning);
+    ExpectSegment(path[1], 2, 10, 25, EdgeState::kRunning);
+    ExpectSegment(path[2], 1, 25, 30, EdgeState::kRunnable);
+    ExpectSegment(path[3], 1, 30, 40, EdgeState::kRunning);
+
+    // Segments are clipped to the interval.
+    graph.ComputeCriticalPath(1, 5, 28, &path);
+    ASSERT_EQ(3u, path.size());
+    ExpectSegment(path[0], 1, 5, 10, EdgeState::kRunning);
+    ExpectSegment(path[1], 2, 10, 25, EdgeState::kRunning);
+    ExpectSegment(path[2], 1, 25, 28, EdgeState::kRunnable);
+
+    // After its last node, a thread is in its current state.
+    graph.ComputeCriticalPath(1, 35, 50, &path);
+    ASSERT_EQ(2u, path.size());
+    ExpectSegment(path[0], 1, 35, 40, EdgeState::kRunning);
+    ExpectSegment(path[1], 1, 40, 50, EdgeState::kBlocked);
+
+    // Unknown thread.
+    graph.ComputeCriticalPath(42, 0, 40, &path);
+    EXPECT_TRUE(path.empty());
+}
+
+TEST(ExecutionGraph, IgnoredWakeup)
+{
+    ExecutionGraph graph;
+    BuildWakeupGraph(&graph);
+
+    // Thread 2 is runnable: the wakeup is ignored.
+    graph.AddWakeup(45, 1, 2);
+    EXPECT_EQ(8u, graph.size());
+}
+
+TEST(ExecutionGraph, InterruptWakeup)
+{
+    ExecutionGraph graph;
+    graph.SetThreadState(0, 3, EdgeState::kBlocked);
+    graph.AddInterruptWakeup(50, EdgeState::kInterrupt, 19, 3);
+    graph.SetThreadState(60, 3, EdgeState::kRunning);
+
+    ExecutionGraph::Path path;
+    graph.ComputeCriticalPath(3, 0, 70, &path);
+    ASSERT_EQ(3u, path.size());
+    ExpectSegment(path[0], 3, 0, 50, EdgeState::kInterrupt);
+    EXPECT_EQ(19u, path[0].interrupt);
+    ExpectSegment(path[1], 3, 50, 60, EdgeState::kRunnable);
+    ExpectSegment(path[2], 3, 60, 70, EdgeState::kRunning);
+}
+
+TEST(ExecutionGraph, NewThread)
+{
+    ExecutionGraph graph;
+    graph.SetThreadState(90, 1, EdgeState::kRunning);
+    graph.AddWakeup(100, 1, 4);
+    graph.SetThreadState(110, 4, EdgeState::kRunning);
+
+    // Before its first wakeup, the new thread waits for its parent.
+    ExecutionGraph::Path path;
+    graph.ComputeCriticalPath(4, 95, 120, &path);
+    ASSERT_EQ(3u, path.size());
+    ExpectSegment(path[0], 1, 95, 100, EdgeState::kRunning);
+    ExpectSegment(path[1], 4, 100, 110, EdgeState::kRunnable);
+    ExpectSegment(path[2], 4, 110, 120, EdgeState::kRunning);
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,295 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/FutexBlock.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+// From include/uapi/linux/futex.h.
+const uint32_t kFutexPrivateFlag = 128;
+const uint32_t kFutexClockRealtime = 256;
+const uint32_t kFutexCmdMask = ~(kFutexPrivateFlag | kFutexClockRealtime);
+
+// prev_state of a thread that is still runnable when it is switched out.
+const int64_t kTaskRunning = 0;
+
+enum FutexCommand
+{
+    kFutexWait = 0,
+    kFutexWake = 1,
+    kFutexRequeue = 3,
+    kFutexCmpRequeue = 4,
+    kFutexWakeOp = 5,
+    kFutexLockPi = 6,
+    kFutexUnlockPi = 7,
+    kFutexTryLockPi = 8,
+    kFutexWaitBitset = 9,
+    kFutexWakeBitset = 10,
+    kFutexWaitRequeuePi = 11,
+    kFutexCmpRequeuePi = 12,
+};
+
+bool IsWait(uint32_t command)
+{
+    return command == kFutexWait || command == kFutexWaitBitset ||
+           command == kFutexLockPi || command == kFutexWaitRequeuePi;
+}
+
+bool IsWake(uint32_t command)
+{
+    return command == kFutexWake || command == kFutexWakeBitset ||
+           command == kFutexWakeOp || command == kFutexUnlockPi ||
+           command == kFutexRequeue || command == kFutexCmpRequeue ||
+           command == kFutexCmpRequeuePi;
+}
+
+std::string AddressName(uint64_t address)
+{
+    std::ostringstream ss;
+    ss << "0x" << std::hex << address;
+    return ss.str();
+}
+
+}  // namespace
+
+const int32_t FutexBlock::kSharedFutex;
+
+FutexBlock::FutexBlock()
+    : AbstractAnalysisBlock("futex"),
+      _topSize(kDefaultTopSize)
+{
+}
+
+void FutexBlock::Start(const value::Value* parameters)
+{
+    _topSize = GetTopSize(parameters);
+}
+
+void FutexBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<FutexBlock, &FutexBlock::onFutexEntry>(notificationCenter, Token("syscall_entry_futex"), this);
+    AddKernelObserver<FutexBlock, &FutexBlock::onFutexExit>(notificationCenter, Token("syscall_exit_futex"), this);
+    AddKernelObserver<FutexBlock, &FutexBlock::onSchedSwitch>(notificationCenter, Token("sched_switch"), this);
+}
+
+void FutexBlock::onFutexEntry(const trace::EventValue& event)
+{
+    auto tid = GetCurrentThread(GetEventCpu(event));
+    if (tid == kUnknownThread)
+        return;
+
+    auto fields = event.getFields();
+    auto op = fields->GetField("op")->AsUInteger();
+    auto command = op & kFutexCmdMask;
+    bool wait = IsWait(command);
+    if (!wait && !IsWake(command))
+        return;
+
+    LockKey key((op & kFutexPrivateFlag) ? GetProcessId(tid) : kSharedFutex,
+                fields->GetField("uaddr")->AsULong());
+    uint32_t lock = GetLockIndex(key);
+
+    if (!wait)
+    {
+        LockState& state = _lockStates[lock];
+        state.lastWaker = tid;
+        state.lastWake = event.getTimestamp();
+        ++_lockStats[lock].wakes;
+    }
+
+    PendingCall& pending = _pending[tid];
+    pending.lock = lock;
+    pending.wait = wait;
+    pending.begin = event.getTimestamp();
+    pending.blocked = 0;
+}
+
+void FutexBlock::onFutexExit(const trace::EventValue& event)
+{
+    auto tid = GetCurrentThread(GetEventCpu(event));
+    auto look = _pending.find(tid);
+    if (look == _pending.end())
+        return;
+
+    PendingCall pending = look->second;
+    _pending.erase(look);
+
+    auto ts = event.getTimestamp();
+    if (!pending.wait || ts < pending.begin)
+        return;
+
+    LockStats& stats = _lockStats[pending.lock];
+    if (event.getFields()->GetField("ret")->AsLong() != 0)
+    {
+        ++stats.failedWaits;
+        return;
+    }
+
+    uint64_t duration = ts - pending.begin;
+    stats.wait.Record(duration);
+    stats.waitTime += duration;
+
+    if (pending.blocked == 0)
+        return;
+    ++stats.blockedWaits;
+
+    // The thread that woke up the lock while the waiter was blocked
+    // released it.
+    const LockState& state = _lockStates[pending.lock];
+    if (state.lastWaker == kUnknownThread || state.lastWaker == tid ||
+        state.lastWake < pending.blocked)
+    {
+        return;
+    }
+
+    PairStats& pair = _pairs[PairKey(pending.lock, state.lastWaker, tid)];
+    ++pair.waits;
+    pair.waitTime += duration;
+}
+
+void FutexBlock::onSchedSwitch(const trace::EventValue& event)
+{
+    // A thread that is switched out in a runnable state is preempted,
+    // not blocked.
+    auto fields = event.getFields();
+    if (fields->GetField("prev_state")->AsLong() == kTaskRunning)
+        return;
+
+    auto look = _pending.find(fields->GetField("prev_tid")->AsInteger());
+    if (look == _pending.end() || !look->second.wait || look->second.blocked != 0)
+        return;
+    look->second.blocked = event.getTimestamp();
+}
+
+uint32_t FutexBlock::GetLockIndex(const LockKey& key)
+{
+    auto inserted = _lockIndexes.Insert(key, static_cast<uint32_t>(_locks.size()));
+    if (inserted.second)
+    {
+        _locks.push_back(key);
+        _lockStates.push_back(LockState {kUnknownThread, 0});
+        _lockStats.push_back(LockStats());
+    }
+    return *inserted.first;
+}
+
+const FutexBlock::LockStats* FutexBlock::GetLockStats(const LockKey& lock) const
+{
+    const uint32_t* index = _lockIndexes.Find(lock);
+    if (index == nullptr)
+        return nullptr;
+    return &_lockStats[*index];
+}
+
+const FutexBlock::PairStats* FutexBlock::GetPairStats(const LockKey& lock, int32_t owner, int32_t waiter) const
+{
+    const uint32_t* index = _lockIndexes.Find(lock);
+    if (index == nullptr)
+        return nullptr;
+    return _pairs.Find(PairKey(*index, owner, waiter));
+}
+
+std::vector<FutexBlock::LockKey> FutexBlock::GetTopLocks() const
+{
+    std::vector<std::pair<uint64_t, uint32_t>> locks;
+    for (uint32_t lock = 0; lock < _lockStats.size(); ++lock)
+    {
+        if (_lockStats[lock].wait.count() != 0)
+            locks.push_back(std::make_pair(_lockStats[lock].waitTime, lock));
+    }
+
+    size_t count = std::min(_topSize, locks.size());
+    std::partial_sort(locks.begin(), locks.begin() + count, locks.end(),
+                      std::greater<std::pair<uint64_t, uint32_t>>());
+
+    std::vector<LockKey> top;
+    for (size_t i = 0; i < count; ++i)
+        top.push_back(_locks[locks[i].second]);
+    return top;
+}
+
+value::Value::UP FutexBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField<value::ULongValue>("locks", _locks.size());
+
+    value::ArrayValue::UP locksValue {new value::ArrayValue};
+    for (const auto& lock : GetTopLocks())
+    {
+        const LockStats& stats = *GetLockStats(lock);
+        value::StructValue::UP lockValue {new value::StructValue};
+        lockValue->AddField<value::IntValue>("pid", lock.pid);
+        lockValue->AddField<value::StringValue>("uaddr", AddressName(lock.uaddr));
+        lockValue->AddField<value::ULongValue>("wait_time", stats.waitTime);
+        lockValue->AddField<value::ULongValue>("blocked_waits", stats.blockedWaits);
+        lockValue->AddField<value::ULongValue>("failed_waits", stats.failedWaits);
+        lockValue->AddField<value::ULongValue>("wakes", stats.wakes);
+        lockValue->AddField("wait", stats.wait.ToValue());
+        locksValue->Append(std::move(lockValue));
+    }
+    report->AddField("top_locks", std::move(locksValue));
+
+    // Pairs with the longest total wait time.
+    std::vector<std::pair<PairKey, PairStats>> pairs;
+    _pairs.ForEach([&] (const PairKey& key, const PairStats& stats) {
+        pairs.push_back(std::make_pair(key, stats));
+    });
+    size_t count = std::min(_topSize, pairs.size());
+    std::partial_sort(pairs.begin(), pairs.begin() + count, pairs.end(),
+                      [] (const std::pair<PairKey, PairStats>& a,
+                          const std::pair<PairKey, PairStats>& b) {
+        return a.second.waitTime > b.second.waitTime;
+    });
+
+    value::ArrayValue::UP pairsValue {new value::ArrayValue};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LockKey& lock = _locks[pairs[i].first.lock];
+        value::StructValue::UP pairValue {new value::StructValue};
+        pairValue->AddField<value::IntValue>("pid", lock.pid);
+        pairValue->AddField<value::StringValue>("uaddr", AddressName(lock.uaddr));
+        pairValue->AddField<value::IntValue>("owner", pairs[i].first.owner);
+        pairValue->AddField<value::StringValue>("owner_name", GetThreadName(pairs[i].first.owner));
+        pairValue->AddField<value::IntValue>("waiter", pairs[i].first.waiter);
+        pairValue->AddField<value::StringValue>("waiter_name", GetThreadName(pairs[i].first.waiter));
+        pairValue->AddField<value::ULongValue>("waits", pairs[i].second.waits);
+        pairValue->AddField<value::ULongValue>("wait_time", pairs[i].second.waitTime);
+        pairsValue->Append(std::move(pairValue));
+    }
+    report->AddField("top_pairs", std::move(pairsValue));
+
+    return std::move(report);
+}
+
+}
+}
@@ -0,0 +1,188 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_FUTEXBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_FUTEXBLOCK_HPP
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "base/OpenHashMap.hpp"
+#include "stats/Histogram.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that measures futex contention.
+ *
+ * Futex waits and wakes are correlated by lock, i.e. by futex address
+ * within a process for private futexes and by futex address for shared
+ * futexes. The duration of each successful wait is recorded in a
+ * histogram of its lock; waits that return an error (e.g. the futex
+ * value changed before the call or a timeout expired) are only counted.
+ * A wait is blocked when its thread is switched out by a sched_switch
+ * that doesn't leave it runnable. When a blocked wait ends after a wake
+ * on the same lock that occurred while it was blocked, the waking
+ * thread is considered as the owner that released the lock, and the
+ * wait is counted for the (owner, waiter) pair.
+ *
+ * Locks are found through an open addressing table that maps a futex
+ * address to a lock index. The state touched by every futex call is
+ * kept in a compact array, apart from the statistics, so hundreds of
+ * thousands of locks remain cache-friendly.
+ *
+ * Parameters:
+ *   top: Optional. Number of locks and pairs to report (default: 10).
+ *
+ * @author Francois Doray
+ */
+class FutexBlock : public AbstractAnalysisBlock
+{
+public:
+    struct LockKey
+    {
+        LockKey() : pid(0), uaddr(0) {}
+        LockKey(int32_t pid, uint64_t uaddr) : pid(pid), uaddr(uaddr) {}
+
+        bool operator==(const LockKey& other) const
+        {
+            return pid == other.pid && uaddr == other.uaddr;
+        }
+
+        // Process of a private futex, or kSharedFutex.
+        int32_t pid;
+        uint64_t uaddr;
+    };
+
+    struct LockStats
+    {
+        LockStats() : waitTime(0), blockedWaits(0), failedWaits(0), wakes(0) {}
+        stats::Histogram wait;
+        uint64_t waitTime;
+        uint64_t blockedWaits;
+        uint64_t failedWaits;
+        uint64_t wakes;
+    };
+
+    struct PairStats
+    {
+        PairStats() : waits(0), waitTime(0) {}
+        uint64_t waits;
+        uint64_t waitTime;
+    };
+
+    static const int32_t kSharedFutex = -1;
+
+    FutexBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Returns the statistics of a lock, or nullptr.
+    const LockStats* GetLockStats(const LockKey& lock) const;
+
+    // Returns the statistics of an (owner, waiter) pair, or nullptr.
+    const PairStats* GetPairStats(const LockKey& lock, int32_t owner, int32_t waiter) const;
+
+    // Returns the locks with the longest total wait time, longest first.
+    std::vector<LockKey> GetTopLocks() const;
+
+    size_t numLocks() const { return _locks.size(); }
+
+private:
+    void onFutexEntry(const trace::EventValue& event);
+    void onFutexExit(const trace::EventValue& event);
+    void onSchedSwitch(const trace::EventValue& event);
+
+    struct LockKeyHash
+    {
+        size_t operator()(const LockKey& key) const
+        {
+            return static_cast<size_t>(key.uaddr ^ (static_cast<uint64_t>(key.pid) << 48));
+        }
+    };
+
+    // State of a lock, updated by each futex call.
+    struct LockState
+    {
+        int32_t lastWaker;
+        timestamp_t lastWake;
+    };
+
+    struct PairKey
+    {
+        PairKey() : lock(0), owner(0), waiter(0) {}
+        PairKey(uint32_t lock, int32_t owner, int32_t waiter)
+            : lock(lock), owner(owner), waiter(waiter) {}
+
+        bool operator==(const PairKey& other) const
+        {
+            return lock == other.lock && owner == other.owner && waiter == other.waiter;
+        }
+
+        uint32_t lock;
+        int32_t owner;
+        int32_t waiter;
+    };
+
+    struct PairKeyHash
+    {
+        size_t operator()(const PairKey& key) const
+        {
+            return static_cast<size_t>((static_cast<uint64_t>(key.lock) << 40) ^
+                                       (static_cast<uint64_t>(static_cast<uint32_t>(key.owner)) << 20) ^
+                                       static_cast<uint32_t>(key.waiter));
+        }
+    };
+
+    // Futex call in progress.
+    struct PendingCall
+    {
+        uint32_t lock;
+        bool wait;
+        timestamp_t begin;
+
+        // Time at which the thread blocked in the call, or 0.
+        timestamp_t blocked;
+    };
+
+    uint32_t GetLockIndex(const LockKey& key);
+
+    base::OpenHashMap<LockKey, uint32_t, LockKeyHash> _lockIndexes;
+    std::vector<LockKey> _locks;
+    std::vector<LockState> _lockStates;
+    std::vector<LockStats> _lockStats;
+
+    base::OpenHashMap<PairKey, PairStats, PairKeyHash> _pairs;
+
+    std::unordered_map<int32_t, PendingCall> _pending;
+
+    size_t _topSize;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_FUTEXBLOCK_HPP
@@ -0,0 +1,84 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/FutexBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+TEST(FutexBlock, FutexBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    FutexBlock futexBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&futexBlock, nullptr);
+    blockRunner.Run();
+
+    auto topLocks = futexBlock.GetTopLocks();
+    EXPECT_LE(topLocks.size(), futexBlock.numLocks());
+
+    uint64_t previousWaitTime = static_cast<uint64_t>(-1);
+    for (const auto& lock : topLocks)
+    {
+        const FutexBlock::LockStats* stats = futexBlock.GetLockStats(lock);
+        ASSERT_NE(nullptr, stats);
+        EXPECT_LT(0u, stats->wait.count());
+        EXPECT_GE(previousWaitTime, stats->waitTime);
+        EXPECT_LE(stats->wait.max(), stats->waitTime);
+        EXPECT_LE(stats->blockedWaits, stats->wait.count());
+        previousWaitTime = stats->waitTime;
+    }
+
+    // The waits of the reported pairs are waits of their lock.
+    auto report = futexBlock.GetReport();
+    for (const auto& pair : *value::ArrayValueBase::Cast(report->GetField("top_pairs")))
+    {
+        auto owner = pair.GetField("owner")->AsInteger();
+        auto waiter = pair.GetField("waiter")->AsInteger();
+        EXPECT_NE(owner, waiter);
+
+        FutexBlock::LockKey lock(pair.GetField("pid")->AsInteger(),
+                                 std::stoull(pair.GetField("uaddr")->AsString(), nullptr, 16));
+        const FutexBlock::LockStats* lockStats = futexBlock.GetLockStats(lock);
+        ASSERT_NE(nullptr, lockStats);
+        const FutexBlock::PairStats* pairStats = futexBlock.GetPairStats(lock, owner, waiter);
+        ASSERT_NE(nullptr, pairStats);
+        EXPECT_LE(pairStats->waits, lockStats->blockedWaits);
+        EXPECT_LE(pairStats->waitTime, lockStats->waitTime);
+    }
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,280 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/InterruptLatencyBlock.hpp"
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+const timestamp_t kNotRaised = static_cast<timestamp_t>(-1);
+
+// Names of the softirq vectors, from include/linux/interrupt.h.
+const char* kSoftIrqNames[] = {
+    "HI",
+    "TIMER",
+    "NET_TX",
+    "NET_RX",
+    "BLOCK",
+    "BLOCK_IOPOLL",
+    "TASKLET",
+    "SCHED",
+    "HRTIMER",
+    "RCU",
+};
+
+}  // namespace
+
+const uint32_t InterruptLatencyBlock::kNumSoftIrqs;
+
+InterruptLatencyBlock::InterruptLatencyBlock()
+    : AbstractAnalysisBlock("interrupt-latency"),
+      _measures(kNumMeasures, MeasureStats(kDefaultTopSize))
+{
+}
+
+void InterruptLatencyBlock::Start(const value::Value* parameters)
+{
+    _measures.assign(kNumMeasures, MeasureStats(GetTopSize(parameters)));
+}
+
+void InterruptLatencyBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<InterruptLatencyBlock, &InterruptLatencyBlock::onIrqHandlerEntry>(notificationCenter, Token("irq_handler_entry"), this);
+    AddKernelObserver<InterruptLatencyBlock, &InterruptLatencyBlock::onIrqHandlerExit>(notificationCenter, Token("irq_handler_exit"), this);
+    AddKernelObserver<InterruptLatencyBlock, &InterruptLatencyBlock::onSoftIrqRaise>(notificationCenter, Token("softirq_raise"), this);
+    AddKernelObserver<InterruptLatencyBlock, &InterruptLatencyBlock::onSoftIrqEntry>(notificationCenter, Token("softirq_entry"), this);
+    AddKernelObserver<InterruptLatencyBlock, &InterruptLatencyBlock::onSoftIrqExit>(notificationCenter, Token("softirq_exit"), this);
+}
+
+void InterruptLatencyBlock::onIrqHandlerEntry(const trace::EventValue& event)
+{
+    auto irq = event.getFields()->GetField("irq")->AsUInteger();
+    CpuState& cpu = GetCpuState(GetEventCpu(event));
+    cpu.inIrq = true;
+    cpu.irq = irq;
+    cpu.irqBegin = event.getTimestamp();
+
+    if (_irqNames.find(irq) == _irqNames.end())
+    {
+        const value::Value* name = event.getFields()->GetField("name");
+        _irqNames[irq] = name != nullptr ? name->AsString() : std::string();
+    }
+}
+
+void InterruptLatencyBlock::onIrqHandlerExit(const trace::EventValue& event)
+{
+    auto irq = event.getFields()->GetField("irq")->AsUInteger();
+    auto cpuNumber = GetEventCpu(event);
+    CpuState& cpu = GetCpuState(cpuNumber);
+
+    // The entry may precede the beginning of the trace.
+    if (!cpu.inIrq || cpu.irq != irq)
+        return;
+    cpu.inIrq = false;
+
+    Record(kIrqDuration, Interval {cpu.irqBegin, event.getTimestamp(), cpuNumber, irq});
+}
+
+void InterruptLatencyBlock::onSoftIrqRaise(const trace::EventValue& event)
+{
+    auto vec = event.getFields()->GetField("vec")->AsUInteger();
+    if (vec >= kNumSoftIrqs)
+        return;
+
+    // A softirq that is already pending keeps its first raise.
+    CpuState& cpu = GetCpuState(GetEventCpu(event));
+    if (cpu.raised[vec] == kNotRaised)
+        cpu.raised[vec] = event.getTimestamp();
+}
+
+void InterruptLatencyBlock::onSoftIrqEntry(const trace::EventValue& event)
+{
+    auto vec = event.getFields()->GetField("vec")->AsUInteger();
+    auto cpuNumber = GetEventCpu(event);
+    CpuState& cpu = GetCpuState(cpuNumber);
+    auto ts = event.getTimestamp();
+
+    cpu.inSoftIrq = true;
+    cpu.softIrq = vec;
+    cpu.softIrqBegin = ts;
+
+    if (vec >= kNumSoftIrqs || cpu.raised[vec] == kNotRaised)
+        return;
+
+    timestamp_t raised = cpu.raised[vec];
+    cpu.raised[vec] = kNotRaised;
+    if (raised <= ts)
+        Record(kSoftIrqLatency, Interval {raised, ts, cpuNumber, vec});
+}
+
+void InterruptLatencyBlock::onSoftIrqExit(const trace::EventValue& event)
+{
+    auto vec = event.getFields()->GetField("vec")->AsUInteger();
+    auto cpuNumber = GetEventCpu(event);
+    CpuState& cpu = GetCpuState(cpuNumber);
+
+    if (!cpu.inSoftIrq || cpu.softIrq != vec)
+        return;
+    cpu.inSoftIrq = false;
+
+    Record(kSoftIrqDuration, Interval {cpu.softIrqBegin, event.getTimestamp(), cpuNumber, vec});
+}
+
+InterruptLatencyBlock::CpuState& InterruptLatencyBlock::GetCpuState(uint32_t cpu)
+{
+    if (cpu >= _cpus.size())
+        _cpus.resize(cpu + 1);
+    return _cpus[cpu];
+}
+
+void InterruptLatencyBlock::Record(Measure measure, const Interval& interval)
+{
+    if (interval.end < interval.begin)
+        return;
+    uint64_t duration = interval.end - interval.begin;
+
+    MeasureStats& measureStats = _measures[measure];
+    InterruptStats& interruptStats = measureStats.interrupts[interval.number];
+    interruptStats.total.Record(duration);
+    if (interval.cpu >= interruptStats.cpus.size())
+        interruptStats.cpus.resize(interval.cpu + 1);
+    interruptStats.cpus[interval.cpu].Record(duration);
+
+    measureStats.top.Add(interval);
+}
+
+const stats::Histogram* InterruptLatencyBlock::GetHistogram(Measure measure, uint32_t number) const
+{
+    const auto& interrupts = _measures[measure].interrupts;
+    auto look = interrupts.find(number);
+    if (look == interrupts.end())
+        return nullptr;
+    return &look->second.total;
+}
+
+const stats::Histogram* InterruptLatencyBlock::GetCpuHistogram(Measure measure, uint32_t number, uint32_t cpu) const
+{
+    const auto& interrupts = _measures[measure].interrupts;
+    auto look = interrupts.find(number);
+    if (look == interrupts.end())
+        return nullptr;
+    const auto& cpus = look->second.cpus;
+    if (cpu >= cpus.size() || cpus[cpu].count() == 0)
+        return nullptr;
+    return &cpus[cpu];
+}
+
+std::vector<InterruptLatencyBlock::Interval> InterruptLatencyBlock::GetTopIntervals(Measure measure) const
+{
+    return _measures[measure].top.Sorted();
+}
+
+std::string InterruptLatencyBlock::GetInterruptName(Measure measure, uint32_t number) const
+{
+    if (measure == kIrqDuration)
+    {
+        auto look = _irqNames.find(number);
+        if (look == _irqNames.end())
+            return std::string();
+        return look->second;
+    }
+
+    if (number >= kNumSoftIrqs)
+        return std::string();
+    return kSoftIrqNames[number];
+}
+
+value::Value::UP InterruptLatencyBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField("irq_duration", GetMeasureReport(kIrqDuration, "irq"));
+    report->AddField("softirq_latency", GetMeasureReport(kSoftIrqLatency, "vec"));
+    report->AddField("softirq_duration", GetMeasureReport(kSoftIrqDuration, "vec"));
+    return std::move(report);
+}
+
+value::Value::UP InterruptLatencyBlock::GetMeasureReport(Measure measure, const char* numberName) const
+{
+    const MeasureStats& measureStats = _measures[measure];
+    value::StructValue::UP report {new value::StructValue};
+
+    value::ArrayValue::UP interruptsValue {new value::ArrayValue};
+    for (const auto& interrupt : measureStats.interrupts)
+    {
+        value::StructValue::UP interruptValue {new value::StructValue};
+        interruptValue->AddField<value::UIntValue>(numberName, interrupt.first);
+        interruptValue->AddField<value::StringValue>("name", GetInterruptName(measure, interrupt.first));
+        interruptValue->AddField("total", interrupt.second.total.ToValue());
+
+        value::ArrayValue::UP cpusValue {new value::ArrayValue};
+        for (size_t cpu = 0; cpu < interrupt.second.cpus.size(); ++cpu)
+        {
+            const stats::Histogram& histogram = interrupt.second.cpus[cpu];
+            if (histogram.count() == 0)
+                continue;
+            value::StructValue::UP cpuValue {new value::StructValue};
+            cpuValue->AddField<value::UIntValue>("cpu", cpu);
+            cpuValue->AddField("histogram", histogram.ToValue());
+            cpusValue->Append(std::move(cpuValue));
+        }
+        interruptValue->AddField("cpus", std::move(cpusValue));
+
+        interruptsValue->Append(std::move(interruptValue));
+    }
+    report->AddField("interrupts", std::move(interruptsValue));
+
+    value::ArrayValue::UP topValue {new value::ArrayValue};
+    for (const auto& interval : measureStats.top.Sorted())
+    {
+        value::StructValue::UP intervalValue {new value::StructValue};
+        intervalValue->AddField<value::ULongValue>("begin", interval.begin);
+        intervalValue->AddField<value::ULongValue>("end", interval.end);
+        intervalValue->AddField<value::UIntValue>("cpu", interval.cpu);
+        intervalValue->AddField<value::UIntValue>(numberName, interval.number);
+        topValue->Append(std::move(intervalValue));
+    }
+    report->AddField("top", std::move(topValue));
+
+    return std::move(report);
+}
+
+InterruptLatencyBlock::CpuState::CpuState()
+    : inIrq(false),
+      irq(0),
+      irqBegin(0),
+      inSoftIrq(false),
+      softIrq(0),
+      softIrqBegin(0)
+{
+    for (uint32_t vec = 0; vec < kNumSoftIrqs; ++vec)
+        raised[vec] = kNotRaised;
+}
+
+}
+}
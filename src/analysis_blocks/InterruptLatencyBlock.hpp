@@ -0,0 +1,155 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_INTERRUPTLATENCYBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_INTERRUPTLATENCYBLOCK_HPP
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "stats/Histogram.hpp"
+#include "stats/TopN.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that measures interrupt handling.
+ *
+ * Three measures are computed:
+ *   - IRQ handler duration, from irq_handler_entry to irq_handler_exit,
+ *     per IRQ line,
+ *   - softirq latency, from softirq_raise to softirq_entry, per vector,
+ *   - softirq handler duration, from softirq_entry to softirq_exit, per
+ *     vector.
+ * Each measure is recorded in a histogram per IRQ line or vector and
+ * per CPU, and the longest intervals are kept so that latency spikes
+ * can be correlated with other events of the trace.
+ *
+ * Parameters:
+ *   top: Optional. Number of longest intervals to keep per measure
+ *        (default: 10).
+ *
+ * @author Francois Doray
+ */
+class InterruptLatencyBlock : public AbstractAnalysisBlock
+{
+public:
+    enum Measure
+    {
+        kIrqDuration = 0,
+        kSoftIrqLatency,
+        kSoftIrqDuration,
+        kNumMeasures,
+    };
+
+    struct Interval
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        uint32_t cpu;
+        // IRQ line or softirq vector.
+        uint32_t number;
+    };
+
+    // Number of softirq vectors.
+    static const uint32_t kNumSoftIrqs = 10;
+
+    InterruptLatencyBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Returns the histogram of an IRQ line or softirq vector, or nullptr.
+    const stats::Histogram* GetHistogram(Measure measure, uint32_t number) const;
+    const stats::Histogram* GetCpuHistogram(Measure measure, uint32_t number, uint32_t cpu) const;
+
+    // Returns the longest intervals of a measure, longest first.
+    std::vector<Interval> GetTopIntervals(Measure measure) const;
+
+    // Returns the name of an IRQ line or softirq vector.
+    std::string GetInterruptName(Measure measure, uint32_t number) const;
+
+private:
+    void onIrqHandlerEntry(const trace::EventValue& event);
+    void onIrqHandlerExit(const trace::EventValue& event);
+    void onSoftIrqRaise(const trace::EventValue& event);
+    void onSoftIrqEntry(const trace::EventValue& event);
+    void onSoftIrqExit(const trace::EventValue& event);
+
+    struct CpuState
+    {
+        CpuState();
+
+        bool inIrq;
+        uint32_t irq;
+        timestamp_t irqBegin;
+
+        bool inSoftIrq;
+        uint32_t softIrq;
+        timestamp_t softIrqBegin;
+
+        // Time at which each softirq vector was raised, if pending.
+        timestamp_t raised[kNumSoftIrqs];
+    };
+
+    struct LongerInterval
+    {
+        bool operator()(const Interval& a, const Interval& b) const
+        {
+            return a.end - a.begin < b.end - b.begin;
+        }
+    };
+
+    struct InterruptStats
+    {
+        stats::Histogram total;
+        std::vector<stats::Histogram> cpus;
+    };
+    typedef std::map<uint32_t, InterruptStats> InterruptStatsMap;
+
+    struct MeasureStats
+    {
+        explicit MeasureStats(size_t topSize) : top(topSize) {}
+
+        InterruptStatsMap interrupts;
+        stats::TopN<Interval, LongerInterval> top;
+    };
+
+    CpuState& GetCpuState(uint32_t cpu);
+    void Record(Measure measure, const Interval& interval);
+    value::Value::UP GetMeasureReport(Measure measure, const char* valueName) const;
+
+    std::vector<CpuState> _cpus;
+    std::vector<MeasureStats> _measures;
+
+    // Names of the IRQ lines.
+    std::map<uint32_t, std::string> _irqNames;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_INTERRUPTLATENCYBLOCK_HPP
@@ -0,0 +1,80 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/InterruptLatencyBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+TEST(InterruptLatencyBlock, InterruptLatencyBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    InterruptLatencyBlock interruptBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&interruptBlock, nullptr);
+    blockRunner.Run();
+
+    EXPECT_FALSE(interruptBlock.GetTopIntervals(InterruptLatencyBlock::kSoftIrqDuration).empty());
+
+    for (auto measure : {InterruptLatencyBlock::kIrqDuration,
+                         InterruptLatencyBlock::kSoftIrqLatency,
+                         InterruptLatencyBlock::kSoftIrqDuration})
+    {
+        auto top = interruptBlock.GetTopIntervals(measure);
+        for (size_t i = 1; i < top.size(); ++i)
+        {
+            EXPECT_GE(top[i - 1].end - top[i - 1].begin,
+                      top[i].end - top[i].begin);
+        }
+
+        // The longest interval is the maximum of its histograms.
+        if (top.empty())
+            continue;
+        const auto& longest = top.front();
+        const stats::Histogram* histogram =
+            interruptBlock.GetHistogram(measure, longest.number);
+        ASSERT_NE(nullptr, histogram);
+        EXPECT_EQ(longest.end - longest.begin, histogram->max());
+        const stats::Histogram* cpuHistogram =
+            interruptBlock.GetCpuHistogram(measure, longest.number, longest.cpu);
+        ASSERT_NE(nullptr, cpuHistogram);
+        EXPECT_EQ(longest.end - longest.begin, cpuHistogram->max());
+    }
+
+    EXPECT_EQ("TIMER", interruptBlock.GetInterruptName(InterruptLatencyBlock::kSoftIrqLatency, 1));
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,312 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/KmemBlock.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+const uint64_t kDefaultChurnNs = 1000000;
+const uint32_t kPageSize = 4096;
+
+std::string CallSiteName(uint64_t callSite)
+{
+    std::ostringstream ss;
+    ss << "0x" << std::hex << callSite;
+    return ss.str();
+}
+
+}  // namespace
+
+KmemBlock::KmemBlock()
+    : AbstractAnalysisBlock("kmem"),
+      _unmatchedFrees(0),
+      _topSize(kDefaultTopSize),
+      _churnNs(kDefaultChurnNs)
+{
+}
+
+void KmemBlock::Start(const value::Value* parameters)
+{
+    _topSize = GetTopSize(parameters);
+
+    const value::Value* churnNs = nullptr;
+    if (parameters != nullptr && parameters->GetField("churn_ns", &churnNs))
+        churnNs->AsULong(&_churnNs);
+}
+
+void KmemBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<KmemBlock, &KmemBlock::onKmalloc>(notificationCenter, Token("kmem_kmalloc"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onKmalloc>(notificationCenter, Token("kmem_kmalloc_node"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onKmalloc>(notificationCenter, Token("kmem_cache_alloc"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onKmalloc>(notificationCenter, Token("kmem_cache_alloc_node"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onKfree>(notificationCenter, Token("kmem_kfree"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onKfree>(notificationCenter, Token("kmem_cache_free"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageAlloc>(notificationCenter, Token("mm_page_alloc"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageAlloc>(notificationCenter, Token("kmem_mm_page_alloc"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageFree>(notificationCenter, Token("mm_page_free"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageFree>(notificationCenter, Token("mm_page_free_batched"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageFree>(notificationCenter, Token("kmem_mm_page_free"), this);
+    AddKernelObserver<KmemBlock, &KmemBlock::onPageFree>(notificationCenter, Token("kmem_mm_page_free_batched"), this);
+}
+
+void KmemBlock::onKmalloc(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    auto ptr = fields->GetField("ptr")->AsULong();
+    if (ptr == 0)
+        return;
+
+    Allocate(&_allocations, ptr, event.getTimestamp(),
+             fields->GetField("call_site")->AsULong(),
+             fields->GetField("bytes_alloc")->AsUInteger(),
+             GetEventCpu(event));
+}
+
+void KmemBlock::onKfree(const trace::EventValue& event)
+{
+    auto ptr = event.getFields()->GetField("ptr")->AsULong();
+    if (ptr == 0)
+        return;
+    Free(&_allocations, ptr, event.getTimestamp());
+}
+
+void KmemBlock::onPageAlloc(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    auto page = fields->GetField("page")->AsULong();
+    if (page == 0)
+        return;
+
+    auto order = fields->GetField("order")->AsUInteger();
+    Allocate(&_pages, page, event.getTimestamp(), 0, kPageSize << order,
+             GetEventCpu(event));
+}
+
+void KmemBlock::onPageFree(const trace::EventValue& event)
+{
+    auto page = event.getFields()->GetField("page")->AsULong();
+    if (page == 0)
+        return;
+    Free(&_pages, page, event.getTimestamp());
+}
+
+void KmemBlock::Allocate(LiveTable* table, uint64_t address, timestamp_t ts,
+                         uint64_t callSite, uint32_t bytes, uint32_t cpu)
+{
+    // An allocation whose free was lost is replaced.
+    if (table->Find(address) != nullptr)
+        Free(table, address, ts);
+
+    uint32_t index = 0;
+    if (!_freeRecords.empty())
+    {
+        index = _freeRecords.back();
+        _freeRecords.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(_records.size());
+        _records.push_back(Record());
+    }
+
+    auto tid = GetCurrentThread(cpu);
+    Record& record = _records[index];
+    record.ts = ts;
+    record.callSite = callSite;
+    record.bytes = bytes;
+    record.pid = tid == kUnknownThread ? kUnknownThread : GetProcessId(tid);
+    table->Insert(address, index);
+
+    RecordAlloc(table == &_pages ? &_pageStats : &_callSites[callSite], bytes);
+    if (record.pid != kUnknownThread)
+        RecordAlloc(&_processes[record.pid], bytes);
+}
+
+void KmemBlock::Free(LiveTable* table, uint64_t address, timestamp_t ts)
+{
+    const uint32_t* index = table->Find(address);
+    if (index == nullptr)
+    {
+        ++_unmatchedFrees;
+        return;
+    }
+
+    uint32_t recordIndex = *index;
+    table->Erase(address);
+    _freeRecords.push_back(recordIndex);
+
+    const Record& record = _records[recordIndex];
+    uint64_t lifetime = ts >= record.ts ? ts - record.ts : 0;
+
+    RecordFree(table == &_pages ? &_pageStats : &_callSites[record.callSite],
+               record.bytes, lifetime);
+    if (record.pid != kUnknownThread)
+        RecordFree(&_processes[record.pid], record.bytes, lifetime);
+}
+
+void KmemBlock::RecordAlloc(Stats* stats, uint32_t bytes)
+{
+    ++stats->allocs;
+    stats->allocatedBytes += bytes;
+    stats->liveBytes += bytes;
+    stats->peakLiveBytes = std::max(stats->peakLiveBytes, stats->liveBytes);
+}
+
+void KmemBlock::RecordFree(Stats* stats, uint32_t bytes, uint64_t lifetime)
+{
+    ++stats->frees;
+    stats->freedBytes += bytes;
+    stats->liveBytes -= std::min<uint64_t>(bytes, stats->liveBytes);
+    if (lifetime <= _churnNs)
+        ++stats->churn;
+    stats->lifetime.Record(lifetime);
+}
+
+const KmemBlock::Stats* KmemBlock::GetCallSiteStats(uint64_t callSite) const
+{
+    auto look = _callSites.find(callSite);
+    if (look == _callSites.end())
+        return nullptr;
+    return &look->second;
+}
+
+const KmemBlock::Stats* KmemBlock::GetProcessStats(int32_t pid) const
+{
+    auto look = _processes.find(pid);
+    if (look == _processes.end())
+        return nullptr;
+    return &look->second;
+}
+
+std::vector<uint64_t> KmemBlock::GetLeakCandidates() const
+{
+    return GetTopCallSites(&Stats::liveBytes);
+}
+
+std::vector<uint64_t> KmemBlock::GetChurnHotspots() const
+{
+    return GetTopCallSites(&Stats::churn);
+}
+
+std::vector<uint64_t> KmemBlock::GetTopCallSites(uint64_t Stats::* field) const
+{
+    std::vector<std::pair<uint64_t, uint64_t>> callSites;
+    for (const auto& callSite : _callSites)
+    {
+        if (callSite.second.*field != 0)
+            callSites.push_back(std::make_pair(callSite.second.*field, callSite.first));
+    }
+
+    size_t count = std::min(_topSize, callSites.size());
+    std::partial_sort(callSites.begin(), callSites.begin() + count, callSites.end(),
+                      std::greater<std::pair<uint64_t, uint64_t>>());
+
+    std::vector<uint64_t> top;
+    for (size_t i = 0; i < count; ++i)
+        top.push_back(callSites[i].second);
+    return top;
+}
+
+namespace
+{
+
+value::Value::UP StatsToValue(const KmemBlock::Stats& stats)
+{
+    value::StructValue::UP value {new value::StructValue};
+    value->AddField<value::ULongValue>("allocs", stats.allocs);
+    value->AddField<value::ULongValue>("frees", stats.frees);
+    value->AddField<value::ULongValue>("allocated_bytes", stats.allocatedBytes);
+    value->AddField<value::ULongValue>("freed_bytes", stats.freedBytes);
+    value->AddField<value::ULongValue>("live_bytes", stats.liveBytes);
+    value->AddField<value::ULongValue>("peak_live_bytes", stats.peakLiveBytes);
+    value->AddField<value::ULongValue>("churn", stats.churn);
+    value->AddField("lifetime", stats.lifetime.ToValue());
+    return std::move(value);
+}
+
+}  // namespace
+
+value::Value::UP KmemBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField<value::ULongValue>("live_allocations", liveAllocations());
+    report->AddField<value::ULongValue>("unmatched_frees", _unmatchedFrees);
+    report->AddField("pages", StatsToValue(_pageStats));
+
+    auto addCallSites = [&] (const char* name, const std::vector<uint64_t>& callSites) {
+        value::ArrayValue::UP callSitesValue {new value::ArrayValue};
+        for (auto callSite : callSites)
+        {
+            value::StructValue::UP callSiteValue {new value::StructValue};
+            callSiteValue->AddField<value::StringValue>("call_site", CallSiteName(callSite));
+            callSiteValue->AddField("stats", StatsToValue(_callSites.at(callSite)));
+            callSitesValue->Append(std::move(callSiteValue));
+        }
+        report->AddField(name, std::move(callSitesValue));
+    };
+    addCallSites("leak_candidates", GetLeakCandidates());
+    addCallSites("churn_hotspots", GetChurnHotspots());
+
+    std::vector<int32_t> pids;
+    for (const auto& process : _processes)
+        pids.push_back(process.first);
+    std::sort(pids.begin(), pids.end());
+
+    value::ArrayValue::UP processesValue {new value::ArrayValue};
+    for (auto pid : pids)
+    {
+        value::StructValue::UP processValue {new value::StructValue};
+        processValue->AddField<value::IntValue>("pid", pid);
+        processValue->AddField<value::StringValue>("name", GetThreadName(pid));
+        processValue->AddField("stats", StatsToValue(_processes.at(pid)));
+        processesValue->Append(std::move(processValue));
+    }
+    report->AddField("processes", std::move(processesValue));
+
+    return std::move(report);
+}
+
+KmemBlock::Stats::Stats()
+    : allocs(0),
+      frees(0),
+      allocatedBytes(0),
+      freedBytes(0),
+      liveBytes(0),
+      peakLiveBytes(0),
+      churn(0)
+{
+}
+
+}
+}
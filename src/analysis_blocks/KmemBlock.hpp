@@ -0,0 +1,145 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_KMEMBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_KMEMBLOCK_HPP
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "base/OpenHashMap.hpp"
+#include "stats/Histogram.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that tracks kernel memory allocations.
+ *
+ * kmalloc and slab cache allocations are matched with their frees by
+ * pointer, and page allocations with page frees by page. Statistics are
+ * kept per call site (pages have no call site) and per process. At the
+ * end of the trace, the call sites with the most live bytes are
+ * reported as leak candidates, and the call sites with the most
+ * allocations freed shortly after being made as churn hotspots.
+ *
+ * Live allocations are 24-byte records in a slab, found through open
+ * addressing tables keyed by pointer, so tens of millions of
+ * allocations don't cost a node allocation each.
+ *
+ * Parameters:
+ *   top: Optional. Number of call sites to report per list (default: 10).
+ *   churn_ns: Optional. Maximum lifetime of an allocation counted as
+ *             churn (default: 1 ms).
+ *
+ * @author Francois Doray
+ */
+class KmemBlock : public AbstractAnalysisBlock
+{
+public:
+    struct Stats
+    {
+        Stats();
+
+        uint64_t allocs;
+        uint64_t frees;
+        uint64_t allocatedBytes;
+        uint64_t freedBytes;
+        uint64_t liveBytes;
+        uint64_t peakLiveBytes;
+
+        // Allocations freed within the churn lifetime.
+        uint64_t churn;
+
+        // Lifetime of the freed allocations.
+        stats::Histogram lifetime;
+    };
+
+    KmemBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Returns the statistics of a call site or process, or nullptr.
+    const Stats* GetCallSiteStats(uint64_t callSite) const;
+    const Stats* GetProcessStats(int32_t pid) const;
+
+    // Call sites with the most live bytes, most first.
+    std::vector<uint64_t> GetLeakCandidates() const;
+
+    // Call sites with the most churn, most first.
+    std::vector<uint64_t> GetChurnHotspots() const;
+
+    size_t liveAllocations() const { return _allocations.size() + _pages.size(); }
+    uint64_t unmatchedFrees() const { return _unmatchedFrees; }
+
+private:
+    void onKmalloc(const trace::EventValue& event);
+    void onKfree(const trace::EventValue& event);
+    void onPageAlloc(const trace::EventValue& event);
+    void onPageFree(const trace::EventValue& event);
+
+    // Live allocation.
+    struct Record
+    {
+        timestamp_t ts;
+        uint64_t callSite;
+        uint32_t bytes;
+        int32_t pid;
+    };
+
+    typedef base::OpenHashMap<uint64_t, uint32_t> LiveTable;
+
+    void Allocate(LiveTable* table, uint64_t address, timestamp_t ts,
+                  uint64_t callSite, uint32_t bytes, uint32_t cpu);
+    void Free(LiveTable* table, uint64_t address, timestamp_t ts);
+
+    void RecordAlloc(Stats* stats, uint32_t bytes);
+    void RecordFree(Stats* stats, uint32_t bytes, uint64_t lifetime);
+
+    std::vector<uint64_t> GetTopCallSites(uint64_t Stats::* field) const;
+
+    // Slab of records, and indexes of the free records.
+    std::vector<Record> _records;
+    std::vector<uint32_t> _freeRecords;
+
+    // Live allocations, by pointer and by page.
+    LiveTable _allocations;
+    LiveTable _pages;
+
+    std::unordered_map<uint64_t, Stats> _callSites;
+    std::unordered_map<int32_t, Stats> _processes;
+    Stats _pageStats;
+
+    uint64_t _unmatchedFrees;
+
+    size_t _topSize;
+    uint64_t _churnNs;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_KMEMBLOCK_HPP
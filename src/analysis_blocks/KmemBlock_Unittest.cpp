@@ -0,0 +1,81 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/KmemBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+TEST(KmemBlock, KmemBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    value::StructValue kmemParams;
+    kmemParams.AddField<value::ULongValue>("top", 1000000);
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    KmemBlock kmemBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&kmemBlock, &kmemParams);
+    blockRunner.Run();
+
+    // Each live allocation is an allocation of a call site or a page
+    // allocation that wasn't freed.
+    auto report = kmemBlock.GetReport();
+    uint64_t live = report->GetField("pages")->GetField("allocs")->AsULong() -
+                    report->GetField("pages")->GetField("frees")->AsULong();
+
+    uint64_t previousLiveBytes = static_cast<uint64_t>(-1);
+    for (auto callSite : kmemBlock.GetLeakCandidates())
+    {
+        const KmemBlock::Stats* stats = kmemBlock.GetCallSiteStats(callSite);
+        ASSERT_NE(nullptr, stats);
+        EXPECT_LT(0u, stats->liveBytes);
+        EXPECT_GE(previousLiveBytes, stats->liveBytes);
+        EXPECT_LE(stats->liveBytes, stats->peakLiveBytes);
+        previousLiveBytes = stats->liveBytes;
+        live += stats->allocs - stats->frees;
+    }
+    EXPECT_EQ(kmemBlock.liveAllocations(), live);
+
+    for (auto callSite : kmemBlock.GetChurnHotspots())
+    {
+        const KmemBlock::Stats* stats = kmemBlock.GetCallSiteStats(callSite);
+        ASSERT_NE(nullptr, stats);
+        EXPECT_LE(stats->churn, stats->frees);
+        EXPECT_EQ(stats->frees, stats->lifetime.count());
+    }
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,333 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/NetworkBlock.hpp"
+
+#include <algorithm>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+const uint64_t kDefaultBucketNs = 100000000;
+const timestamp_t kNoTimestamp = static_cast<timestamp_t>(-1);
+
+// Initial capacities of the per-CPU buffers.
+const size_t kInitialProcesses = 256;
+const size_t kInitialBuckets = 1024;
+
+// Process of the packets sent or received while the thread running on the
+// CPU is unknown.
+const int32_t kUnknownProcess = -1;
+
+template <typename T>
+void GrowTo(std::vector<T>* vector, size_t index)
+{
+    if (index >= vector->size())
+        vector->resize(index + 1);
+}
+
+}  // namespace
+
+NetworkBlock::NetworkBlock()
+    : AbstractAnalysisBlock("network"),
+      _bucketNs(kDefaultBucketNs),
+      _firstTs(kNoTimestamp)
+{
+}
+
+void NetworkBlock::Start(const value::Value* parameters)
+{
+    const value::Value* bucketNs = nullptr;
+    if (parameters != nullptr && parameters->GetField("bucket_ns", &bucketNs))
+        bucketNs->AsULong(&_bucketNs);
+    if (_bucketNs == 0)
+        _bucketNs = kDefaultBucketNs;
+}
+
+void NetworkBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<NetworkBlock, &NetworkBlock::onNetDevQueue>(notificationCenter, Token("net_dev_queue"), this);
+    AddKernelObserver<NetworkBlock, &NetworkBlock::onNetDevXmit>(notificationCenter, Token("net_dev_xmit"), this);
+    AddKernelObserver<NetworkBlock, &NetworkBlock::onNetifReceive>(notificationCenter, Token("netif_receive_skb"), this);
+    AddKernelObserver<NetworkBlock, &NetworkBlock::onNetifReceive>(notificationCenter, Token("netif_rx"), this);
+}
+
+void NetworkBlock::onNetDevQueue(const trace::EventValue& event)
+{
+    auto skbaddr = event.getFields()->GetField("skbaddr")->AsULong();
+    _queuedPackets[skbaddr] = event.getTimestamp();
+}
+
+void NetworkBlock::onNetDevXmit(const trace::EventValue& event)
+{
+    Packet packet;
+    if (!GetPacket(event, &packet))
+        return;
+
+    CpuBuffer& buffer = GetCpuBuffer(packet.cpu);
+    GrowTo(&buffer.devices, packet.device);
+
+    Counters* counters[] = {
+        &buffer.total,
+        &buffer.processes[packet.pid],
+        &buffer.devices[packet.device],
+        GetBucket(&buffer, packet.ts),
+    };
+    for (Counters* c : counters)
+    {
+        ++c->txPackets;
+        c->txBytes += packet.len;
+    }
+
+    auto skbaddr = event.getFields()->GetField("skbaddr")->AsULong();
+    const timestamp_t* queued = _queuedPackets.Find(skbaddr);
+    if (queued == nullptr)
+        return;
+    if (*queued <= packet.ts)
+    {
+        GrowTo(&buffer.deviceLatency, packet.device);
+        buffer.deviceLatency[packet.device].Record(packet.ts - *queued);
+    }
+    _queuedPackets.Erase(skbaddr);
+}
+
+void NetworkBlock::onNetifReceive(const trace::EventValue& event)
+{
+    Packet packet;
+    if (!GetPacket(event, &packet))
+        return;
+
+    CpuBuffer& buffer = GetCpuBuffer(packet.cpu);
+    GrowTo(&buffer.devices, packet.device);
+
+    Counters* counters[] = {
+        &buffer.total,
+        &buffer.processes[packet.pid],
+        &buffer.devices[packet.device],
+        GetBucket(&buffer, packet.ts),
+    };
+    for (Counters* c : counters)
+    {
+        ++c->rxPackets;
+        c->rxBytes += packet.len;
+    }
+}
+
+bool NetworkBlock::GetPacket(const trace::EventValue& event, Packet* packet)
+{
+    auto fields = event.getFields();
+    packet->ts = event.getTimestamp();
+    packet->cpu = GetEventCpu(event);
+    packet->len = fields->GetField("len")->AsUInteger();
+    packet->device = GetDeviceIndex(fields->GetField("name"));
+
+    auto tid = GetCurrentThread(packet->cpu);
+    packet->pid = tid == kUnknownThread ? kUnknownProcess : GetProcessId(tid);
+
+    if (_firstTs == kNoTimestamp)
+        _firstTs = packet->ts;
+    return packet->ts >= _firstTs;
+}
+
+NetworkBlock::CpuBuffer& NetworkBlock::GetCpuBuffer(uint32_t cpu)
+{
+    GrowTo(&_cpuBuffers, cpu);
+    return _cpuBuffers[cpu];
+}
+
+NetworkBlock::Counters* NetworkBlock::GetBucket(CpuBuffer* buffer, timestamp_t ts)
+{
+    size_t bucket = static_cast<size_t>((ts - _firstTs) / _bucketNs);
+    GrowTo(&buffer->buckets, bucket);
+    return &buffer->buckets[bucket];
+}
+
+uint32_t NetworkBlock::GetDeviceIndex(const value::Value* name)
+{
+    // Interface names are shorter than 16 characters: copying them
+    // doesn't allocate with a small string optimization.
+    std::string deviceName = name != nullptr ? name->AsString() : std::string();
+
+    auto look = _deviceIndexes.find(deviceName);
+    if (look != _deviceIndexes.end())
+        return look->second;
+
+    uint32_t index = static_cast<uint32_t>(_deviceNames.size());
+    _deviceNames.push_back(deviceName);
+    _deviceIndexes[deviceName] = index;
+    return index;
+}
+
+void NetworkBlock::Stop()
+{
+    _cpus.assign(_cpuBuffers.size(), Counters());
+    _processes.clear();
+    _devices.assign(_deviceNames.size(), Counters());
+    _deviceLatency.assign(_deviceNames.size(), stats::Histogram());
+    _buckets.clear();
+
+    for (size_t cpu = 0; cpu < _cpuBuffers.size(); ++cpu)
+    {
+        const CpuBuffer& buffer = _cpuBuffers[cpu];
+        _cpus[cpu] = buffer.total;
+
+        buffer.processes.ForEach([&] (int32_t pid, const Counters& counters) {
+            _processes[pid].Add(counters);
+        });
+        for (size_t device = 0; device < buffer.devices.size(); ++device)
+            _devices[device].Add(buffer.devices[device]);
+        for (size_t device = 0; device < buffer.deviceLatency.size(); ++device)
+            _deviceLatency[device].Merge(buffer.deviceLatency[device]);
+
+        if (buffer.buckets.size() > _buckets.size())
+            _buckets.resize(buffer.buckets.size());
+        for (size_t bucket = 0; bucket < buffer.buckets.size(); ++bucket)
+            _buckets[bucket].Add(buffer.buckets[bucket]);
+    }
+
+    AbstractAnalysisBlock::Stop();
+}
+
+const NetworkBlock::Counters* NetworkBlock::GetProcessCounters(int32_t pid) const
+{
+    auto look = _processes.find(pid);
+    if (look == _processes.end())
+        return nullptr;
+    return &look->second;
+}
+
+const NetworkBlock::Counters* NetworkBlock::GetDeviceCounters(const std::string& device) const
+{
+    auto look = _deviceIndexes.find(device);
+    if (look == _deviceIndexes.end() || look->second >= _devices.size())
+        return nullptr;
+    return &_devices[look->second];
+}
+
+const NetworkBlock::Counters* NetworkBlock::GetCpuCounters(uint32_t cpu) const
+{
+    if (cpu >= _cpus.size())
+        return nullptr;
+    return &_cpus[cpu];
+}
+
+const stats::Histogram* NetworkBlock::GetDeviceLatency(const std::string& device) const
+{
+    auto look = _deviceIndexes.find(device);
+    if (look == _deviceIndexes.end() || look->second >= _deviceLatency.size())
+        return nullptr;
+    return &_deviceLatency[look->second];
+}
+
+namespace
+{
+
+void AddCounters(const NetworkBlock::Counters& counters, value::StructValue* value)
+{
+    value->AddField<value::ULongValue>("tx_packets", counters.txPackets);
+    value->AddField<value::ULongValue>("tx_bytes", counters.txBytes);
+    value->AddField<value::ULongValue>("rx_packets", counters.rxPackets);
+    value->AddField<value::ULongValue>("rx_bytes", counters.rxBytes);
+}
+
+}  // namespace
+
+value::Value::UP NetworkBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+
+    value::ArrayValue::UP processesValue {new value::ArrayValue};
+    for (const auto& process : _processes)
+    {
+        value::StructValue::UP processValue {new value::StructValue};
+        processValue->AddField<value::IntValue>("pid", process.first);
+        processValue->AddField<value::StringValue>("name", GetThreadName(process.first));
+        AddCounters(process.second, processValue.get());
+        processesValue->Append(std::move(processValue));
+    }
+    report->AddField("processes", std::move(processesValue));
+
+    value::ArrayValue::UP devicesValue {new value::ArrayValue};
+    for (size_t device = 0; device < _devices.size(); ++device)
+    {
+        value::StructValue::UP deviceValue {new value::StructValue};
+        deviceValue->AddField<value::StringValue>("name", _deviceNames[device]);
+        AddCounters(_devices[device], deviceValue.get());
+        deviceValue->AddField("tx_latency", _deviceLatency[device].ToValue());
+        devicesValue->Append(std::move(deviceValue));
+    }
+    report->AddField("devices", std::move(devicesValue));
+
+    value::ArrayValue::UP cpusValue {new value::ArrayValue};
+    for (size_t cpu = 0; cpu < _cpus.size(); ++cpu)
+    {
+        value::StructValue::UP cpuValue {new value::StructValue};
+        cpuValue->AddField<value::UIntValue>("cpu", cpu);
+        AddCounters(_cpus[cpu], cpuValue.get());
+        cpusValue->Append(std::move(cpuValue));
+    }
+    report->AddField("cpus", std::move(cpusValue));
+
+    value::ArrayValue::UP bucketsValue {new value::ArrayValue};
+    for (size_t bucket = 0; bucket < _buckets.size(); ++bucket)
+    {
+        value::StructValue::UP bucketValue {new value::StructValue};
+        bucketValue->AddField<value::ULongValue>("begin", _firstTs + bucket * _bucketNs);
+        AddCounters(_buckets[bucket], bucketValue.get());
+        bucketsValue->Append(std::move(bucketValue));
+    }
+    report->AddField("buckets", std::move(bucketsValue));
+
+    return std::move(report);
+}
+
+NetworkBlock::Counters::Counters()
+    : txPackets(0),
+      txBytes(0),
+      rxPackets(0),
+      rxBytes(0)
+{
+}
+
+void NetworkBlock::Counters::Add(const Counters& other)
+{
+    txPackets += other.txPackets;
+    txBytes += other.txBytes;
+    rxPackets += other.rxPackets;
+    rxBytes += other.rxBytes;
+}
+
+NetworkBlock::CpuBuffer::CpuBuffer()
+    : processes(kInitialProcesses)
+{
+    buckets.reserve(kInitialBuckets);
+}
+
+}
+}
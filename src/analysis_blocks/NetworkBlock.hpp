@@ -0,0 +1,146 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_NETWORKBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_NETWORKBLOCK_HPP
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "base/OpenHashMap.hpp"
+#include "stats/Histogram.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that aggregates network traffic.
+ *
+ * Transmitted (net_dev_xmit) and received (netif_receive_skb, netif_rx)
+ * packets are attributed to the thread running on the CPU of the event
+ * and aggregated per process, per device, per CPU and per time bucket.
+ * The transmit latency of a packet is measured from net_dev_queue to
+ * net_dev_xmit, per device.
+ *
+ * Packets are aggregated in per-CPU buffers, allocated when a CPU is
+ * first seen, that only grow with the number of processes, devices and
+ * time buckets, never with the number of packets. The buffers are
+ * merged when the block is stopped: the accessors and the report are
+ * only valid after that.
+ *
+ * Parameters:
+ *   bucket_ns: Optional. Duration of a time bucket (default: 100 ms).
+ *
+ * @author Francois Doray
+ */
+class NetworkBlock : public AbstractAnalysisBlock
+{
+public:
+    struct Counters
+    {
+        Counters();
+        void Add(const Counters& other);
+
+        uint64_t txPackets;
+        uint64_t txBytes;
+        uint64_t rxPackets;
+        uint64_t rxBytes;
+    };
+
+    NetworkBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+    virtual void Stop() override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Return the traffic of a process, device or CPU, or nullptr.
+    const Counters* GetProcessCounters(int32_t pid) const;
+    const Counters* GetDeviceCounters(const std::string& device) const;
+    const Counters* GetCpuCounters(uint32_t cpu) const;
+
+    // Returns the transmit latency of a device, or nullptr.
+    const stats::Histogram* GetDeviceLatency(const std::string& device) const;
+
+    // Traffic per time bucket, starting at the first network event.
+    const std::vector<Counters>& buckets() const { return _buckets; }
+    timestamp_t bucketBegin() const { return _firstTs; }
+    uint64_t bucketNs() const { return _bucketNs; }
+
+private:
+    void onNetDevQueue(const trace::EventValue& event);
+    void onNetDevXmit(const trace::EventValue& event);
+    void onNetifReceive(const trace::EventValue& event);
+
+    // Aggregated traffic of a CPU since the beginning of the trace.
+    struct CpuBuffer
+    {
+        CpuBuffer();
+
+        Counters total;
+        base::OpenHashMap<int32_t, Counters> processes;
+        std::vector<Counters> devices;
+        std::vector<stats::Histogram> deviceLatency;
+        std::vector<Counters> buckets;
+    };
+
+    struct Packet
+    {
+        uint32_t cpu;
+        int32_t pid;
+        uint32_t device;
+        uint32_t len;
+        timestamp_t ts;
+    };
+
+    bool GetPacket(const trace::EventValue& event, Packet* packet);
+    CpuBuffer& GetCpuBuffer(uint32_t cpu);
+    Counters* GetBucket(CpuBuffer* buffer, timestamp_t ts);
+    uint32_t GetDeviceIndex(const value::Value* name);
+
+    uint64_t _bucketNs;
+    timestamp_t _firstTs;
+
+    // Devices, by index.
+    std::vector<std::string> _deviceNames;
+    std::unordered_map<std::string, uint32_t> _deviceIndexes;
+
+    // Time at which each packet was queued for transmission.
+    base::OpenHashMap<uint64_t, timestamp_t> _queuedPackets;
+
+    std::vector<CpuBuffer> _cpuBuffers;
+
+    // Merged when the block is stopped.
+    std::vector<Counters> _cpus;
+    std::map<int32_t, Counters> _processes;
+    std::vector<Counters> _devices;
+    std::vector<stats::Histogram> _deviceLatency;
+    std::vector<Counters> _buckets;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_NETWORKBLOCK_HPP
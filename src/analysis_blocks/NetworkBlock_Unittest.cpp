@@ -0,0 +1,103 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/NetworkBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+namespace
+{
+
+void ExpectEqualCounters(const NetworkBlock::Counters& expected,
+                         const NetworkBlock::Counters& actual)
+{
+    EXPECT_EQ(expected.txPackets, actual.txPackets);
+    EXPECT_EQ(expected.txBytes, actual.txBytes);
+    EXPECT_EQ(expected.rxPackets, actual.rxPackets);
+    EXPECT_EQ(expected.rxBytes, actual.rxBytes);
+}
+
+}  // namespace
+
+TEST(NetworkBlock, NetworkBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    value::StructValue networkParams;
+    networkParams.AddField<value::ULongValue>("bucket_ns", 10000000);
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    NetworkBlock networkBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&networkBlock, &networkParams);
+    blockRunner.Run();
+
+    EXPECT_EQ(10000000u, networkBlock.bucketNs());
+
+    // All aggregations count the same packets.
+    NetworkBlock::Counters cpus;
+    for (uint32_t cpu = 0; networkBlock.GetCpuCounters(cpu) != nullptr; ++cpu)
+        cpus.Add(*networkBlock.GetCpuCounters(cpu));
+
+    NetworkBlock::Counters buckets;
+    for (const auto& bucket : networkBlock.buckets())
+        buckets.Add(bucket);
+    ExpectEqualCounters(cpus, buckets);
+
+    auto report = networkBlock.GetReport();
+    NetworkBlock::Counters devices;
+    for (const auto& device : *value::ArrayValueBase::Cast(report->GetField("devices")))
+    {
+        std::string name = device.GetField("name")->AsString();
+        ASSERT_NE(nullptr, networkBlock.GetDeviceCounters(name));
+        devices.Add(*networkBlock.GetDeviceCounters(name));
+
+        const stats::Histogram* latency = networkBlock.GetDeviceLatency(name);
+        ASSERT_NE(nullptr, latency);
+        EXPECT_LE(latency->count(), networkBlock.GetDeviceCounters(name)->txPackets);
+    }
+    ExpectEqualCounters(cpus, devices);
+
+    NetworkBlock::Counters processes;
+    for (const auto& process : *value::ArrayValueBase::Cast(report->GetField("processes")))
+    {
+        auto counters = networkBlock.GetProcessCounters(process.GetField("pid")->AsInteger());
+        ASSERT_NE(nullptr, counters);
+        processes.Add(*counters);
+    }
+    ExpectEqualCounters(cpus, processes);
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
@@ -0,0 +1,223 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/SchedLatencyBlock.hpp"
+
+#include <algorithm>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+using notification::Token;
+
+namespace
+{
+
+// The idle thread is never waiting for a CPU.
+const int32_t kIdleThread = 0;
+
+// prev_state of a thread that is still runnable when it is switched out.
+const int64_t kTaskRunning = 0;
+
+}  // namespace
+
+SchedLatencyBlock::SchedLatencyBlock()
+    : AbstractAnalysisBlock("sched-latency"),
+      _stats(kNumDelayTypes, DelayStats(kDefaultTopSize))
+{
+}
+
+void SchedLatencyBlock::Start(const value::Value* parameters)
+{
+    _stats.assign(kNumDelayTypes, DelayStats(GetTopSize(parameters)));
+}
+
+void SchedLatencyBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<SchedLatencyBlock, &SchedLatencyBlock::onSchedWakeup>(notificationCenter, Token("sched_wakeup"), this);
+    AddKernelObserver<SchedLatencyBlock, &SchedLatencyBlock::onSchedWakeup>(notificationCenter, Token("sched_wakeup_new"), this);
+    AddKernelObserver<SchedLatencyBlock, &SchedLatencyBlock::onSchedSwitch>(notificationCenter, Token("sched_switch"), this);
+}
+
+void SchedLatencyBlock::onSchedWakeup(const trace::EventValue& event)
+{
+    auto tid = event.getFields()->GetField("tid")->AsInteger();
+    if (tid == kIdleThread)
+        return;
+
+    // A thread that is already waiting for a CPU keeps its first wakeup.
+    RunnableThread runnable {kWakeupLatency, event.getTimestamp()};
+    _runnable.insert(std::make_pair(tid, runnable));
+}
+
+void SchedLatencyBlock::onSchedSwitch(const trace::EventValue& event)
+{
+    auto fields = event.getFields();
+    auto ts = event.getTimestamp();
+
+    auto prevTid = fields->GetField("prev_tid")->AsInteger();
+    if (prevTid != kIdleThread)
+    {
+        if (fields->GetField("prev_state")->AsLong() == kTaskRunning)
+            _runnable[prevTid] = RunnableThread {kPreemptedDelay, ts};
+        else
+            _runnable.erase(prevTid);
+    }
+
+    auto nextTid = fields->GetField("next_tid")->AsInteger();
+    auto look = _runnable.find(nextTid);
+    if (look == _runnable.end())
+        return;
+
+    RunnableThread runnable = look->second;
+    _runnable.erase(look);
+
+    if (ts < runnable.since)
+        return;
+
+    Delay delay;
+    delay.begin = runnable.since;
+    delay.duration = ts - runnable.since;
+    delay.tid = nextTid;
+    delay.cpu = GetEventCpu(event);
+    delay.prio = fields->GetField("next_prio")->AsInteger();
+    _stats[runnable.type].Record(delay);
+}
+
+void SchedLatencyBlock::DelayStats::Record(const Delay& delay)
+{
+    total.Record(delay.duration);
+    threads[delay.tid].Record(delay.duration);
+    if (delay.cpu >= cpus.size())
+        cpus.resize(delay.cpu + 1);
+    cpus[delay.cpu].Record(delay.duration);
+    priorities[delay.prio].Record(delay.duration);
+    worst.Add(delay);
+}
+
+const stats::Histogram& SchedLatencyBlock::GetHistogram(DelayType type) const
+{
+    return _stats[type].total;
+}
+
+const stats::Histogram* SchedLatencyBlock::GetThreadHistogram(DelayType type, int32_t tid) const
+{
+    const auto& threads = _stats[type].threads;
+    auto look = threads.find(tid);
+    if (look == threads.end())
+        return nullptr;
+    return &look->second;
+}
+
+const stats::Histogram* SchedLatencyBlock::GetCpuHistogram(DelayType type, uint32_t cpu) const
+{
+    const auto& cpus = _stats[type].cpus;
+    if (cpu >= cpus.size() || cpus[cpu].count() == 0)
+        return nullptr;
+    return &cpus[cpu];
+}
+
+const stats::Histogram* SchedLatencyBlock::GetPriorityHistogram(DelayType type, int32_t prio) const
+{
+    const auto& priorities = _stats[type].priorities;
+    auto look = priorities.find(prio);
+    if (look == priorities.end())
+        return nullptr;
+    return &look->second;
+}
+
+std::vector<SchedLatencyBlock::Delay> SchedLatencyBlock::GetWorstDelays(DelayType type) const
+{
+    return _stats[type].worst.Sorted();
+}
+
+value::Value::UP SchedLatencyBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField("wakeup", GetDelayReport(_stats[kWakeupLatency]));
+    report->AddField("preempted", GetDelayReport(_stats[kPreemptedDelay]));
+    return std::move(report);
+}
+
+value::Value::UP SchedLatencyBlock::GetDelayReport(const DelayStats& stats) const
+{
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField("total", stats.total.ToValue());
+
+    value::ArrayValue::UP cpusValue {new value::ArrayValue};
+    for (size_t cpu = 0; cpu < stats.cpus.size(); ++cpu)
+    {
+        if (stats.cpus[cpu].count() == 0)
+            continue;
+        value::StructValue::UP cpuValue {new value::StructValue};
+        cpuValue->AddField<value::UIntValue>("cpu", cpu);
+        cpuValue->AddField("latency", stats.cpus[cpu].ToValue());
+        cpusValue->Append(std::move(cpuValue));
+    }
+    report->AddField("cpus", std::move(cpusValue));
+
+    value::ArrayValue::UP prioritiesValue {new value::ArrayValue};
+    for (const auto& priority : stats.priorities)
+    {
+        value::StructValue::UP priorityValue {new value::StructValue};
+        priorityValue->AddField<value::IntValue>("prio", priority.first);
+        priorityValue->AddField("latency", priority.second.ToValue());
+        prioritiesValue->Append(std::move(priorityValue));
+    }
+    report->AddField("priorities", std::move(prioritiesValue));
+
+    std::vector<int32_t> tids;
+    for (const auto& thread : stats.threads)
+        tids.push_back(thread.first);
+    std::sort(tids.begin(), tids.end());
+
+    value::ArrayValue::UP threadsValue {new value::ArrayValue};
+    for (auto tid : tids)
+    {
+        value::StructValue::UP threadValue {new value::StructValue};
+        threadValue->AddField<value::IntValue>("tid", tid);
+        threadValue->AddField<value::StringValue>("name", GetThreadName(tid));
+        threadValue->AddField("latency", stats.threads.at(tid).ToValue());
+        threadsValue->Append(std::move(threadValue));
+    }
+    report->AddField("threads", std::move(threadsValue));
+
+    value::ArrayValue::UP worstValue {new value::ArrayValue};
+    for (const auto& delay : stats.worst.Sorted())
+    {
+        value::StructValue::UP delayValue {new value::StructValue};
+        delayValue->AddField<value::ULongValue>("begin", delay.begin);
+        delayValue->AddField<value::ULongValue>("duration", delay.duration);
+        delayValue->AddField<value::IntValue>("tid", delay.tid);
+        delayValue->AddField<value::UIntValue>("cpu", delay.cpu);
+        delayValue->AddField<value::IntValue>("prio", delay.prio);
+        worstValue->Append(std::move(delayValue));
+    }
+    report->AddField("worst", std::move(worstValue));
+
+    return std::move(report);
+}
+
+}
+}
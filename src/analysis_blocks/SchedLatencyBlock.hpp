@@ -0,0 +1,134 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_SCHEDLATENCYBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_SCHEDLATENCYBLOCK_HPP
+
+#include <map>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "stats/Histogram.hpp"
+#include "stats/TopN.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that measures how long runnable threads wait for a CPU.
+ *
+ * Two delays are measured:
+ *   - wakeup latency: from the wakeup of a thread (sched_wakeup or
+ *     sched_wakeup_new) to the sched_switch that runs it,
+ *   - preempted delay: from the sched_switch that preempts a thread
+ *     while it is runnable to the sched_switch that runs it again.
+ *
+ * Each delay is recorded in a global histogram and in histograms per
+ * thread, per CPU (the CPU on which the thread runs at the end of the
+ * delay) and per priority, and the longest delays are kept.
+ *
+ * Parameters:
+ *   top: Optional. Number of longest delays to keep (default: 10).
+ *
+ * @author Francois Doray
+ */
+class SchedLatencyBlock : public AbstractAnalysisBlock
+{
+public:
+    enum DelayType
+    {
+        kWakeupLatency = 0,
+        kPreemptedDelay,
+        kNumDelayTypes,
+    };
+
+    struct Delay
+    {
+        timestamp_t begin;
+        uint64_t duration;
+        int32_t tid;
+        uint32_t cpu;
+        int32_t prio;
+    };
+
+    SchedLatencyBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Returns the histogram of all delays of a type.
+    const stats::Histogram& GetHistogram(DelayType type) const;
+
+    // Return the histogram of a thread, CPU or priority, or nullptr.
+    const stats::Histogram* GetThreadHistogram(DelayType type, int32_t tid) const;
+    const stats::Histogram* GetCpuHistogram(DelayType type, uint32_t cpu) const;
+    const stats::Histogram* GetPriorityHistogram(DelayType type, int32_t prio) const;
+
+    // Returns the longest delays of a type, longest first.
+    std::vector<Delay> GetWorstDelays(DelayType type) const;
+
+private:
+    void onSchedWakeup(const trace::EventValue& event);
+    void onSchedSwitch(const trace::EventValue& event);
+
+    struct RunnableThread
+    {
+        DelayType type;
+        timestamp_t since;
+    };
+
+    struct ShorterDelay
+    {
+        bool operator()(const Delay& a, const Delay& b) const
+        {
+            return a.duration < b.duration;
+        }
+    };
+
+    struct DelayStats
+    {
+        explicit DelayStats(size_t topSize) : worst(topSize) {}
+
+        void Record(const Delay& delay);
+
+        stats::Histogram total;
+        std::unordered_map<int32_t, stats::Histogram> threads;
+        std::vector<stats::Histogram> cpus;
+        std::map<int32_t, stats::Histogram> priorities;
+        stats::TopN<Delay, ShorterDelay> worst;
+    };
+
+    value::Value::UP GetDelayReport(const DelayStats& stats) const;
+
+    // Threads waiting for a CPU.
+    std::unordered_map<int32_t, RunnableThread> _runnable;
+
+    // Statistics, by delay type.
+    std::vector<DelayStats> _stats;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_SCHEDLATENCYBLOCK_HPP
@@ -0,0 +1,81 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/SchedLatencyBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+TEST(SchedLatencyBlock, SchedLatencyBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    SchedLatencyBlock latencyBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&latencyBlock, nullptr);
+    blockRunner.Run();
+
+    for (auto type : {SchedLatencyBlock::kWakeupLatency,
+                      SchedLatencyBlock::kPreemptedDelay})
+    {
+        const stats::Histogram& total = latencyBlock.GetHistogram(type);
+        EXPECT_LT(0u, total.count());
+        EXPECT_LE(total.Percentile(50), total.Percentile(99));
+        EXPECT_LE(total.Percentile(99), total.max());
+
+        auto worst = latencyBlock.GetWorstDelays(type);
+        ASSERT_FALSE(worst.empty());
+        EXPECT_EQ(total.max(), worst.front().duration);
+        for (size_t i = 1; i < worst.size(); ++i)
+            EXPECT_GE(worst[i - 1].duration, worst[i].duration);
+
+        // The longest delay is in the histograms of its thread, CPU and
+        // priority.
+        const auto& delay = worst.front();
+        const stats::Histogram* thread = latencyBlock.GetThreadHistogram(type, delay.tid);
+        ASSERT_NE(nullptr, thread);
+        EXPECT_EQ(delay.duration, thread->max());
+        const stats::Histogram* cpu = latencyBlock.GetCpuHistogram(type, delay.cpu);
+        ASSERT_NE(nullptr, cpu);
+        EXPECT_EQ(delay.duration, cpu->max());
+        const stats::Histogram* prio = latencyBlock.GetPriorityHistogram(type, delay.prio);
+        ASSERT_NE(nullptr, prio);
+        EXPECT_EQ(delay.duration, prio->max());
+    }
+
+    EXPECT_EQ(nullptr, latencyBlock.GetThreadHistogram(SchedLatencyBlock::kWakeupLatency, 0));
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
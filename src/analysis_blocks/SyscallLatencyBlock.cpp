@@ -0,0 +1,235 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "analysis_blocks/SyscallLatencyBlock.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+namespace
+{
+
+using notification::RegexToken;
+using notification::Token;
+
+const char* kSyscallPrefixes[] = {
+    "syscall_entry_",
+    "compat_syscall_entry_",
+    "compat_sys_",
+    "sys_",
+};
+
+std::string GetSyscallName(const char* eventName)
+{
+    for (const char* prefix : kSyscallPrefixes)
+    {
+        size_t prefixLength = std::strlen(prefix);
+        if (std::strncmp(eventName, prefix, prefixLength) == 0)
+            return eventName + prefixLength;
+    }
+    return eventName;
+}
+
+}  // namespace
+
+SyscallLatencyBlock::SyscallLatencyBlock()
+    : AbstractAnalysisBlock("syscall-latency"),
+      _outliers(kDefaultTopSize)
+{
+}
+
+void SyscallLatencyBlock::Start(const value::Value* parameters)
+{
+    _outliers = stats::TopN<RecordedOutlier, ShorterOutlier>(GetTopSize(parameters));
+}
+
+void SyscallLatencyBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    AbstractAnalysisBlock::AddObservers(notificationCenter);
+
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallEntry>(notificationCenter, RegexToken("^sys_"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallEntry>(notificationCenter, RegexToken("^compat_sys_"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallEntry>(notificationCenter, RegexToken("^syscall_entry_"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallEntry>(notificationCenter, RegexToken("^compat_syscall_entry_"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallExit>(notificationCenter, Token("exit_syscall"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallExit>(notificationCenter, RegexToken("^syscall_exit_"), this);
+    AddKernelObserver<SyscallLatencyBlock, &SyscallLatencyBlock::onSyscallExit>(notificationCenter, RegexToken("^compat_syscall_exit_"), this);
+}
+
+void SyscallLatencyBlock::onSyscallEntry(const trace::EventValue& event)
+{
+    auto tid = GetCurrentThread(GetEventCpu(event));
+    if (tid == kUnknownThread)
+        return;
+
+    PendingSyscall& pending = _pending[tid];
+    pending.syscall = GetSyscallIndex(event);
+    pending.begin = event.getTimestamp();
+}
+
+void SyscallLatencyBlock::onSyscallExit(const trace::EventValue& event)
+{
+    auto tid = GetCurrentThread(GetEventCpu(event));
+    if (tid == kUnknownThread)
+        return;
+
+    auto look = _pending.find(tid);
+    if (look == _pending.end())
+        return;
+
+    PendingSyscall pending = look->second;
+    _pending.erase(look);
+
+    timestamp_t end = event.getTimestamp();
+    if (end < pending.begin)
+        return;
+    uint64_t duration = end - pending.begin;
+
+    _syscalls[pending.syscall].latency.Record(duration);
+
+    auto pid = GetProcessId(tid);
+    auto processLook = _processes.find(pid);
+    if (processLook == _processes.end())
+    {
+        processLook = _processes.insert(std::make_pair(pid, ProcessStats())).first;
+        processLook->second.name = GetThreadName(pid);
+        if (processLook->second.name.empty())
+            processLook->second.name = GetThreadName(tid);
+    }
+    processLook->second.latency.Record(duration);
+
+    _outliers.Add(RecordedOutlier {pending.begin, duration, tid, pending.syscall});
+}
+
+uint32_t SyscallLatencyBlock::GetSyscallIndex(const trace::EventValue& event)
+{
+    auto key = GetEventClassKey(event);
+    auto look = _eventSyscalls.find(key);
+    if (look != _eventSyscalls.end())
+        return look->second;
+
+    std::string name = GetSyscallName(event.getName());
+    auto indexLook = _syscallIndexes.find(name);
+    uint32_t index = 0;
+    if (indexLook != _syscallIndexes.end())
+    {
+        index = indexLook->second;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(_syscalls.size());
+        _syscalls.push_back(SyscallStats());
+        _syscalls.back().name = name;
+        _syscallIndexes[name] = index;
+    }
+
+    _eventSyscalls[key] = index;
+    return index;
+}
+
+const stats::Histogram* SyscallLatencyBlock::GetSyscallHistogram(const std::string& syscall) const
+{
+    auto look = _syscallIndexes.find(syscall);
+    if (look == _syscallIndexes.end())
+        return nullptr;
+    return &_syscalls[look->second].latency;
+}
+
+const stats::Histogram* SyscallLatencyBlock::GetProcessHistogram(int32_t pid) const
+{
+    auto look = _processes.find(pid);
+    if (look == _processes.end())
+        return nullptr;
+    return &look->second.latency;
+}
+
+std::vector<SyscallLatencyBlock::Outlier> SyscallLatencyBlock::GetOutliers() const
+{
+    std::vector<Outlier> outliers;
+    for (const auto& recorded : _outliers.Sorted())
+    {
+        outliers.push_back(Outlier {recorded.begin, recorded.duration, recorded.tid,
+                                    _syscalls[recorded.syscall].name});
+    }
+    return outliers;
+}
+
+value::Value::UP SyscallLatencyBlock::GetReport() const
+{
+    value::StructValue::UP report {new value::StructValue};
+
+    // System calls, by name.
+    std::vector<const SyscallStats*> syscalls;
+    for (const auto& syscall : _syscalls)
+    {
+        if (syscall.latency.count() != 0)
+            syscalls.push_back(&syscall);
+    }
+    std::sort(syscalls.begin(), syscalls.end(),
+              [] (const SyscallStats* a, const SyscallStats* b) {
+        return a->name < b->name;
+    });
+
+    value::StructValue::UP syscallsValue {new value::StructValue};
+    for (const auto* syscall : syscalls)
+        syscallsValue->AddField(syscall->name, syscall->latency.ToValue());
+    report->AddField("syscalls", std::move(syscallsValue));
+
+    // Processes, by PID.
+    std::vector<int32_t> pids;
+    for (const auto& process : _processes)
+        pids.push_back(process.first);
+    std::sort(pids.begin(), pids.end());
+
+    value::ArrayValue::UP processesValue {new value::ArrayValue};
+    for (auto pid : pids)
+    {
+        const ProcessStats& process = _processes.at(pid);
+        value::StructValue::UP processValue {new value::StructValue};
+        processValue->AddField<value::IntValue>("pid", pid);
+        processValue->AddField<value::StringValue>("name", process.name);
+        processValue->AddField("latency", process.latency.ToValue());
+        processesValue->Append(std::move(processValue));
+    }
+    report->AddField("processes", std::move(processesValue));
+
+    // Longest system calls.
+    value::ArrayValue::UP outliersValue {new value::ArrayValue};
+    for (const auto& outlier : GetOutliers())
+    {
+        value::StructValue::UP outlierValue {new value::StructValue};
+        outlierValue->AddField<value::ULongValue>("begin", outlier.begin);
+        outlierValue->AddField<value::ULongValue>("duration", outlier.duration);
+        outlierValue->AddField<value::IntValue>("tid", outlier.tid);
+        outlierValue->AddField<value::StringValue>("syscall", outlier.syscall);
+        outliersValue->Append(std::move(outlierValue));
+    }
+    report->AddField("outliers", std::move(outliersValue));
+
+    return std::move(report);
+}
+
+}
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_ANALYSISBLOCKS_SYSCALLLATENCYBLOCK_HPP
+#define _TIBEE_ANALYSISBLOCKS_SYSCALLLATENCYBLOCK_HPP
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_blocks/AbstractAnalysisBlock.hpp"
+#include "base/BasicTypes.hpp"
+#include "stats/Histogram.hpp"
+#include "stats/TopN.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+/**
+ * A block that measures the duration of system calls.
+ *
+ * Entries and exits are paired per thread. Durations are recorded in a
+ * histogram per system call and in a histogram per process, and the
+ * longest system calls are kept. Memory usage depends on the number of
+ * system calls and processes, not on the length of the trace.
+ *
+ * Parameters:
+ *   top: Optional. Number of longest system calls to keep (default: 10).
+ *
+ * @author Francois Doray
+ */
+class SyscallLatencyBlock : public AbstractAnalysisBlock
+{
+public:
+    struct Outlier
+    {
+        timestamp_t begin;
+        uint64_t duration;
+        int32_t tid;
+        std::string syscall;
+    };
+
+    SyscallLatencyBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+
+    virtual value::Value::UP GetReport() const override;
+
+    // Returns the histogram of a system call, or nullptr.
+    const stats::Histogram* GetSyscallHistogram(const std::string& syscall) const;
+
+    // Returns the histogram of a process, or nullptr.
+    const stats::Histogram* GetProcessHistogram(int32_t pid) const;
+
+    // Returns the longest system calls, longest first.
+    std::vector<Outlier> GetOutliers() const;
+
+private:
+    void onSyscallEntry(const trace::EventValue& event);
+    void onSyscallExit(const trace::EventValue& event);
+    uint32_t GetSyscallIndex(const trace::EventValue& event);
+
+    struct PendingSyscall
+    {
+        uint32_t syscall;
+        timestamp_t begin;
+    };
+
+    struct SyscallStats
+    {
+        std::string name;
+        stats::Histogram latency;
+    };
+
+    struct ProcessStats
+    {
+        std::string name;
+        stats::Histogram latency;
+    };
+
+    struct RecordedOutlier
+    {
+        timestamp_t begin;
+        uint64_t duration;
+        int32_t tid;
+        uint32_t syscall;
+    };
+
+    struct ShorterOutlier
+    {
+        bool operator()(const RecordedOutlier& a, const RecordedOutlier& b) const
+        {
+            return a.duration < b.duration;
+        }
+    };
+
+    // System calls, by index.
+    std::vector<SyscallStats> _syscalls;
+    std::unordered_map<std::string, uint32_t> _syscallIndexes;
+
+    // (event class -> system call index) cache.
+    std::unordered_map<uint64_t, uint32_t> _eventSyscalls;
+
+    // System call in progress, per thread.
+    std::unordered_map<int32_t, PendingSyscall> _pending;
+
+    // Statistics per process.
+    std::unordered_map<int32_t, ProcessStats> _processes;
+
+    stats::TopN<RecordedOutlier, ShorterOutlier> _outliers;
+};
+
+}
+}
+
+#endif // _TIBEE_ANALYSISBLOCKS_SYSCALLLATENCYBLOCK_HPP
@@ -0,0 +1,74 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "analysis_blocks/SyscallLatencyBlock.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace analysis_blocks
+{
+
+TEST(SyscallLatencyBlock, SyscallLatencyBlock)
+{
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>("test_data/kernel_a/kernel");
+    traceParams.AddField("traces", std::move(traceList));
+
+    value::StructValue latencyParams;
+    latencyParams.AddField<value::ULongValue>("top", 5);
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+    SyscallLatencyBlock latencyBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.AddBlock(&latencyBlock, &latencyParams);
+    blockRunner.Run();
+
+    const stats::Histogram* read = latencyBlock.GetSyscallHistogram("read");
+    ASSERT_NE(nullptr, read);
+    EXPECT_LT(0u, read->count());
+    EXPECT_LE(read->min(), read->Percentile(50));
+    EXPECT_LE(read->Percentile(50), read->Percentile(99));
+    EXPECT_LE(read->Percentile(99), read->max());
+
+    EXPECT_EQ(nullptr, latencyBlock.GetSyscallHistogram("not_a_syscall"));
+
+    auto outliers = latencyBlock.GetOutliers();
+    ASSERT_EQ(5u, outliers.size());
+    for (size_t i = 1; i < outliers.size(); ++i)
+        EXPECT_GE(outliers[i - 1].duration, outliers[i].duration);
+
+    auto report = latencyBlock.GetReport();
+    ASSERT_NE(nullptr, report->GetField("syscalls"));
+    ASSERT_NE(nullptr, report->GetField("processes"));
+    ASSERT_NE(nullptr, report->GetField("outliers"));
+    EXPECT_EQ(5u, value::ArrayValueBase::Cast(report->GetField("outliers"))->Length());
+}
+
+}  // namespace analysis_blocks
+}  // namespace tibee
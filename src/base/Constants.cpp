@@ -32,6 +32,8 @@ const char kTimestampNotificationName[] = "ts";
 const char kBeginNotificationName[] = "begin";
 const char kEndNotificationName[] = "end";
 
+const char kAnalysisNotificationPrefix[] = "analysis";
+
 const char kStateLinux[] = "linux";
 const char kStateThreads[] = "threads";
 const char kStateCpus[] = "cpus";
@@ -37,6 +37,8 @@ extern const char kTimestampNotificationName[];
 extern const char kBeginNotificationName[];
 extern const char kEndNotificationName[];
 
+extern const char kAnalysisNotificationPrefix[];
+
 // State system.
 extern const char kStateLinux[];
 extern const char kStateThreads[];
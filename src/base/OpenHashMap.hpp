@@ -0,0 +1,211 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_BASE_OPENHASHMAP_HPP
+#define _TIBEE_BASE_OPENHASHMAP_HPP
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace tibee
+{
+namespace base
+{
+
+/**
+ * Hash map with open addressing and linear probing.
+ *
+ * Keys and values are stored inline in a single array whose capacity is
+ * a power of two, kept at most 3/4 full: a lookup usually touches a
+ * single cache line and an element costs no allocation. Hashes are
+ * scrambled with Fibonacci hashing, so keys that are multiples of a
+ * power of two (addresses, sectors) don't collide. Erasing shifts the
+ * following elements back instead of leaving tombstones, so the table
+ * stays as small as the peak number of elements.
+ *
+ * Pointers to values are invalidated by insertions and erasures.
+ *
+ * @author Francois Doray
+ */
+template <typename K, typename V,
+          typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class OpenHashMap
+{
+public:
+    explicit OpenHashMap(size_t initialCapacity = 16)
+        : _size(0)
+    {
+        Reset(initialCapacity);
+    }
+
+    // Returns the value of |key|, or nullptr.
+    V* Find(const K& key)
+    {
+        size_t index = FindSlot(key);
+        return _slots[index].occupied ? &_slots[index].value : nullptr;
+    }
+
+    const V* Find(const K& key) const
+    {
+        size_t index = FindSlot(key);
+        return _slots[index].occupied ? &_slots[index].value : nullptr;
+    }
+
+    /**
+     * Inserts |value| for |key| if |key| isn't in the map.
+     *
+     * @returns The value of |key| and whether it was inserted.
+     */
+    std::pair<V*, bool> Insert(const K& key, const V& value)
+    {
+        if ((_size + 1) * 4 > _slots.size() * 3)
+            Grow();
+
+        size_t index = FindSlot(key);
+        Slot& slot = _slots[index];
+        if (slot.occupied)
+            return std::make_pair(&slot.value, false);
+
+        slot.key = key;
+        slot.value = value;
+        slot.occupied = true;
+        ++_size;
+        return std::make_pair(&slot.value, true);
+    }
+
+    // Returns the value of |key|, inserting a default value if needed.
+    V& operator[](const K& key)
+    {
+        return *Insert(key, V()).first;
+    }
+
+    // Removes |key| from the map. Returns false if it wasn't there.
+    bool Erase(const K& key)
+    {
+        size_t hole = FindSlot(key);
+        if (!_slots[hole].occupied)
+            return false;
+
+        // Move back the elements that can't be found anymore because of
+        // the hole, until an empty slot is reached.
+        size_t mask = _slots.size() - 1;
+        for (size_t index = (hole + 1) & mask; _slots[index].occupied; index = (index + 1) & mask)
+        {
+            size_t ideal = SlotIndex(_slots[index].key);
+            if (((index - ideal) & mask) >= ((index - hole) & mask))
+            {
+                _slots[hole] = std::move(_slots[index]);
+                hole = index;
+            }
+        }
+
+        _slots[hole] = Slot();
+        --_size;
+        return true;
+    }
+
+    // Calls |function(key, value)| for each element, in no particular order.
+    template <typename F>
+    void ForEach(F function) const
+    {
+        for (const auto& slot : _slots)
+        {
+            if (slot.occupied)
+                function(slot.key, slot.value);
+        }
+    }
+
+    void Clear()
+    {
+        Reset(_slots.size());
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    size_t capacity() const { return _slots.size(); }
+
+private:
+    struct Slot
+    {
+        Slot() : key(), value(), occupied(false) {}
+        K key;
+        V value;
+        bool occupied;
+    };
+
+    void Reset(size_t capacity)
+    {
+        _shift = 64;
+        size_t roundedCapacity = 1;
+        while (roundedCapacity < capacity || roundedCapacity < 2)
+        {
+            roundedCapacity <<= 1;
+            --_shift;
+        }
+
+        _slots.assign(roundedCapacity, Slot());
+        _size = 0;
+    }
+
+    void Grow()
+    {
+        std::vector<Slot> slots;
+        slots.swap(_slots);
+        Reset(slots.size() * 2);
+
+        for (auto& slot : slots)
+        {
+            if (!slot.occupied)
+                continue;
+            Slot& newSlot = _slots[FindSlot(slot.key)];
+            newSlot = std::move(slot);
+            ++_size;
+        }
+    }
+
+    size_t SlotIndex(const K& key) const
+    {
+        const uint64_t kGoldenRatio = 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>((static_cast<uint64_t>(_hash(key)) * kGoldenRatio) >> _shift);
+    }
+
+    // Returns the slot that contains |key|, or the empty slot where it
+    // would be inserted.
+    size_t FindSlot(const K& key) const
+    {
+        size_t mask = _slots.size() - 1;
+        size_t index = SlotIndex(key);
+        while (_slots[index].occupied && !_equal(_slots[index].key, key))
+            index = (index + 1) & mask;
+        return index;
+    }
+
+    std::vector<Slot> _slots;
+    size_t _size;
+    unsigned int _shift;
+    Hash _hash;
+    KeyEqual _equal;
+};
+
+}
+}
+
+#endif // _TIBEE_BASE_OPENHASHMAP_HPP
@@ -0,0 +1,120 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <random>
+#include <unordered_map>
+
+#include "base/OpenHashMap.hpp"
+#include "gtest/gtest.h"
+
+namespace tibee
+{
+namespace base
+{
+
+TEST(OpenHashMap, InsertFindErase)
+{
+    OpenHashMap<uint64_t, int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(nullptr, map.Find(42));
+
+    auto inserted = map.Insert(42, 1);
+    EXPECT_TRUE(inserted.second);
+    EXPECT_EQ(1, *inserted.first);
+
+    // An existing value isn't replaced.
+    inserted = map.Insert(42, 2);
+    EXPECT_FALSE(inserted.second);
+    EXPECT_EQ(1, *inserted.first);
+
+    map[43] = 3;
+    EXPECT_EQ(2u, map.size());
+    ASSERT_NE(nullptr, map.Find(43));
+    EXPECT_EQ(3, *map.Find(43));
+
+    EXPECT_TRUE(map.Erase(42));
+    EXPECT_FALSE(map.Erase(42));
+    EXPECT_EQ(nullptr, map.Find(42));
+    EXPECT_EQ(1u, map.size());
+
+    map.Clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(nullptr, map.Find(43));
+}
+
+TEST(OpenHashMap, Grow)
+{
+    OpenHashMap<uint64_t, uint64_t> map(4);
+    for (uint64_t i = 0; i < 1000; ++i)
+        map[i * 4096] = i;
+
+    EXPECT_EQ(1000u, map.size());
+    EXPECT_GE(map.capacity() * 3, map.size() * 4);
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        ASSERT_NE(nullptr, map.Find(i * 4096));
+        EXPECT_EQ(i, *map.Find(i * 4096));
+    }
+
+    uint64_t sum = 0;
+    map.ForEach([&] (uint64_t key, uint64_t value) {
+        EXPECT_EQ(key, value * 4096);
+        sum += value;
+    });
+    EXPECT_EQ(999u * 1000u / 2, sum);
+}
+
+TEST(OpenHashMap, RandomOperations)
+{
+    // Few distinct keys in a small table, to exercise erasures in long
+    // probe sequences.
+    OpenHashMap<uint32_t, uint32_t> map(4);
+    std::unordered_map<uint32_t, uint32_t> expected;
+    std::mt19937 random(42);
+
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        uint32_t key = random() % 64;
+        if (random() % 2 == 0)
+        {
+            map[key] = i;
+            expected[key] = i;
+        }
+        else
+        {
+            EXPECT_EQ(expected.erase(key) != 0, map.Erase(key));
+        }
+        ASSERT_EQ(expected.size(), map.size());
+    }
+
+    for (uint32_t key = 0; key < 64; ++key)
+    {
+        auto look = expected.find(key);
+        if (look == expected.end())
+        {
+            EXPECT_EQ(nullptr, map.Find(key));
+        }
+        else
+        {
+            ASSERT_NE(nullptr, map.Find(key));
+            EXPECT_EQ(look->second, *map.Find(key));
+        }
+    }
+}
+
+}  // namespace base
+}  // namespace tibee
@@ -0,0 +1,190 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench/Benchmark.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/regex.hpp>
+#include <iostream>
+#include <utility>
+
+#include "base/print.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+typedef std::vector<std::pair<std::string, BenchmarkFunction>> BenchmarkList;
+
+BenchmarkList* GetBenchmarks()
+{
+    // Constructed on first use, since benchmarks are registered during
+    // static initialization.
+    static BenchmarkList benchmarks;
+    return &benchmarks;
+}
+
+const uint64_t kMaxIterations = 1000000000;
+
+boost::filesystem::path& GetDataDir()
+{
+    static boost::filesystem::path dataDir(".");
+    return dataDir;
+}
+
+}  // namespace
+
+BenchmarkState::BenchmarkState(uint64_t maxIterations)
+    : _maxIterations(maxIterations),
+      _iterations(0),
+      _itemsProcessed(0),
+      _timing(false),
+      _elapsedNs(0)
+{
+}
+
+void BenchmarkState::PauseTiming()
+{
+    if (!_timing)
+        return;
+    _elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - _start).count();
+    _timing = false;
+}
+
+void BenchmarkState::ResumeTiming()
+{
+    if (_timing)
+        return;
+    _start = Clock::now();
+    _timing = true;
+}
+
+void BenchmarkState::SkipWithError(const std::string& message)
+{
+    _error = message.empty() ? "unknown error" : message;
+    PauseTiming();
+}
+
+bool RegisterBenchmark(const char* name, BenchmarkFunction function)
+{
+    GetBenchmarks()->push_back(std::make_pair(std::string(name), function));
+    return true;
+}
+
+size_t RunBenchmarks(const std::string& filter,
+                     double minSeconds,
+                     std::vector<BenchmarkResult>* results)
+{
+    boost::regex filterRegex(filter);
+    const uint64_t minNs = static_cast<uint64_t>(minSeconds * 1e9);
+
+    BenchmarkList benchmarks = *GetBenchmarks();
+    std::sort(benchmarks.begin(), benchmarks.end());
+
+    size_t numFailed = 0;
+
+    for (const auto& benchmark : benchmarks) {
+        if (!boost::regex_search(benchmark.first, filterRegex))
+            continue;
+
+        uint64_t iterations = 1;
+        for (;;) {
+            BenchmarkState state(iterations);
+            benchmark.second(&state);
+            state.PauseTiming();
+
+            // Retrying with more iterations can't help a benchmark that
+            // didn't run its measured code.
+            if (!state.error() && state.iterations() == 0)
+                state.SkipWithError("the benchmark returned without running");
+            if (state.error()) {
+                base::tberror() << benchmark.first << ": "
+                                << state.errorMessage() << base::tbendl()
+                                << std::endl;
+                ++numFailed;
+                break;
+            }
+
+            if (state.elapsedNs() >= minNs || iterations >= kMaxIterations) {
+                BenchmarkResult result;
+                result.name = benchmark.first;
+                result.iterations = state.iterations();
+                result.elapsedNs = state.elapsedNs();
+                result.itemsProcessed = state.itemsProcessed() != 0 ?
+                    state.itemsProcessed() : state.iterations();
+                results->push_back(result);
+                break;
+            }
+
+            // Predict the number of iterations needed to reach the minimum
+            // duration, growing by a factor between 2 and 10.
+            double factor = 10.0;
+            if (state.elapsedNs() != 0)
+                factor = std::min(10.0, std::max(2.0, 1.4 * minNs / state.elapsedNs()));
+            iterations = std::min(kMaxIterations,
+                                  static_cast<uint64_t>(iterations * factor));
+        }
+    }
+
+    return numFailed;
+}
+
+void SetDataDir(const std::string& dataDir)
+{
+    GetDataDir() = dataDir;
+}
+
+std::string DataPath(const std::string& relativePath)
+{
+    return (GetDataDir() / relativePath).string();
+}
+
+value::Value::UP ResultsToValue(const std::vector<BenchmarkResult>& results)
+{
+    value::ArrayValue::UP benchmarks {new value::ArrayValue};
+
+    for (const auto& result : results) {
+        double seconds = result.elapsedNs / 1e9;
+
+        value::StructValue::UP benchmark {new value::StructValue};
+        benchmark->AddField<value::StringValue>("name", result.name);
+        benchmark->AddField<value::ULongValue>("iterations", result.iterations);
+        benchmark->AddField<value::ULongValue>("elapsed-ns", result.elapsedNs);
+        benchmark->AddField<value::DoubleValue>(
+            "ns-per-iteration",
+            result.iterations != 0 ?
+                static_cast<double>(result.elapsedNs) / result.iterations : 0);
+        benchmark->AddField<value::ULongValue>("items", result.itemsProcessed);
+        benchmark->AddField<value::DoubleValue>(
+            "items-per-second",
+            seconds > 0 ? result.itemsProcessed / seconds : 0);
+        benchmarks->Append(std::move(benchmark));
+    }
+
+    value::StructValue::UP report {new value::StructValue};
+    report->AddField("benchmarks", std::move(benchmarks));
+    return std::move(report);
+}
+
+}
+}
@@ -0,0 +1,168 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_BENCH_BENCHMARK_HPP
+#define _TIBEE_BENCH_BENCHMARK_HPP
+
+#include <boost/utility.hpp>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+/**
+ * State of a running benchmark.
+ *
+ * A benchmark runs its measured code while KeepRunning() returns true:
+ *
+ *   TIBEE_BENCHMARK(MyBenchmark)
+ *   {
+ *       Setup();
+ *       while (state->KeepRunning())
+ *           MeasuredCode();
+ *   }
+ *
+ * @author Francois Doray
+ */
+class BenchmarkState :
+    boost::noncopyable
+{
+public:
+    explicit BenchmarkState(uint64_t maxIterations);
+
+    bool KeepRunning()
+    {
+        if (_iterations == _maxIterations || !_error.empty()) {
+            PauseTiming();
+            return false;
+        }
+        if (_iterations == 0)
+            ResumeTiming();
+        ++_iterations;
+        return true;
+    }
+
+    // Excludes the code executed between PauseTiming() and ResumeTiming()
+    // from the measurement.
+    void PauseTiming();
+    void ResumeTiming();
+
+    // Sets the number of items (e.g. events) processed by the benchmark,
+    // used to compute a throughput. Defaults to the number of iterations.
+    void SetItemsProcessed(uint64_t items) { _itemsProcessed = items; }
+
+    // Reports that the benchmark cannot run (e.g. missing input). The
+    // benchmark should return right away; it is left out of the results.
+    void SkipWithError(const std::string& message);
+
+    bool error() const { return !_error.empty(); }
+    const std::string& errorMessage() const { return _error; }
+
+    uint64_t iterations() const { return _iterations; }
+    uint64_t itemsProcessed() const { return _itemsProcessed; }
+    uint64_t elapsedNs() const { return _elapsedNs; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    uint64_t _maxIterations;
+    uint64_t _iterations;
+    uint64_t _itemsProcessed;
+
+    bool _timing;
+    Clock::time_point _start;
+    uint64_t _elapsedNs;
+
+    std::string _error;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState* state);
+
+/**
+ * Registers a benchmark. Use the TIBEE_BENCHMARK macro instead.
+ *
+ * @param name Name of the benchmark.
+ * @param function Function that runs the benchmark.
+ * @returns true.
+ */
+bool RegisterBenchmark(const char* name, BenchmarkFunction function);
+
+// Result of a benchmark.
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t iterations;
+    uint64_t elapsedNs;
+    uint64_t itemsProcessed;
+};
+
+/**
+ * Runs the registered benchmarks whose name matches a regex. Each
+ * benchmark runs with an increasing number of iterations until it
+ * lasts at least |minSeconds|. A benchmark that skips with an error,
+ * or that never calls KeepRunning(), is reported as failed and is not
+ * retried.
+ *
+ * @param filter Regex that matches the benchmarks to run.
+ * @param minSeconds Minimum duration of a measurement.
+ * @param results Receives the results of the successful benchmarks.
+ * @returns The number of failed benchmarks.
+ */
+size_t RunBenchmarks(const std::string& filter,
+                     double minSeconds,
+                     std::vector<BenchmarkResult>* results);
+
+/**
+ * Sets the directory against which DataPath() resolves relative paths.
+ *
+ * @param dataDir Directory that contains test_data.
+ */
+void SetDataDir(const std::string& dataDir);
+
+/**
+ * Resolves the path of a benchmark input (e.g. a trace of test_data).
+ *
+ * @param relativePath Path relative to the data directory.
+ * @returns The resolved path.
+ */
+std::string DataPath(const std::string& relativePath);
+
+/**
+ * Converts benchmark results to a value that can be written as JSON.
+ *
+ * @param results Benchmark results.
+ * @returns Value describing the results.
+ */
+value::Value::UP ResultsToValue(const std::vector<BenchmarkResult>& results);
+
+}
+}
+
+#define TIBEE_BENCHMARK(name) \
+    void name(::tibee::bench::BenchmarkState* state); \
+    const bool name##Registered = \
+        ::tibee::bench::RegisterBenchmark(#name, &name); \
+    void name(::tibee::bench::BenchmarkState* state)
+
+#endif // _TIBEE_BENCH_BENCHMARK_HPP
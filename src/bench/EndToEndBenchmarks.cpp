@@ -0,0 +1,199 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+#include <map>
+#include <string>
+
+#include "bench/Benchmark.hpp"
+#include "block/BlockRunner.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "state_blocks/TimeSlicedRunner.hpp"
+#include "trace/TraceSet.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+#include "trace_gen/KernelTraceGenerator.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+uint64_t CountEvents(const std::string& tracePath)
+{
+    trace::TraceSet traceSet;
+    if (!traceSet.addTrace(tracePath))
+        return 0;
+
+    uint64_t numEvents = 0;
+    auto it = traceSet.begin();
+    auto end = traceSet.end();
+    for (; it != end; ++it)
+        ++numEvents;
+    return numEvents;
+}
+
+// Runs the trace block alone, or followed by the blocks that build the
+// current state of a Linux system.
+void RunTrace(BenchmarkState* state, const std::string& tracePath, bool buildState)
+{
+    uint64_t numEvents = CountEvents(tracePath);
+    if (numEvents == 0) {
+        state->SkipWithError("cannot read events from " + tracePath);
+        return;
+    }
+
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>(tracePath);
+    traceParams.AddField("traces", std::move(traceList));
+
+    while (state->KeepRunning()) {
+        trace_blocks::TraceBlock traceBlock;
+        state_blocks::CurrentStateBlock currentStateBlock;
+        state_blocks::LinuxSchedStateBlock linuxBlock;
+
+        block::BlockRunner blockRunner;
+        blockRunner.AddBlock(&traceBlock, &traceParams);
+        if (buildState) {
+            blockRunner.AddBlock(&currentStateBlock, nullptr);
+            blockRunner.AddBlock(&linuxBlock, nullptr);
+        }
+        blockRunner.Run();
+    }
+
+    state->SetItemsProcessed(numEvents * state->iterations());
+}
+
+// Builds the current state of a Linux system over time slices of the
+// trace analyzed in parallel.
+void RunTraceSliced(BenchmarkState* state, const std::string& tracePath, size_t numSlices)
+{
+    uint64_t numEvents = CountEvents(tracePath);
+    if (numEvents == 0) {
+        state->SkipWithError("cannot read events from " + tracePath);
+        return;
+    }
+
+    while (state->KeepRunning()) {
+        state_blocks::TimeSlicedRunner runner(
+            {tracePath}, numSlices, [] (size_t slice) {
+                state_blocks::TimeSlicedRunner::Blocks blocks;
+                blocks.push_back(block::BlockInterface::UP {
+                    new state_blocks::LinuxSchedStateBlock});
+                return blocks;
+            });
+        runner.Run();
+    }
+
+    state->SetItemsProcessed(numEvents * state->iterations());
+}
+
+// Generates, once per process, a synthetic trace of one second with the
+// given number of CPUs. Returns its path.
+const char* GetSyntheticTrace(uint32_t numCpus)
+{
+    static std::map<uint32_t, std::string> paths;
+
+    auto look = paths.find(numCpus);
+    if (look != paths.end())
+        return look->second.c_str();
+
+    auto path = boost::filesystem::temp_directory_path() /
+        ("tibee-bench-synthetic-" + std::to_string(numCpus));
+
+    trace_gen::KernelTraceConfig config;
+    config.numCpus = numCpus;
+    config.numThreads = 8 * numCpus;
+    if (!trace_gen::GenerateKernelTrace(config, path, nullptr))
+        return "";
+
+    return (paths[numCpus] = path.string()).c_str();
+}
+
+}  // namespace
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_kernel_a)
+{
+    RunTrace(state, DataPath("test_data/kernel_a/kernel"), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_kernel_a)
+{
+    RunTrace(state, DataPath("test_data/kernel_a/kernel"), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_kernel_sched_switch)
+{
+    RunTrace(state, DataPath("test_data/kernel_sched_switch/kernel"), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_kernel_sched_switch)
+{
+    RunTrace(state, DataPath("test_data/kernel_sched_switch/kernel"), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_wktasks_a)
+{
+    RunTrace(state, DataPath("test_data/wktasks_a/kernel"), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_wktasks_a)
+{
+    RunTrace(state, DataPath("test_data/wktasks_a/kernel"), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_wktasks_b)
+{
+    RunTrace(state, DataPath("test_data/wktasks_b/kernel"), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_wktasks_b)
+{
+    RunTrace(state, DataPath("test_data/wktasks_b/kernel"), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_synthetic_4cpus)
+{
+    RunTrace(state, GetSyntheticTrace(4), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_synthetic_4cpus)
+{
+    RunTrace(state, GetSyntheticTrace(4), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TraceBlock_synthetic_16cpus)
+{
+    RunTrace(state, GetSyntheticTrace(16), false);
+}
+
+TIBEE_BENCHMARK(EndToEnd_LinuxSchedState_synthetic_16cpus)
+{
+    RunTrace(state, GetSyntheticTrace(16), true);
+}
+
+TIBEE_BENCHMARK(EndToEnd_TimeSliced4_synthetic_16cpus)
+{
+    RunTraceSliced(state, GetSyntheticTrace(16), 4);
+}
+
+}  // namespace bench
+}  // namespace tibee
@@ -0,0 +1,251 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+
+#include "bench/Benchmark.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "notification/NotificationSink.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+using notification::AnyToken;
+using notification::NotificationCenter;
+using notification::Path;
+using notification::Token;
+
+const size_t kNumObservedEvents = 32;
+
+// Adds observers similar to those of the state blocks.
+void AddKernelObservers(NotificationCenter* notificationCenter, size_t* counter)
+{
+    auto callback = [counter] (const Path& path, const value::Value* value) {
+        ++*counter;
+    };
+
+    for (size_t i = 0; i < kNumObservedEvents; ++i) {
+        notificationCenter->AddObserver(
+            {Token("event"), Token("lttng-kernel"), Token("event" + std::to_string(i))},
+            callback);
+    }
+    notificationCenter->AddObserver(
+        {Token("event"), Token("lttng-kernel"), Token("^syscall_entry_")},
+        callback);
+}
+
+void PostNotification(BenchmarkState* state, size_t numObservers)
+{
+    NotificationCenter notificationCenter;
+    size_t counter = 0;
+
+    Path path {Token("event"), Token("lttng-kernel"), Token("sched_switch")};
+    for (size_t i = 0; i < numObservers; ++i) {
+        notificationCenter.AddObserver(path,
+            [&counter] (const Path& path, const value::Value* value) {
+                ++counter;
+            });
+    }
+
+    auto sink = notificationCenter.GetSink(path);
+    value::IntValue value {42};
+
+    while (state->KeepRunning())
+        sink->PostNotification(&value);
+}
+
+struct Counter
+{
+    Counter() : count(0) {}
+
+    void onNotification(const Path& path, const value::Value* value)
+    {
+        ++count;
+    }
+
+    size_t count;
+};
+
+void PostNotificationBound(BenchmarkState* state, size_t numObservers)
+{
+    NotificationCenter notificationCenter;
+    Counter counter;
+
+    Path path {Token("event"), Token("lttng-kernel"), Token("sched_switch")};
+    for (size_t i = 0; i < numObservers; ++i) {
+        notificationCenter.AddObserver(path,
+            notification::Callback::Bind<Counter, &Counter::onNotification>(&counter));
+    }
+
+    auto sink = notificationCenter.GetSink(path);
+    value::IntValue value {42};
+
+    while (state->KeepRunning())
+        sink->PostNotification(&value);
+}
+
+// Sums a field of the notifications, one notification or one batch at a
+// time.
+void SumField(BenchmarkState* state, bool batch)
+{
+    NotificationCenter notificationCenter;
+    int64_t sum = 0;
+
+    Path path {Token("event"), Token("lttng-kernel"), Token("kmem_kmalloc")};
+    if (batch) {
+        notificationCenter.AddBatchObserver({path}, {{"size"}},
+            [&sum] (const notification::NotificationBatch& batch) {
+                const int64_t* sizes = batch.column(0);
+                for (size_t i = 0; i < batch.size(); ++i)
+                    sum += sizes[i];
+            });
+    } else {
+        notificationCenter.AddObserver(path,
+            [&sum] (const Path& path, const value::Value* value) {
+                int64_t size = 0;
+                const value::Value* field = value->GetField("size");
+                if (field != nullptr && field->AsLong(&size))
+                    sum += size;
+            });
+    }
+
+    auto sink = notificationCenter.GetSink(path);
+    value::StructValue value;
+    value.AddField<value::LongValue>("size", 64);
+
+    while (state->KeepRunning())
+        sink->PostNotification(&value);
+    notificationCenter.FlushBatches();
+}
+
+// Notifies observers that each watch one thread, by returning early from
+// the callbacks or with predicates.
+void FilterTid(BenchmarkState* state, bool predicates)
+{
+    const size_t kNumObservers = 8;
+    NotificationCenter notificationCenter;
+    size_t counter = 0;
+
+    Path path {Token("event"), Token("lttng-kernel"), Token("sched_switch")};
+    for (size_t i = 0; i < kNumObservers; ++i) {
+        int64_t tid = 100 + i;
+        if (predicates) {
+            notificationCenter.AddObserver(path,
+                [&counter] (const Path& path, const value::Value* value) {
+                    ++counter;
+                },
+                {notification::FieldPredicate::Equal({"prev_tid"}, tid)});
+        } else {
+            notificationCenter.AddObserver(path,
+                [&counter, tid] (const Path& path, const value::Value* value) {
+                    int64_t prevTid = 0;
+                    const value::Value* field = value->GetField("prev_tid");
+                    if (field == nullptr || !field->AsLong(&prevTid) || prevTid != tid)
+                        return;
+                    ++counter;
+                });
+        }
+    }
+
+    auto sink = notificationCenter.GetSink(path);
+    value::StructValue value;
+    value.AddField<value::IntValue>("prev_tid", 100);
+
+    while (state->KeepRunning())
+        sink->PostNotification(&value);
+}
+
+}  // namespace
+
+TIBEE_BENCHMARK(NotificationCenter_GetSinkExisting)
+{
+    NotificationCenter notificationCenter;
+    size_t counter = 0;
+    AddKernelObservers(&notificationCenter, &counter);
+
+    Path path {Token("event"), Token("lttng-kernel"), Token("event7")};
+    notificationCenter.GetSink(path);
+
+    while (state->KeepRunning())
+        notificationCenter.GetSink(path);
+}
+
+TIBEE_BENCHMARK(NotificationCenter_GetSinkNew)
+{
+    NotificationCenter notificationCenter;
+    size_t counter = 0;
+    AddKernelObservers(&notificationCenter, &counter);
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        state->PauseTiming();
+        Path path {Token("event"), Token("lttng-kernel"),
+                   Token("syscall_entry_" + std::to_string(i++))};
+        state->ResumeTiming();
+
+        notificationCenter.GetSink(path);
+    }
+}
+
+TIBEE_BENCHMARK(NotificationSink_PostNotification0)
+{
+    PostNotification(state, 0);
+}
+
+TIBEE_BENCHMARK(NotificationSink_PostNotification1)
+{
+    PostNotification(state, 1);
+}
+
+TIBEE_BENCHMARK(NotificationSink_PostNotification8)
+{
+    PostNotification(state, 8);
+}
+
+TIBEE_BENCHMARK(NotificationSink_PostNotificationBound8)
+{
+    PostNotificationBound(state, 8);
+}
+
+TIBEE_BENCHMARK(NotificationSink_SumField)
+{
+    SumField(state, false);
+}
+
+TIBEE_BENCHMARK(NotificationSink_SumFieldBatch)
+{
+    SumField(state, true);
+}
+
+TIBEE_BENCHMARK(NotificationSink_FilterTid)
+{
+    FilterTid(state, false);
+}
+
+TIBEE_BENCHMARK(NotificationSink_FilterTidPredicates)
+{
+    FilterTid(state, true);
+}
+
+}  // namespace bench
+}  // namespace tibee
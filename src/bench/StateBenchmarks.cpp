@@ -0,0 +1,177 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+
+#include "bench/Benchmark.hpp"
+#include "keyed_tree/KeyedTree.hpp"
+#include "quark/StringQuarkDatabase.hpp"
+#include "state/CurrentState.hpp"
+#include "value/MakeValue.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+const size_t kNumThreads = 1024;
+const size_t kNumStrings = 1024;
+
+}  // namespace
+
+TIBEE_BENCHMARK(CurrentState_SetAttribute)
+{
+    quark::StringQuarkDatabase quarks;
+    state::CurrentState currentState(
+        [] (state::AttributeKey attribute, const value::ValueRef& value) {},
+        &quarks);
+
+    std::vector<state::AttributeKey> keys;
+    for (size_t i = 0; i < kNumThreads; ++i) {
+        keys.push_back(currentState.GetAttributeKeyStr(
+            {"linux", "threads", std::to_string(i), "status"}));
+    }
+    quark::Quark statuses[] = {
+        currentState.Quark("run-usermode"),
+        currentState.Quark("wait-blocked"),
+        currentState.Quark("run-syscall"),
+    };
+
+    // Cycle through the statuses so that every call changes the value.
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        currentState.SetTimestamp(i);
+        currentState.SetAttribute(keys[i % kNumThreads],
+                                  value::MakeValue(statuses[(i / kNumThreads) % 3]));
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(CurrentState_SetAttributeInterned)
+{
+    quark::StringQuarkDatabase quarks;
+    state::CurrentState currentState(
+        [] (state::AttributeKey attribute, const value::ValueRef& value) {},
+        &quarks);
+
+    std::vector<state::AttributeKey> keys;
+    for (size_t i = 0; i < kNumThreads; ++i) {
+        keys.push_back(currentState.GetAttributeKeyStr(
+            {"linux", "threads", std::to_string(i), "status"}));
+    }
+    value::ValueRef statuses[] = {
+        currentState.Intern(currentState.Quark("run-usermode")),
+        currentState.Intern(currentState.Quark("wait-blocked")),
+        currentState.Intern(currentState.Quark("run-syscall")),
+    };
+
+    // Same as CurrentState_SetAttribute, but the values are shared.
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        currentState.SetTimestamp(i);
+        currentState.SetAttribute(keys[i % kNumThreads],
+                                  statuses[(i / kNumThreads) % 3]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(CurrentState_GetAttributeValue)
+{
+    quark::StringQuarkDatabase quarks;
+    state::CurrentState currentState(nullptr, &quarks);
+
+    auto threads = currentState.GetAttributeKeyStr({"linux", "threads"});
+    auto status = currentState.Quark("status");
+    for (size_t i = 0; i < kNumThreads; ++i) {
+        currentState.SetAttribute(threads, {currentState.IntQuark(i), status},
+                                  value::MakeValue(static_cast<uint32_t>(i)));
+    }
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        currentState.GetAttributeValue(
+            threads, {currentState.IntQuark(i % kNumThreads), status});
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(KeyedTree_CreateNodeKey)
+{
+    keyed_tree::KeyedTree<quark::Quark> tree;
+
+    std::vector<keyed_tree::KeyedTree<quark::Quark>::Path> paths;
+    for (size_t i = 0; i < kNumThreads; ++i) {
+        paths.push_back({quark::Quark(1), quark::Quark(2),
+                         quark::Quark(100 + i), quark::Quark(3)});
+    }
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        tree.CreateNodeKey(paths[i % kNumThreads]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StringQuarkDatabase_StrQuark)
+{
+    quark::StringQuarkDatabase quarks;
+
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < kNumStrings; ++i) {
+        strings.push_back("syscall_entry_" + std::to_string(i));
+        quarks.StrQuark(strings.back());
+    }
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        quarks.StrQuark(strings[i % kNumStrings]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StringQuarkDatabase_IntQuark)
+{
+    quark::StringQuarkDatabase quarks;
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        quarks.IntQuark(i % 32768);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StringQuarkDatabase_String)
+{
+    quark::StringQuarkDatabase quarks;
+
+    std::vector<quark::Quark> quarkList;
+    for (size_t i = 0; i < kNumStrings; ++i)
+        quarkList.push_back(quarks.StrQuark("syscall_entry_" + std::to_string(i)));
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        quarks.String(quarkList[i % kNumStrings]);
+        ++i;
+    }
+}
+
+}  // namespace bench
+}  // namespace tibee
@@ -0,0 +1,85 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include <string>
+
+#include "bench/Benchmark.hpp"
+#include "trace/TraceSet.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+const char kKernelTrace[] = "test_data/kernel_a/kernel";
+
+}  // namespace
+
+TIBEE_BENCHMARK(TraceSetIterator_Traversal)
+{
+    const std::string tracePath = DataPath(kKernelTrace);
+    trace::TraceSet traceSet;
+    if (!traceSet.addTrace(tracePath)) {
+        state->SkipWithError("cannot open " + tracePath);
+        return;
+    }
+
+    uint64_t numEvents = 0;
+    while (state->KeepRunning()) {
+        auto it = traceSet.begin();
+        auto end = traceSet.end();
+        for (; it != end; ++it) {
+            // Force the decoding of the timestamp.
+            (*it).getTimestamp();
+            ++numEvents;
+        }
+    }
+    state->SetItemsProcessed(numEvents);
+}
+
+TIBEE_BENCHMARK(StructEventValue_GetField)
+{
+    const std::string tracePath = DataPath(kKernelTrace);
+    trace::TraceSet traceSet;
+    if (!traceSet.addTrace(tracePath)) {
+        state->SkipWithError("cannot open " + tracePath);
+        return;
+    }
+
+    // The event remains valid as long as the iterator does not move.
+    auto it = traceSet.begin();
+    auto end = traceSet.end();
+    for (; it != end; ++it) {
+        if (std::strcmp((*it).getName(), "sched_switch") == 0)
+            break;
+    }
+    if (it == end) {
+        state->SkipWithError("no sched_switch event in " + tracePath);
+        return;
+    }
+
+    const value::Value* fields = (*it).getFields();
+    while (state->KeepRunning())
+        fields->GetField("next_tid");
+}
+
+}  // namespace bench
+}  // namespace tibee
@@ -0,0 +1,214 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench/Benchmark.hpp"
+#include "value/Arena.hpp"
+#include "value/Binary.hpp"
+#include "value/Utils.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace bench
+{
+
+namespace
+{
+
+const size_t kNumFields = 256;
+
+const char* kEventFields[] = {
+    "prev_comm", "prev_tid", "prev_prio", "prev_state",
+    "next_comm", "next_tid", "next_prio",
+};
+const size_t kNumEventFields = sizeof(kEventFields) / sizeof(kEventFields[0]);
+
+value::StructValue::UP MakeEventStruct()
+{
+    value::StructValue::UP fields {new value::StructValue};
+    for (size_t i = 0; i < kNumEventFields; ++i)
+        fields->AddField<value::ULongValue>(kEventFields[i], i);
+    return fields;
+}
+
+value::StructValue::UP MakeReport()
+{
+    value::StructValue::UP threads {new value::StructValue};
+    for (size_t tid = 0; tid < kNumFields; ++tid) {
+        value::StructValue::UP thread {new value::StructValue};
+        thread->AddField<value::StringValue>("name", "thread-" + std::to_string(tid));
+        thread->AddField<value::ULongValue>("count", tid);
+        thread->AddField<value::ULongValue>("total", tid * 1000000);
+        threads->AddField(std::to_string(tid), std::move(thread));
+    }
+    return threads;
+}
+
+}  // namespace
+
+// Same shape as the notifications posted by CurrentStateBlock.
+TIBEE_BENCHMARK(StructValue_Build)
+{
+    const value::StructValue::Key keyField("k");
+    const value::StructValue::Key valueField("v");
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        value::StructValue notification;
+        notification.AddField<value::UIntValue>(keyField, i);
+        notification.AddField<value::UIntValue>(valueField, i);
+        ++i;
+    }
+}
+
+// Builds and destroys a report with one struct per thread.
+TIBEE_BENCHMARK(StructValue_BuildReport)
+{
+    while (state->KeepRunning()) {
+        value::StructValue threads;
+        for (size_t tid = 0; tid < kNumFields; ++tid) {
+            value::StructValue::UP thread {new value::StructValue};
+            thread->AddField<value::ULongValue>("count", tid);
+            thread->AddField<value::ULongValue>("total", tid);
+            threads.AddField(std::to_string(tid), std::move(thread));
+        }
+    }
+    state->SetItemsProcessed(state->iterations() * kNumFields);
+}
+
+TIBEE_BENCHMARK(StructValue_BuildReportArena)
+{
+    while (state->KeepRunning()) {
+        value::Arena arena;
+        value::StructValue threads(&arena);
+        for (size_t tid = 0; tid < kNumFields; ++tid) {
+            auto thread = value::NewValue<value::StructValue>(&arena, &arena);
+            thread->AddField<value::ULongValue>("count", tid);
+            thread->AddField<value::ULongValue>("total", tid);
+            threads.AddField(std::to_string(tid), std::move(thread));
+        }
+    }
+    state->SetItemsProcessed(state->iterations() * kNumFields);
+}
+
+TIBEE_BENCHMARK(StructValue_GetField)
+{
+    auto fields = MakeEventStruct();
+    std::vector<std::string> names(kEventFields, kEventFields + kNumEventFields);
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        fields->GetField(names[i % kNumEventFields]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StructValue_GetFieldKey)
+{
+    auto fields = MakeEventStruct();
+    std::vector<value::StructValue::Key> keys;
+    for (size_t i = 0; i < kNumEventFields; ++i)
+        keys.emplace_back(kEventFields[i]);
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        fields->GetField(keys[i % kNumEventFields]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StructValue_GetFieldLarge)
+{
+    value::StructValue fields;
+    std::vector<value::StructValue::Key> keys;
+    for (size_t i = 0; i < kNumFields; ++i) {
+        keys.emplace_back(std::to_string(i));
+        fields.AddField<value::ULongValue>(keys.back(), i);
+    }
+
+    uint64_t i = 0;
+    while (state->KeepRunning()) {
+        fields.GetField(keys[i % kNumFields]);
+        ++i;
+    }
+}
+
+TIBEE_BENCHMARK(StructValue_Iterate)
+{
+    auto fields = MakeEventStruct();
+
+    uint64_t items = 0;
+    while (state->KeepRunning()) {
+        for (auto it = fields->fields_begin(); it != fields->fields_end(); ++it)
+            ++items;
+    }
+    state->SetItemsProcessed(items);
+}
+
+TIBEE_BENCHMARK(Value_ToJson)
+{
+    auto report = MakeReport();
+
+    uint64_t bytes = 0;
+    while (state->KeepRunning())
+        bytes += value::ToJson(report.get()).size();
+    state->SetItemsProcessed(bytes);
+}
+
+TIBEE_BENCHMARK(Value_BinaryWrite)
+{
+    auto report = MakeReport();
+    std::stringstream out;
+    value::BinaryWriter writer(&out);
+
+    while (state->KeepRunning()) {
+        writer.Write(report.get());
+        if (out.tellp() > (1 << 24)) {
+            out.str(std::string());
+            out.clear();
+        }
+    }
+    state->SetItemsProcessed(writer.bytes_written());
+}
+
+TIBEE_BENCHMARK(Value_BinaryRead)
+{
+    auto report = MakeReport();
+    std::stringstream out;
+    {
+        value::BinaryWriter writer(&out);
+        writer.Write(report.get());
+    }
+    std::string data = out.str();
+
+    uint64_t bytes = 0;
+    while (state->KeepRunning()) {
+        value::Arena arena;
+        value::BinaryReader reader(data.data(), data.size(), &arena);
+        value::ArenaPtr<value::Value> value;
+        reader.Read(&value);
+        bytes += data.size();
+    }
+    state->SetItemsProcessed(bytes);
+}
+
+}  // namespace bench
+}  // namespace tibee
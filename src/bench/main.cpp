@@ -0,0 +1,141 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/print.hpp"
+#include "bench/Benchmark.hpp"
+#include "value/Utils.hpp"
+
+namespace
+{
+
+const char kFilterFlag[] = "--filter=";
+const char kMinTimeFlag[] = "--min-time=";
+const char kJsonFlag[] = "--json=";
+const char kDataDirFlag[] = "--data-dir=";
+const char kTestDataDir[] = "test_data";
+
+bool StartsWith(const char* str, const char* prefix)
+{
+    return std::strncmp(str, prefix, std::strlen(prefix)) == 0;
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program
+              << " [--filter=<regex>] [--min-time=<seconds>] [--json=<file>]"
+              << " [--data-dir=<dir>]"
+              << std::endl
+              << "Writes the results as JSON to <file>, or to the standard "
+              << "output when no file is given." << std::endl
+              << "Reads the traces of test_data from <dir>, which defaults to "
+              << "the closest ancestor of the program that contains test_data."
+              << std::endl;
+}
+
+// Finds the closest ancestor of the program's directory that contains
+// test_data, so that the benchmarks don't depend on the working directory.
+std::string FindDataDir(const char* program)
+{
+    namespace bfs = boost::filesystem;
+
+    boost::system::error_code ec;
+    bfs::path dir = bfs::canonical(bfs::system_complete(program), ec).parent_path();
+    if (ec)
+        return ".";
+
+    for (; !dir.empty(); dir = dir.parent_path()) {
+        if (bfs::is_directory(dir / kTestDataDir, ec))
+            return dir.string();
+        if (dir == dir.root_path())
+            break;
+    }
+    return ".";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    using namespace tibee;
+
+    std::string filter = ".*";
+    double minSeconds = 0.5;
+    std::string jsonPath;
+    std::string dataDir;
+
+    for (int i = 1; i < argc; ++i) {
+        if (StartsWith(argv[i], kFilterFlag)) {
+            filter = argv[i] + std::strlen(kFilterFlag);
+        } else if (StartsWith(argv[i], kMinTimeFlag)) {
+            minSeconds = std::atof(argv[i] + std::strlen(kMinTimeFlag));
+        } else if (StartsWith(argv[i], kJsonFlag)) {
+            jsonPath = argv[i] + std::strlen(kJsonFlag);
+        } else if (StartsWith(argv[i], kDataDirFlag)) {
+            dataDir = argv[i] + std::strlen(kDataDirFlag);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    bench::SetDataDir(dataDir.empty() ? FindDataDir(argv[0]) : dataDir);
+
+    std::vector<bench::BenchmarkResult> results;
+    size_t numFailed = bench::RunBenchmarks(filter, minSeconds, &results);
+
+    // Human-readable summary, kept out of the standard output so that it
+    // does not mix with the JSON report.
+    for (const auto& result : results) {
+        std::cerr << std::left << std::setw(48) << result.name
+                  << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(1)
+                  << static_cast<double>(result.elapsedNs) / result.iterations
+                  << " ns/iter" << std::setw(16)
+                  << result.itemsProcessed / (result.elapsedNs / 1e9)
+                  << " items/s" << std::endl;
+    }
+
+    auto report = bench::ResultsToValue(results);
+    std::string json = value::ToJson(report.get());
+
+    if (jsonPath.empty()) {
+        std::cout << json << std::endl;
+    } else {
+        std::ofstream out(jsonPath.c_str());
+        if (!out) {
+            base::tberror() << "cannot write " << jsonPath << base::tbendl() << std::endl;
+            return 1;
+        }
+        out << json << std::endl;
+    }
+
+    if (numFailed != 0) {
+        base::tberror() << numFailed << " benchmark(s) failed" << base::tbendl() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
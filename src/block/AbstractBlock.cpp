@@ -32,8 +32,6 @@ namespace
 using notification::AnyToken;
 using notification::Token;
 
-const size_t kTidPathIndex = 3;
-
 void OnEvent(
     const value::Value* event,
     AbstractBlock::EventHandler handler)
@@ -48,12 +46,14 @@ void OnThreadState(
     const value::Value* value,
     AbstractBlock::ThreadStateHandler handler)
 {
-    uint32_t tid = atoi(path[kTidPathIndex].token().c_str());
+    uint32_t tid = atoi(path[AbstractBlock::kTidPathIndex].token().c_str());
     handler(tid, path, value);
 }
 
 }  // namespace
 
+const size_t AbstractBlock::kTidPathIndex;
+
 AbstractBlock::AbstractBlock()
 {
 }
@@ -94,14 +94,8 @@ void AbstractBlock::AddKernelObserver(
 {
     namespace pl = std::placeholders;
 
-    notification::Path path {Token(kTraceNotificationPrefix),
-                             Token("lttng-kernel"),
-                             token};
-    notification::Callback func =
-        std::bind(&OnEvent,
-                  pl::_2,
-                  eventHandler);
-    notificationCenter->AddObserver(path, func);
+    notificationCenter->AddObserver(
+        KernelPath(token), std::bind(&OnEvent, pl::_2, eventHandler));
 }
 
 void AbstractBlock::AddUstObserver(
@@ -111,14 +105,8 @@ void AbstractBlock::AddUstObserver(
 {
     namespace pl = std::placeholders;
 
-    notification::Path path {Token(kTraceNotificationPrefix),
-                             Token("lttng-ust"),
-                             token};
-    notification::Callback func =
-        std::bind(&OnEvent,
-                  pl::_2,
-                  eventHandler);
-    notificationCenter->AddObserver(path, func);
+    notificationCenter->AddObserver(
+        UstPath(token), std::bind(&OnEvent, pl::_2, eventHandler));
 }
 
 void AbstractBlock::AddThreadStateObserver(
@@ -128,19 +116,37 @@ void AbstractBlock::AddThreadStateObserver(
 {
     namespace pl = std::placeholders;
 
-    notification::Path path {Token(kCurrentStateNotificationPrefix),
-                             Token(kStateLinux),
-                             Token(kStateThreads),
-                             AnyToken(),
-                             token};
-    notification::Callback func =
-        std::bind(&OnThreadState,
-                  pl::_1,
-                  pl::_2,
-                  threadStateHandler);
-    notificationCenter->AddObserver(path, func);
+    notificationCenter->AddObserver(
+        ThreadStatePath(token),
+        std::bind(&OnThreadState, pl::_1, pl::_2, threadStateHandler));
+}
+
+notification::Path AbstractBlock::KernelPath(const notification::Token& token)
+{
+    return {Token(kTraceNotificationPrefix), Token("lttng-kernel"), token};
+}
+
+notification::Path AbstractBlock::UstPath(const notification::Token& token)
+{
+    return {Token(kTraceNotificationPrefix), Token("lttng-ust"), token};
 }
 
+notification::Path AbstractBlock::ThreadStatePath(const notification::Token& token)
+{
+    return {Token(kCurrentStateNotificationPrefix),
+            Token(kStateLinux),
+            Token(kStateThreads),
+            AnyToken(),
+            token};
+}
+
+void AbstractBlock::AddObserver(
+    notification::NotificationCenter* notificationCenter,
+    const notification::Path& path,
+    const notification::Callback& callback)
+{
+    notificationCenter->AddObserver(path, callback);
+}
 
 }  // namespace block
 }  // namespace tibee
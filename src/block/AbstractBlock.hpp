@@ -18,8 +18,13 @@
 #ifndef _TIBEE_BLOCK_ABSTRACTBLOCK_HPP
 #define _TIBEE_BLOCK_ABSTRACTBLOCK_HPP
 
+#include <stdint.h>
+#include <stdlib.h>
+
 #include "block/BlockInterface.hpp"
+#include "notification/Callback.hpp"
 #include "notification/Path.hpp"
+#include "notification/Token.hpp"
 #include "trace/value/EventValue.hpp"
 
 namespace tibee
@@ -50,6 +55,9 @@ public:
     typedef std::function<void (const trace::EventValue&)> EventHandler;
     typedef std::function<void (uint32_t tid, const notification::Path& path, const value::Value* value)> ThreadStateHandler;
 
+    // Component of a thread state notification path that holds the thread ID.
+    static const size_t kTidPathIndex = 3;
+
 protected:
     void AddKernelObserver(notification::NotificationCenter* notificationCenter,
                            const notification::Token& token,
@@ -62,6 +70,63 @@ protected:
                                 const notification::Token& token,
                                 ThreadStateHandler threadStateHandler);
 
+    // Typed observers. |Handler| is a method of the block, called directly
+    // by the thunk of the callback rather than through std::function and
+    // std::bind. Usage:
+    //   AddKernelObserver<MyBlock, &MyBlock::onSchedSwitch>(
+    //       notificationCenter, Token("sched_switch"), this);
+    // @{
+    template<class B, void (B::*Handler)(const trace::EventValue& event)>
+    void AddKernelObserver(notification::NotificationCenter* notificationCenter,
+                           const notification::Token& token,
+                           B* block)
+    {
+        AddObserver(notificationCenter, KernelPath(token),
+                    notification::Callback(&EventThunk<B, Handler>, block));
+    }
+
+    template<class B, void (B::*Handler)(const trace::EventValue& event)>
+    void AddUstObserver(notification::NotificationCenter* notificationCenter,
+                        const notification::Token& token,
+                        B* block)
+    {
+        AddObserver(notificationCenter, UstPath(token),
+                    notification::Callback(&EventThunk<B, Handler>, block));
+    }
+
+    template<class B, void (B::*Handler)(uint32_t tid, const notification::Path& path, const value::Value* value)>
+    void AddThreadStateObserver(notification::NotificationCenter* notificationCenter,
+                                const notification::Token& token,
+                                B* block)
+    {
+        AddObserver(notificationCenter, ThreadStatePath(token),
+                    notification::Callback(&ThreadStateThunk<B, Handler>, block));
+    }
+    // @}
+
+private:
+    static notification::Path KernelPath(const notification::Token& token);
+    static notification::Path UstPath(const notification::Token& token);
+    static notification::Path ThreadStatePath(const notification::Token& token);
+
+    static void AddObserver(notification::NotificationCenter* notificationCenter,
+                            const notification::Path& path,
+                            const notification::Callback& callback);
+
+    template<class B, void (B::*Handler)(const trace::EventValue& event)>
+    static void EventThunk(void* block, const notification::Path& path, const value::Value* value)
+    {
+        if (value == nullptr)
+            return;
+        (static_cast<B*>(block)->*Handler)(*static_cast<const trace::EventValue*>(value));
+    }
+
+    template<class B, void (B::*Handler)(uint32_t tid, const notification::Path& path, const value::Value* value)>
+    static void ThreadStateThunk(void* block, const notification::Path& path, const value::Value* value)
+    {
+        uint32_t tid = atoi(path[kTidPathIndex].token().c_str());
+        (static_cast<B*>(block)->*Handler)(tid, path, value);
+    }
 };
 
 }
@@ -17,15 +17,69 @@
  */
 #include "block/BlockRunner.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cxxabi.h>
+#include <stdlib.h>
+#include <typeinfo>
+
 #include "block/ServiceList.hpp"
 #include "notification/NotificationCenter.hpp"
+#include "value/Utils.hpp"
 
 namespace tibee
 {
 namespace block
 {
 
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+const char* kPhaseNames[] = {
+    "start",
+    "register-services",
+    "load-services",
+    "add-observers",
+    "get-notification-sinks",
+    "execute",
+    "stop",
+};
+
+std::string GetTypeName(const BlockInterface* block)
+{
+    const char* mangledName = typeid(*block).name();
+
+    int status = 0;
+    char* demangledName = abi::__cxa_demangle(mangledName, nullptr, nullptr, &status);
+    if (status != 0 || demangledName == nullptr)
+        return mangledName;
+
+    std::string name(demangledName);
+    free(demangledName);
+    return name;
+}
+
+value::Value::UP LatencyToValue(const notification::LatencyStats& latency)
+{
+    value::StructValue::UP value {new value::StructValue};
+    value->AddField<value::ULongValue>("count", latency.count);
+    value->AddField<value::ULongValue>("total-ns", latency.totalNs);
+    value->AddField<value::ULongValue>("max-ns", latency.maxNs);
+    return std::move(value);
+}
+
+template <typename T>
+bool CompareTotalNs(const T& a, const T& b)
+{
+    return a.latency.totalNs > b.latency.totalNs;
+}
+
+}  // namespace
+
 BlockRunner::BlockRunner()
+    : _profilingOutput(nullptr)
 {
 }
 
@@ -36,7 +90,30 @@ BlockRunner::~BlockRunner()
 void BlockRunner::AddBlock(BlockInterface* block,
                            const value::Value* parameters)
 {
-    _blocks.push_back(std::make_pair(block, parameters));
+    AddBlock(block, parameters, GetTypeName(block));
+}
+
+void BlockRunner::AddBlock(BlockInterface* block,
+                           const value::Value* parameters,
+                           const std::string& name)
+{
+    BlockInfo blockInfo;
+    blockInfo.block = block;
+    blockInfo.parameters = parameters;
+    blockInfo.name = name;
+
+    // The name owns the observers of the block in the profiling report,
+    // so a repeated name gets the index of the block appended.
+    auto sameName = [&](const BlockInfo& other) { return other.name == name; };
+    if (std::any_of(_blocks.begin(), _blocks.end(), sameName))
+        blockInfo.name += "#" + std::to_string(_blocks.size());
+    std::fill(blockInfo.phaseNs, blockInfo.phaseNs + kNumPhases, 0);
+    _blocks.push_back(blockInfo);
+}
+
+void BlockRunner::EnableProfiling(std::ostream* out)
+{
+    _profilingOutput = out;
 }
 
 void BlockRunner::Run()
@@ -44,13 +121,18 @@ void BlockRunner::Run()
     notification::NotificationCenter notificationCenter;
     block::ServiceList serviceList;
 
+    if (_profilingOutput != nullptr)
+        notificationCenter.EnableProfiling();
+
     // Notify the blocks that the execution will start.
-    for (auto& block : _blocks)
-        block.first->Start(block.second);
+    RunPhase(kStartPhase, [](BlockInfo* block) {
+        block->block->Start(block->parameters);
+    });
 
     // Ask the blocks to declare the services that they offer.
-    for (auto& block : _blocks)
-        block.first->RegisterServices(&serviceList);
+    RunPhase(kRegisterServicesPhase, [&](BlockInfo* block) {
+        block->block->RegisterServices(&serviceList);
+    });
 
     // Register the notification center.
     serviceList.AddService(
@@ -58,24 +140,133 @@ void BlockRunner::Run()
         &notificationCenter);
 
     // Let the blocks load services.
-    for (auto& block : _blocks)
-        block.first->LoadServices(serviceList);
+    RunPhase(kLoadServicesPhase, [&](BlockInfo* block) {
+        block->block->LoadServices(serviceList);
+    });
 
     // Ask the blocks to declare the notifications that they receive.
-    for (auto& block : _blocks)
-        block.first->AddObservers(&notificationCenter);
+    RunPhase(kAddObserversPhase, [&](BlockInfo* block) {
+        notificationCenter.SetObserverOwner(block->name);
+        notificationCenter.SetObserverPriority(notification::ObserverPriority::kAnalysis);
+        block->block->AddObservers(&notificationCenter);
+    });
 
     // Ask the blocks to declare the notifications that they produce.
-    for (auto& block : _blocks)
-        block.first->GetNotificationSinks(&notificationCenter);
+    RunPhase(kGetNotificationSinksPhase, [&](BlockInfo* block) {
+        block->block->GetNotificationSinks(&notificationCenter);
+    });
 
     // Execute the blocks.
-    for (auto& block : _blocks)
-        block.first->Execute();
+    RunPhase(kExecutePhase, [](BlockInfo* block) {
+        block->block->Execute();
+    });
 
     // Stop the execution of the blocks.
-    for (auto& block : _blocks)
-        block.first->Stop();
+    RunPhase(kStopPhase, [](BlockInfo* block) {
+        block->block->Stop();
+    });
+
+    if (_profilingOutput != nullptr) {
+        auto report = GetProfilingReport(notificationCenter);
+        *_profilingOutput << value::ToJson(report.get()) << std::endl;
+    }
+}
+
+void BlockRunner::RunPhase(Phase phase,
+                           const std::function<void (BlockInfo*)>& func)
+{
+    if (_profilingOutput == nullptr) {
+        for (auto& block : _blocks)
+            func(&block);
+        return;
+    }
+
+    for (auto& block : _blocks) {
+        auto start = Clock::now();
+        func(&block);
+        block.phaseNs[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count();
+    }
+}
+
+value::Value::UP BlockRunner::GetProfilingReport(
+    const notification::NotificationCenter& notificationCenter) const
+{
+    std::vector<notification::CallbackStats> callbackStats;
+    notificationCenter.GetCallbackStats(&callbackStats);
+    std::sort(callbackStats.begin(), callbackStats.end(),
+              CompareTotalNs<notification::CallbackStats>);
+
+    std::vector<notification::PathStats> pathStats;
+    notificationCenter.GetPathStats(&pathStats);
+    std::sort(pathStats.begin(), pathStats.end(),
+              CompareTotalNs<notification::PathStats>);
+
+    // Total time of each phase.
+    uint64_t totalPhaseNs[kNumPhases] = {};
+    for (const auto& block : _blocks) {
+        for (size_t phase = 0; phase < kNumPhases; ++phase)
+            totalPhaseNs[phase] += block.phaseNs[phase];
+    }
+
+    value::StructValue::UP report {new value::StructValue};
+
+    value::StructValue::UP phases {new value::StructValue};
+    for (size_t phase = 0; phase < kNumPhases; ++phase)
+        phases->AddField<value::ULongValue>(kPhaseNames[phase], totalPhaseNs[phase]);
+    report->AddField("phases-ns", std::move(phases));
+
+    // Notifications handled by the observers of each block, per second
+    // of execution.
+    double executeSeconds = totalPhaseNs[kExecutePhase] / 1e9;
+
+    value::ArrayValue::UP blocks {new value::ArrayValue};
+    for (const auto& block : _blocks) {
+        notification::LatencyStats latency;
+        for (const auto& stats : callbackStats) {
+            if (stats.owner != block.name)
+                continue;
+            latency.count += stats.latency.count;
+            latency.totalNs += stats.latency.totalNs;
+            latency.maxNs = std::max(latency.maxNs, stats.latency.maxNs);
+        }
+
+        value::StructValue::UP blockValue {new value::StructValue};
+        blockValue->AddField<value::StringValue>("name", block.name);
+
+        value::StructValue::UP blockPhases {new value::StructValue};
+        for (size_t phase = 0; phase < kNumPhases; ++phase)
+            blockPhases->AddField<value::ULongValue>(kPhaseNames[phase], block.phaseNs[phase]);
+        blockValue->AddField("phases-ns", std::move(blockPhases));
+
+        blockValue->AddField("observers", LatencyToValue(latency));
+        blockValue->AddField<value::DoubleValue>(
+            "notifications-per-second",
+            executeSeconds > 0 ? latency.count / executeSeconds : 0);
+        blocks->Append(std::move(blockValue));
+    }
+    report->AddField("blocks", std::move(blocks));
+
+    value::ArrayValue::UP observers {new value::ArrayValue};
+    for (const auto& stats : callbackStats) {
+        value::StructValue::UP observer {new value::StructValue};
+        observer->AddField<value::StringValue>("path", stats.path);
+        observer->AddField<value::StringValue>("owner", stats.owner);
+        observer->AddField("latency", LatencyToValue(stats.latency));
+        observers->Append(std::move(observer));
+    }
+    report->AddField("observers", std::move(observers));
+
+    value::ArrayValue::UP paths {new value::ArrayValue};
+    for (const auto& stats : pathStats) {
+        value::StructValue::UP path {new value::StructValue};
+        path->AddField<value::StringValue>("path", stats.path);
+        path->AddField("latency", LatencyToValue(stats.latency));
+        paths->Append(std::move(path));
+    }
+    report->AddField("paths", std::move(paths));
+
+    return std::move(report);
 }
 
 }
@@ -19,8 +19,12 @@
 #define _TIBEE_BLOCK_BLOCKRUNNER_HPP
 
 #include <boost/utility.hpp>
+#include <functional>
 #include <memory>
-#include <utility>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 #include "block/BlockInterface.hpp"
 #include "value/Value.hpp"
@@ -45,12 +49,53 @@ public:
     void AddBlock(BlockInterface* block,
                   const value::Value* parameters);
 
+    /**
+     * Adds a block with the name used to identify it in the profiling
+     * report. By default, the name of the type of the block is used.
+     * When another block has the same name, "#<index of the block>" is
+     * appended to it.
+     */
+    void AddBlock(BlockInterface* block,
+                  const value::Value* parameters,
+                  const std::string& name);
+
+    /**
+     * Measures the time spent in each phase and in each observer. A JSON
+     * report is written to |out| once the blocks are stopped.
+     */
+    void EnableProfiling(std::ostream* out);
+
     void Run();
 
 private:
-    typedef std::vector<std::pair<BlockInterface*,
-                                  const value::Value*>> BlockVector;
+    enum Phase
+    {
+        kStartPhase = 0,
+        kRegisterServicesPhase,
+        kLoadServicesPhase,
+        kAddObserversPhase,
+        kGetNotificationSinksPhase,
+        kExecutePhase,
+        kStopPhase,
+        kNumPhases,
+    };
+
+    struct BlockInfo
+    {
+        BlockInterface* block;
+        const value::Value* parameters;
+        std::string name;
+        uint64_t phaseNs[kNumPhases];
+    };
+
+    void RunPhase(Phase phase, const std::function<void (BlockInfo*)>& func);
+    value::Value::UP GetProfilingReport(
+        const notification::NotificationCenter& notificationCenter) const;
+
+    typedef std::vector<BlockInfo> BlockVector;
     BlockVector _blocks;
+
+    std::ostream* _profilingOutput;
 };
 
 }
@@ -16,6 +16,7 @@
  * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sstream>
 #include <vector>
 #include <string>
 
@@ -23,6 +24,7 @@
 #include "block/AbstractBlock.hpp"
 #include "block/BlockRunner.hpp"
 #include "block/ServiceList.hpp"
+#include "notification/NotificationCenter.hpp"
 #include "value/Utils.hpp"
 #include "value/Value.hpp"
 
@@ -110,6 +112,43 @@ public:
     std::vector<std::string> callHistory;
 };
 
+// A block that posts integers.
+class ProducerBlock : public AbstractBlock
+{
+public:
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override
+    {
+        _sink = notificationCenter->GetSink({notification::Token("value")});
+    }
+
+    virtual void Execute() override
+    {
+        value::IntValue value {42};
+        for (int i = 0; i < 10; ++i)
+            _sink->PostNotification(&value);
+    }
+
+private:
+    const notification::NotificationSink* _sink;
+};
+
+// A block that observes integers.
+class ObserverBlock : public AbstractBlock
+{
+public:
+    ObserverBlock() : count(0) {}
+
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override
+    {
+        notificationCenter->AddObserver({notification::Token("value")},
+            [this] (const notification::Path& path, const value::Value* value) {
+                ++count;
+            });
+    }
+
+    int count;
+};
+
 }  // namespace
 
 TEST(BlockRunner, run)
@@ -141,5 +180,66 @@ TEST(BlockRunner, run)
     EXPECT_EQ(expectedHistory, blockB.callHistory);
 }
 
+TEST(BlockRunner, profiling)
+{
+    BlockRunner blockRunner;
+
+    ProducerBlock producer;
+    ObserverBlock observer;
+
+    std::stringstream report;
+    blockRunner.EnableProfiling(&report);
+    blockRunner.AddBlock(&producer, nullptr);
+    blockRunner.AddBlock(&observer, nullptr, "observer");
+
+    blockRunner.Run();
+
+    EXPECT_EQ(10, observer.count);
+
+    std::string reportStr = report.str();
+    EXPECT_NE(std::string::npos, reportStr.find("\"phases-ns\":{\"start\":"));
+    EXPECT_NE(std::string::npos, reportStr.find("\"name\":\"tibee::block::(anonymous namespace)::ProducerBlock\""));
+    EXPECT_NE(std::string::npos, reportStr.find("\"name\":\"observer\""));
+    EXPECT_NE(std::string::npos, reportStr.find("\"path\":\"value\",\"owner\":\"observer\",\"latency\":{\"count\":10,"));
+    EXPECT_NE(std::string::npos, reportStr.find("\"paths\":[{\"path\":\"value\",\"latency\":{\"count\":10,"));
+}
+
+TEST(BlockRunner, profilingSameType)
+{
+    BlockRunner blockRunner;
+
+    ProducerBlock producer;
+    ObserverBlock first;
+    ObserverBlock second;
+
+    std::stringstream report;
+    blockRunner.EnableProfiling(&report);
+    blockRunner.AddBlock(&producer, nullptr);
+    blockRunner.AddBlock(&first, nullptr);
+    blockRunner.AddBlock(&second, nullptr);
+
+    blockRunner.Run();
+
+    EXPECT_EQ(10, first.count);
+    EXPECT_EQ(10, second.count);
+
+    // Each block is reported with its own observers.
+    std::string reportStr = report.str();
+    const std::string kObserverName = "tibee::block::(anonymous namespace)::ObserverBlock";
+    EXPECT_NE(std::string::npos, reportStr.find("\"name\":\"" + kObserverName + "\""));
+    EXPECT_NE(std::string::npos, reportStr.find("\"name\":\"" + kObserverName + "#2\""));
+    EXPECT_NE(std::string::npos, reportStr.find("\"owner\":\"" + kObserverName + "\",\"latency\":{\"count\":10,"));
+    EXPECT_NE(std::string::npos, reportStr.find("\"owner\":\"" + kObserverName + "#2\",\"latency\":{\"count\":10,"));
+
+    size_t numBlocksWith10 = 0;
+    for (size_t pos = reportStr.find("\"observers\":{\"count\":10,");
+         pos != std::string::npos;
+         pos = reportStr.find("\"observers\":{\"count\":10,", pos + 1)) {
+        ++numBlocksWith10;
+    }
+    EXPECT_EQ(2u, numBlocksWith10);
+    EXPECT_EQ(std::string::npos, reportStr.find("\"observers\":{\"count\":20,"));
+}
+
 }  // namespace block
 }  // namespace tibee
@@ -0,0 +1,371 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "block/PipelinedBlock.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "base/BindObject.hpp"
+#include "notification/NotificationSink.hpp"
+#include "trace/value/SnapshotEventValue.hpp"
+
+namespace tibee
+{
+namespace block
+{
+
+namespace
+{
+
+using notification::AnyToken;
+using notification::NotificationSink;
+using notification::Path;
+
+// Returns a reference to a value that remains valid after the
+// notification. It must be released with value::Value::Release().
+const value::Value* AcquireValue(const value::Value* value)
+{
+    if (value == nullptr)
+        return nullptr;
+
+    // Shared values are immutable: they are passed without a copy.
+    if (value->IsShared()) {
+        value->AddRef();
+        return value;
+    }
+
+    // Events are only valid until the trace iterator moves forward.
+    auto event = dynamic_cast<const trace::EventValue*>(value);
+    if (event != nullptr)
+        return new trace::SnapshotEventValue(*event);
+
+    return value->Copy().release();
+}
+
+// Waits for the other thread: yields a few times, then sleeps for
+// increasing periods, so that an idle thread doesn't keep a core busy.
+class Backoff
+{
+public:
+    Backoff() : _attempts(0) {}
+
+    void Wait()
+    {
+        if (_attempts < kNumYields) {
+            std::this_thread::yield();
+        } else {
+            size_t shift = std::min(_attempts - kNumYields, kMaxSleepShift);
+            std::this_thread::sleep_for(std::chrono::microseconds(1 << shift));
+        }
+        if (_attempts < kNumYields + kMaxSleepShift)
+            ++_attempts;
+    }
+
+    void Reset() { _attempts = 0; }
+
+private:
+    static const size_t kNumYields = 64;
+    static const size_t kMaxSleepShift = 10;
+
+    size_t _attempts;
+};
+
+}  // namespace
+
+const size_t PipelinedBlock::kDefaultCapacity = 1 << 16;
+const size_t PipelinedBlock::kDefaultBatchSize = 128;
+
+PipelinedBlock::PipelinedBlock()
+    : PipelinedBlock(kDefaultCapacity, kDefaultBatchSize)
+{
+}
+
+PipelinedBlock::PipelinedBlock(size_t capacity, size_t batchSize)
+    : _notificationCenter(nullptr),
+      _postingOutput(nullptr),
+      _queue(capacity),
+      _batchSize(std::max<size_t>(1, std::min(batchSize, _queue.capacity()))),
+      _outputQueue(capacity),
+      _deliveringOutputs(false),
+      _consumerDone(false),
+      _running(false)
+{
+    _batch.reserve(_batchSize);
+    _outputBatch.resize(_batchSize);
+}
+
+PipelinedBlock::~PipelinedBlock()
+{
+    if (_running) {
+        // The main notification center may be gone: drop the pending
+        // notifications of the wrapped blocks.
+        _notificationCenter = nullptr;
+        StopConsumer();
+    }
+}
+
+void PipelinedBlock::AddBlock(BlockInterface* block,
+                              const value::Value* parameters)
+{
+    _blocks.push_back(std::make_pair(block, parameters));
+}
+
+void PipelinedBlock::Start(const value::Value* parameters)
+{
+    for (auto& block : _blocks)
+        block.first->Start(block.second);
+}
+
+void PipelinedBlock::GetNotificationSinks(notification::NotificationCenter* notificationCenter)
+{
+    for (auto& block : _blocks)
+        block.first->GetNotificationSinks(&_outputCenter);
+
+    // All the observers are known: start consuming notifications.
+    _running = true;
+    _consumerDone = false;
+    _consumerThread = std::thread(&PipelinedBlock::ConsumerLoop, this);
+    _consumerThreadId = _consumerThread.get_id();
+}
+
+void PipelinedBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    _notificationCenter = notificationCenter;
+
+    for (auto& block : _blocks) {
+        _consumerCenter.SetObserverPriority(notification::ObserverPriority::kAnalysis);
+        block.first->AddObservers(&_consumerCenter);
+    }
+
+    _outputCenter.AddObserver(
+        {AnyToken()}, base::BindObject(&PipelinedBlock::OnOutput, this));
+    notificationCenter->AddObserver(
+        {AnyToken()}, base::BindObject(&PipelinedBlock::OnNotification, this));
+}
+
+void PipelinedBlock::RegisterServices(ServiceList* serviceList)
+{
+    for (auto& block : _blocks)
+        block.first->RegisterServices(serviceList);
+}
+
+void PipelinedBlock::LoadServices(const ServiceList& serviceList)
+{
+    for (auto& block : _blocks)
+        block.first->LoadServices(serviceList);
+}
+
+void PipelinedBlock::Execute()
+{
+    if (_running)
+        StopConsumer();
+
+    for (auto& block : _blocks)
+        block.first->Execute();
+}
+
+void PipelinedBlock::Stop()
+{
+    for (auto& block : _blocks)
+        block.first->Stop();
+}
+
+void PipelinedBlock::OnNotification(const Path& path,
+                                    const value::Value* value)
+{
+    // A notification of a wrapped block, which already reached the
+    // other wrapped blocks.
+    if (_postingOutput != nullptr && path == *_postingOutput)
+        return;
+
+    if (!_running) {
+        GetConsumerSink(path, &_producerSinkCache)->PostNotification(value);
+        return;
+    }
+
+    auto sink = GetConsumerSink(path, &_producerSinkCache);
+    if (!sink->HasObservers())
+        return;
+
+    Publish(Record {sink, AcquireValue(value)});
+}
+
+const NotificationSink* PipelinedBlock::GetConsumerSink(
+    const Path& path, SinkCache* cache)
+{
+    // The paths of the sinks of the main notification center have a
+    // stable address, which is cheaper to hash than the path itself.
+    auto look = cache->find(&path);
+    if (look != cache->end())
+        return look->second;
+
+    std::lock_guard<std::mutex> lock(_consumerCenterMutex);
+    auto sink = _consumerCenter.GetSink(path);
+    (*cache)[&path] = sink;
+    return sink;
+}
+
+void PipelinedBlock::OnOutput(const Path& path,
+                              const value::Value* value)
+{
+    bool onConsumerThread = std::this_thread::get_id() == _consumerThreadId;
+
+    // The other wrapped blocks receive the notification synchronously.
+    auto sink = GetConsumerSink(
+        path, onConsumerThread ? &_consumerSinkCache : &_producerSinkCache);
+    sink->PostNotification(value);
+
+    if (!onConsumerThread) {
+        PostOutput(path, value);
+        return;
+    }
+
+    // The consumer thread never waits for the main thread while it runs:
+    // records that don't fit in the ring buffer are kept for later.
+    OutputRecord record {&path, AcquireValue(value)};
+    if (!_pendingOutputs.empty() || !_outputQueue.TryPush(record))
+        _pendingOutputs.push_back(record);
+}
+
+void PipelinedBlock::PostOutput(const Path& path,
+                                const value::Value* value)
+{
+    if (_notificationCenter == nullptr)
+        return;
+
+    const NotificationSink* sink = nullptr;
+    auto look = _mainSinkCache.find(&path);
+    if (look != _mainSinkCache.end()) {
+        sink = look->second;
+    } else {
+        sink = _notificationCenter->GetSink(path);
+        _mainSinkCache[&path] = sink;
+    }
+
+    auto previous = _postingOutput;
+    _postingOutput = &path;
+    sink->PostNotification(value);
+    _postingOutput = previous;
+}
+
+size_t PipelinedBlock::DeliverOutputs()
+{
+    // The observers of the main notification center may post
+    // notifications that end up here: deliver the records in order.
+    if (_deliveringOutputs)
+        return 0;
+    _deliveringOutputs = true;
+
+    size_t total = 0;
+    for (;;) {
+        size_t count = _outputQueue.PopBatch(&_outputBatch[0], _outputBatch.size());
+        if (count == 0)
+            break;
+        for (size_t i = 0; i < count; ++i) {
+            PostOutput(*_outputBatch[i].path, _outputBatch[i].value);
+            value::Value::Release(_outputBatch[i].value);
+        }
+        total += count;
+    }
+
+    _deliveringOutputs = false;
+    return total;
+}
+
+void PipelinedBlock::PushPendingOutputs()
+{
+    while (!_pendingOutputs.empty() && _outputQueue.TryPush(_pendingOutputs.front()))
+        _pendingOutputs.pop_front();
+}
+
+void PipelinedBlock::Publish(const Record& record)
+{
+    _batch.push_back(record);
+    if (_batch.size() >= _batchSize || record.sink == nullptr) {
+        Flush();
+        DeliverOutputs();
+    }
+}
+
+void PipelinedBlock::Flush()
+{
+    Backoff backoff;
+    size_t pushed = 0;
+    while (pushed < _batch.size()) {
+        size_t count = _queue.PushBatch(&_batch[pushed], _batch.size() - pushed);
+        if (count == 0)
+            backoff.Wait();
+        pushed += count;
+    }
+    _batch.clear();
+}
+
+void PipelinedBlock::StopConsumer()
+{
+    Publish(Record {nullptr, nullptr});
+
+    // The consumer thread sends its last notifications back before it
+    // exits.
+    Backoff backoff;
+    while (!_consumerDone.load(std::memory_order_acquire)) {
+        if (DeliverOutputs() == 0)
+            backoff.Wait();
+        else
+            backoff.Reset();
+    }
+    _consumerThread.join();
+    DeliverOutputs();
+
+    _running = false;
+}
+
+void PipelinedBlock::ConsumerLoop()
+{
+    std::vector<Record> records(_batchSize);
+    Backoff backoff;
+
+    for (;;) {
+        PushPendingOutputs();
+
+        size_t count = _queue.PopBatch(&records[0], records.size());
+        if (count == 0) {
+            backoff.Wait();
+            continue;
+        }
+        backoff.Reset();
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto& record = records[i];
+            if (record.sink == nullptr) {
+                // The main thread is delivering the notifications of the
+                // wrapped blocks.
+                while (!_pendingOutputs.empty()) {
+                    PushPendingOutputs();
+                    backoff.Wait();
+                }
+                _consumerDone.store(true, std::memory_order_release);
+                return;
+            }
+            record.sink->PostNotification(record.value);
+            value::Value::Release(record.value);
+        }
+    }
+}
+
+}  // namespace block
+}  // namespace tibee
@@ -0,0 +1,172 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_BLOCK_PIPELINEDBLOCK_HPP
+#define _TIBEE_BLOCK_PIPELINEDBLOCK_HPP
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "block/AbstractBlock.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "notification/RingBuffer.hpp"
+
+namespace tibee
+{
+namespace block
+{
+
+/**
+ * Block that runs the observers of other blocks on a consumer thread.
+ *
+ * The wrapped blocks register their observers on a private notification
+ * center. The pipelined block observes every notification of the main
+ * notification center and, when a wrapped block is interested in it,
+ * copies the notified value, unless it is shared, and publishes it in
+ * batches on a lock-free single-producer single-consumer ring buffer.
+ * The consumer thread posts the values to the private notification
+ * center, so handlers added with AddKernelObserver() run unchanged. A
+ * thread that finds the ring buffer empty or full backs off, from
+ * yields to short sleeps.
+ *
+ * The wrapped blocks get their sinks from another private notification
+ * center. Their notifications are dispatched synchronously to the other
+ * wrapped blocks. They are also sent back to the main thread on a second
+ * ring buffer, and posted to the main notification center from there,
+ * so the observers of the main notification center only run on the main
+ * thread. The main thread delivers them when it publishes a batch and
+ * when the consumer thread is done.
+ *
+ * The pipelined block must be added to the block runner after the blocks
+ * that produce its notifications: its Execute() method drains the ring
+ * buffer and waits for the consumer thread before calling Execute() on
+ * the wrapped blocks.
+ *
+ * @author Francois Doray
+ */
+class PipelinedBlock : public AbstractBlock
+{
+public:
+    static const size_t kDefaultCapacity;
+    static const size_t kDefaultBatchSize;
+
+    PipelinedBlock();
+    PipelinedBlock(size_t capacity, size_t batchSize);
+    ~PipelinedBlock();
+
+    void AddBlock(BlockInterface* block,
+                  const value::Value* parameters);
+
+    virtual void Start(const value::Value* parameters) override;
+
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+    virtual void RegisterServices(ServiceList* serviceList) override;
+    virtual void LoadServices(const ServiceList& serviceList) override;
+
+    virtual void Execute() override;
+    virtual void Stop() override;
+
+private:
+    // Record exchanged between the producer and the consumer threads.
+    // The record holds a reference to the value, which is copied unless
+    // it is shared. A null sink ends the stream.
+    struct Record
+    {
+        const notification::NotificationSink* sink;
+        const value::Value* value;
+    };
+
+    // Notification of a wrapped block, sent back to the main thread. The
+    // path is the path of a sink of |_outputCenter|. The record holds a
+    // reference to the value.
+    struct OutputRecord
+    {
+        const notification::Path* path;
+        const value::Value* value;
+    };
+
+    typedef std::unordered_map<const notification::Path*,
+                               const notification::NotificationSink*> SinkCache;
+
+    void OnNotification(const notification::Path& path,
+                        const value::Value* value);
+    const notification::NotificationSink* GetConsumerSink(
+        const notification::Path& path, SinkCache* cache);
+
+    void OnOutput(const notification::Path& path,
+                  const value::Value* value);
+    void PostOutput(const notification::Path& path,
+                    const value::Value* value);
+    size_t DeliverOutputs();
+    void PushPendingOutputs();
+
+    void Publish(const Record& record);
+    void Flush();
+    void StopConsumer();
+    void ConsumerLoop();
+
+    typedef std::vector<std::pair<BlockInterface*,
+                                  const value::Value*>> BlockVector;
+    BlockVector _blocks;
+
+    // Notification center in which the wrapped blocks add their observers.
+    notification::NotificationCenter _consumerCenter;
+    std::mutex _consumerCenterMutex;
+
+    // Notification center from which the wrapped blocks get their sinks.
+    notification::NotificationCenter _outputCenter;
+
+    // Main notification center, only used on the main thread.
+    notification::NotificationCenter* _notificationCenter;
+    SinkCache _mainSinkCache;
+
+    // Path of the notification of a wrapped block being posted to the
+    // main notification center, which must not be forwarded again.
+    const notification::Path* _postingOutput;
+
+    // Sinks of |_consumerCenter|, keyed by the address of the path of the
+    // sinks of the main notification center. Each thread has its own cache.
+    SinkCache _producerSinkCache;
+    SinkCache _consumerSinkCache;
+
+    notification::SpscRingBuffer<Record> _queue;
+    std::vector<Record> _batch;
+    size_t _batchSize;
+
+    notification::SpscRingBuffer<OutputRecord> _outputQueue;
+    std::vector<OutputRecord> _outputBatch;
+    bool _deliveringOutputs;
+
+    // Records that didn't fit in |_outputQueue|. Consumer thread only.
+    std::deque<OutputRecord> _pendingOutputs;
+
+    std::thread _consumerThread;
+    std::thread::id _consumerThreadId;
+    std::atomic<bool> _consumerDone;
+    bool _running;
+};
+
+}
+}
+
+#endif // _TIBEE_BLOCK_PIPELINEDBLOCK_HPP
@@ -0,0 +1,205 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "base/BindObject.hpp"
+#include "block/AbstractBlock.hpp"
+#include "block/BlockRunner.hpp"
+#include "block/PipelinedBlock.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace block
+{
+
+namespace
+{
+
+using notification::Path;
+using notification::Token;
+
+const int kNumValues = 10000;
+
+// A block that posts integers on the main thread.
+class ProducerBlock : public AbstractBlock
+{
+public:
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override
+    {
+        _sink = notificationCenter->GetSink({Token("test"), Token("value")});
+        _unobservedSink = notificationCenter->GetSink({Token("test"), Token("other")});
+    }
+
+    virtual void Execute() override
+    {
+        // The same value object is reused for every notification.
+        value::IntValue value;
+        for (int i = 0; i < kNumValues; ++i) {
+            value.SetValue(i);
+            _sink->PostNotification(&value);
+            _unobservedSink->PostNotification(&value);
+        }
+    }
+
+private:
+    const notification::NotificationSink* _sink;
+    const notification::NotificationSink* _unobservedSink;
+};
+
+// A block that doubles the integers it receives.
+class DoublerBlock : public AbstractBlock
+{
+public:
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override
+    {
+        notificationCenter->AddObserver({Token("test"), Token("value")},
+            base::BindObject(&DoublerBlock::OnValue, this));
+    }
+
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override
+    {
+        _sink = notificationCenter->GetSink({Token("test"), Token("doubled")});
+    }
+
+    void OnValue(const Path& path, const value::Value* value)
+    {
+        value::IntValue doubled(value->AsInteger() * 2);
+        _sink->PostNotification(&doubled);
+    }
+
+private:
+    const notification::NotificationSink* _sink;
+};
+
+// A block that records the integers it receives and the threads
+// on which it receives them.
+class RecorderBlock : public AbstractBlock
+{
+public:
+    RecorderBlock(const char* token) : _token(token) {}
+
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override
+    {
+        notificationCenter->AddObserver({Token("test"), Token(_token)},
+            base::BindObject(&RecorderBlock::OnValue, this));
+    }
+
+    virtual void Execute() override
+    {
+        executeThread = std::this_thread::get_id();
+        executeCount = values.size();
+    }
+
+    void OnValue(const Path& path, const value::Value* value)
+    {
+        values.push_back(value->AsInteger());
+        pointers.push_back(value);
+        threads.push_back(std::this_thread::get_id());
+    }
+
+    std::vector<int> values;
+    std::vector<const value::Value*> pointers;
+    std::vector<std::thread::id> threads;
+    std::thread::id executeThread;
+    size_t executeCount = 0;
+
+private:
+    const char* _token;
+};
+
+}  // namespace
+
+TEST(PipelinedBlock, consumerThread)
+{
+    ProducerBlock producer;
+    DoublerBlock doubler;
+    RecorderBlock valueRecorder("value");
+    RecorderBlock doubledRecorder("doubled");
+    RecorderBlock mainThreadRecorder("doubled");
+
+    PipelinedBlock pipelinedBlock(64, 16);
+    pipelinedBlock.AddBlock(&doubler, nullptr);
+    pipelinedBlock.AddBlock(&valueRecorder, nullptr);
+    pipelinedBlock.AddBlock(&doubledRecorder, nullptr);
+
+    BlockRunner blockRunner;
+    blockRunner.AddBlock(&producer, nullptr);
+    blockRunner.AddBlock(&pipelinedBlock, nullptr);
+    blockRunner.AddBlock(&mainThreadRecorder, nullptr);
+    blockRunner.Run();
+
+    ASSERT_EQ(static_cast<size_t>(kNumValues), valueRecorder.values.size());
+    ASSERT_EQ(static_cast<size_t>(kNumValues), doubledRecorder.values.size());
+    ASSERT_EQ(static_cast<size_t>(kNumValues), mainThreadRecorder.values.size());
+    for (int i = 0; i < kNumValues; ++i) {
+        EXPECT_EQ(i, valueRecorder.values[i]);
+        EXPECT_EQ(2 * i, doubledRecorder.values[i]);
+        EXPECT_EQ(2 * i, mainThreadRecorder.values[i]);
+    }
+
+    // The observers of the wrapped blocks ran on another thread, but
+    // all the notifications were delivered before Execute().
+    std::thread::id mainThread = std::this_thread::get_id();
+    EXPECT_NE(mainThread, valueRecorder.threads.front());
+    EXPECT_EQ(valueRecorder.threads.front(), doubledRecorder.threads.back());
+    EXPECT_EQ(mainThread, valueRecorder.executeThread);
+    EXPECT_EQ(static_cast<size_t>(kNumValues), valueRecorder.executeCount);
+
+    // The notifications of the wrapped blocks reached the observers of
+    // the main notification center on the main thread.
+    for (const auto& thread : mainThreadRecorder.threads)
+        ASSERT_EQ(mainThread, thread);
+}
+
+TEST(PipelinedBlock, sharedValues)
+{
+    notification::NotificationCenter notificationCenter;
+    RecorderBlock recorder("value");
+
+    PipelinedBlock pipelinedBlock(64, 16);
+    pipelinedBlock.AddBlock(&recorder, nullptr);
+    pipelinedBlock.AddObservers(&notificationCenter);
+    pipelinedBlock.GetNotificationSinks(&notificationCenter);
+
+    // A shared value is passed to the consumer thread without a copy.
+    value::ValueRef shared {value::IntValue::UP {new value::IntValue(42)}};
+    auto sink = notificationCenter.GetSink({Token("test"), Token("value")});
+    sink->PostNotification(shared.get());
+    pipelinedBlock.Execute();
+
+    ASSERT_EQ(1u, recorder.values.size());
+    EXPECT_EQ(42, recorder.values[0]);
+    EXPECT_EQ(shared.get(), recorder.pointers[0]);
+
+    // Other values are copied.
+    value::IntValue unshared(7);
+    pipelinedBlock.GetNotificationSinks(&notificationCenter);
+    sink->PostNotification(&unshared);
+    pipelinedBlock.Execute();
+
+    ASSERT_EQ(2u, recorder.values.size());
+    EXPECT_EQ(7, recorder.values[1]);
+    EXPECT_NE(&unshared, recorder.pointers[1]);
+}
+
+}  // namespace block
+}  // namespace tibee
@@ -19,6 +19,7 @@
 #define _TIBEE_BLOCK_SERVICELIST_HPP
 
 #include <boost/utility.hpp>
+#include <string>
 #include <unordered_map>
 
 namespace tibee
@@ -0,0 +1,138 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "base/print.hpp"
+#include "trace_gen/KernelTraceGenerator.hpp"
+
+namespace
+{
+
+const char kOutputFlag[] = "--output=";
+const char kCpusFlag[] = "--cpus=";
+const char kThreadsFlag[] = "--threads=";
+const char kDurationFlag[] = "--duration=";
+const char kRateFlag[] = "--rate=";
+const char kForkRateFlag[] = "--fork-rate=";
+const char kSyscallsFlag[] = "--syscalls=";
+const char kSeedFlag[] = "--seed=";
+
+bool StartsWith(const char* str, const char* prefix)
+{
+    return std::strncmp(str, prefix, std::strlen(prefix)) == 0;
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " --output=<directory>"
+              << " [--cpus=<n>] [--threads=<n>] [--duration=<seconds>]"
+              << " [--rate=<events per second per CPU>]"
+              << " [--fork-rate=<forks per second>]"
+              << " [--syscalls=<name>:<weight>,...] [--seed=<n>]"
+              << std::endl;
+}
+
+// Parses a list of "name:weight" pairs. System calls of the default mix
+// keep their durations and blocking behavior; other system calls never
+// block.
+bool ParseSyscalls(const std::string& str, tibee::trace_gen::SyscallConfigs* syscalls)
+{
+    auto defaults = tibee::trace_gen::GetDefaultSyscalls();
+    syscalls->clear();
+
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto colon = item.find(':');
+        if (colon == std::string::npos || colon == 0)
+            return false;
+
+        tibee::trace_gen::SyscallConfig syscall {item.substr(0, colon), 0, 2000, 0, 0};
+        for (const auto& defaultSyscall : defaults) {
+            if (defaultSyscall.name == syscall.name)
+                syscall = defaultSyscall;
+        }
+        syscall.weight = std::atof(item.c_str() + colon + 1);
+        if (syscall.weight <= 0)
+            return false;
+
+        syscalls->push_back(syscall);
+    }
+
+    return !syscalls->empty();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    using namespace tibee;
+
+    trace_gen::KernelTraceConfig config;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i) {
+        if (StartsWith(argv[i], kOutputFlag)) {
+            output = argv[i] + std::strlen(kOutputFlag);
+        } else if (StartsWith(argv[i], kCpusFlag)) {
+            config.numCpus = std::atoi(argv[i] + std::strlen(kCpusFlag));
+        } else if (StartsWith(argv[i], kThreadsFlag)) {
+            config.numThreads = std::atoi(argv[i] + std::strlen(kThreadsFlag));
+        } else if (StartsWith(argv[i], kDurationFlag)) {
+            config.durationNs = static_cast<timestamp_t>(
+                std::atof(argv[i] + std::strlen(kDurationFlag)) * 1e9);
+        } else if (StartsWith(argv[i], kRateFlag)) {
+            config.eventRate = std::atof(argv[i] + std::strlen(kRateFlag));
+        } else if (StartsWith(argv[i], kForkRateFlag)) {
+            config.forkRate = std::atof(argv[i] + std::strlen(kForkRateFlag));
+        } else if (StartsWith(argv[i], kSyscallsFlag)) {
+            if (!ParseSyscalls(argv[i] + std::strlen(kSyscallsFlag), &config.syscalls)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (StartsWith(argv[i], kSeedFlag)) {
+            config.seed = std::strtoul(argv[i] + std::strlen(kSeedFlag), nullptr, 10);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (output.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    trace_gen::KernelTraceStats stats;
+    if (!trace_gen::GenerateKernelTrace(config, output, &stats))
+        return 1;
+
+    base::tbinfo() << "wrote " << stats.numEvents << " events to " << output
+                   << base::tbendl() << std::endl;
+    std::cout << "sched_switch: " << stats.numSchedSwitch << std::endl
+              << "sched_wakeup: " << stats.numSchedWakeup << std::endl
+              << "syscalls:     " << stats.numSyscalls << std::endl
+              << "forks:        " << stats.numForks << std::endl
+              << "exits:        " << stats.numExits << std::endl;
+
+    return 0;
+}
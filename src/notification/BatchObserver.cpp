@@ -0,0 +1,76 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "notification/BatchObserver.hpp"
+
+#include <assert.h>
+
+namespace tibee
+{
+namespace notification
+{
+
+NotificationBatch::NotificationBatch(const std::vector<FieldPath>& fields, size_t capacity)
+    : _fields(fields),
+      _capacity(capacity),
+      _columns(fields.size())
+{
+    assert(capacity > 0);
+
+    _paths.reserve(capacity);
+    for (auto& column : _columns)
+        column.reserve(capacity);
+}
+
+void NotificationBatch::Append(const Path& path, const value::Value* value)
+{
+    _paths.push_back(&path);
+
+    for (size_t i = 0; i < _fields.size(); ++i)
+    {
+        int64_t integer = 0;
+        if (!GetIntegerField(value, _fields[i], &integer))
+            integer = 0;
+        _columns[i].push_back(integer);
+    }
+}
+
+void NotificationBatch::Clear()
+{
+    _paths.clear();
+    for (auto& column : _columns)
+        column.clear();
+}
+
+BatchObserver::BatchObserver(const std::vector<FieldPath>& fields,
+                             size_t batchSize,
+                             const BatchCallback& callback)
+    : _batch(fields, batchSize),
+      _callback(callback)
+{
+}
+
+void BatchObserver::Flush()
+{
+    if (_batch.size() == 0)
+        return;
+    _callback(_batch);
+    _batch.Clear();
+}
+
+}
+}
@@ -0,0 +1,124 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_NOTIFICATION_BATCHOBSERVER_HPP
+#define _TIBEE_NOTIFICATION_BATCHOBSERVER_HPP
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "notification/FieldPredicate.hpp"
+#include "notification/Path.hpp"
+
+namespace tibee
+{
+
+namespace value
+{
+// Forward declaration.
+class Value;
+}
+
+namespace notification
+{
+
+/**
+ * Notifications delivered at once to a batch observer.
+ *
+ * The notifications are in the order in which they were posted, across
+ * all the paths of the observer. Their values aren't kept, since they may
+ * be transient like trace events: the fields requested by the observer
+ * are read as integers when a notification is posted and stored in one
+ * column per field, so that the observer can process them in tight loops.
+ *
+ * @author Francois Doray
+ */
+class NotificationBatch :
+    boost::noncopyable
+{
+public:
+    NotificationBatch(const std::vector<FieldPath>& fields, size_t capacity);
+
+    size_t size() const { return _paths.size(); }
+    size_t capacity() const { return _capacity; }
+    bool full() const { return _paths.size() >= _capacity; }
+
+    // Path of a notification.
+    const Path& path(size_t index) const { return *_paths[index]; }
+
+    // Values of a field, in the order of the fields of the observer. A
+    // missing or non-integer field reads as 0.
+    size_t numColumns() const { return _columns.size(); }
+    const int64_t* column(size_t index) const { return _columns[index].data(); }
+
+    void Append(const Path& path, const value::Value* value);
+    void Clear();
+
+private:
+    std::vector<FieldPath> _fields;
+    size_t _capacity;
+
+    // Paths are owned by the sinks, which outlive the batches.
+    std::vector<const Path*> _paths;
+    std::vector<std::vector<int64_t>> _columns;
+};
+
+typedef std::function<void (const NotificationBatch& batch)> BatchCallback;
+
+/**
+ * Observer that receives notifications in batches.
+ *
+ * A batch is delivered when it is full, or when the notification center
+ * flushes the batches. Batch observers thus see notifications after the
+ * other observers: they suit analyses that only count or sum fields and
+ * don't depend on the state built by other blocks.
+ *
+ * @author Francois Doray
+ */
+class BatchObserver :
+    boost::noncopyable
+{
+public:
+    BatchObserver(const std::vector<FieldPath>& fields,
+                  size_t batchSize,
+                  const BatchCallback& callback);
+
+    void Post(const Path& path, const value::Value* value)
+    {
+        _batch.Append(path, value);
+        if (_batch.full())
+            Flush();
+    }
+
+    // Delivers the pending notifications, if any.
+    void Flush();
+
+private:
+    NotificationBatch _batch;
+    BatchCallback _callback;
+};
+
+typedef std::vector<BatchObserver*> BatchObservers;
+
+}
+}
+
+#endif // _TIBEE_NOTIFICATION_BATCHOBSERVER_HPP
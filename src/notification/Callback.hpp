@@ -18,7 +18,10 @@
 #ifndef _TIBEE_NOTIFICATION_CALLBACK_HPP
 #define _TIBEE_NOTIFICATION_CALLBACK_HPP
 
-#include <vector>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "notification/Path.hpp"
 
@@ -34,10 +37,94 @@ class Value;
 namespace notification
 {
 
-typedef std::function<void (const Path& path, const value::Value* value)>
-    Callback;
-typedef std::vector<Callback> CallbackContainer;
-typedef std::vector<CallbackContainer*> CallbackContainers;
+/**
+ * Observer of notifications.
+ *
+ * A callback is a function pointer (the thunk) and the object it is
+ * invoked on, so that posting a notification costs a single indirect
+ * call. Member functions are bound at compile time with Bind(): the thunk
+ * calls them directly. Other callables are stored in a std::function,
+ * which adds an indirect call.
+ *
+ * @author Francois Doray
+ */
+class Callback
+{
+public:
+    typedef void (*Thunk)(void* object, const Path& path, const value::Value* value);
+
+    Callback()
+        : _thunk(nullptr), _object(nullptr)
+    {
+    }
+
+    Callback(Thunk thunk, void* object)
+        : _thunk(thunk), _object(object)
+    {
+    }
+
+    // Wraps a callable with the signature
+    // void (const Path& path, const value::Value* value).
+    template<typename F,
+             typename = typename std::enable_if<
+                 !std::is_same<typename std::decay<F>::type, Callback>::value>::type>
+    Callback(F&& function)
+    {
+        typedef std::function<void (const Path&, const value::Value*)> Function;
+        auto stored = std::make_shared<Function>(std::forward<F>(function));
+        _thunk = &InvokeFunction;
+        _object = stored.get();
+        _function = std::move(stored);
+    }
+
+    /**
+     * Returns a callback that invokes |Method| on |object|.
+     */
+    template<class T, void (T::*Method)(const Path& path, const value::Value* value)>
+    static Callback Bind(T* object)
+    {
+        return Callback(&InvokeMethod<T, Method>, object);
+    }
+
+    void operator()(const Path& path, const value::Value* value) const
+    {
+        _thunk(_object, path, value);
+    }
+
+    explicit operator bool() const { return _thunk != nullptr; }
+
+private:
+    template<class T, void (T::*Method)(const Path& path, const value::Value* value)>
+    static void InvokeMethod(void* object, const Path& path, const value::Value* value)
+    {
+        (static_cast<T*>(object)->*Method)(path, value);
+    }
+
+    static void InvokeFunction(void* object, const Path& path, const value::Value* value)
+    {
+        (*static_cast<const std::function<void (const Path&, const value::Value*)>*>(object))(path, value);
+    }
+
+    Thunk _thunk;
+    void* _object;
+
+    // Keeps a wrapped callable alive.
+    std::shared_ptr<void> _function;
+};
+
+/**
+ * Phases in which the observers of a notification run. The observers
+ * that update the state run first, so that analyses read the state that
+ * includes the notification, and the observers that output results run
+ * last. Within a phase, observers run in the order in which they were
+ * added.
+ */
+enum class ObserverPriority
+{
+    kState,
+    kAnalysis,
+    kOutput,
+};
 
 }
 }
@@ -0,0 +1,100 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "notification/FieldPredicate.hpp"
+
+#include <algorithm>
+
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace notification
+{
+
+namespace
+{
+
+// Sets with more values are searched with a binary search.
+const size_t kMaxScannedValues = 8;
+
+}  // namespace
+
+bool GetIntegerField(const value::Value* value, const FieldPath& field, int64_t* integer)
+{
+    for (const auto& name : field)
+    {
+        if (value == nullptr)
+            return false;
+        value = value->GetField(name);
+    }
+    return value != nullptr && value->AsLong(integer);
+}
+
+FieldPredicate::FieldPredicate(const FieldPath& field, Op op)
+    : _field(field),
+      _op(op),
+      _min(0),
+      _max(0)
+{
+}
+
+FieldPredicate FieldPredicate::Equal(const FieldPath& field, int64_t value)
+{
+    return Range(field, value, value);
+}
+
+FieldPredicate FieldPredicate::Range(const FieldPath& field, int64_t min, int64_t max)
+{
+    FieldPredicate predicate(field, Op::kRange);
+    predicate._min = min;
+    predicate._max = max;
+    return predicate;
+}
+
+FieldPredicate FieldPredicate::InSet(const FieldPath& field, const std::vector<int64_t>& values)
+{
+    FieldPredicate predicate(field, Op::kInSet);
+    predicate._values = values;
+    std::sort(predicate._values.begin(), predicate._values.end());
+    predicate._values.erase(
+        std::unique(predicate._values.begin(), predicate._values.end()),
+        predicate._values.end());
+    return predicate;
+}
+
+bool FieldPredicate::Matches(int64_t value) const
+{
+    if (_op == Op::kRange)
+        return value >= _min && value <= _max;
+
+    if (_values.size() <= kMaxScannedValues)
+        return std::find(_values.begin(), _values.end(), value) != _values.end();
+    return std::binary_search(_values.begin(), _values.end(), value);
+}
+
+bool FieldPredicate::operator==(const FieldPredicate& other) const
+{
+    return _field == other._field &&
+           _op == other._op &&
+           _min == other._min &&
+           _max == other._max &&
+           _values == other._values;
+}
+
+}
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_NOTIFICATION_FIELDPREDICATE_HPP
+#define _TIBEE_NOTIFICATION_FIELDPREDICATE_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tibee
+{
+
+namespace value
+{
+// Forward declaration.
+class Value;
+}
+
+namespace notification
+{
+
+// Names of nested fields, e.g. {"fields", "prev_tid"} for a field of an
+// event.
+typedef std::vector<std::string> FieldPath;
+
+/**
+ * Reads an integer field of a notification.
+ *
+ * @returns false if the field is missing or isn't an integer.
+ */
+bool GetIntegerField(const value::Value* value, const FieldPath& field, int64_t* integer);
+
+/**
+ * Condition on an integer field of a notification.
+ *
+ * Observers attach predicates to their paths so that the sink evaluates
+ * them before running the callbacks, instead of each callback decoding
+ * fields to return early. A notification whose field is missing or isn't
+ * an integer doesn't match.
+ *
+ * @author Francois Doray
+ */
+class FieldPredicate
+{
+public:
+    // The field is equal to |value|.
+    static FieldPredicate Equal(const FieldPath& field, int64_t value);
+
+    // The field is in [min, max].
+    static FieldPredicate Range(const FieldPath& field, int64_t min, int64_t max);
+
+    // The field is one of |values|.
+    static FieldPredicate InSet(const FieldPath& field, const std::vector<int64_t>& values);
+
+    const FieldPath& field() const { return _field; }
+
+    bool Matches(int64_t value) const;
+
+    bool operator==(const FieldPredicate& other) const;
+    bool operator!=(const FieldPredicate& other) const { return !(*this == other); }
+
+private:
+    enum class Op
+    {
+        kRange,
+        kInSet,
+    };
+
+    FieldPredicate(const FieldPath& field, Op op);
+
+    FieldPath _field;
+    Op _op;
+
+    // Bounds of a range. Equality is a range of one value.
+    int64_t _min;
+    int64_t _max;
+
+    // Sorted values of a set.
+    std::vector<int64_t> _values;
+};
+
+// Conditions that must all be true for an observer to be notified.
+typedef std::vector<FieldPredicate> FieldPredicates;
+
+// Predicates of a callback, as indexes in the predicates of the
+// notification center.
+typedef std::vector<uint32_t> PredicateIds;
+
+}
+}
+
+#endif // _TIBEE_NOTIFICATION_FIELDPREDICATE_HPP
@@ -17,6 +17,7 @@
  */
 #include "notification/NotificationCenter.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <boost/regex.hpp>
 
@@ -49,11 +50,25 @@ bool TokenMatch(const Token& token, const Token& search)
     return boost::regex_search(token.token(), searchBre);
 }
 
+std::string PathToString(const Path& path)
+{
+    std::string str;
+    for (const auto& token : path) {
+        if (!str.empty())
+            str += "/";
+        str += token.token();
+    }
+    return str;
+}
+
 }  // namespace
 
 const char* NotificationCenter::kNotificationCenterServiceName = "notificationCenter";
+const size_t NotificationCenter::kDefaultBatchSize;
 
 NotificationCenter::NotificationCenter()
+    : _observerPriority(ObserverPriority::kAnalysis),
+      _profiling(false)
 {
 }
 
@@ -63,17 +78,74 @@ NotificationCenter::~NotificationCenter()
 
 void NotificationCenter::AddObserver(const Path& path,
                                      const Callback& callback)
+{
+    AddObserver(path, callback, FieldPredicates());
+}
+
+void NotificationCenter::AddObserver(const Path& path,
+                                     const Callback& callback,
+                                     const FieldPredicates& predicates)
 {
     assert(!path.empty());
     
     auto pathKey = _observerPaths.CreateNodeKey(path);
     
-    if (_pathToCallbacks.size() <= pathKey.get())
-        _pathToCallbacks.resize(pathKey.get() + 1);
-    if (_pathToCallbacks[pathKey.get()].get() == nullptr)
-        _pathToCallbacks[pathKey.get()].reset(new CallbackContainer);
+    if (_pathToObservers.size() <= pathKey.get())
+        _pathToObservers.resize(pathKey.get() + 1);
+    if (_pathToObservers[pathKey.get()].get() == nullptr)
+        _pathToObservers[pathKey.get()].reset(new Observers);
+
+    std::unique_ptr<Observer> observer {new Observer};
+    observer->callback = callback;
+    observer->priority = _observerPriority;
+    observer->sequence = _observers.size();
+
+    // Observers share identical predicates.
+    for (const auto& predicate : predicates)
+    {
+        auto look = std::find(_predicates.begin(), _predicates.end(), predicate);
+        observer->predicates.push_back(look - _predicates.begin());
+        if (look == _predicates.end())
+            _predicates.push_back(predicate);
+    }
+
+    if (_profiling) {
+        observer->stats.reset(new CallbackStats);
+        observer->stats->path = PathToString(path);
+        observer->stats->owner = _observerOwner;
+    }
 
-    _pathToCallbacks[pathKey.get()]->push_back(callback);
+    _pathToObservers[pathKey.get()]->push_back(observer.get());
+    _observers.push_back(std::move(observer));
+}
+
+void NotificationCenter::AddBatchObserver(const std::vector<Path>& paths,
+                                          const std::vector<FieldPath>& fields,
+                                          const BatchCallback& callback,
+                                          size_t batchSize)
+{
+    _batchObservers.emplace_back(new BatchObserver(fields, batchSize, callback));
+    BatchObserver* observer = _batchObservers.back().get();
+
+    for (const auto& path : paths)
+    {
+        assert(!path.empty());
+
+        auto pathKey = _observerPaths.CreateNodeKey(path);
+
+        if (_pathToBatchObservers.size() <= pathKey.get())
+            _pathToBatchObservers.resize(pathKey.get() + 1);
+        if (_pathToBatchObservers[pathKey.get()].get() == nullptr)
+            _pathToBatchObservers[pathKey.get()].reset(new BatchObservers);
+
+        _pathToBatchObservers[pathKey.get()]->push_back(observer);
+    }
+}
+
+void NotificationCenter::FlushBatches()
+{
+    for (const auto& observer : _batchObservers)
+        observer->Flush();
 }
 
 const NotificationSink* NotificationCenter::GetSink(const Path& path)
@@ -83,35 +155,68 @@ const NotificationSink* NotificationCenter::GetSink(const Path& path)
         return look->second.get();
 
     // Create a new sink.
-    CallbackContainers callbacks;
-    FindCallbacks(path, 0, 0, &callbacks);
+    Observers observers;
+    BatchObservers batchObservers;
+    FindObservers(path, 0, 0, &observers, &batchObservers);
+
+    // The order of the callbacks doesn't depend on the order in which
+    // the matching paths were found.
+    std::sort(observers.begin(), observers.end(),
+              [] (const Observer* a, const Observer* b) {
+                  if (a->priority != b->priority)
+                      return a->priority < b->priority;
+                  return a->sequence < b->sequence;
+              });
+
+    NotificationSink::UP sink {new NotificationSink {path, _profiling}};
+    for (auto observer : observers)
+    {
+        sink->AddCallback(observer->callback, observer->predicates,
+                          observer->stats.get());
+    }
+    sink->SetPredicates(_predicates);
+
+    // A batch observer whose paths overlap receives each notification once.
+    for (auto observer : batchObservers)
+    {
+        auto& sinkObservers = sink->_batchObservers;
+        if (std::find(sinkObservers.begin(), sinkObservers.end(), observer) == sinkObservers.end())
+            sinkObservers.push_back(observer);
+    }
 
-    auto sink = NotificationSink::UP {
-        new NotificationSink { path, callbacks } };
     auto sinkPtr = sink.get();
     _pathToSinks[path] = std::move(sink);
 
     return sinkPtr;
 }
 
-void NotificationCenter::FindCallbacks(const Path& path,
+void NotificationCenter::FindObservers(const Path& path,
                                        size_t pathIndex,
                                        keyed_tree::NodeKey node,
-                                       CallbackContainers* callbacks)
+                                       Observers* observers,
+                                       BatchObservers* batchObservers)
 {
-    // Add the callbacks for |node|.
+    // Add the observers for |node|.
+    if (pathIndex != 0 &&
+        node.get() < _pathToObservers.size() &&
+        _pathToObservers[node.get()])
+    {
+        const auto& nodeObservers = *_pathToObservers[node.get()];
+        observers->insert(observers->end(), nodeObservers.begin(), nodeObservers.end());
+    }
     if (pathIndex != 0 &&
-        node.get() < _pathToCallbacks.size() &&
-        _pathToCallbacks[node.get()])
+        node.get() < _pathToBatchObservers.size() &&
+        _pathToBatchObservers[node.get()])
     {
-        callbacks->push_back(_pathToCallbacks[node.get()].get());
+        const auto& observers = *_pathToBatchObservers[node.get()];
+        batchObservers->insert(batchObservers->end(), observers.begin(), observers.end());
     }
 
     // End of the path.
     if (pathIndex >= path.size())
         return;
 
-    // Add the callbacks for the children of |node|.
+    // Add the observers for the children of |node|.
     auto it = _observerPaths.node_children_begin(node);
     auto it_end = _observerPaths.node_children_end(node);
 
@@ -119,7 +224,49 @@ void NotificationCenter::FindCallbacks(const Path& path,
     {
         const auto& label = it->first;
         if (TokenMatch(path[pathIndex], label))
-            FindCallbacks(path, pathIndex + 1, it->second, callbacks);
+            FindObservers(path, pathIndex + 1, it->second, observers, batchObservers);
+    }
+}
+
+void NotificationCenter::EnableProfiling()
+{
+    assert(_observers.empty());
+    _profiling = true;
+}
+
+void NotificationCenter::SetObserverOwner(const std::string& owner)
+{
+    _observerOwner = owner;
+}
+
+void NotificationCenter::SetObserverPriority(ObserverPriority priority)
+{
+    _observerPriority = priority;
+}
+
+void NotificationCenter::GetCallbackStats(std::vector<CallbackStats>* stats) const
+{
+    assert(stats != nullptr);
+
+    for (const auto& observer : _observers) {
+        if (observer->stats.get() == nullptr)
+            continue;
+        stats->push_back(*observer->stats);
+    }
+}
+
+void NotificationCenter::GetPathStats(std::vector<PathStats>* stats) const
+{
+    assert(stats != nullptr);
+
+    for (const auto& sink : _pathToSinks) {
+        if (sink.second->_pathStats.get() == nullptr)
+            continue;
+
+        PathStats pathStats;
+        pathStats.path = PathToString(sink.first);
+        pathStats.latency = *sink.second->_pathStats;
+        stats->push_back(pathStats);
     }
 }
 
@@ -18,12 +18,16 @@
 #ifndef _TIBEE_NOTIFICATION_NOTIFICATIONCENTER_HPP
 #define _TIBEE_NOTIFICATION_NOTIFICATIONCENTER_HPP
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "keyed_tree/KeyedTree.hpp"
+#include "notification/BatchObserver.hpp"
 #include "notification/Callback.hpp"
+#include "notification/FieldPredicate.hpp"
+#include "notification/NotificationStats.hpp"
 #include "notification/Path.hpp"
 #include "notification/NotificationSink.hpp"
 #include "notification/Token.hpp"
@@ -45,27 +49,106 @@ public:
 
     static const char* kNotificationCenterServiceName;
 
+    // Number of notifications in the batches of a batch observer.
+    static const size_t kDefaultBatchSize = 256;
+
     NotificationCenter();
     ~NotificationCenter();
 
     void AddObserver(const Path& path,
                      const Callback& function);
 
+    /**
+     * Adds an observer that is only notified when all |predicates| are
+     * true. Sinks evaluate each distinct predicate once per notification,
+     * and read each field once, before running the callbacks.
+     */
+    void AddObserver(const Path& path,
+                     const Callback& function,
+                     const FieldPredicates& predicates);
+
+    /**
+     * Adds an observer that receives the notifications posted on |paths|
+     * in batches, with the integer values of |fields| in columns. The
+     * notifications of all the paths are delivered in the order in which
+     * they were posted.
+     */
+    void AddBatchObserver(const std::vector<Path>& paths,
+                          const std::vector<FieldPath>& fields,
+                          const BatchCallback& callback,
+                          size_t batchSize = kDefaultBatchSize);
+
+    /**
+     * Delivers the pending notifications of the batch observers. Called
+     * by the block that posts the notifications when it is done.
+     */
+    void FlushBatches();
+
     const NotificationSink* GetSink(const Path& path);
 
+    /**
+     * Enables the profiling counters of the observers and of the sinks.
+     * Must be called before observers are added.
+     */
+    void EnableProfiling();
+    bool IsProfilingEnabled() const { return _profiling; }
+
+    /**
+     * Sets the owner that is reported for the observers added from now on.
+     */
+    void SetObserverOwner(const std::string& owner);
+
+    /**
+     * Sets the phase in which the observers added from now on run. The
+     * default is ObserverPriority::kAnalysis.
+     */
+    void SetObserverPriority(ObserverPriority priority);
+
+    void GetCallbackStats(std::vector<CallbackStats>* stats) const;
+    void GetPathStats(std::vector<PathStats>* stats) const;
+
 private:
-    void FindCallbacks(const Path& path,
+    struct Observer
+    {
+        Callback callback;
+        PredicateIds predicates;
+        ObserverPriority priority;
+
+        // Rank of the observer in the order in which observers were added.
+        size_t sequence;
+
+        // Null when profiling is disabled.
+        std::unique_ptr<CallbackStats> stats;
+    };
+    typedef std::vector<const Observer*> Observers;
+
+    void FindObservers(const Path& path,
                        size_t pathIndex,
                        keyed_tree::NodeKey node,
-                       CallbackContainers* containers);
+                       Observers* observers,
+                       BatchObservers* batchObservers);
     typedef keyed_tree::KeyedTree<Token> ObserverPaths;
     ObserverPaths _observerPaths;
 
-    typedef std::vector<std::unique_ptr<CallbackContainer>> PathToCallbacks;
-    PathToCallbacks _pathToCallbacks;
+    // Observers, in the order in which they were added.
+    std::vector<std::unique_ptr<Observer>> _observers;
+    typedef std::vector<std::unique_ptr<Observers>> PathToObservers;
+    PathToObservers _pathToObservers;
+    ObserverPriority _observerPriority;
+
+    // Distinct predicates of all the observers.
+    FieldPredicates _predicates;
+
+    std::vector<std::unique_ptr<BatchObserver>> _batchObservers;
+    typedef std::vector<std::unique_ptr<BatchObservers>> PathToBatchObservers;
+    PathToBatchObservers _pathToBatchObservers;
 
     typedef std::unordered_map<Path, NotificationSink::UP> PathToSinks;
     PathToSinks _pathToSinks;
+
+    // Profiling.
+    bool _profiling;
+    std::string _observerOwner;
 };
 
 }
@@ -207,5 +207,158 @@ TEST(NotificationCenter, regexNotifications)
     }
 }
 
+TEST(NotificationCenter, boundMethodNotifications)
+{
+    NotificationCenter notificationCenter;
+
+    Path path {Token("a"), Token("b")};
+    MockObserver observer;
+    MockObserver otherObserver;
+
+    notificationCenter.AddObserver(
+        path, Callback::Bind<MockObserver, &MockObserver::method>(&observer));
+    notificationCenter.AddObserver(
+        {Token("a"), AnyToken()},
+        Callback::Bind<MockObserver, &MockObserver::method>(&otherObserver));
+
+    auto sink = notificationCenter.GetSink(path);
+    value::IntValue value(42);
+
+    EXPECT_CALL(observer, method(path, &value));
+    EXPECT_CALL(otherObserver, method(path, &value));
+    sink->PostNotification(&value);
+}
+
+TEST(NotificationCenter, batchNotifications)
+{
+    NotificationCenter notificationCenter;
+
+    Path path_a {Token("a")};
+    Path path_b {Token("b")};
+
+    std::vector<std::string> paths;
+    std::vector<int64_t> sizes;
+    std::vector<int64_t> tids;
+    size_t numBatches = 0;
+    notificationCenter.AddBatchObserver(
+        {path_a, path_b, {AnyToken()}},
+        {{"size"}, {"fields", "tid"}},
+        [&] (const NotificationBatch& batch) {
+            ++numBatches;
+            ASSERT_EQ(2u, batch.numColumns());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                paths.push_back(batch.path(i)[0].token());
+                sizes.push_back(batch.column(0)[i]);
+                tids.push_back(batch.column(1)[i]);
+            }
+        },
+        2);
+
+    auto sink_a = notificationCenter.GetSink(path_a);
+    auto sink_b = notificationCenter.GetSink(path_b);
+    EXPECT_TRUE(sink_a->HasObservers());
+
+    value::StructValue first;
+    first.AddField<value::IntValue>("size", 10);
+    value::StructValue::UP fields {new value::StructValue};
+    fields->AddField<value::IntValue>("tid", 42);
+    first.AddField("fields", std::move(fields));
+
+    value::StructValue second;
+    second.AddField<value::StringValue>("size", "not an integer");
+
+    // Batches are delivered when they are full, in the order of the
+    // notifications across paths.
+    sink_a->PostNotification(&first);
+    sink_b->PostNotification(&second);
+    EXPECT_EQ(1u, numBatches);
+    sink_a->PostNotification(nullptr);
+    EXPECT_EQ(1u, numBatches);
+
+    notificationCenter.FlushBatches();
+    EXPECT_EQ(2u, numBatches);
+    notificationCenter.FlushBatches();
+    EXPECT_EQ(2u, numBatches);
+
+    EXPECT_EQ((std::vector<std::string> {"a", "b", "a"}), paths);
+    EXPECT_EQ((std::vector<int64_t> {10, 0, 0}), sizes);
+    EXPECT_EQ((std::vector<int64_t> {42, 0, 0}), tids);
+}
+
+TEST(NotificationCenter, filteredNotifications)
+{
+    NotificationCenter notificationCenter;
+
+    Path path {Token("a")};
+
+    std::vector<std::string> calls;
+    auto record = [&] (const std::string& name) {
+        return [&calls, name] (const Path&, const value::Value*) {
+            calls.push_back(name);
+        };
+    };
+
+    notificationCenter.AddObserver(path, record("all"));
+    notificationCenter.AddObserver(path, record("tid"),
+        {FieldPredicate::Equal({"tid"}, 42)});
+    notificationCenter.AddObserver(path, record("tidAndCpu"),
+        {FieldPredicate::Equal({"tid"}, 42),
+         FieldPredicate::InSet({"cpu"}, {3, 1, 2, 1})});
+    notificationCenter.AddObserver(path, record("size"),
+        {FieldPredicate::Range({"fields", "size"}, 10, 20)});
+
+    auto sink = notificationCenter.GetSink(path);
+
+    value::StructValue first;
+    first.AddField<value::IntValue>("tid", 42);
+    first.AddField<value::IntValue>("cpu", 2);
+    value::StructValue::UP fields {new value::StructValue};
+    fields->AddField<value::IntValue>("size", 20);
+    first.AddField("fields", std::move(fields));
+    sink->PostNotification(&first);
+    EXPECT_EQ((std::vector<std::string> {"all", "tid", "tidAndCpu", "size"}), calls);
+
+    // Predicates on missing or non-integer fields are false.
+    calls.clear();
+    value::StructValue second;
+    second.AddField<value::IntValue>("tid", 42);
+    second.AddField<value::StringValue>("cpu", "2");
+    sink->PostNotification(&second);
+    EXPECT_EQ((std::vector<std::string> {"all", "tid"}), calls);
+
+    calls.clear();
+    sink->PostNotification(nullptr);
+    EXPECT_EQ((std::vector<std::string> {"all"}), calls);
+}
+
+TEST(NotificationCenter, observerPriorities)
+{
+    NotificationCenter notificationCenter;
+
+    std::vector<std::string> calls;
+    auto record = [&] (const std::string& name) {
+        return [&calls, name] (const Path&, const value::Value*) {
+            calls.push_back(name);
+        };
+    };
+
+    // Observers run by priority phase, then in the order in which they
+    // were added, whatever the paths through which they match.
+    notificationCenter.SetObserverPriority(ObserverPriority::kOutput);
+    notificationCenter.AddObserver({AnyToken()}, record("output"));
+    notificationCenter.SetObserverPriority(ObserverPriority::kAnalysis);
+    notificationCenter.AddObserver({AnyToken()}, record("analysis1"));
+    notificationCenter.AddObserver({RegexToken("^a")}, record("analysis2"));
+    notificationCenter.AddObserver({Token("a")}, record("analysis3"));
+    notificationCenter.SetObserverPriority(ObserverPriority::kState);
+    notificationCenter.AddObserver({Token("a")}, record("state1"));
+    notificationCenter.AddObserver({AnyToken()}, record("state2"));
+
+    auto sink = notificationCenter.GetSink({Token("a")});
+    sink->PostNotification(nullptr);
+    EXPECT_EQ((std::vector<std::string> {
+        "state1", "state2", "analysis1", "analysis2", "analysis3", "output"}), calls);
+}
+
 }  // namespace notification
 }  // namespace tibee
@@ -17,6 +17,9 @@
  */
 #include "notification/NotificationSink.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 #include "notification/NotificationCenter.hpp"
 
 namespace tibee
@@ -24,10 +27,9 @@ namespace tibee
 namespace notification
 {
 
-NotificationSink::NotificationSink(const Path& path,
-                                   const CallbackContainers& callbacks)
+NotificationSink::NotificationSink(const Path& path, bool profiling)
     : _path(path),
-      _callbacks(callbacks)
+      _pathStats(profiling ? new LatencyStats : nullptr)
 {
 }
 
@@ -35,11 +37,100 @@ NotificationSink::~NotificationSink()
 {
 }
 
+void NotificationSink::AddCallback(const Callback& callback,
+                                   const PredicateIds& predicateIds,
+                                   CallbackStats* stats)
+{
+  Dispatch dispatch;
+  dispatch.callback = callback;
+  dispatch.predicatesBegin = _dispatchPredicates.size();
+  _dispatchPredicates.insert(_dispatchPredicates.end(),
+                             predicateIds.begin(), predicateIds.end());
+  dispatch.predicatesEnd = _dispatchPredicates.size();
+  dispatch.stats = stats;
+  _dispatch.push_back(dispatch);
+}
+
+void NotificationSink::SetPredicates(const FieldPredicates& predicates)
+{
+  std::vector<bool> used(predicates.size(), false);
+  for (auto id : _dispatchPredicates)
+    used[id] = true;
+
+  for (uint32_t id = 0; id < predicates.size(); ++id) {
+    if (!used[id])
+      continue;
+    const auto& predicate = predicates[id];
+    auto look = std::find(_predicateFields.begin(), _predicateFields.end(), predicate.field());
+    if (look == _predicateFields.end())
+      look = _predicateFields.insert(_predicateFields.end(), predicate.field());
+    _predicates.emplace_back(predicate, look - _predicateFields.begin(), id);
+  }
+
+  _fieldValues.resize(_predicateFields.size());
+  _fieldPresent.resize(_predicateFields.size());
+  _predicateResults.resize(predicates.size());
+}
+
+void NotificationSink::EvaluatePredicates(const value::Value* value) const
+{
+  for (size_t i = 0; i < _predicateFields.size(); ++i)
+    _fieldPresent[i] = GetIntegerField(value, _predicateFields[i], &_fieldValues[i]);
+
+  for (const auto& predicate : _predicates) {
+    _predicateResults[predicate.id] =
+        _fieldPresent[predicate.field] &&
+        predicate.predicate.Matches(_fieldValues[predicate.field]);
+  }
+}
+
 void NotificationSink::PostNotification(const value::Value* value) const
 {
-  for (const auto& callbacks : _callbacks)
-    for (const auto& callback : *callbacks)
-      callback(_path, value);
+  if (_pathStats) {
+    PostNotificationProfiled(value);
+    return;
+  }
+
+  if (_predicates.empty()) {
+    for (const auto& dispatch : _dispatch)
+      dispatch.callback(_path, value);
+  } else {
+    EvaluatePredicates(value);
+    for (const auto& dispatch : _dispatch) {
+      if (PredicatesMatch(dispatch))
+        dispatch.callback(_path, value);
+    }
+  }
+
+  for (auto observer : _batchObservers)
+    observer->Post(_path, value);
+}
+
+void NotificationSink::PostNotificationProfiled(const value::Value* value) const
+{
+  typedef std::chrono::steady_clock Clock;
+
+  auto notificationStart = Clock::now();
+
+  if (!_predicates.empty())
+    EvaluatePredicates(value);
+
+  for (const auto& dispatch : _dispatch) {
+    if (!PredicatesMatch(dispatch))
+      continue;
+    auto callbackStart = Clock::now();
+    dispatch.callback(_path, value);
+    auto duration = Clock::now() - callbackStart;
+    dispatch.stats->latency.Add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  }
+
+  for (auto observer : _batchObservers)
+    observer->Post(_path, value);
+
+  auto duration = Clock::now() - notificationStart;
+  _pathStats->Add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
 }
 
 
@@ -21,7 +21,10 @@
 #include <memory>
 #include <vector>
 
+#include "notification/BatchObserver.hpp"
 #include "notification/Callback.hpp"
+#include "notification/FieldPredicate.hpp"
+#include "notification/NotificationStats.hpp"
 #include "notification/Path.hpp"
 
 namespace tibee
@@ -39,6 +42,11 @@ namespace notification
 /**
  * Notification sink.
  *
+ * The callbacks of the observers of the path are laid out in a flat
+ * array when the sink is created, in the order of their priority phase
+ * and then of their registration, so that posting a notification is a
+ * single loop over the array.
+ *
  * @author Francois Doray
  */
 class NotificationSink {
@@ -49,13 +57,81 @@ public:
 
     void PostNotification(const value::Value* value) const;
 
+    // Indicates whether at least one observer receives the notifications
+    // posted to this sink.
+    bool HasObservers() const { return !_dispatch.empty() || !_batchObservers.empty(); }
+
 private:
-    NotificationSink(const Path& path,
-                     const CallbackContainers& callbacks);
+    NotificationSink(const Path& path, bool profiling);
     ~NotificationSink();
 
+    // Appends a callback to the dispatch array.
+    // @param stats Profiling counters of the callback, or null.
+    void AddCallback(const Callback& callback,
+                     const PredicateIds& predicateIds,
+                     CallbackStats* stats);
+
+    // Prepares the evaluation of the predicates of the callbacks, once
+    // all the callbacks have been added.
+    // @param predicates Predicates of the notification center.
+    void SetPredicates(const FieldPredicates& predicates);
+
+    void PostNotificationProfiled(const value::Value* value) const;
+
+    void EvaluatePredicates(const value::Value* value) const;
+
+    struct Dispatch
+    {
+        Callback callback;
+
+        // Range of the predicates of the callback in |_dispatchPredicates|.
+        uint32_t predicatesBegin;
+        uint32_t predicatesEnd;
+
+        // Null when profiling is disabled.
+        CallbackStats* stats;
+    };
+
+    bool PredicatesMatch(const Dispatch& dispatch) const
+    {
+        for (uint32_t i = dispatch.predicatesBegin; i < dispatch.predicatesEnd; ++i)
+        {
+            if (!_predicateResults[_dispatchPredicates[i]])
+                return false;
+        }
+        return true;
+    }
+
     Path _path;
-    CallbackContainers _callbacks;
+    std::vector<Dispatch> _dispatch;
+    PredicateIds _dispatchPredicates;
+
+    // Predicates of the callbacks of this sink, each with the index of
+    // the field it reads in |_predicateFields|. Each field is read once.
+    struct SinkPredicate
+    {
+        SinkPredicate(const FieldPredicate& predicate, size_t field, uint32_t id)
+            : predicate(predicate), field(field), id(id) {}
+
+        FieldPredicate predicate;
+        size_t field;
+        uint32_t id;
+    };
+    std::vector<SinkPredicate> _predicates;
+    std::vector<FieldPath> _predicateFields;
+
+    // Scratch space for a notification, indexed like |_predicateFields|
+    // and by predicate id. Sinks are used by a single thread.
+    mutable std::vector<int64_t> _fieldValues;
+    mutable std::vector<char> _fieldPresent;
+    mutable std::vector<char> _predicateResults;
+
+    // Batch observers, which record the notifications after the callbacks
+    // have run.
+    BatchObservers _batchObservers;
+
+    // Profiling counters. Null when profiling is disabled.
+    std::unique_ptr<LatencyStats> _pathStats;
 };
 
 }
@@ -0,0 +1,70 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_NOTIFICATION_NOTIFICATIONSTATS_HPP
+#define _TIBEE_NOTIFICATION_NOTIFICATIONSTATS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tibee
+{
+namespace notification
+{
+
+/**
+ * Call count and latency of an observer or of a notification path.
+ *
+ * @author Francois Doray
+ */
+struct LatencyStats
+{
+    LatencyStats() : count(0), totalNs(0), maxNs(0) {}
+
+    void Add(uint64_t ns)
+    {
+        ++count;
+        totalNs += ns;
+        if (ns > maxNs)
+            maxNs = ns;
+    }
+
+    uint64_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+};
+
+// Profiling counters of an observer.
+struct CallbackStats
+{
+    std::string path;
+    std::string owner;
+    LatencyStats latency;
+};
+
+// Profiling counters of a notification path.
+struct PathStats
+{
+    std::string path;
+    LatencyStats latency;
+};
+
+}
+}
+
+#endif // _TIBEE_NOTIFICATION_NOTIFICATIONSTATS_HPP
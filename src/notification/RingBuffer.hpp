@@ -0,0 +1,257 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_NOTIFICATION_RINGBUFFER_HPP
+#define _TIBEE_NOTIFICATION_RINGBUFFER_HPP
+
+#include <atomic>
+#include <boost/utility.hpp>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tibee
+{
+namespace notification
+{
+
+// Size of a cache line. Indexes that are written by different threads
+// are kept on different cache lines to avoid false sharing.
+const size_t kCacheLineSize = 64;
+
+namespace internal
+{
+
+inline size_t RoundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+}  // namespace internal
+
+/**
+ * Bounded lock-free single-producer single-consumer ring buffer.
+ *
+ * The capacity is rounded up to a power of two. Each side keeps a
+ * cached copy of the index of the other side, so the shared index is
+ * only read when the buffer looks full (producer) or empty (consumer).
+ * Elements are copied in and out of the buffer: they should be small
+ * records rather than owning objects.
+ *
+ * @author Francois Doray
+ */
+template <typename T>
+class SpscRingBuffer :
+    boost::noncopyable
+{
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : _mask(internal::RoundUpToPowerOfTwo(capacity) - 1),
+          _buffer(new T[_mask + 1]),
+          _tail(0),
+          _cachedHead(0),
+          _head(0),
+          _cachedTail(0)
+    {
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+    // Producer side.
+    bool TryPush(const T& item)
+    {
+        return PushBatch(&item, 1) == 1;
+    }
+
+    size_t PushBatch(const T* items, size_t count)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t free = capacity() - (tail - _cachedHead);
+        if (free < count) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            free = capacity() - (tail - _cachedHead);
+        }
+        if (count > free)
+            count = free;
+
+        for (size_t i = 0; i < count; ++i)
+            _buffer[(tail + i) & _mask] = items[i];
+
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side.
+    bool TryPop(T* item)
+    {
+        return PopBatch(item, 1) == 1;
+    }
+
+    size_t PopBatch(T* items, size_t maxCount)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        size_t available = _cachedTail - head;
+        if (available < maxCount) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            available = _cachedTail - head;
+        }
+        if (maxCount > available)
+            maxCount = available;
+
+        for (size_t i = 0; i < maxCount; ++i)
+            items[i] = _buffer[(head + i) & _mask];
+
+        _head.store(head + maxCount, std::memory_order_release);
+        return maxCount;
+    }
+
+private:
+    // Read-only after construction.
+    const size_t _mask;
+    std::unique_ptr<T[]> _buffer;
+
+    // Written by the producer.
+    alignas(kCacheLineSize) std::atomic<size_t> _tail;
+    size_t _cachedHead;
+
+    // Written by the consumer.
+    alignas(kCacheLineSize) std::atomic<size_t> _head;
+    size_t _cachedTail;
+
+    char _padding[kCacheLineSize - sizeof(size_t)];
+};
+
+/**
+ * Bounded lock-free multi-producer multi-consumer ring buffer.
+ *
+ * Each cell carries a sequence number that tells whether it is ready to
+ * be written or read for a given position, as in Dmitry Vyukov's bounded
+ * MPMC queue. The capacity is rounded up to a power of two.
+ *
+ * @author Francois Doray
+ */
+template <typename T>
+class MpmcRingBuffer :
+    boost::noncopyable
+{
+public:
+    explicit MpmcRingBuffer(size_t capacity)
+        : _mask(internal::RoundUpToPowerOfTwo(capacity) - 1),
+          _cells(new Cell[_mask + 1]),
+          _enqueuePos(0),
+          _dequeuePos(0)
+    {
+        for (size_t i = 0; i <= _mask; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+    bool TryPush(const T& item)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) -
+                            static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The buffer is full.
+                return false;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t PushBatch(const T* items, size_t count)
+    {
+        size_t pushed = 0;
+        while (pushed < count && TryPush(items[pushed]))
+            ++pushed;
+        return pushed;
+    }
+
+    bool TryPop(T* item)
+    {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) -
+                            static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The buffer is empty.
+                return false;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        *item = cell->data;
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t PopBatch(T* items, size_t maxCount)
+    {
+        size_t popped = 0;
+        while (popped < maxCount && TryPop(&items[popped]))
+            ++popped;
+        return popped;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // Read-only after construction.
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    alignas(kCacheLineSize) std::atomic<size_t> _enqueuePos;
+    alignas(kCacheLineSize) std::atomic<size_t> _dequeuePos;
+
+    char _padding[kCacheLineSize - sizeof(size_t)];
+};
+
+}
+}
+
+#endif // _TIBEE_NOTIFICATION_RINGBUFFER_HPP
@@ -0,0 +1,163 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "notification/RingBuffer.hpp"
+
+namespace tibee
+{
+namespace notification
+{
+
+TEST(SpscRingBuffer, capacity)
+{
+    SpscRingBuffer<int> buffer(5);
+    EXPECT_EQ(8u, buffer.capacity());
+
+    for (int i = 0; i < 8; ++i)
+        EXPECT_TRUE(buffer.TryPush(i));
+    EXPECT_FALSE(buffer.TryPush(8));
+
+    int value = -1;
+    EXPECT_TRUE(buffer.TryPop(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_TRUE(buffer.TryPush(8));
+
+    for (int i = 1; i <= 8; ++i) {
+        EXPECT_TRUE(buffer.TryPop(&value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(buffer.TryPop(&value));
+}
+
+TEST(SpscRingBuffer, batch)
+{
+    SpscRingBuffer<int> buffer(4);
+
+    int items[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(4u, buffer.PushBatch(items, 6));
+    EXPECT_EQ(0u, buffer.PushBatch(items + 4, 2));
+
+    int popped[6] = {};
+    EXPECT_EQ(3u, buffer.PopBatch(popped, 3));
+    EXPECT_EQ(1, popped[0]);
+    EXPECT_EQ(3, popped[2]);
+
+    // Wrap around the end of the buffer.
+    EXPECT_EQ(2u, buffer.PushBatch(items + 4, 2));
+    EXPECT_EQ(3u, buffer.PopBatch(popped, 6));
+    EXPECT_EQ(4, popped[0]);
+    EXPECT_EQ(5, popped[1]);
+    EXPECT_EQ(6, popped[2]);
+    EXPECT_EQ(0u, buffer.PopBatch(popped, 6));
+}
+
+TEST(SpscRingBuffer, threads)
+{
+    const size_t kNumItems = 100000;
+    SpscRingBuffer<size_t> buffer(64);
+
+    std::thread producer([&]() {
+        for (size_t i = 0; i < kNumItems; ++i) {
+            while (!buffer.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+
+    size_t expected = 0;
+    size_t items[16];
+    while (expected < kNumItems) {
+        size_t count = buffer.PopBatch(items, 16);
+        if (count == 0)
+            std::this_thread::yield();
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(expected, items[i]);
+            ++expected;
+        }
+    }
+
+    producer.join();
+}
+
+TEST(MpmcRingBuffer, capacity)
+{
+    MpmcRingBuffer<int> buffer(3);
+    EXPECT_EQ(4u, buffer.capacity());
+
+    int items[] = {1, 2, 3, 4, 5};
+    EXPECT_EQ(4u, buffer.PushBatch(items, 5));
+    EXPECT_FALSE(buffer.TryPush(5));
+
+    int popped[5] = {};
+    EXPECT_EQ(4u, buffer.PopBatch(popped, 5));
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(i + 1, popped[i]);
+
+    int value = 0;
+    EXPECT_FALSE(buffer.TryPop(&value));
+}
+
+TEST(MpmcRingBuffer, threads)
+{
+    const size_t kNumThreads = 4;
+    const size_t kNumItemsPerThread = 50000;
+    MpmcRingBuffer<size_t> buffer(128);
+
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < kNumThreads; ++t) {
+        producers.push_back(std::thread([&buffer, t, kNumItemsPerThread]() {
+            for (size_t i = 0; i < kNumItemsPerThread; ++i) {
+                while (!buffer.TryPush(t * kNumItemsPerThread + i))
+                    std::this_thread::yield();
+            }
+        }));
+    }
+
+    std::vector<size_t> sums(kNumThreads, 0);
+    std::vector<size_t> counts(kNumThreads, 0);
+    std::vector<std::thread> consumers;
+    for (size_t t = 0; t < kNumThreads; ++t) {
+        consumers.push_back(std::thread([&, t]() {
+            size_t item = 0;
+            while (counts[t] < kNumItemsPerThread) {
+                if (buffer.TryPop(&item)) {
+                    sums[t] += item;
+                    ++counts[t];
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    const size_t kTotal = kNumThreads * kNumItemsPerThread;
+    size_t sum = 0;
+    for (size_t partialSum : sums)
+        sum += partialSum;
+    EXPECT_EQ(kTotal * (kTotal - 1) / 2, sum);
+}
+
+}  // namespace notification
+}  // namespace tibee
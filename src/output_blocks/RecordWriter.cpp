@@ -0,0 +1,489 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "output_blocks/RecordWriter.hpp"
+
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+namespace
+{
+
+// Largest formatted scalar: a double with 17 significant digits, its
+// sign, point and exponent.
+const size_t kMaxScalarSize = 32;
+
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+const char kHexDigits[] = "0123456789abcdef";
+
+bool NeedsCsvQuotes(boost::string_ref str)
+{
+    for (char c : str)
+    {
+        if (c == ',' || c == '"' || c == '\n' || c == '\r')
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+const size_t RecordWriter::kDefaultBufferSize;
+
+RecordWriter::RecordWriter(int fd, RecordFormat format, size_t bufferSize)
+    : _fd(fd),
+      _format(format),
+      _buffer(new char[std::max(bufferSize, 2 * kMaxScalarSize)]),
+      _capacity(std::max(bufferSize, 2 * kMaxScalarSize)),
+      _size(0),
+      _headerWritten(false),
+      _quoteCsv(false),
+      _bytesWritten(0),
+      _failed(false)
+{
+}
+
+RecordWriter::~RecordWriter()
+{
+    Flush();
+}
+
+void RecordWriter::SetColumns(const std::vector<std::string>& columns)
+{
+    assert(!_headerWritten);
+    _columns.clear();
+    for (const auto& column : columns)
+        _columns.emplace_back(column);
+}
+
+void RecordWriter::Write(const notification::Path& path, const value::Value* value)
+{
+    if (_format == RecordFormat::kJsonLines)
+        WriteJsonLine(path, value);
+    else
+        WriteCsvLine(path, value);
+}
+
+bool RecordWriter::Flush()
+{
+    WriteAll(_buffer.get(), _size);
+    _size = 0;
+    return !_failed;
+}
+
+size_t RecordWriter::FormatUnsigned(uint64_t value, char* out)
+{
+    // Format two digits at a time, from the end of a temporary buffer.
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    while (value >= 100)
+    {
+        const char* pair = &kDigitPairs[(value % 100) * 2];
+        value /= 100;
+        *--begin = pair[1];
+        *--begin = pair[0];
+    }
+    if (value >= 10)
+    {
+        const char* pair = &kDigitPairs[value * 2];
+        *--begin = pair[1];
+        *--begin = pair[0];
+    }
+    else
+    {
+        *--begin = static_cast<char>('0' + value);
+    }
+
+    size_t length = end - begin;
+    std::memcpy(out, begin, length);
+    return length;
+}
+
+void RecordWriter::WriteJsonLine(const notification::Path& path, const value::Value* value)
+{
+    Append("{\"path\":\"", 9);
+    AppendPath(path);
+    Append("\",\"value\":", 10);
+    AppendJson(value);
+    Append("}\n", 2);
+}
+
+void RecordWriter::WriteCsvLine(const notification::Path& path, const value::Value* value)
+{
+    if (!_headerWritten)
+        WriteCsvHeader(value);
+
+    AppendPath(path);
+
+    if (_columns.empty())
+    {
+        Append(',');
+        AppendCsvCell(value);
+    }
+    else
+    {
+        const value::StructValue* strct = dynamic_cast<const value::StructValue*>(value);
+        for (const auto& column : _columns)
+        {
+            Append(',');
+            const value::Value* field = nullptr;
+            if (strct != nullptr)
+                field = strct->GetField(column);
+            else if (value != nullptr)
+                field = value->GetField(column.name());
+            if (field != nullptr)
+                AppendCsvCell(field);
+        }
+    }
+    Append('\n');
+}
+
+void RecordWriter::WriteCsvHeader(const value::Value* firstValue)
+{
+    _headerWritten = true;
+
+    if (_columns.empty() && value::StructValueBase::InstanceOf(firstValue))
+    {
+        auto strct = value::StructValueBase::Cast(firstValue);
+        auto end = strct->fields_end();
+        for (auto it = strct->fields_begin(); it != end; ++it)
+            _columns.emplace_back(it->first);
+    }
+
+    Append("path", 4);
+    if (_columns.empty())
+    {
+        Append(",value", 6);
+    }
+    else
+    {
+        for (const auto& column : _columns)
+        {
+            Append(',');
+            AppendCsvString(column.name());
+        }
+    }
+    Append('\n');
+}
+
+void RecordWriter::AppendPath(const notification::Path& path)
+{
+    // Path tokens are plain identifiers: they are written without escaping.
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        if (i != 0)
+            Append('/');
+        const std::string& token = path[i].token();
+        Append(token.data(), token.size());
+    }
+}
+
+void RecordWriter::AppendJson(const value::Value* value)
+{
+    if (value == nullptr)
+    {
+        Append("null", 4);
+        return;
+    }
+
+    switch (value->GetType())
+    {
+    case value::VALUE_STRING:
+    case value::VALUE_STRING_VIEW:
+        AppendJsonString(value->AsStringView());
+        break;
+    case value::VALUE_WSTRING:
+        AppendJsonString(value->AsString());
+        break;
+    case value::VALUE_ARRAY:
+    {
+        auto array = value::ArrayValueBase::Cast(value);
+        Append('[');
+        for (size_t i = 0; i < array->Length(); ++i)
+        {
+            if (i != 0)
+                Append(',');
+            AppendJson(array->at(i));
+        }
+        Append(']');
+        break;
+    }
+    case value::VALUE_STRUCT:
+    {
+        auto strct = value::StructValueBase::Cast(value);
+        Append('{');
+        bool first = true;
+        auto end = strct->fields_end();
+        for (auto it = strct->fields_begin(); it != end; ++it)
+        {
+            if (!first)
+                Append(',');
+            first = false;
+            AppendJsonString(it->first);
+            Append(':');
+            AppendJson(it->second);
+        }
+        Append('}');
+        break;
+    }
+    case value::VALUE_FLOAT:
+    case value::VALUE_DOUBLE:
+    {
+        // JSON has no representation for NaN and infinities.
+        double doubleValue = value->AsFloating();
+        if (!std::isfinite(doubleValue))
+            Append("null", 4);
+        else
+            AppendScalar(value);
+        break;
+    }
+    default:
+        AppendScalar(value);
+        break;
+    }
+}
+
+void RecordWriter::AppendJsonString(boost::string_ref str)
+{
+    Append('"');
+    const char* run = str.data();
+    const char* end = str.data() + str.size();
+    for (const char* c = run; c != end; ++c)
+    {
+        unsigned char uc = static_cast<unsigned char>(*c);
+        if (uc >= 0x20 && uc != '"' && uc != '\\')
+            continue;
+
+        // Copy the characters that don't need escaping in one block.
+        Append(run, c - run);
+        run = c + 1;
+        switch (*c)
+        {
+        case '"': Append("\\\"", 2); break;
+        case '\\': Append("\\\\", 2); break;
+        case '\n': Append("\\n", 2); break;
+        case '\r': Append("\\r", 2); break;
+        case '\t': Append("\\t", 2); break;
+        default:
+        {
+            char escape[6] = {'\\', 'u', '0', '0', kHexDigits[uc >> 4], kHexDigits[uc & 0xF]};
+            Append(escape, sizeof(escape));
+        }
+        }
+    }
+    Append(run, end - run);
+    Append('"');
+}
+
+void RecordWriter::AppendCsvCell(const value::Value* value)
+{
+    if (value->IsScalar())
+    {
+        boost::string_ref str;
+        if (value->AsStringView(&str))
+            AppendCsvString(str);
+        else if (value->GetType() == value::VALUE_WSTRING)
+            AppendCsvString(value->AsString());
+        else
+            AppendScalar(value);
+        return;
+    }
+
+    // Aggregates are written as JSON in a quoted cell.
+    Append('"');
+    _quoteCsv = true;
+    AppendJson(value);
+    _quoteCsv = false;
+    Append('"');
+}
+
+void RecordWriter::AppendCsvString(boost::string_ref str)
+{
+    if (!NeedsCsvQuotes(str))
+    {
+        Append(str.data(), str.size());
+        return;
+    }
+    Append('"');
+    _quoteCsv = true;
+    Append(str.data(), str.size());
+    _quoteCsv = false;
+    Append('"');
+}
+
+void RecordWriter::AppendScalar(const value::Value* value)
+{
+    switch (value->GetType())
+    {
+    case value::VALUE_BOOL:
+        if (value::BoolValue::GetValue(value))
+            Append("true", 4);
+        else
+            Append("false", 5);
+        break;
+    case value::VALUE_CHAR:
+    case value::VALUE_SHORT:
+    case value::VALUE_INT:
+    case value::VALUE_LONG:
+        AppendSigned(value->AsLong());
+        break;
+    case value::VALUE_UCHAR:
+    case value::VALUE_USHORT:
+    case value::VALUE_UINT:
+    case value::VALUE_ULONG:
+        AppendUnsigned(value->AsULong());
+        break;
+    case value::VALUE_FLOAT:
+        AppendDouble(value::FloatValue::GetValue(value), 9);
+        break;
+    case value::VALUE_DOUBLE:
+        AppendDouble(value::DoubleValue::GetValue(value), 17);
+        break;
+    default:
+        break;
+    }
+}
+
+void RecordWriter::AppendUnsigned(uint64_t value)
+{
+    char* out = Reserve(kMaxScalarSize);
+    _size += FormatUnsigned(value, out);
+}
+
+void RecordWriter::AppendSigned(int64_t value)
+{
+    char* out = Reserve(kMaxScalarSize);
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    size_t length = 0;
+    if (value < 0)
+    {
+        out[length++] = '-';
+        magnitude = 0 - magnitude;
+    }
+    length += FormatUnsigned(magnitude, out + length);
+    _size += length;
+}
+
+void RecordWriter::AppendDouble(double value, int precision)
+{
+    // Integral values are common (counts, timestamps) and much cheaper to
+    // format as integers.
+    if (value == std::floor(value) && std::fabs(value) < 1e15)
+    {
+        AppendSigned(static_cast<int64_t>(value));
+        return;
+    }
+    char* out = Reserve(kMaxScalarSize);
+    int length = snprintf(out, kMaxScalarSize, "%.*g", precision, value);
+    if (length > 0)
+        _size += std::min(static_cast<size_t>(length), kMaxScalarSize - 1);
+}
+
+char* RecordWriter::Reserve(size_t size)
+{
+    if (_capacity - _size < size)
+        Flush();
+    return _buffer.get() + _size;
+}
+
+void RecordWriter::Append(const char* data, size_t size)
+{
+    if (_quoteCsv)
+    {
+        // Double the quotes, one run at a time.
+        const char* quote = static_cast<const char*>(std::memchr(data, '"', size));
+        while (quote != nullptr)
+        {
+            size_t runLength = quote - data + 1;
+            _quoteCsv = false;
+            Append(data, runLength);
+            Append('"');
+            _quoteCsv = true;
+            data += runLength;
+            size -= runLength;
+            quote = static_cast<const char*>(std::memchr(data, '"', size));
+        }
+    }
+
+    if (_capacity - _size < size)
+    {
+        Flush();
+        // Blocks larger than the buffer are written directly.
+        if (size > _capacity)
+        {
+            WriteAll(data, size);
+            return;
+        }
+    }
+    std::memcpy(_buffer.get() + _size, data, size);
+    _size += size;
+}
+
+void RecordWriter::Append(char c)
+{
+    if (_size == _capacity)
+        Flush();
+    _buffer[_size++] = c;
+    if (_quoteCsv && c == '"')
+    {
+        _quoteCsv = false;
+        Append(c);
+        _quoteCsv = true;
+    }
+}
+
+void RecordWriter::WriteAll(const char* data, size_t size)
+{
+    while (size != 0 && !_failed)
+    {
+        ssize_t written = ::write(_fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            _failed = true;
+            break;
+        }
+        data += written;
+        size -= written;
+        _bytesWritten += written;
+    }
+}
+
+}
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_OUTPUTBLOCKS_RECORDWRITER_HPP
+#define _TIBEE_OUTPUTBLOCKS_RECORDWRITER_HPP
+
+#include <boost/noncopyable.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "notification/Path.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+enum class RecordFormat
+{
+    kJsonLines,
+    kCsv,
+};
+
+/**
+ * Writes notifications to a file descriptor, one record per line.
+ *
+ * In JSON Lines, a record is {"path":"<path>","value":<value>}. In CSV,
+ * a record is the path followed by one cell per column: the columns are
+ * fields of struct values, and a header line names them. Values that
+ * are not structs are written in a single "value" column, and aggregate
+ * cells are written as JSON.
+ *
+ * Records are formatted directly in a large buffer, without iostreams
+ * or intermediate strings, and the buffer is written with write(2) when
+ * it is full.
+ *
+ * @author Francois Doray
+ */
+class RecordWriter :
+    boost::noncopyable
+{
+public:
+    static const size_t kDefaultBufferSize = 1 << 20;
+
+    /**
+     * @param fd The file descriptor to write to. It isn't closed by the
+     *     writer.
+     * @param format The format of the records.
+     * @param bufferSize The size of the buffer.
+     */
+    RecordWriter(int fd, RecordFormat format,
+                 size_t bufferSize = kDefaultBufferSize);
+
+    // Flushes the buffer.
+    ~RecordWriter();
+
+    /**
+     * Sets the CSV columns. Without this, the columns are the fields of
+     * the first record. The header line is written with the first record.
+     */
+    void SetColumns(const std::vector<std::string>& columns);
+
+    void Write(const notification::Path& path, const value::Value* value);
+
+    /**
+     * Writes the buffered records.
+     *
+     * @returns false if a write failed, now or before.
+     */
+    bool Flush();
+
+    bool failed() const { return _failed; }
+    uint64_t bytesWritten() const { return _bytesWritten + _size; }
+
+    /**
+     * Formats an unsigned integer in decimal.
+     *
+     * @param out Receives the digits. Must have room for 20 characters.
+     * @returns The number of digits.
+     */
+    static size_t FormatUnsigned(uint64_t value, char* out);
+
+private:
+    void WriteJsonLine(const notification::Path& path, const value::Value* value);
+    void WriteCsvLine(const notification::Path& path, const value::Value* value);
+    void WriteCsvHeader(const value::Value* firstValue);
+
+    void AppendPath(const notification::Path& path);
+    void AppendJson(const value::Value* value);
+    void AppendJsonString(boost::string_ref str);
+    void AppendCsvCell(const value::Value* value);
+    void AppendCsvString(boost::string_ref str);
+    void AppendScalar(const value::Value* value);
+    void AppendUnsigned(uint64_t value);
+    void AppendSigned(int64_t value);
+    void AppendDouble(double value, int precision);
+
+    // Makes room for |size| bytes in the buffer.
+    char* Reserve(size_t size);
+    void Append(const char* data, size_t size);
+    void Append(char c);
+    void WriteAll(const char* data, size_t size);
+
+    int _fd;
+    RecordFormat _format;
+
+    std::unique_ptr<char[]> _buffer;
+    size_t _capacity;
+    size_t _size;
+
+    // CSV columns, empty until they are known.
+    bool _headerWritten;
+    std::vector<value::StructValue::Key> _columns;
+
+    // True while an aggregate is written in a quoted CSV cell: quotes
+    // are doubled.
+    bool _quoteCsv;
+
+    uint64_t _bytesWritten;
+    bool _failed;
+};
+
+}
+}
+
+#endif // _TIBEE_OUTPUTBLOCKS_RECORDWRITER_HPP
@@ -0,0 +1,213 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <limits>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "notification/Token.hpp"
+#include "output_blocks/RecordWriter.hpp"
+#include "value/MakeValue.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+using notification::Path;
+using notification::Token;
+
+namespace
+{
+
+// Reads the content of a temporary file.
+std::string ReadFile(FILE* file)
+{
+    fflush(file);
+    rewind(file);
+    std::string content;
+    char buffer[4096];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+        content.append(buffer, size);
+    return content;
+}
+
+value::StructValue::UP MakeStruct()
+{
+    value::StructValue::UP strct(new value::StructValue);
+    strct->AddField<value::IntValue>("tid", -42);
+    strct->AddField<value::StringValue>("name", "ls, \"a\"");
+    strct->AddField<value::DoubleValue>("ratio", 0.5);
+    return strct;
+}
+
+}  // namespace
+
+TEST(RecordWriter, FormatUnsigned)
+{
+    char out[20];
+    EXPECT_EQ("0", std::string(out, RecordWriter::FormatUnsigned(0, out)));
+    EXPECT_EQ("7", std::string(out, RecordWriter::FormatUnsigned(7, out)));
+    EXPECT_EQ("10", std::string(out, RecordWriter::FormatUnsigned(10, out)));
+    EXPECT_EQ("123", std::string(out, RecordWriter::FormatUnsigned(123, out)));
+    EXPECT_EQ("18446744073709551615",
+              std::string(out, RecordWriter::FormatUnsigned(
+                  std::numeric_limits<uint64_t>::max(), out)));
+}
+
+TEST(RecordWriter, JsonLines)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        RecordWriter writer(fileno(file), RecordFormat::kJsonLines);
+        Path path = {Token("analysis"), Token("syscall")};
+
+        auto strct = MakeStruct();
+        value::ArrayValue::UP array(new value::ArrayValue);
+        array->Append<value::ULongValue>(std::numeric_limits<uint64_t>::max());
+        array->Append<value::BoolValue>(true);
+        strct->AddField("array", std::move(array));
+        writer.Write(path, strct.get());
+
+        value::StringValue str("tab\there\x01");
+        writer.Write(path, &str);
+
+        value::DoubleValue nan(std::numeric_limits<double>::quiet_NaN());
+        writer.Write({Token("x")}, &nan);
+    }
+
+    EXPECT_EQ(
+        "{\"path\":\"analysis/syscall\",\"value\":{\"tid\":-42,"
+        "\"name\":\"ls, \\\"a\\\"\",\"ratio\":0.5,"
+        "\"array\":[18446744073709551615,true]}}\n"
+        "{\"path\":\"analysis/syscall\",\"value\":\"tab\\there\\u0001\"}\n"
+        "{\"path\":\"x\",\"value\":null}\n",
+        ReadFile(file));
+    fclose(file);
+}
+
+TEST(RecordWriter, Csv)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        RecordWriter writer(fileno(file), RecordFormat::kCsv);
+        Path path = {Token("a")};
+
+        auto first = MakeStruct();
+        writer.Write(path, first.get());
+
+        // Missing fields are empty, extra fields are ignored and
+        // aggregates are written as JSON.
+        value::StructValue second;
+        second.AddField<value::StringValue>("name", "plain");
+        second.AddField<value::DoubleValue>("ratio", 2.0);
+        second.AddField("extra", value::MakeValue(1));
+        value::ArrayValue::UP array(new value::ArrayValue);
+        array->Append<value::StringValue>("q");
+        second.AddField("tid", std::move(array));
+        writer.Write(path, &second);
+    }
+
+    EXPECT_EQ(
+        "path,tid,name,ratio\n"
+        "a,-42,\"ls, \"\"a\"\"\",0.5\n"
+        "a,\"[\"\"q\"\"]\",plain,2\n",
+        ReadFile(file));
+    fclose(file);
+}
+
+TEST(RecordWriter, CsvColumnsAndScalars)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    {
+        RecordWriter writer(fileno(file), RecordFormat::kCsv);
+        writer.SetColumns({"ratio", "value"});
+
+        auto strct = MakeStruct();
+        writer.Write({Token("a")}, strct.get());
+    }
+    {
+        RecordWriter writer(fileno(file), RecordFormat::kCsv);
+        value::FloatValue value(1.25f);
+        writer.Write({Token("b"), Token("c")}, &value);
+    }
+
+    EXPECT_EQ(
+        "path,ratio,value\n"
+        "a,0.5,\n"
+        "path,value\n"
+        "b/c,1.25\n",
+        ReadFile(file));
+    fclose(file);
+}
+
+TEST(RecordWriter, SmallBuffer)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+
+    std::string expected;
+    uint64_t bytesWritten = 0;
+    {
+        // Records are larger than the buffer.
+        RecordWriter writer(fileno(file), RecordFormat::kJsonLines, 16);
+        value::StringValue str(std::string(100, 'x'));
+        for (int i = 0; i < 10; ++i)
+        {
+            value::IntValue value(i);
+            writer.Write({Token("int")}, &value);
+            expected += "{\"path\":\"int\",\"value\":" + std::to_string(i) + "}\n";
+            writer.Write({Token("str")}, &str);
+            expected += "{\"path\":\"str\",\"value\":\"" + std::string(100, 'x') + "\"}\n";
+        }
+        EXPECT_TRUE(writer.Flush());
+        EXPECT_FALSE(writer.failed());
+        bytesWritten = writer.bytesWritten();
+    }
+
+    EXPECT_EQ(expected.size(), bytesWritten);
+    EXPECT_EQ(expected, ReadFile(file));
+    fclose(file);
+}
+
+TEST(RecordWriter, WriteError)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    int fd = dup(fileno(file));
+    close(fd);
+
+    RecordWriter writer(fd, RecordFormat::kJsonLines);
+    value::IntValue value(1);
+    writer.Write({Token("a")}, &value);
+    EXPECT_FALSE(writer.Flush());
+    EXPECT_TRUE(writer.failed());
+    fclose(file);
+}
+
+}  // namespace output_blocks
+}  // namespace tibee
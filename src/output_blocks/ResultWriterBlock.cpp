@@ -0,0 +1,181 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "output_blocks/ResultWriterBlock.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "base/print.hpp"
+#include "notification/Callback.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "notification/Token.hpp"
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+using base::tbendl;
+using base::tberror;
+using notification::Token;
+
+namespace
+{
+
+notification::Path ParsePath(const std::string& str)
+{
+    notification::Path path;
+    size_t begin = 0;
+    while (begin <= str.size())
+    {
+        size_t end = str.find('/', begin);
+        if (end == std::string::npos)
+            end = str.size();
+        std::string token = str.substr(begin, end - begin);
+        if (token == "*")
+            path.push_back(notification::AnyToken());
+        else
+            path.push_back(Token(token));
+        begin = end + 1;
+    }
+    return path;
+}
+
+}  // namespace
+
+ResultWriterBlock::ResultWriterBlock()
+    : _fd(-1),
+      _ownsFd(false)
+{
+}
+
+ResultWriterBlock::~ResultWriterBlock()
+{
+    Close();
+}
+
+void ResultWriterBlock::Start(const value::Value* parameters)
+{
+    std::string output = "-";
+    std::string format = "json";
+    const value::ArrayValueBase* notifications = nullptr;
+    const value::ArrayValueBase* columns = nullptr;
+    if (parameters != nullptr)
+    {
+        const value::Value* field = nullptr;
+        if (parameters->GetField("output", &field))
+            output = field->AsString();
+        if (parameters->GetField("format", &field))
+            format = field->AsString();
+        parameters->GetFieldAs("notifications", &notifications);
+        parameters->GetFieldAs("columns", &columns);
+    }
+
+    RecordFormat recordFormat = RecordFormat::kJsonLines;
+    if (format == "csv")
+    {
+        recordFormat = RecordFormat::kCsv;
+    }
+    else if (format != "json")
+    {
+        tberror() << "Unknown output format " << format << "." << tbendl();
+        return;
+    }
+
+    if (output == "-")
+    {
+        _fd = STDOUT_FILENO;
+        _ownsFd = false;
+    }
+    else
+    {
+        _fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0)
+        {
+            tberror() << "Could not open " << output << ": "
+                      << strerror(errno) << "." << tbendl();
+            return;
+        }
+        _ownsFd = true;
+    }
+
+    _writer.reset(new RecordWriter(_fd, recordFormat));
+
+    if (columns != nullptr)
+    {
+        std::vector<std::string> columnNames;
+        for (const auto& column : *columns)
+            columnNames.push_back(column.AsString());
+        _writer->SetColumns(columnNames);
+    }
+
+    if (notifications != nullptr)
+    {
+        for (const auto& notification : *notifications)
+            _paths.push_back(ParsePath(notification.AsString()));
+    }
+}
+
+void ResultWriterBlock::AddObservers(notification::NotificationCenter* notificationCenter)
+{
+    if (!_writer)
+        return;
+
+    notificationCenter->SetObserverPriority(notification::ObserverPriority::kOutput);
+    for (const auto& path : _paths)
+    {
+        notificationCenter->AddObserver(
+            path, notification::Callback::Bind<ResultWriterBlock, &ResultWriterBlock::onNotification>(this));
+    }
+}
+
+void ResultWriterBlock::Stop()
+{
+    // Blocks that are stopped after this one can still post results, e.g.
+    // the reports of the analysis blocks: the file is closed when the
+    // block is destroyed.
+    Flush();
+}
+
+void ResultWriterBlock::onNotification(const notification::Path& path, const value::Value* value)
+{
+    if (!_writer)
+        return;
+    _writer->Write(path, value);
+}
+
+void ResultWriterBlock::Flush()
+{
+    if (_writer && !_writer->Flush())
+        tberror() << "Could not write the results: " << strerror(errno) << "." << tbendl();
+}
+
+void ResultWriterBlock::Close()
+{
+    Flush();
+    _writer.reset();
+    if (_ownsFd)
+        ::close(_fd);
+    _fd = -1;
+    _ownsFd = false;
+}
+
+}
+}
@@ -0,0 +1,79 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_OUTPUTBLOCKS_RESULTWRITERBLOCK_HPP
+#define _TIBEE_OUTPUTBLOCKS_RESULTWRITERBLOCK_HPP
+
+#include <memory>
+#include <vector>
+
+#include "block/AbstractBlock.hpp"
+#include "notification/Path.hpp"
+#include "output_blocks/RecordWriter.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+/**
+ * A block that writes notifications to a file, one record per line.
+ *
+ * Parameters:
+ *   output:        Optional. Path of the output file, or "-" for the
+ *                  standard output (default).
+ *   format:        Optional. "json" for JSON Lines (default) or "csv".
+ *   notifications: Array of notification paths to write. The tokens of
+ *                  a path are separated by '/', and "*" matches any
+ *                  token.
+ *   columns:       Optional. Array of CSV columns. By default, the
+ *                  columns are the fields of the first notification.
+ *
+ * The records are flushed when the block is stopped. The file stays open
+ * until the block is destroyed, so that the results posted by the blocks
+ * stopped after it are written too.
+ *
+ * @author Francois Doray
+ */
+class ResultWriterBlock : public block::AbstractBlock
+{
+public:
+    ResultWriterBlock();
+    ~ResultWriterBlock();
+
+    virtual void Start(const value::Value* parameters) override;
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
+    virtual void Stop() override;
+
+private:
+    void onNotification(const notification::Path& path, const value::Value* value);
+    void Flush();
+    void Close();
+
+    int _fd;
+    bool _ownsFd;
+    std::unique_ptr<RecordWriter> _writer;
+
+    // Paths of the notifications to write.
+    std::vector<notification::Path> _paths;
+};
+
+}
+}
+
+#endif // _TIBEE_OUTPUTBLOCKS_RESULTWRITERBLOCK_HPP
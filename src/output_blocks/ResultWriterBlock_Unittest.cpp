@@ -0,0 +1,103 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "block/AbstractBlock.hpp"
+#include "block/BlockRunner.hpp"
+#include "notification/NotificationCenter.hpp"
+#include "notification/NotificationSink.hpp"
+#include "notification/Token.hpp"
+#include "output_blocks/ResultWriterBlock.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace output_blocks
+{
+
+namespace
+{
+
+// A block that posts a report when it is stopped, like an analysis block.
+class ReportBlock : public block::AbstractBlock
+{
+public:
+    ReportBlock() : _sink(nullptr) {}
+
+    virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override
+    {
+        _sink = notificationCenter->GetSink({
+            notification::Token("analysis"), notification::Token("report")
+        });
+    }
+
+    virtual void Stop() override
+    {
+        value::IntValue report {42};
+        _sink->PostNotification(&report);
+    }
+
+private:
+    const notification::NotificationSink* _sink;
+};
+
+std::string ReadFile(const std::string& path)
+{
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+}  // namespace
+
+TEST(ResultWriterBlock, PostAfterStop)
+{
+    char path[] = "/tmp/ResultWriterBlock_UnittestXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_LE(0, fd);
+    close(fd);
+
+    value::StructValue parameters;
+    parameters.AddField<value::StringValue>("output", path);
+    value::ArrayValue::UP notifications {new value::ArrayValue};
+    notifications->Append<value::StringValue>("analysis/*");
+    parameters.AddField("notifications", std::move(notifications));
+
+    {
+        // The writer is stopped before the block that posts the report.
+        ResultWriterBlock writerBlock;
+        ReportBlock reportBlock;
+
+        block::BlockRunner blockRunner;
+        blockRunner.AddBlock(&writerBlock, &parameters);
+        blockRunner.AddBlock(&reportBlock, nullptr);
+        blockRunner.Run();
+    }
+
+    EXPECT_EQ("{\"path\":\"analysis/report\",\"value\":42}\n", ReadFile(path));
+    unlink(path);
+}
+
+}  // namespace output_blocks
+}  // namespace tibee
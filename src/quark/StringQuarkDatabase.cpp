@@ -33,8 +33,18 @@ StringQuarkDatabase::StringQuarkDatabase()
         StrQuark(std::to_string(i));
 }
 
+void StringQuarkDatabase::EnableLocking()
+{
+    _mutex.reset(new std::mutex);
+}
+
 const Quark& StringQuarkDatabase::StrQuark(const std::string& str)
 {
+    if (_mutex != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(*_mutex);
+        return _quarks.Insert(str);
+    }
     return _quarks.Insert(str);
 }
 
@@ -47,6 +57,11 @@ Quark StringQuarkDatabase::IntQuark(int value)
 
 const std::string& StringQuarkDatabase::String(const Quark& quark) const
 {
+    if (_mutex != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(*_mutex);
+        return _quarks.ValueOf(quark);
+    }
     return _quarks.ValueOf(quark);
 }
 
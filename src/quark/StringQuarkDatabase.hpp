@@ -20,6 +20,7 @@
 
 #include <boost/noncopyable.hpp>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "quark/QuarkDatabase.hpp"
@@ -37,6 +38,13 @@ public:
 
     StringQuarkDatabase();
 
+    /*
+     * Protects the database with a mutex, so that it can be shared by
+     * analyses running on different threads. Must be called before the
+     * database is shared.
+     */
+    void EnableLocking();
+
     /*
      * Inserts a value in the database if it's not already present and returns
      * its quark.
@@ -69,6 +77,9 @@ public:
 
 private:
     QuarkDatabase<std::string> _quarks;
+
+    // Null unless locking is enabled.
+    std::unique_ptr<std::mutex> _mutex;
 };
 
 }
@@ -0,0 +1,255 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sequence/SequenceAligner.hpp"
+
+#include <algorithm>
+
+#include "base/OpenHashMap.hpp"
+
+namespace tibee
+{
+namespace sequence
+{
+
+namespace
+{
+
+const uint32_t kNoRow = static_cast<uint32_t>(-1);
+
+// Ranges with fewer cells than this are aligned with the quadratic
+// algorithm rather than split further.
+const size_t kDirectCells = 1 << 14;
+
+const size_t kWordBits = 64;
+
+}  // namespace
+
+SequenceAligner::SequenceAligner()
+    : _numSymbols(0)
+{
+}
+
+size_t SequenceAligner::LcsLength(const Sequence& left, const Sequence& right)
+{
+    ToSymbols(left, right);
+    ComputeScores(0, _left.size(), 0, _right.size(), false, &_forward);
+    return _forward.back();
+}
+
+size_t SequenceAligner::Align(const Sequence& left, const Sequence& right,
+                              Alignment* alignment)
+{
+    alignment->clear();
+    ToSymbols(left, right);
+    AlignRange(0, _left.size(), 0, _right.size(), alignment);
+    return alignment->size();
+}
+
+void SequenceAligner::ToSymbols(const Sequence& left, const Sequence& right)
+{
+    base::OpenHashMap<quark::Quark::quark_t, symbol_t> symbols;
+
+    _left.resize(left.size());
+    for (size_t i = 0; i < left.size(); ++i)
+        _left[i] = *symbols.Insert(left[i].get(), symbols.size()).first;
+
+    _right.resize(right.size());
+    for (size_t i = 0; i < right.size(); ++i)
+        _right[i] = *symbols.Insert(right[i].get(), symbols.size()).first;
+
+    _numSymbols = symbols.size();
+    _rowOfSymbol.assign(_numSymbols, kNoRow);
+}
+
+void SequenceAligner::ComputeScores(size_t l0, size_t l1, size_t r0, size_t r1,
+                                    bool backward, std::vector<uint32_t>* scores)
+{
+    const size_t length = r1 - r0;
+    const size_t numWords = (length + kWordBits - 1) / kWordBits;
+
+    // Bit k of the masks stands for the k-th element of the right range,
+    // counted from the end when going backward.
+    uint32_t numRows = 0;
+    for (size_t k = 0; k < length; ++k)
+    {
+        symbol_t symbol = backward ? _right[r1 - 1 - k] : _right[r0 + k];
+        if (_rowOfSymbol[symbol] == kNoRow)
+            _rowOfSymbol[symbol] = numRows++;
+    }
+    _masks.assign(numRows * numWords, 0);
+    for (size_t k = 0; k < length; ++k)
+    {
+        symbol_t symbol = backward ? _right[r1 - 1 - k] : _right[r0 + k];
+        _masks[_rowOfSymbol[symbol] * numWords + k / kWordBits] |=
+            uint64_t(1) << (k % kWordBits);
+    }
+
+    // A zero bit in |_row| means that the LCS length increases at this
+    // column. Elements of the left range that don't appear in the right
+    // range leave the row unchanged.
+    _row.assign(numWords, ~uint64_t(0));
+    const size_t numElements = l1 - l0;
+    for (size_t i = 0; i < numElements; ++i)
+    {
+        symbol_t symbol = backward ? _left[l1 - 1 - i] : _left[l0 + i];
+        uint32_t row = _rowOfSymbol[symbol];
+        if (row == kNoRow)
+            continue;
+
+        const uint64_t* mask = &_masks[row * numWords];
+        uint64_t carry = 0;
+        for (size_t w = 0; w < numWords; ++w)
+        {
+            uint64_t v = _row[w];
+            uint64_t u = v & mask[w];
+            uint64_t sum = v + u;
+            uint64_t nextCarry = sum < v;
+            sum += carry;
+            nextCarry |= sum < carry;
+            carry = nextCarry;
+            _row[w] = sum | (v & ~u);
+        }
+    }
+
+    scores->resize(length + 1);
+    uint32_t score = 0;
+    (*scores)[0] = 0;
+    for (size_t k = 0; k < length; ++k)
+    {
+        if ((_row[k / kWordBits] & (uint64_t(1) << (k % kWordBits))) == 0)
+            ++score;
+        (*scores)[k + 1] = score;
+    }
+
+    for (size_t k = r0; k < r1; ++k)
+        _rowOfSymbol[_right[k]] = kNoRow;
+}
+
+void SequenceAligner::AlignRange(size_t l0, size_t l1, size_t r0, size_t r1,
+                                 Alignment* alignment)
+{
+    // Common prefix and suffix.
+    while (l0 < l1 && r0 < r1 && _left[l0] == _right[r0])
+    {
+        alignment->push_back(Match(l0, r0));
+        ++l0;
+        ++r0;
+    }
+    size_t suffix = 0;
+    while (l0 < l1 - suffix && r0 < r1 - suffix &&
+           _left[l1 - 1 - suffix] == _right[r1 - 1 - suffix])
+    {
+        ++suffix;
+    }
+    l1 -= suffix;
+    r1 -= suffix;
+
+    if (l0 == l1 || r0 == r1)
+    {
+        // Nothing left to align.
+    }
+    else if (l1 - l0 == 1)
+    {
+        for (size_t r = r0; r < r1; ++r)
+        {
+            if (_right[r] == _left[l0])
+            {
+                alignment->push_back(Match(l0, r));
+                break;
+            }
+        }
+    }
+    else if ((l1 - l0) * (r1 - r0) <= kDirectCells)
+    {
+        AlignDirect(l0, l1, r0, r1, alignment);
+    }
+    else
+    {
+        // Find the column where an optimal alignment crosses the
+        // middle row of the left range.
+        size_t middle = l0 + (l1 - l0) / 2;
+        ComputeScores(l0, middle, r0, r1, false, &_forward);
+        ComputeScores(middle, l1, r0, r1, true, &_backward);
+
+        const size_t length = r1 - r0;
+        size_t split = 0;
+        uint32_t best = 0;
+        for (size_t k = 0; k <= length; ++k)
+        {
+            uint32_t score = _forward[k] + _backward[length - k];
+            if (score > best)
+            {
+                best = score;
+                split = k;
+            }
+        }
+
+        AlignRange(l0, middle, r0, r0 + split, alignment);
+        AlignRange(middle, l1, r0 + split, r1, alignment);
+    }
+
+    for (size_t k = 0; k < suffix; ++k)
+        alignment->push_back(Match(l1 + k, r1 + k));
+}
+
+void SequenceAligner::AlignDirect(size_t l0, size_t l1, size_t r0, size_t r1,
+                                  Alignment* alignment)
+{
+    const size_t rows = l1 - l0 + 1;
+    const size_t columns = r1 - r0 + 1;
+    _direct.assign(rows * columns, 0);
+
+    for (size_t i = 1; i < rows; ++i)
+    {
+        for (size_t j = 1; j < columns; ++j)
+        {
+            uint32_t* cell = &_direct[i * columns + j];
+            if (_left[l0 + i - 1] == _right[r0 + j - 1])
+                *cell = _direct[(i - 1) * columns + j - 1] + 1;
+            else
+                *cell = std::max(_direct[(i - 1) * columns + j],
+                                 _direct[i * columns + j - 1]);
+        }
+    }
+
+    // Walk back from the last cell, then put the matches in order.
+    const size_t first = alignment->size();
+    size_t i = rows - 1;
+    size_t j = columns - 1;
+    while (i > 0 && j > 0)
+    {
+        if (_left[l0 + i - 1] == _right[r0 + j - 1])
+        {
+            alignment->push_back(Match(l0 + i - 1, r0 + j - 1));
+            --i;
+            --j;
+        }
+        else if (_direct[(i - 1) * columns + j] >= _direct[i * columns + j - 1])
+        {
+            --i;
+        }
+        else
+        {
+            --j;
+        }
+    }
+    std::reverse(alignment->begin() + first, alignment->end());
+}
+
+}
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_SEQUENCE_SEQUENCEALIGNER_HPP
+#define _TIBEE_SEQUENCE_SEQUENCEALIGNER_HPP
+
+#include <boost/noncopyable.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "quark/Quark.hpp"
+
+namespace tibee
+{
+namespace sequence
+{
+
+typedef std::vector<quark::Quark> Sequence;
+
+// A pair of positions holding the same symbol in the left and right sequences.
+struct Match
+{
+    Match() : left(0), right(0) {}
+    Match(size_t left, size_t right) : left(left), right(right) {}
+
+    bool operator==(const Match& other) const
+    {
+        return left == other.left && right == other.right;
+    }
+
+    size_t left;
+    size_t right;
+};
+
+typedef std::vector<Match> Alignment;
+
+/**
+ * Aligns two sequences of quarks, e.g. the system calls made by a
+ * thread in two executions of the same task.
+ *
+ * The alignment is a longest common subsequence. Its length is computed
+ * with the bit-parallel algorithm of Allison-Dix / Hyyro: each row of
+ * the dynamic programming matrix is encoded as one bit per element of
+ * the right sequence, and is updated 64 elements at a time with an
+ * addition. The matched pairs are recovered with Hirschberg's
+ * divide-and-conquer, which runs the bit-parallel kernel forward on the
+ * first half of the left sequence and backward on the second half to
+ * find where the alignment crosses the middle row. Memory stays linear
+ * in the length of the sequences, so sequences of millions of elements
+ * can be aligned.
+ *
+ * An aligner keeps its working buffers between calls.
+ *
+ * @author Francois Doray
+ */
+class SequenceAligner :
+    boost::noncopyable
+{
+public:
+    SequenceAligner();
+
+    /**
+     * Computes the length of a longest common subsequence.
+     *
+     * @param left Left sequence.
+     * @param right Right sequence.
+     * @returns The length of a longest common subsequence.
+     */
+    size_t LcsLength(const Sequence& left, const Sequence& right);
+
+    /**
+     * Computes a longest common subsequence.
+     *
+     * @param left Left sequence.
+     * @param right Right sequence.
+     * @param alignment Receives the matched positions, strictly
+     *     increasing on both sides.
+     * @returns The length of the alignment.
+     */
+    size_t Align(const Sequence& left, const Sequence& right,
+                 Alignment* alignment);
+
+private:
+    typedef uint32_t symbol_t;
+
+    // Replaces quarks by dense symbols in [0, _numSymbols).
+    void ToSymbols(const Sequence& left, const Sequence& right);
+
+    // Fills |scores| with the LCS length of left[l0, l1) and every
+    // prefix of right[r0, r1), or every suffix if |backward| is true.
+    void ComputeScores(size_t l0, size_t l1, size_t r0, size_t r1,
+                       bool backward, std::vector<uint32_t>* scores);
+
+    void AlignRange(size_t l0, size_t l1, size_t r0, size_t r1,
+                    Alignment* alignment);
+
+    // Quadratic alignment, for small ranges.
+    void AlignDirect(size_t l0, size_t l1, size_t r0, size_t r1,
+                     Alignment* alignment);
+
+    std::vector<symbol_t> _left;
+    std::vector<symbol_t> _right;
+    size_t _numSymbols;
+
+    // Match masks of the right range, one row of words per symbol that
+    // appears in it. |_rowOfSymbol| is kNoRow for the other symbols.
+    std::vector<uint64_t> _masks;
+    std::vector<uint32_t> _rowOfSymbol;
+    std::vector<uint64_t> _row;
+
+    std::vector<uint32_t> _forward;
+    std::vector<uint32_t> _backward;
+    std::vector<uint32_t> _direct;
+};
+
+}
+}
+
+#endif // _TIBEE_SEQUENCE_SEQUENCEALIGNER_HPP
@@ -0,0 +1,213 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "quark/StringQuarkDatabase.hpp"
+#include "sequence/SequenceAligner.hpp"
+
+namespace tibee
+{
+namespace sequence
+{
+
+namespace
+{
+
+Sequence MakeSequence(const std::string& str)
+{
+    Sequence sequence;
+    for (char c : str)
+        sequence.push_back(quark::Quark(c));
+    return sequence;
+}
+
+// Reads one symbol per line. Blank lines are symbols too, including the
+// empty line that follows the last newline.
+Sequence ReadSequence(const std::string& path, quark::StringQuarkDatabase* quarks)
+{
+    std::ifstream in(path);
+    std::string contents((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+
+    Sequence sequence;
+    size_t begin = 0;
+    for (;;)
+    {
+        size_t end = contents.find('\n', begin);
+        if (end == std::string::npos)
+            break;
+        sequence.push_back(quarks->StrQuark(contents.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    sequence.push_back(quarks->StrQuark(contents.substr(begin)));
+    return sequence;
+}
+
+size_t QuadraticLcsLength(const Sequence& left, const Sequence& right)
+{
+    std::vector<size_t> previous(right.size() + 1, 0);
+    std::vector<size_t> current(right.size() + 1, 0);
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        for (size_t j = 0; j < right.size(); ++j)
+        {
+            if (left[i] == right[j])
+                current[j + 1] = previous[j] + 1;
+            else
+                current[j + 1] = std::max(previous[j + 1], current[j]);
+        }
+        std::swap(previous, current);
+    }
+    return previous.back();
+}
+
+void ExpectValidAlignment(const Sequence& left, const Sequence& right,
+                          const Alignment& alignment)
+{
+    for (size_t i = 0; i < alignment.size(); ++i)
+    {
+        ASSERT_LT(alignment[i].left, left.size());
+        ASSERT_LT(alignment[i].right, right.size());
+        EXPECT_EQ(left[alignment[i].left], right[alignment[i].right]);
+    }
+    for (size_t i = 1; i < alignment.size(); ++i)
+    {
+        EXPECT_LT(alignment[i - 1].left, alignment[i].left);
+        EXPECT_LT(alignment[i - 1].right, alignment[i].right);
+    }
+}
+
+}  // namespace
+
+TEST(SequenceAligner, Simple)
+{
+    Sequence left = MakeSequence("ABCBDAB");
+    Sequence right = MakeSequence("BDCABA");
+
+    SequenceAligner aligner;
+    EXPECT_EQ(4u, aligner.LcsLength(left, right));
+
+    Alignment alignment;
+    EXPECT_EQ(4u, aligner.Align(left, right, &alignment));
+    EXPECT_EQ(4u, alignment.size());
+    ExpectValidAlignment(left, right, alignment);
+}
+
+TEST(SequenceAligner, Empty)
+{
+    Sequence empty;
+    Sequence other = MakeSequence("ABC");
+
+    SequenceAligner aligner;
+    Alignment alignment;
+    EXPECT_EQ(0u, aligner.LcsLength(empty, other));
+    EXPECT_EQ(0u, aligner.LcsLength(other, empty));
+    EXPECT_EQ(0u, aligner.Align(empty, other, &alignment));
+    EXPECT_EQ(0u, aligner.Align(other, empty, &alignment));
+    EXPECT_EQ(3u, aligner.Align(other, other, &alignment));
+    EXPECT_EQ(Match(2, 2), alignment.back());
+}
+
+TEST(SequenceAligner, Random)
+{
+    // Long enough to cross several words and to be split by Hirschberg's
+    // recursion before the quadratic algorithm takes over.
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> symbols(0, 5);
+    std::uniform_int_distribution<int> lengths(0, 700);
+
+    SequenceAligner aligner;
+    for (int iteration = 0; iteration < 20; ++iteration)
+    {
+        Sequence left(lengths(generator));
+        Sequence right(lengths(generator));
+        for (auto& element : left)
+            element = quark::Quark(symbols(generator));
+        for (auto& element : right)
+            element = quark::Quark(symbols(generator));
+
+        size_t expected = QuadraticLcsLength(left, right);
+        EXPECT_EQ(expected, aligner.LcsLength(left, right));
+
+        Alignment alignment;
+        EXPECT_EQ(expected, aligner.Align(left, right, &alignment));
+        ExpectValidAlignment(left, right, alignment);
+    }
+}
+
+TEST(SequenceAligner, SyscallSequences)
+{
+    quark::StringQuarkDatabase quarks;
+    Sequence left = ReadSequence("test_data/seq_left_1.txt", &quarks);
+    Sequence right = ReadSequence("test_data/seq_right_1.txt", &quarks);
+    ASSERT_EQ(107017u, left.size());
+    ASSERT_EQ(218165u, right.size());
+
+    // The reference matching was produced by another tool: keep the
+    // pairs that hold the same symbol, in increasing order, to get a
+    // common subsequence that the alignment must not be shorter than.
+    std::ifstream in("test_data/seq_match_1.txt");
+    std::set<std::pair<size_t, size_t>> reference;
+    size_t l = 0;
+    size_t r = 0;
+    while (in >> l >> r)
+    {
+        ASSERT_LT(l, left.size());
+        ASSERT_LT(r, right.size());
+        reference.insert(std::make_pair(l, r));
+    }
+    size_t referenceLength = 0;
+    size_t lastLeft = 0;
+    size_t lastRight = 0;
+    for (const auto& pair : reference)
+    {
+        if (left[pair.first] != right[pair.second])
+            continue;
+        if (referenceLength != 0 &&
+            (pair.first <= lastLeft || pair.second <= lastRight))
+        {
+            continue;
+        }
+        lastLeft = pair.first;
+        lastRight = pair.second;
+        ++referenceLength;
+    }
+    EXPECT_EQ(90959u, referenceLength);
+
+    SequenceAligner aligner;
+    size_t lcsLength = aligner.LcsLength(left, right);
+    EXPECT_EQ(107006u, lcsLength);
+    EXPECT_GE(lcsLength, referenceLength);
+
+    Alignment alignment;
+    EXPECT_EQ(lcsLength, aligner.Align(left, right, &alignment));
+    ExpectValidAlignment(left, right, alignment);
+
+    // Both sequences start and end with the same system calls.
+    EXPECT_EQ(Match(0, 0), alignment.front());
+    EXPECT_EQ(Match(left.size() - 1, right.size() - 1), alignment.back());
+}
+
+}  // namespace sequence
+}  // namespace tibee
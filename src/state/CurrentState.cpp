@@ -17,6 +17,7 @@
  */
 #include "base/Constants.hpp"
 #include "state/CurrentState.hpp"
+#include "value/MakeValue.hpp"
 #include "value/Utils.hpp"
 
 namespace tibee
@@ -28,7 +29,8 @@ CurrentState::CurrentState(OnAttributeChangeCallback onAttributeChangeCallback,
                            quark::StringQuarkDatabase* quarks) :
     _ts(0),
     _quarks(quarks),
-    _onAttributeChangeCallback(onAttributeChangeCallback)
+    _onAttributeChangeCallback(onAttributeChangeCallback),
+    _readTracking(false)
 {
     assert(_quarks != nullptr);
 
@@ -78,26 +80,31 @@ AttributeKey CurrentState::GetAttributeKey(AttributeKey root, const AttributePat
     return _attributeTree.CreateNodeKey(root, subPath);
 }
 
-void CurrentState::SetAttribute(AttributeKey attribute, value::Value::UP value)
+void CurrentState::SetAttribute(AttributeKey attribute, value::ValueRef value)
 {
-    if (value::Value::AreEqual(value.get(), GetAttributeValue(attribute)))
+    AttributeValue& previousValue = _attributeValues[attribute.get()];
+    previousValue.written = true;
+    if (value::Value::AreEqual(value.get(), previousValue.value.get()))
         return;
 
+    if (!_timeInStateAttributes.empty())
+        AccumulateTimeInState(attribute, &previousValue);
+
     if (_onAttributeChangeCallback != nullptr)
-        _onAttributeChangeCallback(attribute, value.get());
+        _onAttributeChangeCallback(attribute, value);
 
     AttributeValue& attributeValue = _attributeValues[attribute.get()];
     attributeValue.value = std::move(value);
     attributeValue.since = _ts;
 }
 
-void CurrentState::SetAttribute(AttributeKey attribute, const AttributePath& subPath, value::Value::UP value)
+void CurrentState::SetAttribute(AttributeKey attribute, const AttributePath& subPath, value::ValueRef value)
 {
     AttributeKey subPathKey = GetAttributeKey(attribute, subPath);
     SetAttribute(subPathKey, std::move(value));
 }
 
-void CurrentState::SetAttribute(const AttributePath& path, value::Value::UP value)
+void CurrentState::SetAttribute(const AttributePath& path, value::ValueRef value)
 {
     AttributeKey key = GetAttributeKey(path);
     SetAttribute(key, std::move(value));
@@ -105,7 +112,7 @@ void CurrentState::SetAttribute(const AttributePath& path, value::Value::UP valu
 
 void CurrentState::NullAttribute(AttributeKey attribute)
 {
-    SetAttribute(attribute, value::Value::UP {});
+    SetAttribute(attribute, nullptr);
 
     auto it = _attributeTree.node_children_begin(attribute);
     auto it_end = _attributeTree.node_children_end(attribute);
@@ -125,10 +132,55 @@ void CurrentState::NullAttribute(const AttributePath& path)
     NullAttribute(key);
 }
 
-const value::Value* CurrentState::GetAttributeValue(AttributeKey attribute)
+void CurrentState::InitAttribute(AttributeKey attribute, value::ValueRef value, timestamp_t since)
 {
     AttributeValue& attributeValue = _attributeValues[attribute.get()];
-    return attributeValue.value.get();
+    attributeValue.value = std::move(value);
+    attributeValue.since = since;
+}
+
+void CurrentState::EnableTimeInState(quark::Quark attributeName)
+{
+    _timeInStateAttributes.insert(attributeName);
+}
+
+timestamp_t CurrentState::GetTimeInState(AttributeKey attribute, const value::Value* value)
+{
+    uint64_t key = 0;
+    if (!GetTimeInStateKey(value, &key))
+        return 0;
+
+    const AttributeValue& attributeValue = ReadAttribute(attribute);
+    timestamp_t time = 0;
+    for (const auto& timeInState : attributeValue.timeInState)
+    {
+        if (timeInState.first == key)
+        {
+            time = timeInState.second;
+            break;
+        }
+    }
+
+    // Add the time spent in the current value.
+    if (attributeValue.timeInStateTracking == AttributeValue::TimeInStateTracking::kEnabled &&
+        value::Value::AreEqual(value, attributeValue.value.get()) &&
+        _ts > attributeValue.since)
+    {
+        time += _ts - attributeValue.since;
+    }
+
+    return time;
+}
+
+timestamp_t CurrentState::GetTimeInState(AttributeKey attribute, const AttributePath& subPath, const value::Value* value)
+{
+    AttributeKey subPathKey = GetAttributeKey(attribute, subPath);
+    return GetTimeInState(subPathKey, value);
+}
+
+const value::Value* CurrentState::GetAttributeValue(AttributeKey attribute)
+{
+    return ReadAttribute(attribute).value.get();
 }
 
 const value::Value* CurrentState::GetAttributeValue(AttributeKey attribute, const AttributePath& subPath)
@@ -145,8 +197,7 @@ const value::Value* CurrentState::GetAttributeValue(const AttributePath& path)
 
 timestamp_t CurrentState::GetAttributeLastChange(AttributeKey attribute)
 {
-    AttributeValue& attributeValue = _attributeValues[attribute.get()];
-    return attributeValue.since;
+    return ReadAttribute(attribute).since;
 }
 
 timestamp_t CurrentState::GetAttributeLastChange(AttributeKey attribute, const AttributePath& subPath)
@@ -166,6 +217,17 @@ void CurrentState::GetAttributePath(AttributeKey attribute, AttributeTree::Path*
     _attributeTree.GetNodePath(attribute, path);
 }
 
+void CurrentState::VisitAttributes(const AttributeVisitor& visitor) const
+{
+    for (const auto& attributeValue : _attributeValues)
+    {
+        const AttributeValue& value = attributeValue.second;
+        if (value.value == nullptr && !value.written && !value.readBeforeWrite)
+            continue;
+        visitor(AttributeKey(attributeValue.first), value);
+    }
+}
+
 uint32_t CurrentState::CurrentThreadForCpu(uint32_t cpu)
 {
     auto threadValue = GetAttributeValue(_cpusAttribute, {IntQuark(cpu), Q_CUR_THREAD});
@@ -195,8 +257,75 @@ quark::Quark CurrentState::CurrentStatusForThread(uint32_t thread)
     return status->AsQuark();
 }
 
+timestamp_t CurrentState::TimeInStatusForThread(uint32_t thread, quark::Quark status)
+{
+    return GetTimeInState(_threadsAttribute, {IntQuark(thread), Q_STATUS},
+                          value::MakeValue(status).get());
+}
+
+void CurrentState::AccumulateTimeInState(AttributeKey attribute, AttributeValue* attributeValue)
+{
+    typedef AttributeValue::TimeInStateTracking Tracking;
+
+    if (attributeValue->timeInStateTracking == Tracking::kUnresolved)
+    {
+        AttributeTree::Path path;
+        _attributeTree.GetNodePath(attribute, &path);
+        bool enabled = !path.empty() &&
+            _timeInStateAttributes.find(path.back()) != _timeInStateAttributes.end();
+        attributeValue->timeInStateTracking = enabled ? Tracking::kEnabled : Tracking::kDisabled;
+    }
+
+    if (attributeValue->timeInStateTracking != Tracking::kEnabled)
+        return;
+
+    uint64_t key = 0;
+    if (!GetTimeInStateKey(attributeValue->value.get(), &key))
+        return;
+    if (_ts <= attributeValue->since)
+        return;
+    timestamp_t elapsed = _ts - attributeValue->since;
+
+    // An attribute takes few distinct values: a linear search is faster
+    // than a map.
+    for (auto& timeInState : attributeValue->timeInState)
+    {
+        if (timeInState.first == key)
+        {
+            timeInState.second += elapsed;
+            return;
+        }
+    }
+    attributeValue->timeInState.push_back(std::make_pair(key, elapsed));
+}
+
+bool CurrentState::GetTimeInStateKey(const value::Value* value, uint64_t* key)
+{
+    if (value == nullptr)
+        return false;
+    if (value->AsULong(key))
+        return true;
+
+    int64_t signedValue = 0;
+    if (!value->AsLong(&signedValue))
+        return false;
+    *key = static_cast<uint64_t>(signedValue);
+    return true;
+}
+
+CurrentState::AttributeValue& CurrentState::ReadAttribute(AttributeKey attribute)
+{
+    AttributeValue& attributeValue = _attributeValues[attribute.get()];
+    if (_readTracking && !attributeValue.written)
+        attributeValue.readBeforeWrite = true;
+    return attributeValue;
+}
+
 CurrentState::AttributeValue::AttributeValue() :
-    since(0)
+    since(0),
+    written(false),
+    readBeforeWrite(false),
+    timeInStateTracking(TimeInStateTracking::kUnresolved)
 {
 }
 
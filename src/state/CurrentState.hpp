@@ -19,9 +19,12 @@
 #define _TIBEE_STATE_CURRENTSTATE_HPP
 
 #include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "base/BasicTypes.hpp"
@@ -29,6 +32,7 @@
 #include "state/AttributeKey.hpp"
 #include "state/AttributePath.hpp"
 #include "state/AttributeTree.hpp"
+#include "value/Interner.hpp"
 #include "value/Value.hpp"
 
 namespace tibee
@@ -45,9 +49,39 @@ class CurrentState
 {
 public:
     typedef std::unique_ptr<CurrentState> UP;
-    typedef std::function<void (AttributeKey attribute, const value::Value* newValue)>
+    // The new value is shared with the state: observers can keep a
+    // reference to it instead of copying it.
+    typedef std::function<void (AttributeKey attribute, const value::ValueRef& newValue)>
         OnAttributeChangeCallback;
 
+    struct AttributeValue {
+        AttributeValue();
+        value::ValueRef value;
+        timestamp_t since;
+
+        // Whether the attribute was set since the creation of the state.
+        bool written;
+
+        // Whether the attribute was read before being set. Only recorded
+        // when read tracking is enabled.
+        bool readBeforeWrite;
+
+        // Whether the time spent in each value is accumulated, as
+        // determined by EnableTimeInState(). Resolved on the first change.
+        enum class TimeInStateTracking : uint8_t {
+            kUnresolved,
+            kEnabled,
+            kDisabled,
+        };
+        TimeInStateTracking timeInStateTracking;
+
+        // Time spent in each previous value (value key, duration).
+        std::vector<std::pair<uint64_t, timestamp_t>> timeInState;
+    };
+
+    typedef std::function<void (AttributeKey attribute, const AttributeValue& value)>
+        AttributeVisitor;
+
     CurrentState(OnAttributeChangeCallback onAttributeChangeCallback,
                  quark::StringQuarkDatabase* quarks);
     ~CurrentState();
@@ -67,9 +101,20 @@ public:
     AttributeKey GetAttributeKeyStr(const AttributePathStr& pathStr);
     AttributeKey GetAttributeKey(AttributeKey root, const AttributePath& subPath);
 
-    void SetAttribute(AttributeKey attribute, value::Value::UP value);
-    void SetAttribute(AttributeKey attribute, const AttributePath& subPath, value::Value::UP value);
-    void SetAttribute(const AttributePath& path, value::Value::UP value);
+    void SetAttribute(AttributeKey attribute, value::ValueRef value);
+    void SetAttribute(AttributeKey attribute, const AttributePath& subPath, value::ValueRef value);
+    void SetAttribute(const AttributePath& path, value::ValueRef value);
+
+    /**
+     * Returns a shared instance of a value, to set attributes whose values
+     * repeat (statuses, thread names) without allocating them each time.
+     */
+    value::ValueRef Intern(quark::Quark quark) {
+        return _interner.Intern<value::UIntValue>(quark.get());
+    }
+    value::ValueRef InternString(boost::string_ref str) {
+        return _interner.InternString(str);
+    }
 
     void NullAttribute(AttributeKey attribute);
     void NullAttribute(AttributeKey attribute, const AttributePath& subPath);
@@ -85,10 +130,50 @@ public:
 
     void GetAttributePath(AttributeKey attribute, AttributeTree::Path* path) const;
 
+    /**
+     * Records which attributes are read before being set. Used when the
+     * state is built from a time slice of a trace: the initial value of
+     * these attributes is unknown, so the results that depend on them
+     * have to be patched once the state at the beginning of the slice
+     * is known.
+     */
+    void EnableReadTracking() {
+        _readTracking = true;
+    }
+
+    /**
+     * Accumulates the time spent in each value by the attributes whose
+     * name (last component of their path) is |attributeName|. When such
+     * an attribute changes, the time elapsed since its last change is
+     * added to the total of its previous value, so the time spent by
+     * each thread in each status can be queried at the end of a trace
+     * without a history. Only integer values (including quarks) are
+     * accumulated. Must be called before the attributes change.
+     */
+    void EnableTimeInState(quark::Quark attributeName);
+
+    /**
+     * Returns the time spent by an attribute in a value, up to the
+     * current timestamp. Returns 0 if the time spent by the attribute in
+     * its values isn't accumulated.
+     */
+    timestamp_t GetTimeInState(AttributeKey attribute, const value::Value* value);
+    timestamp_t GetTimeInState(AttributeKey attribute, const AttributePath& subPath, const value::Value* value);
+
+    /**
+     * Sets the initial value of an attribute, without notifying the
+     * change. The attribute is not considered as written.
+     */
+    void InitAttribute(AttributeKey attribute, value::ValueRef value, timestamp_t since);
+
+    // Visits all attributes that have a value, were written or were read.
+    void VisitAttributes(const AttributeVisitor& visitor) const;
+
     // Utils.
     uint32_t CurrentThreadForCpu(uint32_t cpu);
     std::string CurrentNameForThread(uint32_t thread);
     quark::Quark CurrentStatusForThread(uint32_t thread);
+    timestamp_t TimeInStatusForThread(uint32_t thread, quark::Quark status);
 
     // Accessors.
     AttributeTree::Iterator attribute_children_begin(AttributeKey attribute) const {
@@ -102,11 +187,9 @@ public:
     }
 
 private:
-    struct AttributeValue {
-        AttributeValue();
-        value::Value::UP value;
-        timestamp_t since;
-    };
+    AttributeValue& ReadAttribute(AttributeKey attribute);
+    void AccumulateTimeInState(AttributeKey attribute, AttributeValue* attributeValue);
+    static bool GetTimeInStateKey(const value::Value* value, uint64_t* key);
 
     // Current timestamp.
     timestamp_t _ts;
@@ -114,6 +197,9 @@ private:
     // Quark database.
     quark::StringQuarkDatabase* _quarks;
 
+    // Shared instances of the values that repeat.
+    value::Interner _interner;
+
     // Attribute tree.
     AttributeTree _attributeTree;
 
@@ -124,6 +210,12 @@ private:
     // Callback invoked when an attribute changes.
     OnAttributeChangeCallback _onAttributeChangeCallback;
 
+    // Whether reads before writes are recorded.
+    bool _readTracking;
+
+    // Names of the attributes whose time in state is accumulated.
+    std::unordered_set<quark::Quark> _timeInStateAttributes;
+
     // Shortcut for utility methods.
     state::AttributeKey _cpusAttribute;
     state::AttributeKey _threadsAttribute;
@@ -19,6 +19,7 @@
 #include "gtest/gtest.h"
 #include "quark/StringQuarkDatabase.hpp"
 #include "state/CurrentState.hpp"
+#include "value/MakeValue.hpp"
 
 namespace tibee
 {
@@ -91,5 +92,82 @@ TEST(CurrentState, NullAttribute)
     EXPECT_EQ(nullptr, currentState.GetAttributeValue(abdeKey));
 }
 
+TEST(CurrentState, ReadTracking)
+{
+    quark::StringQuarkDatabase quarks;
+    CurrentState currentState(nullptr, &quarks);
+    currentState.EnableReadTracking();
+
+    AttributeKey aKey = currentState.GetAttributeKeyStr({"a"});
+    AttributeKey bKey = currentState.GetAttributeKeyStr({"b"});
+    AttributeKey cKey = currentState.GetAttributeKeyStr({"c"});
+
+    currentState.InitAttribute(cKey, value::Value::UP {new value::UIntValue(7)}, 1);
+
+    EXPECT_EQ(nullptr, currentState.GetAttributeValue(aKey));
+    currentState.SetAttribute(aKey, value::Value::UP {new value::UIntValue(1)});
+    currentState.SetAttribute(bKey, value::Value::UP {new value::UIntValue(2)});
+    EXPECT_EQ(2u, currentState.GetAttributeValue(bKey)->AsUInteger());
+    EXPECT_EQ(7u, currentState.GetAttributeValue(cKey)->AsUInteger());
+
+    size_t numAttributes = 0;
+    currentState.VisitAttributes([&] (AttributeKey attribute,
+                                      const CurrentState::AttributeValue& value) {
+        ++numAttributes;
+        if (attribute == aKey) {
+            EXPECT_TRUE(value.written);
+            EXPECT_TRUE(value.readBeforeWrite);
+        } else if (attribute == bKey) {
+            EXPECT_TRUE(value.written);
+            EXPECT_FALSE(value.readBeforeWrite);
+        } else if (attribute == cKey) {
+            EXPECT_FALSE(value.written);
+            EXPECT_TRUE(value.readBeforeWrite);
+            EXPECT_EQ(1u, value.since);
+        }
+    });
+    EXPECT_EQ(3u, numAttributes);
+}
+
+TEST(CurrentState, TimeInState)
+{
+    quark::StringQuarkDatabase quarks;
+    CurrentState currentState(nullptr, &quarks);
+    currentState.EnableTimeInState(currentState.Quark(kStateStatus));
+
+    auto qRun = currentState.Quark(kStateRunUsermode);
+    auto qWait = currentState.Quark(kStateWaitBlocked);
+
+    AttributeKey statusKey = currentState.GetAttributeKeyStr(
+        {kStateLinux, kStateThreads, "42", kStateStatus});
+    AttributeKey nameKey = currentState.GetAttributeKeyStr(
+        {kStateLinux, kStateThreads, "42", kStateExecName});
+
+    currentState.SetTimestamp(10);
+    currentState.SetAttribute(statusKey, value::MakeValue(qRun));
+    currentState.SetAttribute(nameKey, value::Value::UP {new value::UIntValue(1)});
+    currentState.SetTimestamp(15);
+    currentState.SetAttribute(statusKey, value::MakeValue(qWait));
+    currentState.SetAttribute(nameKey, value::Value::UP {new value::UIntValue(2)});
+    currentState.SetTimestamp(22);
+    currentState.SetAttribute(statusKey, value::MakeValue(qRun));
+    currentState.SetTimestamp(25);
+    currentState.NullAttribute(statusKey);
+    currentState.SetTimestamp(30);
+    currentState.SetAttribute(statusKey, value::MakeValue(qRun));
+
+    // The time spent in the current value is included.
+    currentState.SetTimestamp(31);
+    EXPECT_EQ(9u, currentState.GetTimeInState(statusKey, value::MakeValue(qRun).get()));
+    EXPECT_EQ(7u, currentState.GetTimeInState(statusKey, value::MakeValue(qWait).get()));
+    EXPECT_EQ(9u, currentState.TimeInStatusForThread(42, qRun));
+    EXPECT_EQ(0u, currentState.TimeInStatusForThread(43, qRun));
+    EXPECT_EQ(0u, currentState.GetTimeInState(statusKey, nullptr));
+
+    // Attributes with another name are not accumulated.
+    EXPECT_EQ(0u, currentState.GetTimeInState(
+        nameKey, value::Value::UP {new value::UIntValue(1)}.get()));
+}
+
 }  // namespace state
 }  // namespace tibee
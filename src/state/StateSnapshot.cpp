@@ -0,0 +1,121 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "state/StateSnapshot.hpp"
+
+#include "state/CurrentState.hpp"
+
+namespace tibee
+{
+namespace state
+{
+
+namespace
+{
+
+const value::Value* FindValue(const StateSnapshot& snapshot, const AttributePathStr& path)
+{
+    auto look = snapshot.find(path);
+    if (look == snapshot.end())
+        return nullptr;
+    return look->second.value.get();
+}
+
+}  // namespace
+
+AttributeSnapshot::AttributeSnapshot()
+    : since(0),
+      written(false),
+      readBeforeWrite(false)
+{
+}
+
+void TakeSnapshot(const CurrentState& state, StateSnapshot* snapshot)
+{
+    assert(snapshot != nullptr);
+    snapshot->clear();
+
+    state.VisitAttributes([&] (AttributeKey attribute,
+                               const CurrentState::AttributeValue& value) {
+        AttributeTree::Path path;
+        state.GetAttributePath(attribute, &path);
+
+        AttributePathStr pathStr;
+        pathStr.reserve(path.size());
+        for (const auto& quark : path)
+            pathStr.push_back(state.String(quark));
+
+        AttributeSnapshot& attributeSnapshot = (*snapshot)[pathStr];
+        attributeSnapshot.value = value.value;
+        attributeSnapshot.since = value.since;
+        attributeSnapshot.written = value.written;
+        attributeSnapshot.readBeforeWrite = value.readBeforeWrite;
+    });
+}
+
+void ApplySnapshot(const StateSnapshot& snapshot, CurrentState* state)
+{
+    assert(state != nullptr);
+
+    for (const auto& attribute : snapshot)
+    {
+        if (attribute.second.value == nullptr)
+            continue;
+
+        state->InitAttribute(state->GetAttributeKeyStr(attribute.first),
+                             attribute.second.value,
+                             attribute.second.since);
+    }
+}
+
+void StitchSnapshots(const StateSnapshot& previous,
+                     const StateSnapshot& initial,
+                     const StateSnapshot& slice,
+                     StateSnapshot* stitched,
+                     std::vector<AttributePathStr>* unresolved)
+{
+    assert(stitched != nullptr);
+    assert(unresolved != nullptr);
+
+    *stitched = previous;
+    for (auto& attribute : *stitched)
+        attribute.second.readBeforeWrite = false;
+    unresolved->clear();
+
+    for (const auto& attribute : slice)
+    {
+        const AttributeSnapshot& sliceValue = attribute.second;
+
+        if (sliceValue.readBeforeWrite &&
+            !value::Value::AreEqual(FindValue(previous, attribute.first),
+                                    FindValue(initial, attribute.first)))
+        {
+            unresolved->push_back(attribute.first);
+        }
+
+        AttributeSnapshot& stitchedValue = (*stitched)[attribute.first];
+        if (sliceValue.written)
+        {
+            stitchedValue.value = sliceValue.value;
+            stitchedValue.since = sliceValue.since;
+        }
+        stitchedValue.written = stitchedValue.written || sliceValue.written;
+    }
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_STATE_STATESNAPSHOT_HPP
+#define _TIBEE_STATE_STATESNAPSHOT_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "base/BasicTypes.hpp"
+#include "state/AttributePath.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace state
+{
+
+// Forward declaration.
+class CurrentState;
+
+/**
+ * Value of an attribute in a state snapshot.
+ *
+ * @author Francois Doray
+ */
+struct AttributeSnapshot
+{
+    AttributeSnapshot();
+
+    // Values are immutable, so snapshots share them with the state.
+    value::ValueRef value;
+    timestamp_t since;
+    bool written;
+    bool readBeforeWrite;
+};
+
+/**
+ * Attributes of a current state, keyed by their path. Unlike attribute
+ * keys, paths can be compared between states built by different runs.
+ */
+typedef std::map<AttributePathStr, AttributeSnapshot> StateSnapshot;
+
+/**
+ * Takes a snapshot of all the attributes of a state.
+ *
+ * @param state The state.
+ * @param snapshot Receives the snapshot.
+ */
+void TakeSnapshot(const CurrentState& state, StateSnapshot* snapshot);
+
+/**
+ * Initializes the attributes of a state from a snapshot, without
+ * notifying the changes.
+ *
+ * @param snapshot The snapshot.
+ * @param state The state to initialize.
+ */
+void ApplySnapshot(const StateSnapshot& snapshot, CurrentState* state);
+
+/**
+ * Computes the state at the end of a time slice from the state at the
+ * end of the previous slice. Attributes written by the slice take the
+ * value they had at the end of the slice. The other attributes keep
+ * their value from the previous slice.
+ *
+ * An attribute that the slice read before writing it is unresolved if
+ * its value at the end of the previous slice differs from the value the
+ * slice started with: the results that depend on it must be recomputed.
+ *
+ * @param previous State at the end of the previous slice.
+ * @param initial State the slice started with.
+ * @param slice State at the end of the slice.
+ * @param stitched Receives the state at the end of the slice.
+ * @param unresolved Receives the unresolved attributes.
+ */
+void StitchSnapshots(const StateSnapshot& previous,
+                     const StateSnapshot& initial,
+                     const StateSnapshot& slice,
+                     StateSnapshot* stitched,
+                     std::vector<AttributePathStr>* unresolved);
+
+}
+}
+
+#endif // _TIBEE_STATE_STATESNAPSHOT_HPP
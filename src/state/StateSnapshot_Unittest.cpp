@@ -0,0 +1,96 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "quark/StringQuarkDatabase.hpp"
+#include "state/CurrentState.hpp"
+#include "state/StateSnapshot.hpp"
+
+namespace tibee
+{
+namespace state
+{
+
+TEST(StateSnapshot, TakeAndApply)
+{
+    quark::StringQuarkDatabase quarks;
+    CurrentState currentState(nullptr, &quarks);
+
+    currentState.SetTimestamp(5);
+    currentState.SetAttribute(currentState.GetAttributeKeyStr({"a", "b"}),
+                              value::Value::UP {new value::UIntValue(42)});
+
+    StateSnapshot snapshot;
+    TakeSnapshot(currentState, &snapshot);
+    ASSERT_EQ(1u, snapshot.size());
+
+    const auto& attribute = snapshot[AttributePathStr {"a", "b"}];
+    EXPECT_EQ(42u, attribute.value->AsUInteger());
+    EXPECT_EQ(5u, attribute.since);
+    EXPECT_TRUE(attribute.written);
+
+    quark::StringQuarkDatabase otherQuarks;
+    CurrentState otherState(nullptr, &otherQuarks);
+    ApplySnapshot(snapshot, &otherState);
+
+    AttributeKey abKey = otherState.GetAttributeKeyStr({"a", "b"});
+    EXPECT_EQ(42u, otherState.GetAttributeValue(abKey)->AsUInteger());
+    EXPECT_EQ(5u, otherState.GetAttributeLastChange(abKey));
+}
+
+TEST(StateSnapshot, Stitch)
+{
+    quark::StringQuarkDatabase quarks;
+
+    // First slice.
+    CurrentState first(nullptr, &quarks);
+    first.SetAttribute(first.GetAttributeKeyStr({"a"}), value::Value::UP {new value::UIntValue(1)});
+    first.SetAttribute(first.GetAttributeKeyStr({"b"}), value::Value::UP {new value::UIntValue(2)});
+    first.SetAttribute(first.GetAttributeKeyStr({"c"}), value::Value::UP {new value::UIntValue(3)});
+
+    // Second slice: reads "a" before writing it, reads "d" which is
+    // unknown in both slices and overwrites "b" without reading it.
+    CurrentState second(nullptr, &quarks);
+    second.EnableReadTracking();
+    second.GetAttributeValue(second.GetAttributeKeyStr({"a"}));
+    second.GetAttributeValue(second.GetAttributeKeyStr({"d"}));
+    second.SetAttribute(second.GetAttributeKeyStr({"a"}), value::Value::UP {new value::UIntValue(10)});
+    second.SetAttribute(second.GetAttributeKeyStr({"b"}), value::Value::UP {new value::UIntValue(20)});
+
+    StateSnapshot previous;
+    TakeSnapshot(first, &previous);
+    StateSnapshot slice;
+    TakeSnapshot(second, &slice);
+
+    StateSnapshot stitched;
+    std::vector<AttributePathStr> unresolved;
+    StitchSnapshots(previous, StateSnapshot(), slice, &stitched, &unresolved);
+
+    EXPECT_EQ(10u, stitched[AttributePathStr {"a"}].value->AsUInteger());
+    EXPECT_EQ(20u, stitched[AttributePathStr {"b"}].value->AsUInteger());
+    EXPECT_EQ(3u, stitched[AttributePathStr {"c"}].value->AsUInteger());
+
+    ASSERT_EQ(1u, unresolved.size());
+    EXPECT_EQ(AttributePathStr {"a"}, unresolved[0]);
+
+    // Once the slice starts with the right value, "a" is resolved.
+    StitchSnapshots(previous, previous, slice, &stitched, &unresolved);
+    EXPECT_TRUE(unresolved.empty());
+}
+
+}  // namespace state
+}  // namespace tibee
@@ -17,9 +17,9 @@
  */
 #include "state_blocks/CurrentStateBlock.hpp"
 
-#include "base/BindObject.hpp"
 #include "base/Constants.hpp"
 #include "block/ServiceList.hpp"
+#include "notification/Callback.hpp"
 #include "notification/NotificationCenter.hpp"
 #include "notification/Path.hpp"
 #include "notification/Token.hpp"
@@ -34,22 +34,54 @@ namespace state_blocks
 using notification::Token;
 using trace_blocks::TraceBlock;
 
+namespace
+{
+
+const value::StructValue::Key kAttributeKeyField {kCurrentStateAttributeKeyField};
+const value::StructValue::Key kAttributeValueField {kCurrentStateAttributeValueField};
+
+}  // namespace
+
 CurrentStateBlock::CurrentStateBlock()
-    : _notificationCenter(nullptr)
+    : _ownedQuarks(new quark::StringQuarkDatabase),
+      _quarks(_ownedQuarks.get()),
+      _notificationCenter(nullptr)
+{
+    CreateCurrentState();
+}
+
+CurrentStateBlock::CurrentStateBlock(quark::StringQuarkDatabase* quarks)
+    : _quarks(quarks),
+      _notificationCenter(nullptr)
+{
+    assert(_quarks != nullptr);
+    CreateCurrentState();
+}
+
+void CurrentStateBlock::CreateCurrentState()
 {
     namespace pl = std::placeholders;
 
-    _quarks.reset(new quark::StringQuarkDatabase);
     _currentState.reset(new state::CurrentState(
         std::bind(&CurrentStateBlock::onStateChange,
                   this, pl::_1, pl::_2),
-        _quarks.get()));
+        _quarks));
+}
+
+void CurrentStateBlock::Start(const value::Value* parameters)
+{
+    const value::ArrayValueBase* timeInState = nullptr;
+    if (parameters == nullptr || !parameters->GetFieldAs("time_in_state", &timeInState))
+        return;
+
+    for (const auto& attributeName : *timeInState)
+        _currentState->EnableTimeInState(_quarks->StrQuark(attributeName.AsString()));
 }
 
 void CurrentStateBlock::RegisterServices(block::ServiceList* serviceList)
 {
     serviceList->AddService(kCurrentStateServiceName, _currentState.get());
-    serviceList->AddService(kQuarksServiceName, _quarks.get());
+    serviceList->AddService(kQuarksServiceName, _quarks);
 }
 
 void CurrentStateBlock::LoadServices(const block::ServiceList& serviceList)
@@ -61,9 +93,10 @@ void CurrentStateBlock::LoadServices(const block::ServiceList& serviceList)
 
 void CurrentStateBlock::AddObservers(notification::NotificationCenter* notificationCenter)
 {
+    notificationCenter->SetObserverPriority(notification::ObserverPriority::kState);
     notificationCenter->AddObserver(
         {Token(kTraceNotificationPrefix), Token(kTimestampNotificationName)},
-        base::BindObject(&CurrentStateBlock::onTimestamp, this));   
+        notification::Callback::Bind<CurrentStateBlock, &CurrentStateBlock::onTimestamp>(this));
 }
 
 void CurrentStateBlock::onTimestamp(const notification::Path& path, const value::Value* value)
@@ -71,7 +104,7 @@ void CurrentStateBlock::onTimestamp(const notification::Path& path, const value:
     _currentState->SetTimestamp(value->AsULong());
 }
 
-void CurrentStateBlock::onStateChange(state::AttributeKey attribute, const value::Value* value)
+void CurrentStateBlock::onStateChange(state::AttributeKey attribute, const value::ValueRef& value)
 {
     assert(_notificationCenter != nullptr);
 
@@ -92,12 +125,8 @@ void CurrentStateBlock::onStateChange(state::AttributeKey attribute, const value
 
     // Post notification.
     value::StructValue::UP notification {new value::StructValue};
-    notification->AddField<value::UIntValue>(kCurrentStateAttributeKeyField, attribute.get());
-
-    if (value != nullptr)
-        notification->AddField(kCurrentStateAttributeValueField, value->Copy());
-    else
-        notification->AddField(kCurrentStateAttributeValueField, nullptr);
+    notification->AddField<value::UIntValue>(kAttributeKeyField, attribute.get());
+    notification->AddSharedField(kAttributeValueField, value);
 
     _sinks[attribute.get()]->PostNotification(notification.get());
 }
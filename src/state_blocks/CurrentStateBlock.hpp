@@ -36,6 +36,10 @@ namespace state_blocks
 /**
  * A block that keeps track of the current state.
  *
+ * Parameters:
+ *   time_in_state: Optional. Names of the attributes whose time spent in
+ *                  each value is accumulated (e.g. "status").
+ *
  * @author Francois Doray
  */
 class CurrentStateBlock : public block::AbstractBlock
@@ -43,15 +47,26 @@ class CurrentStateBlock : public block::AbstractBlock
 public:
     CurrentStateBlock();
 
+    /**
+     * Constructor for a block that uses an external quark database,
+     * shared with other current state blocks.
+     */
+    explicit CurrentStateBlock(quark::StringQuarkDatabase* quarks);
+
+    state::CurrentState* GetCurrentState() const { return _currentState.get(); }
+
+    virtual void Start(const value::Value* parameters) override;
     virtual void RegisterServices(block::ServiceList* serviceList) override;
     virtual void LoadServices(const block::ServiceList& serviceList) override;
     virtual void AddObservers(notification::NotificationCenter* notificationCenter) override;
 
 private:
+    void CreateCurrentState();
     void onTimestamp(const notification::Path& path, const value::Value* value);
-    void onStateChange(state::AttributeKey attribute, const value::Value* value);
+    void onStateChange(state::AttributeKey attribute, const value::ValueRef& value);
 
-    quark::StringQuarkDatabase::UP _quarks;
+    quark::StringQuarkDatabase::UP _ownedQuarks;
+    quark::StringQuarkDatabase* _quarks;
     state::CurrentState::UP _currentState;
 
     typedef std::vector<const notification::NotificationSink*> Sinks;
@@ -84,38 +84,38 @@ void LinuxSchedStateBlock::LoadServices(const block::ServiceList& serviceList)
 
 void LinuxSchedStateBlock::AddObservers(notification::NotificationCenter* notificationCenter)
 {
-    namespace pl = std::placeholders;
-
-    AddKernelObserver(notificationCenter, Token("sched_process_exec"), std::bind(&LinuxSchedStateBlock::onSchedProcessExec, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("syscall_entry_execve"), std::bind(&LinuxSchedStateBlock::onSchedProcessExec, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("exit_syscall"), std::bind(&LinuxSchedStateBlock::onExitSyscall, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("irq_handler_entry"), std::bind(&LinuxSchedStateBlock::onIrqHandlerEntry, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("irq_handler_exit"), std::bind(&LinuxSchedStateBlock::onIrqHandlerExit, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("softirq_entry"), std::bind(&LinuxSchedStateBlock::onSoftIrqEntry, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("softirq_exit"), std::bind(&LinuxSchedStateBlock::onSoftIrqExit, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("softirq_raise"), std::bind(&LinuxSchedStateBlock::onSoftIrqRaise, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("sched_switch"), std::bind(&LinuxSchedStateBlock::onSchedSwitch, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("sched_process_fork"), std::bind(&LinuxSchedStateBlock::onSchedProcessFork, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("sched_process_free"), std::bind(&LinuxSchedStateBlock::onSchedProcessFree, this, pl::_1));
-    AddKernelObserver(notificationCenter, Token("lttng_statedump_process_state"), std::bind(&LinuxSchedStateBlock::onLttngStatedumpProcessState, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^sched_wakeup"), std::bind(&LinuxSchedStateBlock::onSchedWakeupEvent, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^sys_"), std::bind(&LinuxSchedStateBlock::onSysEvent, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^compat_sys_"), std::bind(&LinuxSchedStateBlock::onSysEvent, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^syscall_entry_"), std::bind(&LinuxSchedStateBlock::onSysEvent, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^syscall_exit_"), std::bind(&LinuxSchedStateBlock::onExitSyscall, this, pl::_1));
-    AddKernelObserver(notificationCenter, RegexToken("^compat_syscall_exit_"), std::bind(&LinuxSchedStateBlock::onExitSyscall, this, pl::_1));
+    notificationCenter->SetObserverPriority(notification::ObserverPriority::kState);
+
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedProcessExec>(notificationCenter, Token("sched_process_exec"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedProcessExec>(notificationCenter, Token("syscall_entry_execve"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onExitSyscall>(notificationCenter, Token("exit_syscall"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onIrqHandlerEntry>(notificationCenter, Token("irq_handler_entry"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onIrqHandlerExit>(notificationCenter, Token("irq_handler_exit"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSoftIrqEntry>(notificationCenter, Token("softirq_entry"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSoftIrqExit>(notificationCenter, Token("softirq_exit"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSoftIrqRaise>(notificationCenter, Token("softirq_raise"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedSwitch>(notificationCenter, Token("sched_switch"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedProcessFork>(notificationCenter, Token("sched_process_fork"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedProcessFree>(notificationCenter, Token("sched_process_free"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onLttngStatedumpProcessState>(notificationCenter, Token("lttng_statedump_process_state"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSchedWakeupEvent>(notificationCenter, RegexToken("^sched_wakeup"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSysEvent>(notificationCenter, RegexToken("^sys_"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSysEvent>(notificationCenter, RegexToken("^compat_sys_"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onSysEvent>(notificationCenter, RegexToken("^syscall_entry_"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onExitSyscall>(notificationCenter, RegexToken("^syscall_exit_"), this);
+    AddKernelObserver<LinuxSchedStateBlock, &LinuxSchedStateBlock::onExitSyscall>(notificationCenter, RegexToken("^compat_syscall_exit_"), this);
 }
 
 void LinuxSchedStateBlock::onSchedProcessExec(const trace::EventValue& event)
 {
     auto currentThreadAttribute = getCurrentThreadAttribute(event);
-    auto filename = event.getFields()->GetField("filename")->AsString();
+    auto filename = event.getFields()->GetField("filename")->AsStringView();
     auto last_slash_pos = filename.find_last_of('/');
-    if (last_slash_pos != std::string::npos)
+    if (last_slash_pos != boost::string_ref::npos)
         filename = filename.substr(last_slash_pos + 1);
 
     // exec name
-    State()->SetAttribute(currentThreadAttribute, {Q_EXEC_NAME}, MakeValue(filename));
+    State()->SetAttribute(currentThreadAttribute, {Q_EXEC_NAME}, State()->InternString(filename));
 }
 
 void LinuxSchedStateBlock::onExitSyscall(const trace::EventValue& event)
@@ -127,11 +127,11 @@ void LinuxSchedStateBlock::onExitSyscall(const trace::EventValue& event)
     if (currentThreadAttribute != state::InvalidAttributeKey())
     {
         State()->NullAttribute(currentThreadAttribute, {Q_SYSCALL});
-        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
     }
 
     // current CPU status
-    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
 }
 
 void LinuxSchedStateBlock::onIrqHandlerEntry(const trace::EventValue& event)
@@ -147,11 +147,11 @@ void LinuxSchedStateBlock::onIrqHandlerEntry(const trace::EventValue& event)
     if (currentThreadAttribute != state::InvalidAttributeKey())
     {
         // current thread's status
-        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_INTERRUPTED));
+        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_INTERRUPTED));
     }
 
     // current CPU's status
-    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_IRQ));
+    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_IRQ));
 }
 
 void LinuxSchedStateBlock::onIrqHandlerExit(const trace::EventValue& event)
@@ -173,21 +173,21 @@ void LinuxSchedStateBlock::onIrqHandlerExit(const trace::EventValue& event)
         if (State()->GetAttributeValue(currentThreadAttribute, {Q_SYSCALL}) == nullptr)
         {
             // syscall not set for current thread: running in usermode
-            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
         }
         else
         {
             // syscall set for current thread: running a syscall
-            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
         }
     }
 
     if (cpuIsIdle)
     {
         // no current thread for this CPU: CPU is idle.
-        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_IDLE));
+        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_IDLE));
     }
 }
 
@@ -207,11 +207,11 @@ void LinuxSchedStateBlock::onSoftIrqEntry(const trace::EventValue& event)
     if (currentThreadAttribute != state::InvalidAttributeKey())
     {
         // current thread's status
-        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_INTERRUPTED));
+        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_INTERRUPTED));
     }
 
     // current CPU's status
-    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_SOFT_IRQ));
+    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_SOFT_IRQ));
 }
 
 void LinuxSchedStateBlock::onSoftIrqExit(const trace::EventValue& event)
@@ -236,21 +236,21 @@ void LinuxSchedStateBlock::onSoftIrqExit(const trace::EventValue& event)
         if (State()->GetAttributeValue(currentThreadAttribute, {Q_SYSCALL}) == nullptr)
         {
             // syscall not set for current thread: running in usermode
-            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
         }
         else
         {
             // syscall set for current thread: running a syscall
-            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+            State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
         }
     }
 
     if (cpuIsIdle)
     {
         // no current thread for this CPU: CPU is idle.
-        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_IDLE));
+        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_IDLE));
     }
 }
 
@@ -259,7 +259,7 @@ void LinuxSchedStateBlock::onSoftIrqRaise(const trace::EventValue& event)
     auto currentSoftIrqAttribute = getCurrentSoftIrqAttribute(event);
 
     // current soft IRQ's status: raised
-    State()->SetAttribute(currentSoftIrqAttribute, {Q_STATUS}, MakeValue(Q_RAISED));
+    State()->SetAttribute(currentSoftIrqAttribute, {Q_STATUS}, State()->Intern(Q_RAISED));
 }
 
 void LinuxSchedStateBlock::onSchedSwitch(const trace::EventValue& event)
@@ -270,15 +270,15 @@ void LinuxSchedStateBlock::onSchedSwitch(const trace::EventValue& event)
     auto qPrevTid = State()->IntQuark(prevTid);
     auto nextTid =  event.getFields()->GetField("next_tid")->AsInteger();
     auto qNextTid =  State()->IntQuark(nextTid);
-    auto nextComm = event.getFields()->GetField("next_comm")->AsString();
+    auto nextComm = event.getFields()->GetField("next_comm");
     auto currentCpuAttribute = getCurrentCpuAttribute(event);
     auto threadsPrevTidStatusAttribute =
         State()->GetAttributeKey(linuxAttribute, {Q_THREADS, qPrevTid, Q_STATUS});
 
     if (prevState == 0) {
-        State()->SetAttribute(threadsPrevTidStatusAttribute, MakeValue(Q_WAIT_FOR_CPU));
+        State()->SetAttribute(threadsPrevTidStatusAttribute, State()->Intern(Q_WAIT_FOR_CPU));
     } else {
-        State()->SetAttribute(threadsPrevTidStatusAttribute, MakeValue(Q_WAIT_BLOCKED));
+        State()->SetAttribute(threadsPrevTidStatusAttribute, State()->Intern(Q_WAIT_BLOCKED));
     }
 
     auto newCurrentThread =
@@ -286,13 +286,13 @@ void LinuxSchedStateBlock::onSchedSwitch(const trace::EventValue& event)
 
     // new current thread's run mode
     if (State()->GetAttributeValue(newCurrentThread, {Q_SYSCALL}) == nullptr) {
-        State()->SetAttribute(newCurrentThread, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+        State()->SetAttribute(newCurrentThread, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
     } else {
-        State()->SetAttribute(newCurrentThread, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+        State()->SetAttribute(newCurrentThread, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
     }
 
     // thread's exec name
-    State()->SetAttribute(newCurrentThread, {Q_EXEC_NAME}, MakeValue(nextComm));
+    State()->SetAttribute(newCurrentThread, {Q_EXEC_NAME}, State()->InternString(nextComm->AsStringView()));
 
     // thread's current cpu
     State()->SetAttribute(newCurrentThread, {Q_CUR_CPU}, MakeValue(getEventCpu(event)));
@@ -303,12 +303,12 @@ void LinuxSchedStateBlock::onSchedSwitch(const trace::EventValue& event)
     // current CPU's status
     if (nextTid != 0L) {
         if (State()->GetAttributeValue(newCurrentThread, {Q_SYSCALL}) != nullptr) {
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
         } else {
-            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_USERMODE));
+            State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_USERMODE));
         }
     } else {
-        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_IDLE));
+        State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_IDLE));
     }
 }
 
@@ -319,7 +319,7 @@ void LinuxSchedStateBlock::onSchedProcessFork(const trace::EventValue& event)
     auto qChildTid = State()->IntQuark(childTid);
     auto parentTid = event.getFields()->GetField("parent_tid")->AsInteger();
     auto qParentTid = State()->IntQuark(parentTid);
-    auto childComm = event.getFields()->GetField("child_comm")->AsString();
+    auto childComm = event.getFields()->GetField("child_comm");
     auto threadsChildTidAttribute =
         State()->GetAttributeKey(linuxAttribute, {Q_THREADS, qChildTid});
 
@@ -327,20 +327,20 @@ void LinuxSchedStateBlock::onSchedProcessFork(const trace::EventValue& event)
     State()->SetAttribute(threadsChildTidAttribute, {Q_PPID}, MakeValue(parentTid));
 
     // child thread's exec name
-    State()->SetAttribute(threadsChildTidAttribute, {Q_EXEC_NAME}, MakeValue(childComm));
+    State()->SetAttribute(threadsChildTidAttribute, {Q_EXEC_NAME}, State()->InternString(childComm->AsStringView()));
 
     // child thread's status
-    State()->SetAttribute(threadsChildTidAttribute, {Q_STATUS}, MakeValue(Q_WAIT_FOR_CPU));
+    State()->SetAttribute(threadsChildTidAttribute, {Q_STATUS}, State()->Intern(Q_WAIT_FOR_CPU));
 
     // child thread's syscall
     auto parentSyscall =
         State()->GetAttributeValue(linuxAttribute, {Q_THREADS, qParentTid, Q_SYSCALL});
     if (parentSyscall) {
-        State()->SetAttribute(threadsChildTidAttribute, {Q_SYSCALL}, parentSyscall->Copy());
+        State()->SetAttribute(threadsChildTidAttribute, {Q_SYSCALL}, value::ValueRef::Share(parentSyscall));
     }
 
     if (State()->GetAttributeValue(threadsChildTidAttribute, {Q_SYSCALL}) == nullptr) {
-        State()->SetAttribute(threadsChildTidAttribute, {Q_SYSCALL}, MakeValue(kStateSysClone));
+        State()->SetAttribute(threadsChildTidAttribute, {Q_SYSCALL}, State()->InternString(kStateSysClone));
     }
 }
 
@@ -359,7 +359,7 @@ void LinuxSchedStateBlock::onLttngStatedumpProcessState(const trace::EventValue&
     auto qTid = State()->IntQuark(event.getFields()->GetField("tid")->AsInteger());
     auto ppid = event.getFields()->GetField("ppid")->AsInteger();
     auto status = event.getFields()->GetField("status")->AsInteger();
-    auto name = event.getFields()->GetField("name")->AsString();
+    auto name = event.getFields()->GetField("name");
     auto threadsTidAttribute = State()->GetAttributeKey(linuxAttribute, {Q_THREADS, qTid});
     auto threadsTidExecNameAttribute = State()->GetAttributeKey(threadsTidAttribute, {Q_EXEC_NAME});
     auto threadsTidPpidAttribute = State()->GetAttributeKey(threadsTidAttribute, {Q_PPID});
@@ -367,7 +367,7 @@ void LinuxSchedStateBlock::onLttngStatedumpProcessState(const trace::EventValue&
 
     // initialize thread's exec name
     if (State()->GetAttributeValue(threadsTidExecNameAttribute) == nullptr) {
-        State()->SetAttribute(threadsTidExecNameAttribute, MakeValue(name));
+        State()->SetAttribute(threadsTidExecNameAttribute, State()->InternString(name->AsStringView()));
     }
 
     // initialize thread's parent TID
@@ -378,11 +378,11 @@ void LinuxSchedStateBlock::onLttngStatedumpProcessState(const trace::EventValue&
     // initialize thread's status
     if (State()->GetAttributeValue(threadsTidStatusAttribute) == nullptr) {
         if (status == 2L) {
-            State()->SetAttribute(threadsTidStatusAttribute, MakeValue(Q_WAIT_FOR_CPU));
+            State()->SetAttribute(threadsTidStatusAttribute, State()->Intern(Q_WAIT_FOR_CPU));
         } else if (status == 5L) {
-            State()->SetAttribute(threadsTidStatusAttribute, MakeValue(Q_WAIT_BLOCKED));
+            State()->SetAttribute(threadsTidStatusAttribute, State()->Intern(Q_WAIT_BLOCKED));
         } else {
-            State()->SetAttribute(threadsTidStatusAttribute, MakeValue(Q_UNKNOWN));
+            State()->SetAttribute(threadsTidStatusAttribute, State()->Intern(Q_UNKNOWN));
         }   
     }
 }
@@ -400,13 +400,13 @@ void LinuxSchedStateBlock::onSchedWakeupEvent(const trace::EventValue& event)
             State()->GetAttributeValue(threadsTidStatusAttribute)->AsUInteger();
         if (qThreadTidStatusAttribute != Q_RUN_USERMODE.get() &&
             qThreadTidStatusAttribute != Q_RUN_SYSCALL.get()) {
-            State()->SetAttribute(threadsTidStatusAttribute, MakeValue(Q_WAIT_FOR_CPU));
+            State()->SetAttribute(threadsTidStatusAttribute, State()->Intern(Q_WAIT_FOR_CPU));
         }
     }
     else
     {
         // TODO: is this right?
-        State()->SetAttribute(threadsTidStatusAttribute, MakeValue(Q_WAIT_FOR_CPU));
+        State()->SetAttribute(threadsTidStatusAttribute, State()->Intern(Q_WAIT_FOR_CPU));
     }
 }
 
@@ -416,15 +416,15 @@ void LinuxSchedStateBlock::onSysEvent(const trace::EventValue& event)
     auto currentCpuAttribute = getCurrentCpuAttribute(event);
 
     if (currentThreadAttribute != state::InvalidAttributeKey()) {
-        std::string syscall = event.getName();
-        if (syscall.find(kSyscallWithParamsPrefix) == 0)
-            syscall = syscall.substr(strlen(kSyscallWithParamsPrefix));
+        boost::string_ref syscall = event.getName();
+        if (syscall.starts_with(kSyscallWithParamsPrefix))
+            syscall.remove_prefix(strlen(kSyscallWithParamsPrefix));
 
-        State()->SetAttribute(currentThreadAttribute, {Q_SYSCALL}, MakeValue(syscall));
-        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+        State()->SetAttribute(currentThreadAttribute, {Q_SYSCALL}, State()->InternString(syscall));
+        State()->SetAttribute(currentThreadAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
     }
 
-    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, MakeValue(Q_RUN_SYSCALL));
+    State()->SetAttribute(currentCpuAttribute, {Q_STATUS}, State()->Intern(Q_RUN_SYSCALL));
 }
 
 uint32_t LinuxSchedStateBlock::getEventCpu(const trace::EventValue& event) const
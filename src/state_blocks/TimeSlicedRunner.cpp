@@ -0,0 +1,178 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "state_blocks/TimeSlicedRunner.hpp"
+
+#include <thread>
+
+#include "base/print.hpp"
+#include "block/BlockRunner.hpp"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "trace/TraceSet.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace state_blocks
+{
+
+using base::tbendl;
+using base::tberror;
+
+TimeSlicedRunner::TimeSlicedRunner(const std::vector<std::string>& traces,
+                                   size_t numSlices,
+                                   const BlocksFactory& blocksFactory)
+    : _traces(traces),
+      _blocksFactory(blocksFactory),
+      _slices(numSlices == 0 ? 1 : numSlices)
+{
+    _quarks.EnableLocking();
+}
+
+TimeSlicedRunner::~TimeSlicedRunner()
+{
+}
+
+bool TimeSlicedRunner::Run()
+{
+    // Split the time range of the traces in slices of equal duration.
+    trace::TraceSet traceSet;
+    for (const auto& trace : _traces)
+    {
+        if (!traceSet.addTrace(trace))
+        {
+            tberror() << "Trace " << trace << " could not be loaded." << tbendl();
+            return false;
+        }
+    }
+
+    timestamp_t begin = traceSet.getBegin();
+    timestamp_t end = traceSet.getEnd();
+    if (begin > end)
+        return false;
+
+    timestamp_t sliceDuration = (end - begin) / _slices.size() + 1;
+    std::vector<size_t> allSlices;
+    for (size_t i = 0; i < _slices.size(); ++i)
+    {
+        _slices[i].begin = begin + i * sliceDuration;
+        _slices[i].end = begin + (i + 1) * sliceDuration;
+        _slices[i].initial.clear();
+        _slices[i].numRuns = 1;
+        allSlices.push_back(i);
+    }
+    _slices.back().end = end + 1;
+
+    // First run: all slices start with an unknown state.
+    RunSlices(allSlices);
+    StitchSlices(0);
+
+    // Slices that read attributes whose value differs from the one they
+    // started with run again from the stitched state of the previous
+    // slice, until the stitched states stop changing. The first slice
+    // of an iteration starts from a final state: the slices before it
+    // don't change anymore.
+    for (;;)
+    {
+        std::vector<size_t> slicesToRunAgain;
+        for (size_t i = 1; i < _slices.size(); ++i)
+        {
+            if (_slices[i].unresolved.empty())
+                continue;
+            _slices[i].initial = _slices[i - 1].stitched;
+            ++_slices[i].numRuns;
+            slicesToRunAgain.push_back(i);
+        }
+
+        if (slicesToRunAgain.empty())
+            break;
+
+        RunSlices(slicesToRunAgain);
+        StitchSlices(slicesToRunAgain.front());
+    }
+
+    return true;
+}
+
+void TimeSlicedRunner::MergeResults(const ResultsMerger& merge) const
+{
+    for (size_t i = 0; i < _slices.size(); ++i)
+        merge(i, _slices[i].blocks);
+}
+
+void TimeSlicedRunner::RunSlices(const std::vector<size_t>& slices)
+{
+    // The blocks are created on this thread, the factory doesn't have to
+    // be thread-safe.
+    for (size_t slice : slices)
+        _slices[slice].blocks = _blocksFactory(slice);
+
+    std::vector<std::thread> threads;
+    for (size_t slice : slices)
+        threads.push_back(std::thread(&TimeSlicedRunner::RunSlice, this, slice));
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void TimeSlicedRunner::RunSlice(size_t sliceIndex)
+{
+    Slice& slice = _slices[sliceIndex];
+
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    for (const auto& trace : _traces)
+        traceList->Append<value::StringValue>(trace);
+    traceParams.AddField("traces", std::move(traceList));
+    traceParams.AddField<value::ULongValue>("begin", slice.begin);
+    traceParams.AddField<value::ULongValue>("end", slice.end);
+
+    trace_blocks::TraceBlock traceBlock;
+    CurrentStateBlock currentStateBlock(&_quarks);
+
+    state::CurrentState* currentState = currentStateBlock.GetCurrentState();
+    state::ApplySnapshot(slice.initial, currentState);
+    currentState->EnableReadTracking();
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    for (const auto& block : slice.blocks)
+        blockRunner.AddBlock(block.get(), nullptr);
+    blockRunner.Run();
+
+    state::TakeSnapshot(*currentState, &slice.final);
+}
+
+void TimeSlicedRunner::StitchSlices(size_t first)
+{
+    const state::StateSnapshot emptySnapshot;
+
+    for (size_t i = first; i < _slices.size(); ++i)
+    {
+        const state::StateSnapshot& previous =
+            i == 0 ? emptySnapshot : _slices[i - 1].stitched;
+        state::StitchSnapshots(previous,
+                               _slices[i].initial,
+                               _slices[i].final,
+                               &_slices[i].stitched,
+                               &_slices[i].unresolved);
+    }
+}
+
+}
+}
@@ -0,0 +1,161 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_STATEBLOCKS_TIMESLICEDRUNNER_HPP
+#define _TIBEE_STATEBLOCKS_TIMESLICEDRUNNER_HPP
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/BasicTypes.hpp"
+#include "block/BlockInterface.hpp"
+#include "quark/StringQuarkDatabase.hpp"
+#include "state/AttributePath.hpp"
+#include "state/StateSnapshot.hpp"
+
+namespace tibee
+{
+namespace state_blocks
+{
+
+/**
+ * Runs an analysis over time slices of a trace, in parallel.
+ *
+ * Each slice is analyzed on its own thread by a trace block restricted
+ * to the time range of the slice, a current state block and the blocks
+ * returned by the factory. The slices share a quark database, so that
+ * quarks stored in attribute values mean the same thing in all slices.
+ *
+ * A slice starts with an unknown state and records which attributes it
+ * reads before writing them. Once all slices are done, their final
+ * states are stitched in order. Slices that read attributes whose value
+ * differs from the one they started with are then run again, in
+ * parallel, starting from the stitched state of the previous slice, and
+ * the states are stitched again. This is repeated until the stitched
+ * states stop changing: a slice that is run again while the previous
+ * slice is also run again may start from a stale state, but the first
+ * slice run again in an iteration always starts from a final state, so
+ * each iteration resolves at least one slice.
+ *
+ * The results of the analysis are in the blocks of the last run of each
+ * slice, which MergeResults() hands over in the order of the slices.
+ *
+ * @author Francois Doray
+ */
+class TimeSlicedRunner :
+    boost::noncopyable
+{
+public:
+    typedef std::vector<block::BlockInterface::UP> Blocks;
+
+    /**
+     * Creates the analysis blocks of a slice. Called again for a slice
+     * that is run again: the blocks of the first run are then discarded.
+     */
+    typedef std::function<Blocks (size_t slice)> BlocksFactory;
+
+    /**
+     * Constructor.
+     *
+     * @param traces Paths of the traces to analyze.
+     * @param numSlices Number of time slices, i.e. of threads.
+     * @param blocksFactory Creates the analysis blocks of a slice.
+     */
+    TimeSlicedRunner(const std::vector<std::string>& traces,
+                     size_t numSlices,
+                     const BlocksFactory& blocksFactory);
+    ~TimeSlicedRunner();
+
+    /**
+     * Runs the analysis.
+     *
+     * @returns true on success, false if the traces could not be read.
+     */
+    bool Run();
+
+    size_t numSlices() const { return _slices.size(); }
+    timestamp_t GetSliceBegin(size_t slice) const { return _slices[slice].begin; }
+    timestamp_t GetSliceEnd(size_t slice) const { return _slices[slice].end; }
+
+    /**
+     * Returns the state at the end of a slice, after stitching.
+     */
+    const state::StateSnapshot& GetStitchedState(size_t slice) const {
+        return _slices[slice].stitched;
+    }
+
+    /**
+     * Returns the attributes whose value was wrong when the slice read
+     * them during its last run. Empty for all slices once Run() succeeds.
+     */
+    const std::vector<state::AttributePathStr>& GetUnresolvedReads(size_t slice) const {
+        return _slices[slice].unresolved;
+    }
+
+    /**
+     * Returns the number of times a slice was run.
+     */
+    size_t GetNumRuns(size_t slice) const { return _slices[slice].numRuns; }
+    bool WasRunAgain(size_t slice) const { return _slices[slice].numRuns > 1; }
+
+    /**
+     * Returns the blocks of the last run of a slice.
+     */
+    const Blocks& GetBlocks(size_t slice) const { return _slices[slice].blocks; }
+
+    /**
+     * Receives the blocks of the last run of a slice, to merge their
+     * results with those of the previous slices.
+     */
+    typedef std::function<void (size_t slice, const Blocks& blocks)> ResultsMerger;
+
+    /**
+     * Calls |merge| with the blocks of each slice, in the order of the
+     * slices. Must be called after Run().
+     */
+    void MergeResults(const ResultsMerger& merge) const;
+
+private:
+    struct Slice
+    {
+        timestamp_t begin;
+        timestamp_t end;
+        Blocks blocks;
+        state::StateSnapshot initial;
+        state::StateSnapshot final;
+        state::StateSnapshot stitched;
+        std::vector<state::AttributePathStr> unresolved;
+        size_t numRuns;
+    };
+
+    void RunSlice(size_t slice);
+    void RunSlices(const std::vector<size_t>& slices);
+    void StitchSlices(size_t first);
+
+    std::vector<std::string> _traces;
+    BlocksFactory _blocksFactory;
+    quark::StringQuarkDatabase _quarks;
+    std::vector<Slice> _slices;
+};
+
+}
+}
+
+#endif // _TIBEE_STATEBLOCKS_TIMESLICEDRUNNER_HPP
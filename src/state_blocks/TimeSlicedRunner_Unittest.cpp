@@ -0,0 +1,132 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+
+#include "base/Constants.hpp"
+#include "block/AbstractBlock.hpp"
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "state_blocks/TimeSlicedRunner.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+
+namespace tibee
+{
+namespace state_blocks
+{
+
+namespace
+{
+
+const char kTrace[] = "test_data/kernel_a/kernel";
+
+// Counts the events of a slice.
+class EventCountBlock : public block::AbstractBlock
+{
+public:
+    EventCountBlock() : count(0) {}
+
+    virtual void AddObservers(notification::NotificationCenter* notificationCenter) override
+    {
+        AddKernelObserver<EventCountBlock, &EventCountBlock::onEvent>(
+            notificationCenter, notification::AnyToken(), this);
+    }
+
+    void onEvent(const trace::EventValue& event)
+    {
+        ++count;
+    }
+
+    uint64_t count;
+};
+
+TimeSlicedRunner::Blocks CreateLinuxSchedBlocks(size_t slice)
+{
+    TimeSlicedRunner::Blocks blocks;
+    blocks.push_back(block::BlockInterface::UP {new LinuxSchedStateBlock});
+    blocks.push_back(block::BlockInterface::UP {new EventCountBlock});
+    return blocks;
+}
+
+uint64_t CountEvents(const TimeSlicedRunner& runner)
+{
+    uint64_t count = 0;
+    runner.MergeResults([&] (size_t slice, const TimeSlicedRunner::Blocks& blocks) {
+        count += static_cast<const EventCountBlock*>(blocks[1].get())->count;
+    });
+    return count;
+}
+
+}  // namespace
+
+TEST(TimeSlicedRunner, SingleSlice)
+{
+    TimeSlicedRunner runner({kTrace}, 1, CreateLinuxSchedBlocks);
+    ASSERT_TRUE(runner.Run());
+    ASSERT_EQ(1u, runner.numSlices());
+    EXPECT_FALSE(runner.WasRunAgain(0));
+    EXPECT_TRUE(runner.GetUnresolvedReads(0).empty());
+    EXPECT_FALSE(runner.GetStitchedState(0).empty());
+}
+
+TEST(TimeSlicedRunner, SlicesMatchSequentialRun)
+{
+    TimeSlicedRunner sequential({kTrace}, 1, CreateLinuxSchedBlocks);
+    ASSERT_TRUE(sequential.Run());
+
+    TimeSlicedRunner sliced({kTrace}, 4, CreateLinuxSchedBlocks);
+    ASSERT_TRUE(sliced.Run());
+    ASSERT_EQ(4u, sliced.numSlices());
+
+    EXPECT_EQ(sequential.GetSliceBegin(0), sliced.GetSliceBegin(0));
+    EXPECT_EQ(sequential.GetSliceEnd(0), sliced.GetSliceEnd(3));
+    for (size_t i = 1; i < sliced.numSlices(); ++i)
+        EXPECT_EQ(sliced.GetSliceEnd(i - 1), sliced.GetSliceBegin(i));
+
+    // The slices were run again until all their reads were resolved.
+    EXPECT_EQ(1u, sliced.GetNumRuns(0));
+    for (size_t i = 0; i < sliced.numSlices(); ++i)
+        EXPECT_TRUE(sliced.GetUnresolvedReads(i).empty()) << i;
+
+    // The merged results of the slices cover the whole trace once.
+    EXPECT_GT(CountEvents(sequential), 0u);
+    EXPECT_EQ(CountEvents(sequential), CountEvents(sliced));
+
+    // The current thread of each CPU is known once stitched.
+    const auto& expected = sequential.GetStitchedState(0);
+    const auto& actual = sliced.GetStitchedState(3);
+    size_t numCpus = 0;
+    for (const auto& attribute : expected)
+    {
+        const auto& path = attribute.first;
+        if (path.size() != 4 || path[1] != kStateCpus || path[3] != kStateCurThread)
+            continue;
+        ++numCpus;
+
+        auto look = actual.find(path);
+        ASSERT_NE(actual.end(), look);
+        EXPECT_TRUE(value::Value::AreEqual(attribute.second.value.get(),
+                                           look->second.value.get()));
+    }
+    EXPECT_GT(numCpus, 0u);
+}
+
+}  // namespace state_blocks
+}  // namespace tibee
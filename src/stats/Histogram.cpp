@@ -0,0 +1,141 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "stats/Histogram.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+
+namespace tibee
+{
+namespace stats
+{
+
+namespace
+{
+
+const uint64_t kSubBucketCount = 1ull << Histogram::kSubBucketBits;
+
+int HighestBit(uint64_t value)
+{
+    assert(value != 0);
+    return 63 - __builtin_clzll(value);
+}
+
+}  // namespace
+
+Histogram::Histogram()
+    : _count(0),
+      _sum(0),
+      _min(std::numeric_limits<uint64_t>::max()),
+      _max(0)
+{
+}
+
+size_t Histogram::BucketIndex(uint64_t value)
+{
+    if (value < kSubBucketCount)
+        return static_cast<size_t>(value);
+
+    // The bits below the |kSubBucketBits| most significant bits are
+    // dropped.
+    int shift = HighestBit(value) - kSubBucketBits;
+    return static_cast<size_t>(((shift + 1) << kSubBucketBits) +
+                               ((value >> shift) - kSubBucketCount));
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index)
+{
+    if (index < kSubBucketCount)
+        return index;
+
+    uint64_t shift = (index >> kSubBucketBits) - 1;
+    uint64_t subBucket = (index & (kSubBucketCount - 1)) + kSubBucketCount;
+    uint64_t lowerBound = subBucket << shift;
+    return lowerBound + ((1ull << shift) - 1);
+}
+
+void Histogram::Record(uint64_t value)
+{
+    size_t index = BucketIndex(value);
+    if (index >= _buckets.size())
+        _buckets.resize(index + 1);
+    ++_buckets[index];
+
+    ++_count;
+    _sum += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+void Histogram::Merge(const Histogram& other)
+{
+    if (other._buckets.size() > _buckets.size())
+        _buckets.resize(other._buckets.size());
+    for (size_t i = 0; i < other._buckets.size(); ++i)
+        _buckets[i] += other._buckets[i];
+
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+double Histogram::mean() const
+{
+    if (_count == 0)
+        return 0;
+    return static_cast<double>(_sum) / _count;
+}
+
+uint64_t Histogram::Percentile(double percentile) const
+{
+    if (_count == 0)
+        return 0;
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * _count + 0.5);
+    rank = std::min(std::max(rank, static_cast<uint64_t>(1)), _count);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i)
+    {
+        seen += _buckets[i];
+        if (seen >= rank)
+            return std::min(std::max(BucketUpperBound(i), min()), _max);
+    }
+
+    return _max;
+}
+
+value::Value::UP Histogram::ToValue() const
+{
+    value::StructValue::UP summary {new value::StructValue};
+    summary->AddField<value::ULongValue>("count", _count);
+    summary->AddField<value::ULongValue>("min", min());
+    summary->AddField<value::ULongValue>("max", _max);
+    summary->AddField<value::DoubleValue>("mean", mean());
+    summary->AddField<value::ULongValue>("p50", Percentile(50));
+    summary->AddField<value::ULongValue>("p90", Percentile(90));
+    summary->AddField<value::ULongValue>("p99", Percentile(99));
+    summary->AddField<value::ULongValue>("p99.9", Percentile(99.9));
+    return std::move(summary);
+}
+
+}
+}
@@ -0,0 +1,93 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_STATS_HISTOGRAM_HPP
+#define _TIBEE_STATS_HISTOGRAM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "value/Value.hpp"
+
+namespace tibee
+{
+namespace stats
+{
+
+/**
+ * Streaming histogram of unsigned values with log-linear buckets.
+ *
+ * Values below 2^kSubBucketBits have their own bucket. Each following
+ * power of two is split into 2^kSubBucketBits buckets of equal width,
+ * so a percentile is reported with a relative error below
+ * 2^-kSubBucketBits. Memory is bounded by the number of buckets needed
+ * to hold the largest recorded value, no matter how many values are
+ * recorded.
+ *
+ * @author Francois Doray
+ */
+class Histogram
+{
+public:
+    static const int kSubBucketBits = 5;
+
+    Histogram();
+
+    void Record(uint64_t value);
+
+    // Adds the values recorded by another histogram.
+    void Merge(const Histogram& other);
+
+    uint64_t count() const { return _count; }
+    uint64_t sum() const { return _sum; }
+    uint64_t min() const { return _count == 0 ? 0 : _min; }
+    uint64_t max() const { return _max; }
+    double mean() const;
+
+    /**
+     * Returns the smallest value such that |percentile| percent of the
+     * recorded values are lower or equal, within the precision of the
+     * buckets.
+     *
+     * @param percentile Percentile, between 0 and 100.
+     * @returns The value at the percentile, 0 if the histogram is empty.
+     */
+    uint64_t Percentile(double percentile) const;
+
+    /**
+     * Returns a summary of the histogram: count, min, max, mean, p50,
+     * p90, p99 and p99.9.
+     */
+    value::Value::UP ToValue() const;
+
+    // Exposed for tests.
+    static size_t BucketIndex(uint64_t value);
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    std::vector<uint64_t> _buckets;
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
+
+}
+}
+
+#endif // _TIBEE_STATS_HISTOGRAM_HPP
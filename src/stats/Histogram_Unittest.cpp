@@ -0,0 +1,92 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "stats/Histogram.hpp"
+
+namespace tibee
+{
+namespace stats
+{
+
+TEST(Histogram, Empty)
+{
+    Histogram histogram;
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(0u, histogram.min());
+    EXPECT_EQ(0u, histogram.max());
+    EXPECT_EQ(0u, histogram.Percentile(50));
+}
+
+TEST(Histogram, Buckets)
+{
+    // Small values are exact.
+    for (uint64_t value = 0; value < 64; ++value)
+    {
+        EXPECT_EQ(value, Histogram::BucketIndex(value));
+        EXPECT_EQ(value, Histogram::BucketUpperBound(value));
+    }
+
+    // The upper bound of the bucket of a value is within the precision
+    // of the histogram.
+    for (uint64_t value = 64; value < (1ull << 40); value = value * 3 / 2 + 1)
+    {
+        uint64_t upperBound = Histogram::BucketUpperBound(Histogram::BucketIndex(value));
+        EXPECT_LE(value, upperBound);
+        EXPECT_LE(upperBound - value, value >> Histogram::kSubBucketBits);
+        EXPECT_EQ(Histogram::BucketIndex(value), Histogram::BucketIndex(upperBound));
+        EXPECT_EQ(Histogram::BucketIndex(value) + 1, Histogram::BucketIndex(upperBound + 1));
+    }
+}
+
+TEST(Histogram, Percentiles)
+{
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 10000; ++value)
+        histogram.Record(value);
+
+    EXPECT_EQ(10000u, histogram.count());
+    EXPECT_EQ(1u, histogram.min());
+    EXPECT_EQ(10000u, histogram.max());
+    EXPECT_DOUBLE_EQ(5000.5, histogram.mean());
+
+    const double kPrecision = 1.0 / (1 << Histogram::kSubBucketBits);
+    EXPECT_NEAR(5000, histogram.Percentile(50), 5000 * kPrecision);
+    EXPECT_NEAR(9900, histogram.Percentile(99), 9900 * kPrecision);
+    EXPECT_NEAR(9990, histogram.Percentile(99.9), 9990 * kPrecision);
+    EXPECT_EQ(10000u, histogram.Percentile(100));
+    EXPECT_EQ(1u, histogram.Percentile(0));
+}
+
+TEST(Histogram, Merge)
+{
+    Histogram a;
+    Histogram b;
+    a.Record(10);
+    b.Record(1000000);
+    b.Record(5);
+
+    a.Merge(b);
+    EXPECT_EQ(3u, a.count());
+    EXPECT_EQ(5u, a.min());
+    EXPECT_EQ(1000000u, a.max());
+    EXPECT_EQ(1000015u, a.sum());
+    EXPECT_EQ(10u, a.Percentile(50));
+}
+
+}  // namespace stats
+}  // namespace tibee
@@ -0,0 +1,102 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_STATS_TOPN_HPP
+#define _TIBEE_STATS_TOPN_HPP
+
+#include <algorithm>
+#include <functional>
+#include <stddef.h>
+#include <vector>
+
+namespace tibee
+{
+namespace stats
+{
+
+/**
+ * Keeps the N greatest elements added to it, according to |Compare|.
+ *
+ * Elements are kept in a min-heap of at most N elements: adding an
+ * element that is not among the N greatest costs one comparison.
+ *
+ * @author Francois Doray
+ */
+template <typename T, typename Compare = std::less<T>>
+class TopN
+{
+public:
+    explicit TopN(size_t n, Compare compare = Compare())
+        : _n(n), _greater(compare)
+    {
+        _heap.reserve(n);
+    }
+
+    void Add(const T& element)
+    {
+        if (_n == 0)
+            return;
+
+        if (_heap.size() < _n)
+        {
+            _heap.push_back(element);
+            std::push_heap(_heap.begin(), _heap.end(), _greater);
+            return;
+        }
+
+        // The heap front is the smallest of the N greatest elements.
+        if (!_greater.compare(_heap.front(), element))
+            return;
+
+        std::pop_heap(_heap.begin(), _heap.end(), _greater);
+        _heap.back() = element;
+        std::push_heap(_heap.begin(), _heap.end(), _greater);
+    }
+
+    // Returns the kept elements, greatest first.
+    std::vector<T> Sorted() const
+    {
+        std::vector<T> sorted(_heap);
+        std::sort(sorted.begin(), sorted.end(), _greater);
+        return sorted;
+    }
+
+    size_t size() const { return _heap.size(); }
+    bool empty() const { return _heap.empty(); }
+
+private:
+    // Reverses |Compare| so that the standard heap functions build a
+    // min-heap.
+    struct Greater
+    {
+        explicit Greater(Compare compare) : compare(compare) {}
+        bool operator()(const T& left, const T& right) const
+        {
+            return compare(right, left);
+        }
+        Compare compare;
+    };
+
+    size_t _n;
+    Greater _greater;
+    std::vector<T> _heap;
+};
+
+}
+}
+
+#endif // _TIBEE_STATS_TOPN_HPP
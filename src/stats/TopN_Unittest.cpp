@@ -0,0 +1,67 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "stats/TopN.hpp"
+
+namespace tibee
+{
+namespace stats
+{
+
+TEST(TopN, KeepsGreatest)
+{
+    TopN<int> top(3);
+    EXPECT_TRUE(top.empty());
+
+    int values[] = {5, 1, 9, 3, 7, 9, 2};
+    for (int value : values)
+        top.Add(value);
+
+    EXPECT_EQ(3u, top.size());
+    EXPECT_EQ((std::vector<int> {9, 9, 7}), top.Sorted());
+}
+
+TEST(TopN, CustomCompare)
+{
+    typedef std::pair<int, const char*> Element;
+    auto compareFirst = [] (const Element& a, const Element& b) {
+        return a.first < b.first;
+    };
+
+    TopN<Element, decltype(compareFirst)> top(2, compareFirst);
+    top.Add(Element(1, "a"));
+    top.Add(Element(3, "b"));
+    top.Add(Element(2, "c"));
+
+    auto sorted = top.Sorted();
+    ASSERT_EQ(2u, sorted.size());
+    EXPECT_STREQ("b", sorted[0].second);
+    EXPECT_STREQ("c", sorted[1].second);
+}
+
+TEST(TopN, Zero)
+{
+    TopN<int> top(0);
+    top.Add(1);
+    EXPECT_TRUE(top.empty());
+}
+
+}  // namespace stats
+}  // namespace tibee
@@ -73,9 +73,13 @@ void EventValueFactory::initTypes()
         return new(_enumPool.get()) value::ULongValue {::bt_ctf_get_uint64(intDef)};
     };
 
+    // String values point into the trace buffers rather than copying the
+    // characters: they are valid until the end of the event.
     auto stringBuilder = [this] (const ::bt_definition* def, const ::bt_ctf_event* ev)
     {
-        return new(_stringPool.get()) value::StringValue {::bt_ctf_get_string(def)};
+        auto str = ::bt_ctf_get_string(def);
+        return new(_stringPool.get()) value::StringViewValue {
+            str != nullptr ? boost::string_ref {str} : boost::string_ref {}};
     };
 
     auto structBuilder = [this] (const ::bt_definition* def, const ::bt_ctf_event* ev)
@@ -96,10 +100,11 @@ void EventValueFactory::initTypes()
         if (encoding == ::CTF_STRING_UTF8 || encoding == ::CTF_STRING_ASCII) {
             if (::bt_ctf_field_type(decl) == CTF_TYPE_SEQUENCE) {
                 // TODO(fdoray): Find a way to retrieve a CTF sequence string.
-                return new(_stringPool.get()) value::StringValue {"/ Unable to read ctf string sequence. /"};
+                return new(_stringPool.get()) value::StringViewValue {"/ Unable to read ctf string sequence. /"};
             } else {
                 auto str = ::bt_ctf_get_char_array(def);
-                return new(_stringPool.get()) value::StringValue {str};
+                return new(_stringPool.get()) value::StringViewValue {
+                    str != nullptr ? boost::string_ref {str} : boost::string_ref {}};
             }
         }
         return new(_arrayPool.get()) ArrayEventValue {def, ev, this};
@@ -90,7 +90,7 @@ private:
     EventValuePool<value::ULongValue> _enumPool;
     EventValuePool<value::DoubleValue> _doublePool;
     EventValuePool<value::LongValue> _longPool;
-    EventValuePool<value::StringValue> _stringPool;
+    EventValuePool<value::StringViewValue> _stringPool;
     EventValuePool<value::ULongValue> _ulongPool;
 
     // TODO(fdoray): Add an enum type.
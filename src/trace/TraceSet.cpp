@@ -68,6 +68,15 @@ void TraceSet::seekBegin() const
     ::bt_iter_set_pos(_btIter, &beginPos);
 }
 
+void TraceSet::seekTime(timestamp_t ts) const
+{
+    ::bt_iter_pos timePos;
+    timePos.type = ::BT_SEEK_TIME;
+    timePos.u.seek_time = ts;
+
+    ::bt_iter_set_pos(_btIter, &timePos);
+}
+
 std::unique_ptr<FieldInfos> TraceSet::getFieldInfos(const ::tibee_bt_declaration* tibeeBtDecl,
                                                     std::string name,
                                                     field_index_t index)
@@ -378,6 +387,14 @@ TraceSet::Iterator TraceSet::begin() const
     return TraceSet::Iterator {_btCtfIter};
 }
 
+TraceSet::Iterator TraceSet::seek(timestamp_t ts) const
+{
+    // move to timestamp (will also affect all existing iterators)
+    this->seekTime(ts);
+
+    // create new iterator
+    return TraceSet::Iterator {_btCtfIter};
+}
 
 TraceSet::Iterator TraceSet::end() const
 {
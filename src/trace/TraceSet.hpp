@@ -89,6 +89,15 @@ public:
      */
     Iterator begin() const;
 
+    /**
+     * Returns an iterator pointing to the first event of the set whose
+     * timestamp is greater than or equal to \p ts.
+     *
+     * @param ts Timestamp to seek
+     * @returns  Iterator pointing to the first event at or after \p ts
+     */
+    Iterator seek(timestamp_t ts) const;
+
     /**
      * Returns an iterator pointing after the last event of the set.
      *
@@ -108,6 +117,7 @@ public:
 
 private:
     void seekBegin() const;
+    void seekTime(timestamp_t ts) const;
     static std::unique_ptr<TraceInfos::EventMap> getEventMap(::bt_ctf_event_decl* const* eventDeclList,
                                                              unsigned int count);
     static std::unique_ptr<EventInfos> getEventInfos(const ::tibee_bt_ctf_event_decl* tibeeBtCtfEventDecl,
@@ -52,10 +52,39 @@ const char* kEventTopLevelFields[] = {
 }  // namespace
 
 EventValue::EventValue(const EventValueFactory* valueFactory) :
+    _btEvent {nullptr},
     _valueFactory {valueFactory}
 {
 }
 
+EventValue::EventValue(event_id_t id, trace_id_t traceId, const char* name,
+                       trace_cycles_t cycles, timestamp_t timestamp) :
+    _btEvent {nullptr},
+    _valueFactory {nullptr},
+    _name {name},
+    _ts {timestamp},
+    _cycles {cycles},
+    _fieldsDict {nullptr},
+    _contextDict {nullptr},
+    _streamEventContextDict {nullptr},
+    _streamPacketContextDict {nullptr},
+    _id {id},
+    _traceId {traceId}
+{
+}
+
+void EventValue::setScopes(const value::Value* fields,
+                           const value::Value* context,
+                           const value::Value* streamEventContext,
+                           const value::Value* streamPacketContext)
+{
+    const value::Value* empty = std::addressof(_emptyStruct);
+    _fieldsDict = fields != nullptr ? fields : empty;
+    _contextDict = context != nullptr ? context : empty;
+    _streamEventContextDict = streamEventContext != nullptr ? streamEventContext : empty;
+    _streamPacketContextDict = streamPacketContext != nullptr ? streamPacketContext : empty;
+}
+
 size_t EventValue::Length() const
 {
     return kNumFields;
@@ -93,13 +122,17 @@ const value::Value* EventValue::GetField(const std::string& name) const
 
 const value::Value* EventValue::at(size_t index) const
 {
+    // Events that are not backed by a babeltrace event already hold
+    // their name and timestamp.
     if (index == kNameFieldOffset) {
-        _name.SetValue(getName());
+        if (_btEvent != nullptr)
+            _name.SetValue(getName());
         return &_name;
     }
 
     if (index == kTimestampFieldOffset) {
-        _ts.SetValue(getTimestamp());
+        if (_btEvent != nullptr)
+            _ts.SetValue(getTimestamp());
         return &_ts;
     }
         
@@ -127,6 +160,8 @@ value::StructValueBase::Iterator EventValue::fields_end() const
 
 const char* EventValue::getName() const
 {
+    if (_btEvent == nullptr)
+        return _name.GetValue().c_str();
     return ::bt_ctf_event_name(_btEvent);
 }
 
@@ -137,11 +172,15 @@ std::string EventValue::getNameStr() const
 
 trace_cycles_t EventValue::getCycles() const
 {
+    if (_btEvent == nullptr)
+        return _cycles;
     return static_cast<trace_cycles_t>(::bt_ctf_get_cycles(_btEvent));
 }
 
 timestamp_t EventValue::getTimestamp() const
 {
+    if (_btEvent == nullptr)
+        return _ts.GetValue();
     return static_cast<timestamp_t>(::bt_ctf_get_timestamp(_btEvent));
 }
 
@@ -183,6 +183,31 @@ public:
         return _traceId;
     }
 
+protected:
+    /**
+     * Constructor for events that are not backed by a babeltrace
+     * event. The accessors return the given values and the scopes set
+     * with setScopes().
+     *
+     * @param id Event numeric ID
+     * @param traceId Numeric ID of the trace of the event
+     * @param name Event name
+     * @param cycles Cycle count
+     * @param timestamp Event timestamp
+     */
+    EventValue(event_id_t id, trace_id_t traceId, const char* name,
+               trace_cycles_t cycles, timestamp_t timestamp);
+
+    /**
+     * Sets the scopes of an event that is not backed by a babeltrace
+     * event. The scopes are owned by the caller. A null scope is
+     * returned as an empty dictionary.
+     */
+    void setScopes(const value::Value* fields,
+                   const value::Value* context,
+                   const value::Value* streamEventContext,
+                   const value::Value* streamPacketContext);
+
 private:
     // Implementation of a struct iterator.
     class IteratorImpl :
@@ -217,6 +242,7 @@ private:
     const EventValueFactory* _valueFactory;
     mutable value::StringValue _name;
     mutable value::ULongValue _ts;
+    trace_cycles_t _cycles;
     mutable const value::Value* _fieldsDict;
     mutable const value::Value* _contextDict;
     mutable const value::Value* _streamEventContextDict;
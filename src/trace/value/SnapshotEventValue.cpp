@@ -0,0 +1,50 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trace/value/SnapshotEventValue.hpp"
+
+namespace tibee
+{
+namespace trace
+{
+
+namespace
+{
+
+value::Value::UP CopyScope(const value::Value* scope)
+{
+    if (scope == nullptr)
+        return nullptr;
+    return scope->Copy();
+}
+
+}  // namespace
+
+SnapshotEventValue::SnapshotEventValue(const EventValue& event) :
+    EventValue {event.getId(), event.getTraceId(), event.getName(),
+                event.getCycles(), event.getTimestamp()},
+    _fields {CopyScope(event.getFields())},
+    _context {CopyScope(event.getContext())},
+    _streamEventContext {CopyScope(event.getStreamEventContext())},
+    _streamPacketContext {CopyScope(event.getStreamPacketContext())}
+{
+    setScopes(_fields.get(), _context.get(),
+              _streamEventContext.get(), _streamPacketContext.get());
+}
+
+}
+}
@@ -0,0 +1,65 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_TRACE_VALUE_SNAPSHOTEVENTVALUE_HPP
+#define _TIBEE_TRACE_VALUE_SNAPSHOTEVENTVALUE_HPP
+
+#include <memory>
+
+#include "trace/value/EventValue.hpp"
+
+namespace tibee
+{
+namespace trace
+{
+
+/**
+ * Event that owns a copy of all the fields of another event.
+ *
+ * An EventValue is only valid until its trace set iterator moves
+ * forward. A snapshot can be kept as long as needed, for example
+ * to hand the event to another thread. The accessors of EventValue
+ * aren't virtual: a snapshot fills the cached name, timestamp and
+ * scopes of the event, which are returned when there is no babeltrace
+ * event.
+ *
+ * @author Francois Doray
+ */
+class SnapshotEventValue :
+    public EventValue
+{
+public:
+    typedef std::unique_ptr<SnapshotEventValue> UP;
+
+    /**
+     * Copies an event.
+     *
+     * @param event Event to copy.
+     */
+    explicit SnapshotEventValue(const EventValue& event);
+
+private:
+    value::Value::UP _fields;
+    value::Value::UP _context;
+    value::Value::UP _streamEventContext;
+    value::Value::UP _streamPacketContext;
+};
+
+}
+}
+
+#endif  // _TIBEE_TRACE_VALUE_SNAPSHOTEVENTVALUE_HPP
@@ -17,6 +17,8 @@
  */
 #include "trace_blocks/TraceBlock.hpp"
 
+#include <limits>
+
 #include "base/Constants.hpp"
 #include "base/print.hpp"
 #include "notification/NotificationCenter.hpp"
@@ -30,10 +32,25 @@ using notification::Token;
 using tibee::base::tbendl;
 using tibee::base::tbwarn;
 
+TraceBlock::TraceBlock()
+    : _begin(0),
+      _end(std::numeric_limits<timestamp_t>::max()),
+      _notificationCenter(nullptr)
+{
+}
+
 void TraceBlock::Start(const value::Value* params)
 {
     _traceSet.reset(new trace::TraceSet);
 
+    const value::Value* begin = nullptr;
+    if (params->GetField("begin", &begin))
+        begin->AsULong(&_begin);
+
+    const value::Value* end = nullptr;
+    if (params->GetField("end", &end))
+        end->AsULong(&_end);
+
     const value::ArrayValueBase* traceList = nullptr;
     if (!params->GetFieldAs("traces", &traceList))
         return;
@@ -50,6 +67,8 @@ void TraceBlock::Start(const value::Value* params)
 
 void TraceBlock::GetNotificationSinks(notification::NotificationCenter* notificationCenter)
 {
+    _notificationCenter = notificationCenter;
+
     const auto& tracesInfos = _traceSet->getTracesInfos();
 
     for (const auto& traceInfos : tracesInfos)
@@ -86,8 +105,14 @@ void TraceBlock::Execute()
 {
     _beginSink->PostNotification(nullptr);
 
-    for (const auto& event : *_traceSet)
+    auto it = _begin == 0 ? _traceSet->begin() : _traceSet->seek(_begin);
+    auto itEnd = _traceSet->end();
+    for (; it != itEnd; ++it)
     {
+        const auto& event = *it;
+        if (event.getTimestamp() >= _end)
+            break;
+
         // Timestamp notification.
         _tsNotification.SetValue(event.getTimestamp());
         _tsSink->PostNotification(&_tsNotification);
@@ -105,6 +130,9 @@ void TraceBlock::Execute()
         eventIt->second->PostNotification(&event);
     }
 
+    // Batch observers receive the last events before the end notification.
+    _notificationCenter->FlushBatches();
+
     _endSink->PostNotification(nullptr);
 }
 
@@ -34,11 +34,18 @@ namespace trace_blocks
 /**
  * A block that reads events from a trace.
  *
+ * Parameters:
+ *   traces: Array of trace paths.
+ *   begin:  Optional. Timestamp of the first event to read.
+ *   end:    Optional. Events at or after this timestamp are not read.
+ *
  * @author Francois Doray
  */
 class TraceBlock : public block::AbstractBlock
 {
 public:
+    TraceBlock();
+
     virtual void Start(const value::Value* params) override;
     virtual void GetNotificationSinks(notification::NotificationCenter* notificationCenter) override;
     virtual void Execute() override;
@@ -46,6 +53,10 @@ public:
 private:
     trace::TraceSet::UP _traceSet;
 
+    // Time range to read.
+    timestamp_t _begin;
+    timestamp_t _end;
+
     // (event ID -> event callback) map
     typedef std::unordered_map<trace::event_id_t, const notification::NotificationSink*> EventIdSinkMap;
 
@@ -66,6 +77,9 @@ private:
 
     // Timestamp notification.
     value::ULongValue _tsNotification;
+
+    // Notification center whose batches are flushed at the end of the trace.
+    notification::NotificationCenter* _notificationCenter;
 };
 
 }
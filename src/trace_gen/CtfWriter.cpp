@@ -0,0 +1,435 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trace_gen/CtfWriter.hpp"
+
+#include <assert.h>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+#include "base/print.hpp"
+
+namespace tibee
+{
+namespace trace_gen
+{
+
+namespace
+{
+
+const uint32_t kPacketMagic = 0xC1FC1FC1;
+const uint32_t kStreamId = 0;
+
+// Size of the packet header and of the packet context, in bytes.
+const size_t kPacketHeaderSize = 68;
+
+// Offsets of the fields of the packet header and of the packet context.
+const size_t kMagicOffset = 0;
+const size_t kUuidOffset = 4;
+const size_t kStreamIdOffset = 20;
+const size_t kTimestampBeginOffset = 24;
+const size_t kTimestampEndOffset = 32;
+const size_t kContentSizeOffset = 40;
+const size_t kPacketSizeOffset = 48;
+const size_t kEventsDiscardedOffset = 56;
+const size_t kCpuIdOffset = 64;
+
+// Event header ("event_header_large" of LTTng).
+const uint16_t kExtendedEventId = 65535;
+const size_t kCompactEventHeaderSize = 2 + 4;
+const size_t kExtendedEventHeaderSize = 2 + 4 + 8;
+const uint64_t kCompactTimestampRange = 1ull << 32;
+
+const size_t kCommSize = 16;
+
+template <typename T>
+void StoreLittleEndian(T value, char* dest)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+        dest[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+}
+
+template <typename T>
+void AppendLittleEndian(T value, std::vector<char>* dest)
+{
+    char bytes[sizeof(T)];
+    StoreLittleEndian(value, bytes);
+    dest->insert(dest->end(), bytes, bytes + sizeof(T));
+}
+
+const char* FieldTypeToTsdl(FieldType type)
+{
+    switch (type) {
+        case FieldType::kInt32:
+            return "integer { size = 32; align = 8; signed = 1; encoding = none; base = 10; }";
+        case FieldType::kUInt32:
+            return "integer { size = 32; align = 8; signed = 0; encoding = none; base = 10; }";
+        case FieldType::kInt64:
+            return "integer { size = 64; align = 8; signed = 1; encoding = none; base = 10; }";
+        case FieldType::kUInt64:
+            return "integer { size = 64; align = 8; signed = 0; encoding = none; base = 10; }";
+        case FieldType::kComm:
+            return "integer { size = 8; align = 8; signed = 1; encoding = UTF8; base = 10; }";
+        case FieldType::kString:
+            return "string";
+    }
+    return "";
+}
+
+const char kMetadataHeader[] =
+    "/* CTF 1.8 */\n"
+    "\n"
+    "typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+    "typealias integer { size = 16; align = 8; signed = false; } := uint16_t;\n"
+    "typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+    "typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+    "typealias integer { size = 64; align = 8; signed = false; } := unsigned long;\n"
+    "\n";
+
+const char kMetadataEnvironment[] =
+    "env {\n"
+    "\thostname = \"tibee-ctfgen\";\n"
+    "\tdomain = \"kernel\";\n"
+    "\tsysname = \"Linux\";\n"
+    "\tkernel_release = \"3.13.0\";\n"
+    "\tkernel_version = \"#1 SMP\";\n"
+    "\ttracer_name = \"lttng-modules\";\n"
+    "\ttracer_major = 2;\n"
+    "\ttracer_minor = 5;\n"
+    "\ttracer_patchlevel = 0;\n"
+    "};\n"
+    "\n"
+    "clock {\n"
+    "\tname = monotonic;\n"
+    "\tdescription = \"Monotonic Clock\";\n"
+    "\tfreq = 1000000000; /* Frequency, in Hz */\n"
+    "\toffset = 0;\n"
+    "};\n"
+    "\n"
+    "typealias integer {\n"
+    "\tsize = 32; align = 8; signed = false;\n"
+    "\tmap = clock.monotonic.value;\n"
+    "} := uint32_clock_monotonic_t;\n"
+    "\n"
+    "typealias integer {\n"
+    "\tsize = 64; align = 8; signed = false;\n"
+    "\tmap = clock.monotonic.value;\n"
+    "} := uint64_clock_monotonic_t;\n"
+    "\n"
+    "struct packet_context {\n"
+    "\tuint64_clock_monotonic_t timestamp_begin;\n"
+    "\tuint64_clock_monotonic_t timestamp_end;\n"
+    "\tuint64_t content_size;\n"
+    "\tuint64_t packet_size;\n"
+    "\tunsigned long events_discarded;\n"
+    "\tuint32_t cpu_id;\n"
+    "};\n"
+    "\n"
+    "struct event_header_large {\n"
+    "\tenum : uint16_t { compact = 0 ... 65534, extended = 65535 } id;\n"
+    "\tvariant <id> {\n"
+    "\t\tstruct {\n"
+    "\t\t\tuint32_clock_monotonic_t timestamp;\n"
+    "\t\t} compact;\n"
+    "\t\tstruct {\n"
+    "\t\t\tuint32_t id;\n"
+    "\t\t\tuint64_clock_monotonic_t timestamp;\n"
+    "\t\t} extended;\n"
+    "\t} v;\n"
+    "} align(8);\n"
+    "\n"
+    "stream {\n"
+    "\tid = 0;\n"
+    "\tevent.header := struct event_header_large;\n"
+    "\tpacket.context := struct packet_context;\n"
+    "};\n"
+    "\n";
+
+}  // namespace
+
+const size_t CtfWriter::kDefaultPacketSize = 256 * 1024;
+
+CtfWriter::CtfWriter(const boost::filesystem::path& directory,
+                     uint32_t numCpus,
+                     size_t packetSize,
+                     uint32_t seed)
+    : _directory(directory),
+      _packetSize(packetSize),
+      _eventCpu(0),
+      _eventTimestamp(0),
+      _eventClass(0),
+      _numEvents(0),
+      _open(false)
+{
+    assert(packetSize > kPacketHeaderSize + kExtendedEventHeaderSize);
+
+    // Random UUID (version 4).
+    std::mt19937 generator(seed);
+    for (size_t i = 0; i < sizeof(_uuid); ++i)
+        _uuid[i] = static_cast<uint8_t>(generator() & 0xFF);
+    _uuid[6] = (_uuid[6] & 0x0F) | 0x40;
+    _uuid[8] = (_uuid[8] & 0x3F) | 0x80;
+
+    for (uint32_t cpu = 0; cpu < numCpus; ++cpu) {
+        std::unique_ptr<Stream> stream {new Stream};
+        stream->packet.resize(_packetSize);
+        stream->contentSize = kPacketHeaderSize;
+        stream->numEventsInPacket = 0;
+        stream->firstTimestamp = 0;
+        stream->lastTimestamp = 0;
+        _streams.push_back(std::move(stream));
+    }
+}
+
+CtfWriter::~CtfWriter()
+{
+    if (_open)
+        Close();
+}
+
+bool CtfWriter::Open()
+{
+    boost::system::error_code error;
+    boost::filesystem::create_directories(_directory, error);
+    if (error) {
+        base::tberror() << "cannot create directory " << _directory.string()
+                        << base::tbendl() << std::endl;
+        return false;
+    }
+
+    for (size_t cpu = 0; cpu < _streams.size(); ++cpu) {
+        auto path = _directory / ("channel0_" + std::to_string(cpu));
+        _streams[cpu]->file.open(path.string().c_str(),
+                                 std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!_streams[cpu]->file) {
+            base::tberror() << "cannot create stream file " << path.string()
+                            << base::tbendl() << std::endl;
+            return false;
+        }
+    }
+
+    _open = true;
+    return true;
+}
+
+uint32_t CtfWriter::AddEventClass(const std::string& name,
+                                  const FieldDeclarations& fields)
+{
+    assert(_eventClasses.size() < kExtendedEventId);
+
+    EventClass eventClass;
+    eventClass.name = name;
+    eventClass.fields = fields;
+    _eventClasses.push_back(eventClass);
+    return static_cast<uint32_t>(_eventClasses.size() - 1);
+}
+
+void CtfWriter::BeginEvent(uint32_t cpu, timestamp_t ts, uint32_t eventClass)
+{
+    assert(cpu < _streams.size());
+    assert(eventClass < _eventClasses.size());
+
+    _eventCpu = cpu;
+    _eventTimestamp = ts;
+    _eventClass = eventClass;
+    _eventPayload.clear();
+}
+
+void CtfWriter::AddInt32(int32_t value)
+{
+    AppendLittleEndian(value, &_eventPayload);
+}
+
+void CtfWriter::AddUInt32(uint32_t value)
+{
+    AppendLittleEndian(value, &_eventPayload);
+}
+
+void CtfWriter::AddInt64(int64_t value)
+{
+    AppendLittleEndian(value, &_eventPayload);
+}
+
+void CtfWriter::AddUInt64(uint64_t value)
+{
+    AppendLittleEndian(value, &_eventPayload);
+}
+
+void CtfWriter::AddComm(const std::string& value)
+{
+    char comm[kCommSize] = {};
+    std::strncpy(comm, value.c_str(), kCommSize - 1);
+    _eventPayload.insert(_eventPayload.end(), comm, comm + kCommSize);
+}
+
+void CtfWriter::AddString(const std::string& value)
+{
+    _eventPayload.insert(_eventPayload.end(), value.begin(), value.end());
+    _eventPayload.push_back('\0');
+}
+
+void CtfWriter::EndEvent()
+{
+    auto& stream = *_streams[_eventCpu];
+    assert(stream.numEventsInPacket == 0 ||
+           _eventTimestamp >= stream.lastTimestamp);
+
+    // A compact header holds the 32 low-order bits of the timestamp. The
+    // reader infers the high-order bits from the previous event of the
+    // packet, which is only possible if less than 2^32 ns elapsed.
+    bool compact = stream.numEventsInPacket != 0 &&
+                   _eventTimestamp - stream.lastTimestamp < kCompactTimestampRange;
+    size_t headerSize = compact ? kCompactEventHeaderSize : kExtendedEventHeaderSize;
+
+    if (stream.contentSize + headerSize + _eventPayload.size() > _packetSize &&
+        stream.numEventsInPacket != 0) {
+        FlushPacket(_eventCpu);
+        compact = false;
+        headerSize = kExtendedEventHeaderSize;
+    }
+    assert(stream.contentSize + headerSize + _eventPayload.size() <= _packetSize);
+
+    char* dest = &stream.packet[stream.contentSize];
+    if (compact) {
+        StoreLittleEndian(static_cast<uint16_t>(_eventClass), dest);
+        StoreLittleEndian(static_cast<uint32_t>(_eventTimestamp), dest + 2);
+    } else {
+        StoreLittleEndian(kExtendedEventId, dest);
+        StoreLittleEndian(_eventClass, dest + 2);
+        StoreLittleEndian(static_cast<uint64_t>(_eventTimestamp), dest + 6);
+    }
+    if (!_eventPayload.empty())
+        std::memcpy(dest + headerSize, &_eventPayload[0], _eventPayload.size());
+    stream.contentSize += headerSize + _eventPayload.size();
+
+    if (stream.numEventsInPacket == 0)
+        stream.firstTimestamp = _eventTimestamp;
+    stream.lastTimestamp = _eventTimestamp;
+    ++stream.numEventsInPacket;
+    ++_numEvents;
+}
+
+void CtfWriter::FlushPacket(uint32_t cpu)
+{
+    auto& stream = *_streams[cpu];
+    char* packet = &stream.packet[0];
+
+    StoreLittleEndian(kPacketMagic, packet + kMagicOffset);
+    std::memcpy(packet + kUuidOffset, _uuid, sizeof(_uuid));
+    StoreLittleEndian(kStreamId, packet + kStreamIdOffset);
+    StoreLittleEndian(static_cast<uint64_t>(stream.firstTimestamp), packet + kTimestampBeginOffset);
+    StoreLittleEndian(static_cast<uint64_t>(stream.lastTimestamp), packet + kTimestampEndOffset);
+    StoreLittleEndian(static_cast<uint64_t>(stream.contentSize * 8), packet + kContentSizeOffset);
+    StoreLittleEndian(static_cast<uint64_t>(_packetSize * 8), packet + kPacketSizeOffset);
+    StoreLittleEndian(static_cast<uint64_t>(0), packet + kEventsDiscardedOffset);
+    StoreLittleEndian(cpu, packet + kCpuIdOffset);
+
+    std::memset(packet + stream.contentSize, 0, _packetSize - stream.contentSize);
+    stream.file.write(packet, _packetSize);
+
+    stream.contentSize = kPacketHeaderSize;
+    stream.numEventsInPacket = 0;
+    stream.firstTimestamp = stream.lastTimestamp;
+}
+
+bool CtfWriter::Close()
+{
+    if (!_open)
+        return false;
+    _open = false;
+
+    bool success = true;
+    for (uint32_t cpu = 0; cpu < _streams.size(); ++cpu) {
+        auto& stream = *_streams[cpu];
+
+        // Every stream file contains at least one packet.
+        if (stream.numEventsInPacket != 0 || stream.file.tellp() == 0)
+            FlushPacket(cpu);
+
+        stream.file.close();
+        if (stream.file.fail())
+            success = false;
+    }
+
+    auto metadataPath = _directory / "metadata";
+    std::ofstream metadata(metadataPath.string().c_str(),
+                           std::ios::out | std::ios::binary | std::ios::trunc);
+    metadata << GetMetadata();
+    metadata.close();
+    if (metadata.fail())
+        success = false;
+
+    if (!success) {
+        base::tberror() << "cannot write trace " << _directory.string()
+                        << base::tbendl() << std::endl;
+    }
+
+    return success;
+}
+
+std::string CtfWriter::GetMetadata() const
+{
+    std::stringstream ss;
+
+    ss << kMetadataHeader;
+
+    ss << "trace {\n"
+       << "\tmajor = 1;\n"
+       << "\tminor = 8;\n"
+       << "\tuuid = \"";
+    const char kHexDigits[] = "0123456789abcdef";
+    for (size_t i = 0; i < sizeof(_uuid); ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+            ss << '-';
+        ss << kHexDigits[_uuid[i] >> 4] << kHexDigits[_uuid[i] & 0xF];
+    }
+    ss << "\";\n"
+       << "\tbyte_order = le;\n"
+       << "\tpacket.header := struct {\n"
+       << "\t\tuint32_t magic;\n"
+       << "\t\tuint8_t  uuid[16];\n"
+       << "\t\tuint32_t stream_id;\n"
+       << "\t};\n"
+       << "};\n"
+       << "\n";
+
+    ss << kMetadataEnvironment;
+
+    for (size_t id = 0; id < _eventClasses.size(); ++id) {
+        const auto& eventClass = _eventClasses[id];
+        ss << "event {\n"
+           << "\tname = \"" << eventClass.name << "\";\n"
+           << "\tid = " << id << ";\n"
+           << "\tstream_id = " << kStreamId << ";\n"
+           << "\tfields := struct {\n";
+        for (const auto& field : eventClass.fields) {
+            ss << "\t\t" << FieldTypeToTsdl(field.type) << " _" << field.name;
+            if (field.type == FieldType::kComm)
+                ss << "[" << kCommSize << "]";
+            ss << ";\n";
+        }
+        ss << "\t};\n"
+           << "};\n"
+           << "\n";
+    }
+
+    return ss.str();
+}
+
+}
+}
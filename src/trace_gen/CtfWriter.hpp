@@ -0,0 +1,162 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_TRACE_GEN_CTFWRITER_HPP
+#define _TIBEE_TRACE_GEN_CTFWRITER_HPP
+
+#include <boost/filesystem.hpp>
+#include <boost/utility.hpp>
+#include <fstream>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/BasicTypes.hpp"
+
+namespace tibee
+{
+namespace trace_gen
+{
+
+// Types of the fields of the generated events.
+enum class FieldType
+{
+    kInt32,
+    kUInt32,
+    kInt64,
+    kUInt64,
+    kComm,    // 16 characters array, as the "comm" fields of the kernel.
+    kString,  // Null-terminated string.
+};
+
+struct FieldDeclaration
+{
+    std::string name;
+    FieldType type;
+};
+
+typedef std::vector<FieldDeclaration> FieldDeclarations;
+
+/**
+ * Writes a CTF trace that looks like an LTTng kernel trace: a textual
+ * metadata file and one stream file per CPU. Each packet context holds
+ * the CPU number in its "cpu_id" field.
+ *
+ * Event classes are declared with AddEventClass(). An event is written
+ * with BeginEvent(), one Add*() call per declared field, in declaration
+ * order, and EndEvent(). The events of a CPU must be written in
+ * timestamp order.
+ *
+ * @author Francois Doray
+ */
+class CtfWriter :
+    boost::noncopyable
+{
+public:
+    static const size_t kDefaultPacketSize;
+
+    /**
+     * Constructor.
+     *
+     * @param directory Directory in which the trace is written.
+     * @param numCpus Number of CPUs, i.e. of stream files.
+     * @param packetSize Size of the packets, in bytes.
+     * @param seed Seed used to generate the UUID of the trace.
+     */
+    CtfWriter(const boost::filesystem::path& directory,
+              uint32_t numCpus,
+              size_t packetSize,
+              uint32_t seed);
+    ~CtfWriter();
+
+    /**
+     * Creates the trace directory and the stream files.
+     *
+     * @returns true on success, false otherwise.
+     */
+    bool Open();
+
+    /**
+     * Declares an event class. Must be called before Close().
+     *
+     * @param name Name of the event.
+     * @param fields Fields of the event.
+     * @returns Numeric ID of the event class.
+     */
+    uint32_t AddEventClass(const std::string& name,
+                           const FieldDeclarations& fields);
+
+    void BeginEvent(uint32_t cpu, timestamp_t ts, uint32_t eventClass);
+    void AddInt32(int32_t value);
+    void AddUInt32(uint32_t value);
+    void AddInt64(int64_t value);
+    void AddUInt64(uint64_t value);
+    void AddComm(const std::string& value);
+    void AddString(const std::string& value);
+    void EndEvent();
+
+    /**
+     * Flushes the last packets and writes the metadata file.
+     *
+     * @returns true on success, false otherwise.
+     */
+    bool Close();
+
+    uint64_t numEvents() const { return _numEvents; }
+
+private:
+    struct Stream
+    {
+        std::ofstream file;
+        std::vector<char> packet;
+        size_t contentSize;
+        uint64_t numEventsInPacket;
+        timestamp_t firstTimestamp;
+        timestamp_t lastTimestamp;
+    };
+
+    struct EventClass
+    {
+        std::string name;
+        FieldDeclarations fields;
+    };
+
+    void FlushPacket(uint32_t cpu);
+    std::string GetMetadata() const;
+
+    boost::filesystem::path _directory;
+    size_t _packetSize;
+    uint8_t _uuid[16];
+
+    std::vector<std::unique_ptr<Stream>> _streams;
+    std::vector<EventClass> _eventClasses;
+
+    // Event being written.
+    uint32_t _eventCpu;
+    timestamp_t _eventTimestamp;
+    uint32_t _eventClass;
+    std::vector<char> _eventPayload;
+
+    uint64_t _numEvents;
+    bool _open;
+};
+
+}
+}
+
+#endif // _TIBEE_TRACE_GEN_CTFWRITER_HPP
@@ -0,0 +1,717 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trace_gen/KernelTraceGenerator.hpp"
+
+#include <assert.h>
+#include <deque>
+#include <queue>
+#include <random>
+#include <unordered_map>
+
+#include "base/print.hpp"
+#include "trace_gen/CtfWriter.hpp"
+
+namespace tibee
+{
+namespace trace_gen
+{
+
+namespace
+{
+
+// Values of the "prev_state" field of sched_switch.
+const int64_t kTaskRunning = 0;
+const int64_t kTaskInterruptible = 1;
+const int64_t kTaskDead = 64;
+
+// Value of the "status" field of lttng_statedump_process_state for a
+// blocked thread.
+const int32_t kStatusWaitBlocked = 5;
+
+const int32_t kIdleTid = 0;
+const int32_t kFirstTid = 1000;
+const int32_t kPrio = 20;
+
+// Time between the exit of a thread and the release of its resources.
+const timestamp_t kFreeDelayNs = 50000;
+
+// Time between the return of a blocked system call and the moment the
+// thread is scheduled back.
+const timestamp_t kResumeDelayNs = 1000;
+
+// Maximum delay before the first wakeup of a long-lived thread.
+const timestamp_t kMaxFirstWakeupNs = 1000000;
+
+enum class ThreadStatus
+{
+    kBlocked,
+    kRunnable,
+    kRunning,
+    kDead,
+};
+
+struct Thread
+{
+    int32_t tid;
+    std::string comm;
+    ThreadStatus status;
+    uint32_t cpu;
+    bool inSyscall;
+    size_t syscall;
+    timestamp_t switchInTs;
+    bool isChild;
+    timestamp_t deathTs;
+};
+
+struct Cpu
+{
+    std::string idleComm;
+    int32_t current;
+    std::deque<int32_t> runQueue;
+
+    // Incremented on each context switch to invalidate pending ticks.
+    uint64_t generation;
+};
+
+enum class ActionType
+{
+    kTick,
+    kWakeup,
+    kFork,
+    kFree,
+};
+
+struct Action
+{
+    timestamp_t ts;
+    uint64_t seq;
+    ActionType type;
+    uint32_t cpu;
+    int32_t tid;
+    uint64_t generation;
+};
+
+struct LaterAction
+{
+    bool operator()(const Action& a, const Action& b) const
+    {
+        if (a.ts != b.ts)
+            return a.ts > b.ts;
+        return a.seq > b.seq;
+    }
+};
+
+// Fields of the system call events, as declared by LTTng.
+FieldDeclarations GetSyscallEntryFields(const std::string& name)
+{
+    if (name == "read")
+        return {{"fd", FieldType::kUInt32}, {"count", FieldType::kUInt64}};
+    if (name == "write") {
+        return {{"fd", FieldType::kUInt32}, {"buf", FieldType::kUInt64},
+                {"count", FieldType::kUInt64}};
+    }
+    if (name == "close")
+        return {{"fd", FieldType::kUInt32}};
+    if (name == "futex") {
+        return {{"uaddr", FieldType::kUInt64}, {"op", FieldType::kInt32},
+                {"val", FieldType::kUInt32}, {"utime", FieldType::kUInt64},
+                {"uaddr2", FieldType::kUInt64}, {"val3", FieldType::kUInt32}};
+    }
+    if (name == "open") {
+        return {{"filename", FieldType::kString}, {"flags", FieldType::kInt32},
+                {"mode", FieldType::kUInt32}};
+    }
+    if (name == "poll") {
+        return {{"ufds", FieldType::kUInt64}, {"nfds", FieldType::kUInt32},
+                {"timeout_msecs", FieldType::kInt32}};
+    }
+    if (name == "mmap") {
+        return {{"addr", FieldType::kUInt64}, {"len", FieldType::kUInt64},
+                {"prot", FieldType::kInt32}, {"flags", FieldType::kInt32},
+                {"fd", FieldType::kInt32}, {"offset", FieldType::kInt64}};
+    }
+    if (name == "ioctl") {
+        return {{"fd", FieldType::kUInt32}, {"cmd", FieldType::kUInt32},
+                {"arg", FieldType::kUInt64}};
+    }
+    return {};
+}
+
+class Generator
+{
+public:
+    Generator(const KernelTraceConfig& config, CtfWriter* writer)
+        : _config(config),
+          _writer(writer),
+          _random(config.seed),
+          _now(config.beginTimestamp),
+          _nextSeq(0),
+          _nextTid(kFirstTid)
+    {
+    }
+
+    void Run(KernelTraceStats* stats);
+
+private:
+    void DeclareEventClasses();
+
+    // Actions.
+    void Tick(uint32_t cpu);
+    void Wakeup(int32_t tid, bool isNew);
+    void Fork();
+    void Free(uint32_t cpu, int32_t tid);
+
+    // Scheduler.
+    void Switch(uint32_t cpu, int64_t prevState);
+    int32_t PickNext(uint32_t cpu);
+    uint32_t SelectWakeupCpu(const Thread& thread);
+    void StartSyscall(uint32_t cpu, Thread* thread);
+    void Exit(uint32_t cpu, Thread* thread);
+
+    void Schedule(timestamp_t ts, ActionType type, uint32_t cpu, int32_t tid);
+    void ScheduleTick(uint32_t cpu, timestamp_t delay);
+    Thread* CreateThread(const std::string& comm);
+    const std::string& CommOf(uint32_t cpu, int32_t tid);
+
+    // Random values.
+    timestamp_t RandomDelay(double mean);
+    timestamp_t UserTime();
+    size_t RandomSyscall();
+    bool RandomBool(double probability);
+    void AddRandomField(const FieldDeclaration& field);
+
+    const KernelTraceConfig& _config;
+    CtfWriter* _writer;
+    std::mt19937_64 _random;
+
+    timestamp_t _now;
+    std::priority_queue<Action, std::vector<Action>, LaterAction> _actions;
+    uint64_t _nextSeq;
+
+    std::vector<Cpu> _cpus;
+    std::unordered_map<int32_t, Thread> _threads;
+    int32_t _nextTid;
+
+    std::discrete_distribution<size_t> _syscallDistribution;
+
+    // Event classes.
+    uint32_t _schedSwitch;
+    uint32_t _schedWakeup;
+    uint32_t _schedWakeupNew;
+    uint32_t _schedProcessFork;
+    uint32_t _schedProcessExit;
+    uint32_t _schedProcessFree;
+    uint32_t _statedumpProcessState;
+    std::vector<uint32_t> _syscallEntry;
+    std::vector<uint32_t> _syscallExit;
+    std::vector<FieldDeclarations> _syscallEntryFields;
+
+    KernelTraceStats _stats;
+};
+
+void Generator::Run(KernelTraceStats* stats)
+{
+    DeclareEventClasses();
+
+    std::vector<double> weights;
+    for (const auto& syscall : _config.syscalls)
+        weights.push_back(syscall.weight);
+    _syscallDistribution = std::discrete_distribution<size_t>(
+        weights.begin(), weights.end());
+
+    for (uint32_t cpu = 0; cpu < _config.numCpus; ++cpu) {
+        Cpu state;
+        state.idleComm = "swapper/" + std::to_string(cpu);
+        state.current = kIdleTid;
+        state.generation = 0;
+        _cpus.push_back(state);
+    }
+
+    // State dump of the long-lived threads, which are all blocked.
+    for (uint32_t i = 0; i < _config.numThreads; ++i) {
+        Thread* thread = CreateThread("worker-" + std::to_string(i));
+
+        _writer->BeginEvent(0, _now, _statedumpProcessState);
+        _writer->AddInt32(thread->tid);  // tid
+        _writer->AddInt32(thread->tid);  // vtid
+        _writer->AddInt32(thread->tid);  // pid
+        _writer->AddInt32(thread->tid);  // vpid
+        _writer->AddInt32(1);            // ppid
+        _writer->AddInt32(1);            // vppid
+        _writer->AddComm(thread->comm);  // name
+        _writer->AddInt32(0);            // type
+        _writer->AddInt32(0);            // mode
+        _writer->AddInt32(0);            // submode
+        _writer->AddInt32(kStatusWaitBlocked);
+        _writer->AddInt32(0);            // ns_level
+        _writer->EndEvent();
+
+        Schedule(_now + 1 + _random() % kMaxFirstWakeupNs,
+                 ActionType::kWakeup, 0, thread->tid);
+    }
+
+    if (_config.forkRate > 0)
+        Schedule(_now + RandomDelay(1e9 / _config.forkRate), ActionType::kFork, 0, 0);
+
+    const timestamp_t endTs = _config.beginTimestamp + _config.durationNs;
+    while (!_actions.empty() && _actions.top().ts < endTs) {
+        Action action = _actions.top();
+        _actions.pop();
+        _now = action.ts;
+
+        switch (action.type) {
+            case ActionType::kTick:
+                if (action.generation == _cpus[action.cpu].generation)
+                    Tick(action.cpu);
+                break;
+            case ActionType::kWakeup:
+                Wakeup(action.tid, false);
+                break;
+            case ActionType::kFork:
+                Fork();
+                break;
+            case ActionType::kFree:
+                Free(action.cpu, action.tid);
+                break;
+        }
+    }
+
+    _stats.numEvents = _writer->numEvents();
+    if (stats != nullptr)
+        *stats = _stats;
+}
+
+void Generator::DeclareEventClasses()
+{
+    _schedSwitch = _writer->AddEventClass("sched_switch", {
+        {"prev_comm", FieldType::kComm},
+        {"prev_tid", FieldType::kInt32},
+        {"prev_prio", FieldType::kInt32},
+        {"prev_state", FieldType::kInt64},
+        {"next_comm", FieldType::kComm},
+        {"next_tid", FieldType::kInt32},
+        {"next_prio", FieldType::kInt32},
+    });
+
+    FieldDeclarations wakeupFields {
+        {"comm", FieldType::kComm},
+        {"tid", FieldType::kInt32},
+        {"prio", FieldType::kInt32},
+        {"success", FieldType::kInt32},
+        {"target_cpu", FieldType::kInt32},
+    };
+    _schedWakeup = _writer->AddEventClass("sched_wakeup", wakeupFields);
+    _schedWakeupNew = _writer->AddEventClass("sched_wakeup_new", wakeupFields);
+
+    _schedProcessFork = _writer->AddEventClass("sched_process_fork", {
+        {"parent_comm", FieldType::kComm},
+        {"parent_tid", FieldType::kInt32},
+        {"parent_pid", FieldType::kInt32},
+        {"child_comm", FieldType::kComm},
+        {"child_tid", FieldType::kInt32},
+        {"child_pid", FieldType::kInt32},
+    });
+
+    FieldDeclarations processFields {
+        {"comm", FieldType::kComm},
+        {"tid", FieldType::kInt32},
+        {"prio", FieldType::kInt32},
+    };
+    _schedProcessExit = _writer->AddEventClass("sched_process_exit", processFields);
+    _schedProcessFree = _writer->AddEventClass("sched_process_free", processFields);
+
+    _statedumpProcessState = _writer->AddEventClass("lttng_statedump_process_state", {
+        {"tid", FieldType::kInt32},
+        {"vtid", FieldType::kInt32},
+        {"pid", FieldType::kInt32},
+        {"vpid", FieldType::kInt32},
+        {"ppid", FieldType::kInt32},
+        {"vppid", FieldType::kInt32},
+        {"name", FieldType::kComm},
+        {"type", FieldType::kInt32},
+        {"mode", FieldType::kInt32},
+        {"submode", FieldType::kInt32},
+        {"status", FieldType::kInt32},
+        {"ns_level", FieldType::kInt32},
+    });
+
+    for (const auto& syscall : _config.syscalls) {
+        auto entryFields = GetSyscallEntryFields(syscall.name);
+        _syscallEntry.push_back(_writer->AddEventClass(
+            "syscall_entry_" + syscall.name, entryFields));
+        _syscallExit.push_back(_writer->AddEventClass(
+            "syscall_exit_" + syscall.name, {{"ret", FieldType::kInt64}}));
+        _syscallEntryFields.push_back(entryFields);
+    }
+}
+
+void Generator::Tick(uint32_t cpu)
+{
+    Thread* thread = &_threads.at(_cpus[cpu].current);
+    assert(thread->status == ThreadStatus::kRunning);
+
+    if (thread->inSyscall) {
+        _writer->BeginEvent(cpu, _now, _syscallExit[thread->syscall]);
+        _writer->AddInt64(0);  // ret
+        _writer->EndEvent();
+        thread->inSyscall = false;
+        ScheduleTick(cpu, UserTime());
+        return;
+    }
+
+    if (thread->isChild && _now >= thread->deathTs) {
+        Exit(cpu, thread);
+        return;
+    }
+
+    if (_now - thread->switchInTs >= _config.timeSliceNs &&
+        !_cpus[cpu].runQueue.empty()) {
+        thread->status = ThreadStatus::kRunnable;
+        _cpus[cpu].runQueue.push_back(thread->tid);
+        Switch(cpu, kTaskRunning);
+        return;
+    }
+
+    StartSyscall(cpu, thread);
+}
+
+void Generator::StartSyscall(uint32_t cpu, Thread* thread)
+{
+    size_t syscall = RandomSyscall();
+    const auto& syscallConfig = _config.syscalls[syscall];
+
+    _writer->BeginEvent(cpu, _now, _syscallEntry[syscall]);
+    for (const auto& field : _syscallEntryFields[syscall])
+        AddRandomField(field);
+    _writer->EndEvent();
+    ++_stats.numSyscalls;
+
+    thread->inSyscall = true;
+    thread->syscall = syscall;
+
+    if (RandomBool(syscallConfig.blockProbability)) {
+        thread->status = ThreadStatus::kBlocked;
+        Switch(cpu, kTaskInterruptible);
+        Schedule(_now + RandomDelay(syscallConfig.meanBlockedNs),
+                 ActionType::kWakeup, 0, thread->tid);
+    } else {
+        ScheduleTick(cpu, RandomDelay(syscallConfig.meanDurationNs));
+    }
+}
+
+void Generator::Exit(uint32_t cpu, Thread* thread)
+{
+    _writer->BeginEvent(cpu, _now, _schedProcessExit);
+    _writer->AddComm(thread->comm);
+    _writer->AddInt32(thread->tid);
+    _writer->AddInt32(kPrio);
+    _writer->EndEvent();
+    ++_stats.numExits;
+
+    thread->status = ThreadStatus::kDead;
+    Switch(cpu, kTaskDead);
+    Schedule(_now + kFreeDelayNs, ActionType::kFree, cpu, thread->tid);
+}
+
+void Generator::Wakeup(int32_t tid, bool isNew)
+{
+    Thread* thread = &_threads.at(tid);
+    assert(thread->status == ThreadStatus::kBlocked);
+
+    uint32_t cpu = SelectWakeupCpu(*thread);
+
+    _writer->BeginEvent(cpu, _now, isNew ? _schedWakeupNew : _schedWakeup);
+    _writer->AddComm(thread->comm);
+    _writer->AddInt32(thread->tid);
+    _writer->AddInt32(kPrio);
+    _writer->AddInt32(1);  // success
+    _writer->AddInt32(static_cast<int32_t>(cpu));
+    _writer->EndEvent();
+    ++_stats.numSchedWakeup;
+
+    thread->status = ThreadStatus::kRunnable;
+    _cpus[cpu].runQueue.push_back(tid);
+    if (_cpus[cpu].current == kIdleTid)
+        Switch(cpu, kTaskRunning);
+}
+
+void Generator::Fork()
+{
+    Schedule(_now + RandomDelay(1e9 / _config.forkRate), ActionType::kFork, 0, 0);
+
+    // The parent is the thread running on a random busy CPU.
+    uint32_t first = _random() % _cpus.size();
+    for (uint32_t i = 0; i < _cpus.size(); ++i) {
+        uint32_t cpu = (first + i) % _cpus.size();
+        if (_cpus[cpu].current == kIdleTid)
+            continue;
+
+        const Thread& parent = _threads.at(_cpus[cpu].current);
+        Thread* child = CreateThread(parent.comm);
+        child->isChild = true;
+        child->deathTs = _now + RandomDelay(_config.meanChildLifetimeNs);
+
+        _writer->BeginEvent(cpu, _now, _schedProcessFork);
+        _writer->AddComm(parent.comm);
+        _writer->AddInt32(parent.tid);
+        _writer->AddInt32(parent.tid);
+        _writer->AddComm(child->comm);
+        _writer->AddInt32(child->tid);
+        _writer->AddInt32(child->tid);
+        _writer->EndEvent();
+        ++_stats.numForks;
+
+        child->cpu = cpu;
+        Wakeup(child->tid, true);
+        return;
+    }
+}
+
+void Generator::Free(uint32_t cpu, int32_t tid)
+{
+    auto look = _threads.find(tid);
+    assert(look != _threads.end());
+
+    _writer->BeginEvent(cpu, _now, _schedProcessFree);
+    _writer->AddComm(look->second.comm);
+    _writer->AddInt32(tid);
+    _writer->AddInt32(kPrio);
+    _writer->EndEvent();
+
+    _threads.erase(look);
+}
+
+void Generator::Switch(uint32_t cpu, int64_t prevState)
+{
+    Cpu& state = _cpus[cpu];
+    int32_t prev = state.current;
+    int32_t next = PickNext(cpu);
+
+    _writer->BeginEvent(cpu, _now, _schedSwitch);
+    _writer->AddComm(CommOf(cpu, prev));
+    _writer->AddInt32(prev);
+    _writer->AddInt32(kPrio);
+    _writer->AddInt64(prevState);
+    _writer->AddComm(CommOf(cpu, next));
+    _writer->AddInt32(next);
+    _writer->AddInt32(kPrio);
+    _writer->EndEvent();
+    ++_stats.numSchedSwitch;
+
+    state.current = next;
+    ++state.generation;
+
+    if (next == kIdleTid)
+        return;
+
+    Thread& thread = _threads.at(next);
+    thread.status = ThreadStatus::kRunning;
+    thread.cpu = cpu;
+    thread.switchInTs = _now;
+    ScheduleTick(cpu, thread.inSyscall ? kResumeDelayNs : UserTime());
+}
+
+int32_t Generator::PickNext(uint32_t cpu)
+{
+    auto& runQueue = _cpus[cpu].runQueue;
+    if (!runQueue.empty()) {
+        int32_t next = runQueue.front();
+        runQueue.pop_front();
+        return next;
+    }
+
+    // Steal the last thread of the longest run queue.
+    Cpu* busiest = nullptr;
+    for (auto& other : _cpus) {
+        if (!other.runQueue.empty() &&
+            (busiest == nullptr || other.runQueue.size() > busiest->runQueue.size())) {
+            busiest = &other;
+        }
+    }
+    if (busiest == nullptr)
+        return kIdleTid;
+
+    int32_t next = busiest->runQueue.back();
+    busiest->runQueue.pop_back();
+    return next;
+}
+
+uint32_t Generator::SelectWakeupCpu(const Thread& thread)
+{
+    // Prefer the previous CPU of the thread, then any idle CPU.
+    if (_cpus[thread.cpu].current == kIdleTid)
+        return thread.cpu;
+    for (uint32_t cpu = 0; cpu < _cpus.size(); ++cpu) {
+        if (_cpus[cpu].current == kIdleTid)
+            return cpu;
+    }
+    return _random() % _cpus.size();
+}
+
+void Generator::Schedule(timestamp_t ts, ActionType type, uint32_t cpu, int32_t tid)
+{
+    Action action;
+    action.ts = ts;
+    action.seq = _nextSeq++;
+    action.type = type;
+    action.cpu = cpu;
+    action.tid = tid;
+    action.generation = _cpus.empty() ? 0 : _cpus[cpu].generation;
+    _actions.push(action);
+}
+
+void Generator::ScheduleTick(uint32_t cpu, timestamp_t delay)
+{
+    Schedule(_now + delay, ActionType::kTick, cpu, _cpus[cpu].current);
+}
+
+Thread* Generator::CreateThread(const std::string& comm)
+{
+    Thread thread;
+    thread.tid = _nextTid++;
+    thread.comm = comm;
+    thread.status = ThreadStatus::kBlocked;
+    thread.cpu = static_cast<uint32_t>(thread.tid % _config.numCpus);
+    thread.inSyscall = false;
+    thread.syscall = 0;
+    thread.switchInTs = 0;
+    thread.isChild = false;
+    thread.deathTs = 0;
+    return &(_threads[thread.tid] = thread);
+}
+
+const std::string& Generator::CommOf(uint32_t cpu, int32_t tid)
+{
+    if (tid == kIdleTid)
+        return _cpus[cpu].idleComm;
+    return _threads.at(tid).comm;
+}
+
+timestamp_t Generator::RandomDelay(double mean)
+{
+    if (mean <= 0)
+        return 1;
+    std::exponential_distribution<double> distribution(1.0 / mean);
+    timestamp_t delay = static_cast<timestamp_t>(distribution(_random));
+    return delay == 0 ? 1 : delay;
+}
+
+timestamp_t Generator::UserTime()
+{
+    // Each system call produces two events.
+    return RandomDelay(2e9 / _config.eventRate);
+}
+
+size_t Generator::RandomSyscall()
+{
+    return _syscallDistribution(_random);
+}
+
+bool Generator::RandomBool(double probability)
+{
+    std::bernoulli_distribution distribution(probability);
+    return distribution(_random);
+}
+
+void Generator::AddRandomField(const FieldDeclaration& field)
+{
+    switch (field.type) {
+        case FieldType::kInt32:
+            _writer->AddInt32(static_cast<int32_t>(_random() % 64));
+            break;
+        case FieldType::kUInt32:
+            _writer->AddUInt32(static_cast<uint32_t>(_random() % 64));
+            break;
+        case FieldType::kInt64:
+            _writer->AddInt64(static_cast<int64_t>(_random() % 4096));
+            break;
+        case FieldType::kUInt64:
+            _writer->AddUInt64(_random() % 4096);
+            break;
+        case FieldType::kComm:
+            _writer->AddComm("comm");
+            break;
+        case FieldType::kString:
+            _writer->AddString("/usr/lib/libtibee" + std::to_string(_random() % 16) + ".so");
+            break;
+    }
+}
+
+}  // namespace
+
+KernelTraceConfig::KernelTraceConfig()
+    : numCpus(4),
+      numThreads(32),
+      beginTimestamp(1000000000),
+      durationNs(1000000000),
+      eventRate(100000),
+      forkRate(100),
+      meanChildLifetimeNs(10000000),
+      timeSliceNs(4000000),
+      syscalls(GetDefaultSyscalls()),
+      seed(1),
+      packetSize(CtfWriter::kDefaultPacketSize)
+{
+}
+
+KernelTraceStats::KernelTraceStats()
+    : numEvents(0),
+      numSchedSwitch(0),
+      numSchedWakeup(0),
+      numSyscalls(0),
+      numForks(0),
+      numExits(0)
+{
+}
+
+SyscallConfigs GetDefaultSyscalls()
+{
+    return {
+        // name, weight, duration, block probability, blocked time
+        {"read", 30, 2000, 0.3, 200000},
+        {"write", 20, 3000, 0.05, 100000},
+        {"close", 8, 1000, 0, 0},
+        {"futex", 20, 1000, 0.6, 50000},
+        {"open", 5, 5000, 0.05, 500000},
+        {"poll", 8, 2000, 0.7, 1000000},
+        {"mmap", 4, 4000, 0, 0},
+        {"ioctl", 5, 3000, 0.2, 100000},
+    };
+}
+
+bool GenerateKernelTrace(const KernelTraceConfig& config,
+                         const boost::filesystem::path& directory,
+                         KernelTraceStats* stats)
+{
+    if (config.numCpus == 0 || config.eventRate <= 0 || config.syscalls.empty()) {
+        base::tberror() << "invalid trace configuration" << base::tbendl() << std::endl;
+        return false;
+    }
+
+    CtfWriter writer(directory, config.numCpus, config.packetSize, config.seed);
+    if (!writer.Open())
+        return false;
+
+    Generator generator(config, &writer);
+    generator.Run(stats);
+
+    return writer.Close();
+}
+
+}
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TIBEE_TRACE_GEN_KERNELTRACEGENERATOR_HPP
+#define _TIBEE_TRACE_GEN_KERNELTRACEGENERATOR_HPP
+
+#include <boost/filesystem.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/BasicTypes.hpp"
+
+namespace tibee
+{
+namespace trace_gen
+{
+
+// A system call that can be issued by the simulated threads.
+struct SyscallConfig
+{
+    // Name of the system call, without the "syscall_entry_" prefix.
+    std::string name;
+
+    // Relative frequency of the system call.
+    double weight;
+
+    // Mean time spent in the kernel when the system call doesn't block.
+    timestamp_t meanDurationNs;
+
+    // Probability that the thread blocks during the system call, and
+    // mean time it stays blocked.
+    double blockProbability;
+    timestamp_t meanBlockedNs;
+};
+
+typedef std::vector<SyscallConfig> SyscallConfigs;
+
+// Parameters of a generated kernel trace.
+struct KernelTraceConfig
+{
+    KernelTraceConfig();
+
+    uint32_t numCpus;
+
+    // Number of long-lived threads.
+    uint32_t numThreads;
+
+    timestamp_t beginTimestamp;
+    timestamp_t durationNs;
+
+    // Approximate number of events per second generated by a busy CPU.
+    double eventRate;
+
+    // Number of short-lived threads forked per second, and mean lifetime
+    // of these threads.
+    double forkRate;
+    timestamp_t meanChildLifetimeNs;
+
+    // Time after which a running thread is preempted if other threads
+    // are waiting for its CPU.
+    timestamp_t timeSliceNs;
+
+    SyscallConfigs syscalls;
+
+    uint32_t seed;
+    size_t packetSize;
+};
+
+// Summary of a generated trace.
+struct KernelTraceStats
+{
+    KernelTraceStats();
+
+    uint64_t numEvents;
+    uint64_t numSchedSwitch;
+    uint64_t numSchedWakeup;
+    uint64_t numSyscalls;
+    uint64_t numForks;
+    uint64_t numExits;
+};
+
+/**
+ * Returns the default system call mix: read, write, close, futex, open,
+ * poll, mmap and ioctl, with weights loosely based on real LTTng traces.
+ */
+SyscallConfigs GetDefaultSyscalls();
+
+/**
+ * Generates a synthetic LTTng-style kernel trace.
+ *
+ * The generator runs a discrete-event simulation of a machine whose
+ * threads alternate between user space and system calls. A system call
+ * may block the thread, in which case it is woken up later, possibly on
+ * another CPU. Threads that exhaust their time slice while others wait
+ * are preempted, idle CPUs steal work from busy ones, and short-lived
+ * threads are forked and exit at the configured rate. The trace starts
+ * with a state dump of the long-lived threads, all blocked.
+ *
+ * The output only depends on the configuration, including the seed.
+ *
+ * @param config Parameters of the trace.
+ * @param directory Directory in which the trace is written.
+ * @param stats Summary of the generated trace (can be null).
+ * @returns true on success, false otherwise.
+ *
+ * @author Francois Doray
+ */
+bool GenerateKernelTrace(const KernelTraceConfig& config,
+                         const boost::filesystem::path& directory,
+                         KernelTraceStats* stats);
+
+}
+}
+
+#endif // _TIBEE_TRACE_GEN_KERNELTRACEGENERATOR_HPP
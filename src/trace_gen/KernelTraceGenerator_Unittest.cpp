@@ -0,0 +1,176 @@
+/* Copyright (c) 2015 Francois Doray <francois.pierre-doray@polymtl.ca>
+ *
+ * This file is part of tigerbeetle.
+ *
+ * tigerbeetle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tigerbeetle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tigerbeetle.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "block/BlockRunner.hpp"
+#include "gtest/gtest.h"
+#include "state_blocks/CurrentStateBlock.hpp"
+#include "state_blocks/LinuxSchedStateBlock.hpp"
+#include "trace/TraceSet.hpp"
+#include "trace_blocks/TraceBlock.hpp"
+#include "trace_gen/KernelTraceGenerator.hpp"
+#include "value/MakeValue.hpp"
+
+namespace tibee
+{
+namespace trace_gen
+{
+
+namespace
+{
+
+namespace bfs = boost::filesystem;
+
+class ScopedTempDirectory
+{
+public:
+    ScopedTempDirectory()
+        : _path(bfs::temp_directory_path() / bfs::unique_path("tibee-%%%%-%%%%"))
+    {
+    }
+
+    ~ScopedTempDirectory()
+    {
+        boost::system::error_code error;
+        bfs::remove_all(_path, error);
+    }
+
+    const bfs::path& path() const { return _path; }
+
+private:
+    bfs::path _path;
+};
+
+KernelTraceConfig GetSmallConfig()
+{
+    KernelTraceConfig config;
+    config.numCpus = 3;
+    config.numThreads = 8;
+    config.durationNs = 20000000;
+    config.eventRate = 50000;
+    config.forkRate = 500;
+    config.meanChildLifetimeNs = 2000000;
+    config.packetSize = 4096;
+    return config;
+}
+
+std::string ReadFile(const bfs::path& path)
+{
+    std::ifstream in(path.string().c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST(KernelTraceGenerator, ReadBack)
+{
+    ScopedTempDirectory directory;
+    auto config = GetSmallConfig();
+
+    KernelTraceStats stats;
+    ASSERT_TRUE(GenerateKernelTrace(config, directory.path(), &stats));
+    EXPECT_GT(stats.numSchedSwitch, 0u);
+    EXPECT_GT(stats.numSchedWakeup, 0u);
+    EXPECT_GT(stats.numSyscalls, 0u);
+    EXPECT_GT(stats.numForks, 0u);
+
+    trace::TraceSet traceSet;
+    ASSERT_TRUE(traceSet.addTrace(directory.path()));
+    EXPECT_EQ(config.beginTimestamp, traceSet.getBegin());
+
+    uint64_t numEvents = 0;
+    timestamp_t lastTimestamp = 0;
+    for (const auto& event : traceSet) {
+        EXPECT_LE(lastTimestamp, event.getTimestamp());
+        lastTimestamp = event.getTimestamp();
+
+        auto cpu = event.getStreamPacketContext()->GetField("cpu_id")->AsUInteger();
+        EXPECT_LT(cpu, config.numCpus);
+        ++numEvents;
+    }
+
+    EXPECT_EQ(stats.numEvents, numEvents);
+    EXPECT_LT(lastTimestamp, config.beginTimestamp + config.durationNs);
+}
+
+TEST(KernelTraceGenerator, Deterministic)
+{
+    ScopedTempDirectory first;
+    ScopedTempDirectory second;
+    auto config = GetSmallConfig();
+
+    ASSERT_TRUE(GenerateKernelTrace(config, first.path(), nullptr));
+    ASSERT_TRUE(GenerateKernelTrace(config, second.path(), nullptr));
+
+    for (uint32_t cpu = 0; cpu < config.numCpus; ++cpu) {
+        std::string stream = "channel0_" + std::to_string(cpu);
+        EXPECT_EQ(ReadFile(first.path() / stream), ReadFile(second.path() / stream));
+    }
+    EXPECT_EQ(ReadFile(first.path() / "metadata"), ReadFile(second.path() / "metadata"));
+}
+
+TEST(KernelTraceGenerator, LinuxSchedStateBlock)
+{
+    ScopedTempDirectory directory;
+    auto config = GetSmallConfig();
+    ASSERT_TRUE(GenerateKernelTrace(config, directory.path(), nullptr));
+
+    value::StructValue traceParams;
+    value::ArrayValue::UP traceList {new value::ArrayValue};
+    traceList->Append<value::StringValue>(directory.path().string());
+    traceParams.AddField("traces", std::move(traceList));
+
+    trace_blocks::TraceBlock traceBlock;
+    state_blocks::CurrentStateBlock currentStateBlock;
+    state_blocks::LinuxSchedStateBlock linuxBlock;
+
+    block::BlockRunner blockRunner;
+    blockRunner.AddBlock(&traceBlock, &traceParams);
+    blockRunner.AddBlock(&currentStateBlock, nullptr);
+    blockRunner.AddBlock(&linuxBlock, nullptr);
+    blockRunner.Run();
+
+    // Every CPU runs the idle thread or a thread of the trace.
+    auto state = currentStateBlock.GetCurrentState();
+    for (uint32_t cpu = 0; cpu < config.numCpus; ++cpu) {
+        auto curThread = state->GetAttributeValue(state->GetAttributeKeyStr(
+            {"linux", "cpus", std::to_string(cpu), "cur-thread"}));
+        ASSERT_NE(nullptr, curThread);
+        auto tid = curThread->AsInteger();
+        EXPECT_TRUE(tid == 0 || tid >= 1000) << tid;
+    }
+
+    // The long-lived threads, with tids from 1000, were all scheduled.
+    for (uint32_t i = 0; i < config.numThreads; ++i) {
+        std::string tid = std::to_string(1000 + i);
+        auto status = state->GetAttributeValue(state->GetAttributeKeyStr(
+            {"linux", "threads", tid, "status"}));
+        EXPECT_NE(nullptr, status) << tid;
+        auto execName = state->GetAttributeValue(state->GetAttributeKeyStr(
+            {"linux", "threads", tid, "exec-name"}));
+        ASSERT_NE(nullptr, execName) << tid;
+        EXPECT_EQ("worker-" + std::to_string(i), execName->AsString());
+    }
+}
+
+}  // namespace trace_gen
+}  // namespace tibee
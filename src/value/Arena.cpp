@@ -0,0 +1,69 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "value/Arena.hpp"
+
+namespace tibee {
+namespace value {
+
+const size_t Arena::kDefaultChunkSize;
+const size_t Arena::kAlignment;
+
+Arena::Arena(size_t chunk_size)
+    : chunk_size_(chunk_size),
+      next_(nullptr),
+      end_(nullptr),
+      bytes_allocated_(0) {
+}
+
+Arena::~Arena() {
+}
+
+void* Arena::Allocate(size_t size) {
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  bytes_allocated_ += size;
+
+  // Large blocks get their own chunk, so that they don't waste the end of
+  // the current one.
+  if (size > chunk_size_ / 4)
+    return AllocateChunk(size);
+
+  if (static_cast<size_t>(end_ - next_) < size) {
+    next_ = AllocateChunk(chunk_size_);
+    end_ = next_ + chunk_size_;
+  }
+  void* result = next_;
+  next_ += size;
+  return result;
+}
+
+char* Arena::AllocateChunk(size_t size) {
+  // operator new[] returns memory aligned for any fundamental type.
+  chunks_.emplace_back(new char[size]);
+  return chunks_.back().get();
+}
+
+}  // namespace value
+}  // namespace tibee
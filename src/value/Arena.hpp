@@ -0,0 +1,85 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// An Arena allocates the nodes of Value trees in large chunks and releases
+// them all at once when it is destroyed. It suits large results built once
+// and discarded together, such as per-thread statistics.
+//
+// Usage example:
+//   Arena arena;
+//   ArenaPtr<StructValue> threads = NewValue<StructValue>(&arena, &arena);
+//   threads->AddField<IntValue>("1234", 42);  // Allocated in |arena|.
+//   ...
+//   threads.reset();  // Runs the destructors, doesn't free the nodes.
+//
+// The values of a tree allocated in an arena must be released before the
+// arena. Releasing such a value runs its destructor but leaves its memory
+// to the arena. Arena values are held by ArenaPtr handles rather than
+// Value::UP, whose deleter would free them.
+
+#ifndef _TIBEE_VALUE_ARENA_HPP
+#define _TIBEE_VALUE_ARENA_HPP
+
+#include <boost/utility.hpp>
+#include <memory>
+#include <stddef.h>
+#include <vector>
+
+namespace tibee {
+namespace value {
+
+class Arena : boost::noncopyable {
+ public:
+  static const size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit Arena(size_t chunk_size = kDefaultChunkSize);
+  ~Arena();
+
+  // Allocates |size| bytes aligned on 8 bytes. The memory is released when
+  // the arena is destroyed.
+  void* Allocate(size_t size);
+
+  // Returns the number of bytes handed out by Allocate().
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+  // Returns the number of chunks obtained from the heap.
+  size_t num_chunks() const { return chunks_.size(); }
+
+ private:
+  static const size_t kAlignment = 8;
+
+  char* AllocateChunk(size_t size);
+
+  const size_t chunk_size_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  char* next_;
+  char* end_;
+  size_t bytes_allocated_;
+};
+
+}  // namespace value
+}  // namespace tibee
+
+#endif  // _TIBEE_VALUE_ARENA_HPP
@@ -0,0 +1,155 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+
+#include "value/Arena.hpp"
+#include "value/MakeValue.hpp"
+#include "value/Value.hpp"
+#include "gtest/gtest.h"
+
+namespace tibee {
+namespace value {
+
+namespace {
+
+class IncrementOnDelete : public IntValue {
+ public:
+  IncrementOnDelete(int value, int* ptr)
+      : IntValue(value), ptr_(ptr) {
+  }
+  ~IncrementOnDelete() { *ptr_ += 1; }
+ private:
+  int* ptr_;
+};
+
+}  // namespace
+
+TEST(ArenaTest, Allocate) {
+  Arena arena(1024);
+  EXPECT_EQ(0u, arena.num_chunks());
+
+  char* first = static_cast<char*>(arena.Allocate(3));
+  char* second = static_cast<char*>(arena.Allocate(8));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first) % 8);
+  EXPECT_EQ(first + 8, second);
+  EXPECT_EQ(16u, arena.bytes_allocated());
+  EXPECT_EQ(1u, arena.num_chunks());
+
+  // A large block gets its own chunk.
+  arena.Allocate(512);
+  EXPECT_EQ(2u, arena.num_chunks());
+  EXPECT_EQ(second + 8, arena.Allocate(8));
+
+  // The current chunk is full.
+  for (int i = 0; i < 128; ++i)
+    arena.Allocate(8);
+  EXPECT_EQ(3u, arena.num_chunks());
+}
+
+TEST(ArenaTest, ValueTree) {
+  const int kNumThreads = 100000;
+  Arena arena;
+
+  ArenaPtr<StructValue> threads = NewValue<StructValue>(&arena, &arena);
+  for (int tid = 0; tid < kNumThreads; ++tid) {
+    ArenaPtr<StructValue> thread = NewValue<StructValue>(&arena, &arena);
+    thread->AddField<IntValue>("tid", tid);
+    thread->AddField<StringValue>("name", "thread-" + std::to_string(tid));
+    thread->AddField("cpu", MakeValue(tid % 8, &arena));
+    threads->AddField(std::to_string(tid), std::move(thread));
+  }
+
+  // 4 values per thread, with no header. A chunk only wastes the tail that
+  // is too small for the next value.
+  EXPECT_EQ(kNumThreads * (sizeof(StructValue) + sizeof(IntValue) +
+                           sizeof(StringValue) + sizeof(IntValue)) +
+                sizeof(StructValue),
+            arena.bytes_allocated());
+  EXPECT_LE(arena.num_chunks(),
+            arena.bytes_allocated() /
+                (Arena::kDefaultChunkSize - sizeof(StructValue)) + 1);
+
+  const Value* thread = threads->GetField("4242");
+  ASSERT_NE(nullptr, thread);
+  EXPECT_EQ(4242, thread->GetField("tid")->AsInteger());
+  EXPECT_EQ("thread-4242", thread->GetField("name")->AsString());
+  EXPECT_EQ(2, thread->GetField("cpu")->AsInteger());
+
+  // Copies are on the heap and outlive the arena tree.
+  Value::UP copy = thread->Copy();
+  threads.reset();
+  EXPECT_EQ("thread-4242", copy->GetField("name")->AsString());
+}
+
+TEST(ArenaTest, NoHeader) {
+  Arena arena;
+
+  // Values are laid out back to back.
+  ArenaPtr<IntValue> first = NewValue<IntValue>(&arena, 1);
+  ArenaPtr<IntValue> second = NewValue<IntValue>(&arena, 2);
+  EXPECT_EQ(reinterpret_cast<char*>(first.get()) + sizeof(IntValue),
+            reinterpret_cast<char*>(second.get()));
+  EXPECT_EQ(2 * sizeof(IntValue), arena.bytes_allocated());
+
+  EXPECT_TRUE(first->IsArenaOwned());
+  EXPECT_FALSE(first->IsShared());
+  ArenaPtr<IntValue> heap = NewValue<IntValue>(nullptr, 3);
+  EXPECT_FALSE(heap->IsArenaOwned());
+}
+
+TEST(ArenaTest, Destructors) {
+  Arena arena;
+  int count = 0;
+  {
+    ArenaPtr<StructValue> root = NewValue<StructValue>(&arena, &arena);
+    root->AddField("a", NewValue<IncrementOnDelete>(&arena, 1, &count));
+    root->AddField("b", std::unique_ptr<Value>(new IncrementOnDelete(2, &count)));
+  }
+  EXPECT_EQ(2, count);
+}
+
+TEST(ArenaTest, HeapValues) {
+  Arena arena;
+
+  // Arena and heap values can be mixed in a tree owned by the heap.
+  ArrayValue::UP array {new ArrayValue};
+  EXPECT_EQ(nullptr, array->arena());
+  array->Append<IntValue>(1);
+  array->Append(MakeValue(2, &arena));
+  array->Append(MakeValue(3));
+  EXPECT_EQ(3u, array->Length());
+  EXPECT_EQ(2, array->at(1)->AsInteger());
+  array.reset();
+
+  ArrayValue arena_array(&arena);
+  EXPECT_EQ(&arena, arena_array.arena());
+  size_t bytes = arena.bytes_allocated();
+  arena_array.Append<StringValue>("value");
+  EXPECT_LT(bytes, arena.bytes_allocated());
+}
+
+}  // namespace value
+}  // namespace tibee
@@ -0,0 +1,445 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "value/Binary.hpp"
+
+#include <assert.h>
+#include <cstring>
+
+#include "value/Arena.hpp"
+
+namespace tibee {
+namespace value {
+
+const char kBinaryMagic[4] = {'T', 'B', 'V', '1'};
+
+namespace {
+
+// The buffer of a writer is flushed when it grows past this size.
+const size_t kFlushThreshold = 1 << 16;
+
+// Deeper trees are considered malformed, to bound the recursion.
+const size_t kMaxDepth = 256;
+
+const size_t kMaxVarintBytes = 10;
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+}  // namespace
+
+BinaryWriter::BinaryWriter(std::ostream* out)
+    : out_(out),
+      bytes_written_(sizeof(kBinaryMagic)) {
+  assert(out != nullptr);
+  buffer_.reserve(kFlushThreshold + kFlushThreshold / 4);
+  buffer_.append(kBinaryMagic, sizeof(kBinaryMagic));
+}
+
+BinaryWriter::~BinaryWriter() {
+  Flush();
+}
+
+void BinaryWriter::Write(const Value* value) {
+  record_.clear();
+  Encode(value);
+
+  // Prefix the record with its length.
+  size_t buffered = buffer_.size();
+  AppendVarint(record_.size(), &buffer_);
+  buffer_.append(record_);
+  bytes_written_ += buffer_.size() - buffered;
+
+  if (buffer_.size() >= kFlushThreshold)
+    Flush();
+}
+
+void BinaryWriter::Flush() {
+  if (buffer_.empty())
+    return;
+  out_->write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
+
+void BinaryWriter::Encode(const Value* value) {
+  if (value == nullptr) {
+    PutTag(BINARY_NULL);
+    return;
+  }
+
+  switch (value->GetType()) {
+    case VALUE_BOOL:
+      PutTag(BoolValue::GetValue(value) ? BINARY_TRUE : BINARY_FALSE);
+      break;
+    case VALUE_CHAR:
+      PutTag(BINARY_CHAR);
+      PutSigned(CharValue::GetValue(value));
+      break;
+    case VALUE_UCHAR:
+      PutTag(BINARY_UCHAR);
+      PutVarint(UCharValue::GetValue(value));
+      break;
+    case VALUE_SHORT:
+      PutTag(BINARY_SHORT);
+      PutSigned(ShortValue::GetValue(value));
+      break;
+    case VALUE_USHORT:
+      PutTag(BINARY_USHORT);
+      PutVarint(UShortValue::GetValue(value));
+      break;
+    case VALUE_INT:
+      PutTag(BINARY_INT);
+      PutSigned(IntValue::GetValue(value));
+      break;
+    case VALUE_UINT:
+      PutTag(BINARY_UINT);
+      PutVarint(UIntValue::GetValue(value));
+      break;
+    case VALUE_LONG:
+      PutTag(BINARY_LONG);
+      PutSigned(LongValue::GetValue(value));
+      break;
+    case VALUE_ULONG:
+      PutTag(BINARY_ULONG);
+      PutVarint(ULongValue::GetValue(value));
+      break;
+    case VALUE_FLOAT: {
+      PutTag(BINARY_FLOAT);
+      float float_value = FloatValue::GetValue(value);
+      uint32_t bits = 0;
+      std::memcpy(&bits, &float_value, sizeof(bits));
+      for (int i = 0; i < 4; ++i)
+        record_.push_back(static_cast<char>(bits >> (8 * i)));
+      break;
+    }
+    case VALUE_DOUBLE: {
+      PutTag(BINARY_DOUBLE);
+      double double_value = DoubleValue::GetValue(value);
+      uint64_t bits = 0;
+      std::memcpy(&bits, &double_value, sizeof(bits));
+      for (int i = 0; i < 8; ++i)
+        record_.push_back(static_cast<char>(bits >> (8 * i)));
+      break;
+    }
+    case VALUE_STRING:
+    case VALUE_STRING_VIEW: {
+      PutTag(BINARY_STRING);
+      boost::string_ref str = value->AsStringView();
+      PutVarint(str.size());
+      PutBytes(str.data(), str.size());
+      break;
+    }
+    case VALUE_WSTRING: {
+      PutTag(BINARY_WSTRING);
+      const std::wstring& str = WStringValue::GetValue(value);
+      PutVarint(str.size());
+      for (wchar_t c : str)
+        PutVarint(static_cast<uint64_t>(c));
+      break;
+    }
+    case VALUE_ARRAY: {
+      PutTag(BINARY_ARRAY);
+      const ArrayValueBase* array = ArrayValueBase::Cast(value);
+      PutVarint(array->Length());
+      for (size_t i = 0; i < array->Length(); ++i)
+        Encode(array->at(i));
+      break;
+    }
+    case VALUE_STRUCT: {
+      PutTag(BINARY_STRUCT);
+      const StructValueBase* strct = StructValueBase::Cast(value);
+      PutVarint(strct->Length());
+      auto end = strct->fields_end();
+      for (auto it = strct->fields_begin(); it != end; ++it) {
+        EncodeName(it->first);
+        Encode(it->second);
+      }
+      break;
+    }
+  }
+}
+
+void BinaryWriter::EncodeName(const std::string& name) {
+  auto look = names_.find(name);
+  if (look != names_.end()) {
+    PutVarint(look->second + 1);
+    return;
+  }
+  names_.insert(std::make_pair(name, names_.size()));
+  PutVarint(0);
+  PutVarint(name.size());
+  PutBytes(name.data(), name.size());
+}
+
+void BinaryWriter::PutTag(BinaryTag tag) {
+  record_.push_back(static_cast<char>(tag));
+}
+
+void BinaryWriter::PutVarint(uint64_t value) {
+  AppendVarint(value, &record_);
+}
+
+void BinaryWriter::PutSigned(int64_t value) {
+  PutVarint(ZigZagEncode(value));
+}
+
+void BinaryWriter::PutBytes(const char* data, size_t size) {
+  record_.append(data, size);
+}
+
+BinaryReader::BinaryReader(const char* data, size_t size, Arena* arena)
+    : next_(data),
+      end_(data + size),
+      arena_(arena),
+      error_(false) {
+  if (size < sizeof(kBinaryMagic) ||
+      std::memcmp(data, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+    error_ = true;
+    return;
+  }
+  next_ += sizeof(kBinaryMagic);
+}
+
+bool BinaryReader::Read(ArenaPtr<Value>* value) {
+  assert(value != nullptr);
+  if (error_ || next_ == end_)
+    return false;
+
+  // Decode within the bounds of the record, which must be consumed
+  // entirely.
+  uint64_t length = 0;
+  if (!GetVarint(&length) ||
+      length > static_cast<uint64_t>(end_ - next_)) {
+    error_ = true;
+    return false;
+  }
+  const char* stream_end = end_;
+  end_ = next_ + length;
+  bool decoded = Decode(0, value) && next_ == end_;
+  end_ = stream_end;
+
+  if (!decoded) {
+    value->reset();
+    error_ = true;
+    return false;
+  }
+  return true;
+}
+
+template<class T>
+bool BinaryReader::DecodeUnsigned(ArenaPtr<Value>* value) {
+  uint64_t raw = 0;
+  if (!GetVarint(&raw) || raw > T::MaxValue())
+    return false;
+  *value = NewValue<T>(arena_, static_cast<typename T::ScalarType>(raw));
+  return true;
+}
+
+template<class T>
+bool BinaryReader::DecodeSigned(ArenaPtr<Value>* value) {
+  int64_t raw = 0;
+  if (!GetSigned(&raw) || raw < T::MinValue() || raw > T::MaxValue())
+    return false;
+  *value = NewValue<T>(arena_, static_cast<typename T::ScalarType>(raw));
+  return true;
+}
+
+bool BinaryReader::Decode(size_t depth, ArenaPtr<Value>* value) {
+  if (depth > kMaxDepth || next_ == end_)
+    return false;
+
+  BinaryTag tag = static_cast<BinaryTag>(*next_++);
+  switch (tag) {
+    case BINARY_NULL:
+      value->reset();
+      return true;
+    case BINARY_FALSE:
+    case BINARY_TRUE:
+      *value = NewValue<BoolValue>(arena_, tag == BINARY_TRUE);
+      return true;
+    case BINARY_CHAR:
+      return DecodeSigned<CharValue>(value);
+    case BINARY_UCHAR:
+      return DecodeUnsigned<UCharValue>(value);
+    case BINARY_SHORT:
+      return DecodeSigned<ShortValue>(value);
+    case BINARY_USHORT:
+      return DecodeUnsigned<UShortValue>(value);
+    case BINARY_INT:
+      return DecodeSigned<IntValue>(value);
+    case BINARY_UINT:
+      return DecodeUnsigned<UIntValue>(value);
+    case BINARY_LONG:
+      return DecodeSigned<LongValue>(value);
+    case BINARY_ULONG:
+      return DecodeUnsigned<ULongValue>(value);
+    case BINARY_FLOAT: {
+      const char* bytes = nullptr;
+      if (!GetBytes(4, &bytes))
+        return false;
+      uint32_t bits = 0;
+      for (int i = 0; i < 4; ++i)
+        bits |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+      float float_value = 0;
+      std::memcpy(&float_value, &bits, sizeof(bits));
+      *value = NewValue<FloatValue>(arena_, float_value);
+      return true;
+    }
+    case BINARY_DOUBLE: {
+      const char* bytes = nullptr;
+      if (!GetBytes(8, &bytes))
+        return false;
+      uint64_t bits = 0;
+      for (int i = 0; i < 8; ++i)
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+      double double_value = 0;
+      std::memcpy(&double_value, &bits, sizeof(bits));
+      *value = NewValue<DoubleValue>(arena_, double_value);
+      return true;
+    }
+    case BINARY_STRING: {
+      uint64_t size = 0;
+      const char* data = nullptr;
+      if (!GetVarint(&size) || !GetBytes(size, &data))
+        return false;
+      *value = NewValue<StringViewValue>(arena_, boost::string_ref(data, size));
+      return true;
+    }
+    case BINARY_WSTRING: {
+      uint64_t size = 0;
+      if (!GetVarint(&size) || size > static_cast<uint64_t>(end_ - next_))
+        return false;
+      std::wstring str;
+      str.reserve(size);
+      for (uint64_t i = 0; i < size; ++i) {
+        uint64_t c = 0;
+        if (!GetVarint(&c))
+          return false;
+        str.push_back(static_cast<wchar_t>(c));
+      }
+      *value = NewValue<WStringValue>(arena_, str);
+      return true;
+    }
+    case BINARY_ARRAY: {
+      // Each element takes at least one byte.
+      uint64_t length = 0;
+      if (!GetVarint(&length) || length > static_cast<uint64_t>(end_ - next_))
+        return false;
+      ArenaPtr<ArrayValue> array = NewValue<ArrayValue>(arena_, arena_);
+      for (uint64_t i = 0; i < length; ++i) {
+        // Arrays can't hold null elements.
+        ArenaPtr<Value> element;
+        if (!Decode(depth + 1, &element) || !element)
+          return false;
+        array->Append(std::move(element));
+      }
+      *value = std::move(array);
+      return true;
+    }
+    case BINARY_STRUCT: {
+      uint64_t length = 0;
+      if (!GetVarint(&length) || length > static_cast<uint64_t>(end_ - next_))
+        return false;
+      ArenaPtr<StructValue> strct = NewValue<StructValue>(arena_, arena_);
+      for (uint64_t i = 0; i < length; ++i) {
+        size_t name = 0;
+        ArenaPtr<Value> field;
+        if (!DecodeName(&name) || !Decode(depth + 1, &field))
+          return false;
+        if (!strct->AddField(names_[name], std::move(field)))
+          return false;
+      }
+      *value = std::move(strct);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BinaryReader::DecodeName(size_t* index) {
+  uint64_t reference = 0;
+  if (!GetVarint(&reference))
+    return false;
+  if (reference != 0) {
+    if (reference > names_.size())
+      return false;
+    *index = reference - 1;
+    return true;
+  }
+
+  uint64_t size = 0;
+  const char* data = nullptr;
+  if (!GetVarint(&size) || !GetBytes(size, &data))
+    return false;
+  *index = names_.size();
+  names_.emplace_back(std::string(data, size));
+  return true;
+}
+
+bool BinaryReader::GetVarint(uint64_t* value) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < kMaxVarintBytes && next_ != end_; ++i) {
+    uint8_t byte = static_cast<uint8_t>(*next_++);
+    result |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BinaryReader::GetSigned(int64_t* value) {
+  uint64_t raw = 0;
+  if (!GetVarint(&raw))
+    return false;
+  *value = ZigZagDecode(raw);
+  return true;
+}
+
+bool BinaryReader::GetBytes(size_t size, const char** data) {
+  if (size > static_cast<size_t>(end_ - next_))
+    return false;
+  *data = next_;
+  next_ += size;
+  return true;
+}
+
+}  // namespace value
+}  // namespace tibee
@@ -0,0 +1,184 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// This file specifies a compact binary encoding of Value trees, meant for
+// analysis results and notification streams written to disk or piped
+// between processes.
+//
+// A stream starts with the 4 bytes "TBV1" and holds a sequence of records.
+// Each record is a varint length followed by one encoded value:
+// - a tag byte (see BinaryTag),
+// - integers as varints, zigzag-encoded when signed,
+// - floats and doubles as 4 or 8 little-endian bytes,
+// - strings as a varint length and the bytes,
+// - wide strings as a varint length and one varint per character,
+// - arrays as a varint length and the elements,
+// - structs as a varint length and, for each field, a name reference and
+//   the value.
+// A name reference is 0 followed by a string when the name appears for the
+// first time in the stream, and the index of the name plus one otherwise.
+// Records of a stream must therefore be read in order.
+//
+// Usage example:
+//   std::ofstream out("results.tbv", std::ios::binary);
+//   BinaryWriter writer(&out);
+//   writer.Write(report.get());
+//
+//   BinaryReader reader(data, size);
+//   ArenaPtr<Value> value;
+//   while (reader.Read(&value))
+//     // Use value.
+
+#ifndef _TIBEE_VALUE_BINARY_HPP
+#define _TIBEE_VALUE_BINARY_HPP
+
+#include <boost/utility.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "value/Value.hpp"
+
+namespace tibee {
+namespace value {
+
+// Type tags of the binary encoding. These values are part of the format:
+// new tags must be added at the end.
+enum BinaryTag : uint8_t {
+  BINARY_NULL,
+  BINARY_FALSE,
+  BINARY_TRUE,
+  BINARY_CHAR,
+  BINARY_UCHAR,
+  BINARY_SHORT,
+  BINARY_USHORT,
+  BINARY_INT,
+  BINARY_UINT,
+  BINARY_LONG,
+  BINARY_ULONG,
+  BINARY_FLOAT,
+  BINARY_DOUBLE,
+  BINARY_STRING,
+  BINARY_WSTRING,
+  BINARY_ARRAY,
+  BINARY_STRUCT,
+};
+
+// Header of a binary stream.
+extern const char kBinaryMagic[4];
+
+// Encodes values to an output stream. The encoded bytes are buffered and
+// written in large blocks.
+class BinaryWriter : boost::noncopyable {
+ public:
+  // @param out the stream that receives the encoded values. Must outlive
+  //     the writer.
+  explicit BinaryWriter(std::ostream* out);
+
+  // Flushes the buffered bytes.
+  ~BinaryWriter();
+
+  // Appends a record holding |value|, which can be null.
+  void Write(const Value* value);
+
+  // Writes the buffered bytes to the output stream.
+  void Flush();
+
+  // Returns the number of bytes encoded so far, header included.
+  uint64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  void Encode(const Value* value);
+  void EncodeName(const std::string& name);
+  void PutTag(BinaryTag tag);
+  void PutVarint(uint64_t value);
+  void PutSigned(int64_t value);
+  void PutBytes(const char* data, size_t size);
+
+  std::ostream* out_;
+
+  // Encoded records waiting to be written.
+  std::string buffer_;
+
+  // The record being encoded, to compute its length.
+  std::string record_;
+
+  // Index of the field names seen so far.
+  std::unordered_map<std::string, uint64_t> names_;
+
+  uint64_t bytes_written_;
+};
+
+// Decodes values from a buffer without copying it: strings are decoded as
+// StringViewValues pointing into the buffer, which must outlive them.
+class BinaryReader : boost::noncopyable {
+ public:
+  // @param data the encoded stream, header included.
+  // @param size the size of the encoded stream.
+  // @param arena the arena in which values are allocated, or nullptr to
+  //     allocate them on the heap.
+  BinaryReader(const char* data, size_t size, Arena* arena = nullptr);
+
+  // Decodes the next record.
+  // @param value receives the decoded value, which can be null.
+  // @returns true if a record was decoded, false at the end of the stream
+  //     or if the stream is malformed.
+  bool Read(ArenaPtr<Value>* value);
+
+  // Returns true if the stream is malformed.
+  bool error() const { return error_; }
+
+  // Returns true if all the records were read.
+  bool at_end() const { return !error_ && next_ == end_; }
+
+ private:
+  bool Decode(size_t depth, ArenaPtr<Value>* value);
+  bool DecodeName(size_t* index);
+  bool GetVarint(uint64_t* value);
+  bool GetSigned(int64_t* value);
+  bool GetBytes(size_t size, const char** data);
+
+  template<class T>
+  bool DecodeUnsigned(ArenaPtr<Value>* value);
+  template<class T>
+  bool DecodeSigned(ArenaPtr<Value>* value);
+
+  const char* next_;
+  const char* end_;
+  Arena* arena_;
+  bool error_;
+
+  // Field names seen so far, in order of appearance.
+  std::vector<StructValue::Key> names_;
+};
+
+}  // namespace value
+}  // namespace tibee
+
+#endif  // _TIBEE_VALUE_BINARY_HPP
@@ -0,0 +1,178 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "value/Arena.hpp"
+#include "value/Binary.hpp"
+#include "value/Value.hpp"
+#include "gtest/gtest.h"
+
+namespace tibee {
+namespace value {
+
+namespace {
+
+StructValue::UP MakeReport() {
+  StructValue::UP report {new StructValue};
+  report->AddField<BoolValue>("enabled", true);
+  report->AddField<CharValue>("char", -5);
+  report->AddField<UCharValue>("uchar", 250);
+  report->AddField<ShortValue>("short", -30000);
+  report->AddField<UShortValue>("ushort", 60000);
+  report->AddField<IntValue>("int", std::numeric_limits<int32_t>::min());
+  report->AddField<UIntValue>("uint", std::numeric_limits<uint32_t>::max());
+  report->AddField<LongValue>("long", std::numeric_limits<int64_t>::min());
+  report->AddField<ULongValue>("ulong", std::numeric_limits<uint64_t>::max());
+  report->AddField<FloatValue>("float", 1.5f);
+  report->AddField<DoubleValue>("double", -0.1);
+  report->AddField<StringValue>("string", std::string("a\0b", 3));
+  report->AddField<WStringValue>("wstring", L"été");
+  report->AddField("null", nullptr);
+
+  std::unique_ptr<ArrayValue> threads(new ArrayValue);
+  for (int tid = 0; tid < 3; ++tid) {
+    std::unique_ptr<StructValue> thread(new StructValue);
+    thread->AddField<IntValue>("tid", tid);
+    thread->AddField<StringValue>("name", "thread-" + std::to_string(tid));
+    threads->Append(std::move(thread));
+  }
+  report->AddField("threads", std::move(threads));
+  return report;
+}
+
+}  // namespace
+
+TEST(BinaryTest, RoundTrip) {
+  StructValue::UP report = MakeReport();
+  IntValue second(42);
+
+  std::stringstream stream;
+  {
+    BinaryWriter writer(&stream);
+    writer.Write(report.get());
+    writer.Write(&second);
+    writer.Write(nullptr);
+    EXPECT_EQ(stream.str().size(), 0u);
+    writer.Flush();
+    EXPECT_EQ(writer.bytes_written(), stream.str().size());
+  }
+  std::string data = stream.str();
+
+  BinaryReader reader(data.data(), data.size());
+  ArenaPtr<Value> value;
+  ASSERT_TRUE(reader.Read(&value));
+  EXPECT_TRUE(report->Equals(value.get()));
+  EXPECT_TRUE(value->Equals(report.get()));
+
+  // Strings point into the encoded data.
+  boost::string_ref name;
+  ASSERT_TRUE(StructValueBase::Cast(value.get())->GetFieldAsStringView(
+      "string", &name));
+  EXPECT_LE(data.data(), name.data());
+  EXPECT_GT(data.data() + data.size(), name.data());
+
+  ASSERT_TRUE(reader.Read(&value));
+  EXPECT_TRUE(second.Equals(value.get()));
+  ASSERT_TRUE(reader.Read(&value));
+  EXPECT_EQ(nullptr, value.get());
+  EXPECT_FALSE(reader.Read(&value));
+  EXPECT_TRUE(reader.at_end());
+  EXPECT_FALSE(reader.error());
+}
+
+TEST(BinaryTest, FieldNamesAreEncodedOnce) {
+  StructValue::UP report = MakeReport();
+
+  std::stringstream stream;
+  BinaryWriter writer(&stream);
+  writer.Write(report.get());
+  uint64_t first = writer.bytes_written();
+  writer.Write(report.get());
+  uint64_t second = writer.bytes_written() - first;
+  writer.Flush();
+
+  // The second record only refers to the names of the first one.
+  EXPECT_LT(second + std::string("enabledcharucharshortushortintuint"
+                                 "longulongfloatdoublestringwstringnull"
+                                 "threadstidname").size(),
+            first);
+
+  std::string data = stream.str();
+  Arena arena;
+  BinaryReader reader(data.data(), data.size(), &arena);
+  ArenaPtr<Value> value;
+  ASSERT_TRUE(reader.Read(&value));
+  EXPECT_TRUE(report->Equals(value.get()));
+  ASSERT_TRUE(reader.Read(&value));
+  EXPECT_TRUE(report->Equals(value.get()));
+  EXPECT_TRUE(reader.at_end());
+  EXPECT_LT(0u, arena.bytes_allocated());
+}
+
+TEST(BinaryTest, Malformed) {
+  ArenaPtr<Value> value;
+
+  std::string bad_magic("TBV0");
+  BinaryReader bad_magic_reader(bad_magic.data(), bad_magic.size());
+  EXPECT_FALSE(bad_magic_reader.Read(&value));
+  EXPECT_TRUE(bad_magic_reader.error());
+
+  StructValue::UP report = MakeReport();
+  std::stringstream stream;
+  {
+    BinaryWriter writer(&stream);
+    writer.Write(report.get());
+  }
+  std::string data = stream.str();
+
+  // Every truncation of the record is detected.
+  for (size_t size = sizeof(kBinaryMagic) + 1; size < data.size(); ++size) {
+    BinaryReader reader(data.data(), size);
+    EXPECT_FALSE(reader.Read(&value));
+    EXPECT_TRUE(reader.error());
+    EXPECT_EQ(nullptr, value.get());
+  }
+
+  // An unknown tag.
+  std::string unknown_tag(kBinaryMagic, sizeof(kBinaryMagic));
+  unknown_tag += "\x01\x7f";
+  BinaryReader unknown_tag_reader(unknown_tag.data(), unknown_tag.size());
+  EXPECT_FALSE(unknown_tag_reader.Read(&value));
+  EXPECT_TRUE(unknown_tag_reader.error());
+
+  // An array with a null element.
+  std::string null_element(kBinaryMagic, sizeof(kBinaryMagic));
+  null_element += std::string("\x03\x0f\x01\x00", 4);
+  BinaryReader null_element_reader(null_element.data(), null_element.size());
+  EXPECT_FALSE(null_element_reader.Read(&value));
+  EXPECT_TRUE(null_element_reader.error());
+  EXPECT_EQ(nullptr, value.get());
+}
+
+}  // namespace value
+}  // namespace tibee
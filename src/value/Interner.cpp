@@ -0,0 +1,149 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "value/Interner.hpp"
+
+#include <boost/functional/hash.hpp>
+#include <cstring>
+
+namespace tibee {
+namespace value {
+
+Interner::Interner() {
+}
+
+Interner::~Interner() {
+}
+
+ValueRef Interner::Intern(const Value* value) {
+  if (value == nullptr)
+    return nullptr;
+
+  boost::string_ref str;
+  if (value->AsStringView(&str))
+    return InternString(str);
+
+  ScalarKey key;
+  if (!GetScalarKey(value, &key))
+    return ValueRef(value->Copy());
+
+  auto look = scalars_.find(key);
+  if (look != scalars_.end())
+    return look->second;
+
+  ValueRef ref(value->Copy());
+  scalars_.emplace(key, ref);
+  return ref;
+}
+
+ValueRef Interner::Intern(Value::UP value) {
+  if (value == nullptr)
+    return nullptr;
+
+  boost::string_ref str;
+  if (value->AsStringView(&str)) {
+    // A view doesn't own its characters: it is copied into a StringValue.
+    if (value->GetType() != VALUE_STRING)
+      return InternString(str);
+
+    auto look = strings_.find(str);
+    if (look != strings_.end())
+      return look->second;
+
+    ValueRef ref(std::move(value));
+    strings_.emplace(ref->AsStringView(), ref);
+    return ref;
+  }
+
+  ScalarKey key;
+  if (!GetScalarKey(value.get(), &key))
+    return ValueRef(std::move(value));
+
+  auto look = scalars_.find(key);
+  if (look != scalars_.end())
+    return look->second;
+
+  ValueRef ref(std::move(value));
+  scalars_.emplace(key, ref);
+  return ref;
+}
+
+ValueRef Interner::InternString(boost::string_ref str) {
+  auto look = strings_.find(str);
+  if (look != strings_.end())
+    return look->second;
+
+  ValueRef ref(Value::UP(new StringValue(str.to_string())));
+  strings_.emplace(ref->AsStringView(), ref);
+  return ref;
+}
+
+size_t Interner::ScalarKeyHash::operator()(const ScalarKey& key) const {
+  size_t seed = static_cast<size_t>(key.type);
+  boost::hash_combine(seed, key.bits);
+  return seed;
+}
+
+size_t Interner::StringRefHash::operator()(boost::string_ref str) const {
+  return boost::hash_range(str.begin(), str.end());
+}
+
+bool Interner::GetScalarKey(const Value* value, ScalarKey* key) {
+  key->type = value->GetType();
+  switch (key->type) {
+    case VALUE_BOOL:
+      key->bits = BoolValue::GetValue(value) ? 1 : 0;
+      return true;
+    case VALUE_CHAR:
+    case VALUE_SHORT:
+    case VALUE_INT:
+    case VALUE_LONG:
+      key->bits = static_cast<uint64_t>(value->AsLong());
+      return true;
+    case VALUE_UCHAR:
+    case VALUE_USHORT:
+    case VALUE_UINT:
+    case VALUE_ULONG:
+      key->bits = value->AsULong();
+      return true;
+    case VALUE_FLOAT: {
+      uint32_t bits = 0;
+      float float_value = FloatValue::GetValue(value);
+      std::memcpy(&bits, &float_value, sizeof(bits));
+      key->bits = bits;
+      return true;
+    }
+    case VALUE_DOUBLE: {
+      double double_value = DoubleValue::GetValue(value);
+      std::memcpy(&key->bits, &double_value, sizeof(key->bits));
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace value
+}  // namespace tibee
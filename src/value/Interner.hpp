@@ -0,0 +1,114 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// An Interner keeps one shared instance of each distinct scalar value it
+// is given, so that values that repeat, such as the statuses and names of
+// threads, are allocated once and shared through ValueRefs instead of
+// being copied for each owner.
+//
+// Usage example:
+//   Interner interner;
+//   ValueRef running = interner.Intern<UIntValue>(42);
+//   ValueRef same = interner.Intern<UIntValue>(42);  // Same instance.
+//   ValueRef name = interner.InternString(event_field->AsStringView());
+//
+// Interned values are kept until the interner is destroyed: it suits
+// values with few distinct instances. An Interner isn't thread-safe, but
+// the values it returns can be shared between threads.
+
+#ifndef _TIBEE_VALUE_INTERNER_HPP
+#define _TIBEE_VALUE_INTERNER_HPP
+
+#include <boost/utility.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "value/Value.hpp"
+
+namespace tibee {
+namespace value {
+
+class Interner : boost::noncopyable {
+ public:
+  Interner();
+  ~Interner();
+
+  // Returns the shared instance of a value equal to |value|. A copy of
+  // |value| becomes the shared instance if there is none. String views are
+  // interned as strings. Aggregates and wide strings aren't interned: a
+  // new copy is returned for them.
+  ValueRef Intern(const Value* value);
+
+  // Same as above, but |value| becomes the shared instance if there is
+  // none, without being copied.
+  ValueRef Intern(Value::UP value);
+
+  // Returns the shared instance of a scalar value of type |T|.
+  template<class T>
+  ValueRef Intern(const typename T::ScalarType& value) {
+    T wrapper(value);
+    return Intern(&wrapper);
+  }
+
+  // Returns the shared instance of a StringValue.
+  ValueRef InternString(boost::string_ref str);
+
+  // Returns the number of interned values.
+  size_t size() const { return scalars_.size() + strings_.size(); }
+
+ private:
+  struct ScalarKey {
+    ValueType type;
+    uint64_t bits;
+
+    bool operator==(const ScalarKey& other) const {
+      return type == other.type && bits == other.bits;
+    }
+  };
+
+  struct ScalarKeyHash {
+    size_t operator()(const ScalarKey& key) const;
+  };
+
+  struct StringRefHash {
+    size_t operator()(boost::string_ref str) const;
+  };
+
+  // Returns the key of a non-string scalar.
+  static bool GetScalarKey(const Value* value, ScalarKey* key);
+
+  // Interned values other than strings.
+  std::unordered_map<ScalarKey, ValueRef, ScalarKeyHash> scalars_;
+
+  // Interned strings. The keys point into the interned values.
+  std::unordered_map<boost::string_ref, ValueRef, StringRefHash> strings_;
+};
+
+}  // namespace value
+}  // namespace tibee
+
+#endif  // _TIBEE_VALUE_INTERNER_HPP
@@ -0,0 +1,102 @@
+// Copyright (c) 2014 The LibTrace Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//   * Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//   * Neither the name of the <organization> nor the
+//     names of its contributors may be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+
+#include "value/Interner.hpp"
+#include "value/MakeValue.hpp"
+#include "value/Value.hpp"
+#include "gtest/gtest.h"
+
+namespace tibee {
+namespace value {
+
+TEST(InternerTest, Scalars) {
+  Interner interner;
+
+  ValueRef first = interner.Intern<UIntValue>(42);
+  ValueRef second = interner.Intern(MakeValue(42u));
+  UIntValue third_value(42);
+  ValueRef third = interner.Intern(&third_value);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(first.get(), third.get());
+  EXPECT_EQ(42u, first->AsUInteger());
+
+  // Values of different types aren't merged.
+  ValueRef long_value = interner.Intern<LongValue>(42);
+  EXPECT_NE(first.get(), long_value.get());
+  EXPECT_EQ(VALUE_LONG, long_value->GetType());
+
+  ValueRef double_value = interner.Intern<DoubleValue>(0.5);
+  EXPECT_EQ(double_value.get(), interner.Intern<DoubleValue>(0.5).get());
+  EXPECT_NE(double_value.get(), interner.Intern<DoubleValue>(-0.5).get());
+
+  EXPECT_EQ(4u, interner.size());
+  EXPECT_EQ(nullptr, interner.Intern(static_cast<const Value*>(nullptr)).get());
+}
+
+TEST(InternerTest, Strings) {
+  Interner interner;
+
+  std::string name = "bash";
+  StringViewValue view(name);
+  ValueRef from_view = interner.Intern(&view);
+  ValueRef from_string = interner.Intern(MakeValue("bash"));
+  ValueRef from_ref = interner.InternString("bash");
+  EXPECT_EQ(from_view.get(), from_string.get());
+  EXPECT_EQ(from_view.get(), from_ref.get());
+
+  // The interned value owns its characters.
+  EXPECT_EQ(VALUE_STRING, from_view->GetType());
+  name = "ls";
+  EXPECT_EQ("bash", from_view->AsString());
+
+  EXPECT_NE(from_view.get(), interner.InternString("ls").get());
+  EXPECT_EQ(2u, interner.size());
+}
+
+TEST(InternerTest, Aggregates) {
+  Interner interner;
+
+  StructValue struct_value;
+  struct_value.AddField<IntValue>("a", 1);
+  ValueRef first = interner.Intern(&struct_value);
+  ValueRef second = interner.Intern(&struct_value);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_TRUE(first->Equals(&struct_value));
+  EXPECT_EQ(0u, interner.size());
+}
+
+TEST(InternerTest, OutlivesInterner) {
+  ValueRef value;
+  {
+    Interner interner;
+    value = interner.InternString("swapper");
+  }
+  EXPECT_EQ("swapper", value->AsString());
+}
+
+}  // namespace value
+}  // namespace tibee
@@ -85,6 +85,49 @@ inline std::unique_ptr<Value> MakeValue(const std::string& value)
     return value_wrapper;
 }
 
+// Allocates the value in |arena| when it is not null, on the heap
+// otherwise.
+
+inline ArenaPtr<Value> MakeValue(quark::Quark value, Arena* arena)
+{
+    return NewValue<UIntValue>(arena, value.get());
+}
+
+inline ArenaPtr<Value> MakeValue(bool value, Arena* arena)
+{
+    return NewValue<BoolValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(int32_t value, Arena* arena)
+{
+    return NewValue<IntValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(uint32_t value, Arena* arena)
+{
+    return NewValue<UIntValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(int64_t value, Arena* arena)
+{
+    return NewValue<LongValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(uint64_t value, Arena* arena)
+{
+    return NewValue<ULongValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(const char* value, Arena* arena)
+{
+    return NewValue<StringValue>(arena, value);
+}
+
+inline ArenaPtr<Value> MakeValue(const std::string& value, Arena* arena)
+{
+    return NewValue<StringValue>(arena, value);
+}
+
 inline std::unique_ptr<Value> MakeNullValue()
 {
     std::unique_ptr<Value> value_wrapper { };
@@ -131,6 +131,90 @@ bool ToString(const Value* value, size_t indent, std::stringstream* result) {
   return false;
 }
 
+void StringToJson(const std::string& str, std::stringstream* result) {
+  *result << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"': *result << "\\\""; break;
+      case '\\': *result << "\\\\"; break;
+      case '\n': *result << "\\n"; break;
+      case '\r': *result << "\\r"; break;
+      case '\t': *result << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          const char kHexDigits[] = "0123456789abcdef";
+          *result << "\\u00" << kHexDigits[(c >> 4) & 0xF]
+                  << kHexDigits[c & 0xF];
+        } else {
+          *result << c;
+        }
+    }
+  }
+  *result << '"';
+}
+
+bool ToJson(const Value* value, std::stringstream* result) {
+  assert(result != nullptr);
+
+  if (value == nullptr) {
+    *result << "null";
+    return true;
+  }
+
+  if (value->IsScalar()) {
+    bool bool_value = false;
+    std::string string_value;
+
+    if (BoolValue::GetValue(value, &bool_value)) {
+      *result << (bool_value ? "true" : "false");
+      return true;
+    } else if (value->AsString(&string_value)) {
+      StringToJson(string_value, result);
+      return true;
+    }
+
+    // Numbers have the same representation as in ToString().
+    return ToString(value, 0, result);
+  } else if (value->IsAggregate()) {
+    if (ArrayValueBase::InstanceOf(value)) {
+      const ArrayValueBase* array_value = ArrayValueBase::Cast(value);
+      assert(array_value != nullptr);
+
+      *result << "[";
+      bool first = true;
+      for (auto it = array_value->begin(); it != array_value->end(); ++it) {
+        if (!first)
+          *result << ",";
+        first = false;
+        if (!ToJson(&*it, result))
+          return false;
+      }
+      *result << "]";
+      return true;
+    } else if (StructValueBase::InstanceOf(value)) {
+      const StructValueBase* struct_value = StructValueBase::Cast(value);
+      assert(struct_value != nullptr);
+
+      *result << "{";
+      bool first = true;
+      auto it = struct_value->fields_begin();
+      for (; it != struct_value->fields_end(); ++it) {
+        if (!first)
+          *result << ",";
+        first = false;
+        StringToJson(it->first, result);
+        *result << ":";
+        if (!ToJson(it->second, result))
+          return false;
+      }
+      *result << "}";
+      return true;
+    }
+  }
+
+  return false;
+}
+
 }  // namespace
 
 bool ToString(const Value* value, std::string* result) {
@@ -152,5 +236,24 @@ std::string ToString(const Value* value)
   return result;
 }
 
+bool ToJson(const Value* value, std::string* result) {
+  assert(result != nullptr);
+
+  std::stringstream ss;
+  if (!ToJson(value, &ss))
+    return false;
+
+  *result = ss.str();
+
+  return true;
+}
+
+std::string ToJson(const Value* value)
+{
+  std::string result;
+  ToJson(value, &result);
+  return result;
+}
+
 }  // namespace value
 }  // namespace tibee
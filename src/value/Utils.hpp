@@ -42,6 +42,14 @@ bool ToString(const Value* value, std::string* result);
 
 std::string ToString(const Value* value);
 
+// Produce a compact JSON representation of a Value.
+// @param value the value to serialize.
+// @param result receives the JSON representation.
+// @returns true if the conversion was successful, false otherwise.
+bool ToJson(const Value* value, std::string* result);
+
+std::string ToJson(const Value* value);
+
 }  // namespace value
 }  // namespace tibee
 
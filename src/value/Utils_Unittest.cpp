@@ -93,5 +93,27 @@ TEST(EventToStringTest, StructType) {
   EXPECT_STREQ(expected, struct_str.c_str());
 }
 
+TEST(EventToJsonTest, NestedTypes) {
+  StructValue struct_value;
+  struct_value.AddField<IntValue>("int", -12);
+  struct_value.AddField<BoolValue>("bool", true);
+  struct_value.AddField<StringValue>("string", "a \"quoted\"\n\\value");
+
+  std::unique_ptr<ArrayValue> array_value(new ArrayValue);
+  array_value->Append<ULongValue>(1);
+  array_value->Append<DoubleValue>(0.5);
+  struct_value.AddField("array", std::move(array_value));
+  struct_value.AddField("empty", std::unique_ptr<Value>(new StructValue));
+
+  std::string json;
+  EXPECT_TRUE(ToJson(&struct_value, &json));
+
+  const char* expected =
+      "{\"int\":-12,\"bool\":true,"
+      "\"string\":\"a \\\"quoted\\\"\\n\\\\value\","
+      "\"array\":[1,0.5],\"empty\":{}}";
+  EXPECT_STREQ(expected, json.c_str());
+}
+
 }  // namespace value
 }  // namespace tibee
@@ -25,6 +25,7 @@
 
 #include "value/Value.hpp"
 
+#include <functional>
 #include <limits>
 
 #include "base/StringUtils.hpp"
@@ -286,6 +287,11 @@ bool Value::AsString(std::string* value) const {
       *value = base::WStringToString(WStringValue::GetValue(this));
       return true;
     }
+    case VALUE_STRING_VIEW: {
+      const boost::string_ref& view = StringViewValue::GetValue(this);
+      value->assign(view.data(), view.size());
+      return true;
+    }
     default:
       return false;
   }
@@ -303,6 +309,28 @@ bool Value::AsWString(std::wstring* value) const {
       *value = WStringValue::GetValue(this);
       return true;
     }
+    case VALUE_STRING_VIEW: {
+      const boost::string_ref& view = StringViewValue::GetValue(this);
+      *value = base::StringToWString(std::string(view.data(), view.size()));
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool Value::AsStringView(boost::string_ref* value) const {
+  assert(value != nullptr);
+
+  switch (GetType()) {
+    case VALUE_STRING: {
+      *value = StringValue::GetValue(this);
+      return true;
+    }
+    case VALUE_STRING_VIEW: {
+      *value = StringViewValue::GetValue(this);
+      return true;
+    }
     default:
       return false;
   }
@@ -364,13 +392,42 @@ std::wstring Value::AsWString() const
   return value;
 }
 
+boost::string_ref Value::AsStringView() const
+{
+  boost::string_ref value;
+  if (!AsStringView(&value))
+    throw ex::InvalidConversion(std::string("The value cannot be viewed as a string. ") + value::ToString(this));
+  return value;
+}
+
 bool Value::AreEqual(const Value* left, const Value* right) {
+  // Shared values are often compared with themselves.
+  if (left == right)
+    return true;
   if (left == nullptr || right == nullptr)
-    return left == right;
+    return false;
 
   return left->Equals(right);
 }
 
+const uint32_t Value::kArenaOwned;
+
+void Value::Release(const Value* value) {
+  if (value == nullptr)
+    return;
+  uint32_t count = value->ref_count_.load(std::memory_order_acquire);
+  // The memory of an arena value is freed with its arena.
+  if (count & kArenaOwned) {
+    value->~Value();
+    return;
+  }
+  // A value that isn't shared belongs to the caller.
+  if (count == 0 ||
+      value->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete value;
+  }
+}
+
 bool Value::GetField(const std::string& name,
                      const Value** value) const {
   assert(value != nullptr);
@@ -414,7 +471,8 @@ bool ScalarValue<T, TYPE>::IsFloating() const {
 
 template<class T, int TYPE>
 bool ScalarValue<T, TYPE>::IsString() const {
-  return GetType() == VALUE_STRING || GetType() == VALUE_WSTRING;
+  return GetType() == VALUE_STRING || GetType() == VALUE_WSTRING ||
+         GetType() == VALUE_STRING_VIEW;
 }
 
 template<class T, int TYPE>
@@ -435,6 +493,28 @@ Value::UP ScalarValue<T, TYPE>::Copy() const {
   return copy;
 }
 
+template<>
+Value::UP StringViewValue::Copy() const {
+  Value::UP copy {new StringValue(value_.to_string())};
+  return copy;
+}
+
+template<>
+bool StringViewValue::Equals(const Value* value) const {
+  boost::string_ref other;
+  if (value == nullptr || !value->AsStringView(&other))
+    return false;
+  return other == value_;
+}
+
+template<>
+bool StringValue::Equals(const Value* value) const {
+  boost::string_ref other;
+  if (value == nullptr || !value->AsStringView(&other))
+    return false;
+  return other == value_;
+}
+
 template<class T, int TYPE>
 const T& ScalarValue<T, TYPE>::GetValue() const {
   return value_;
@@ -585,6 +665,14 @@ bool ArrayValueBase::GetElementAsWString(size_t index, std::wstring* value) cons
   return at(index)->AsWString(value);
 }
 
+bool ArrayValueBase::GetElementAsStringView(
+    size_t index, boost::string_ref* value) const {
+  assert(value != nullptr);
+  if (index >= Length())
+    return false;
+  return at(index)->AsStringView(value);
+}
+
 bool ArrayValueBase::Equals(const Value* value) const {
   if (value == nullptr)
     return false;
@@ -599,7 +687,7 @@ bool ArrayValueBase::Equals(const Value* value) const {
   size_t length = Length();
 
   for (size_t i = 0; i < length; ++i) {
-    if (!at(i)->Equals(array->at(i)))
+    if (!Value::AreEqual(at(i), array->at(i)))
       return false;
   }
 
@@ -657,12 +745,13 @@ const Value* ArrayValueBase::Iterator::operator->() const {
   return &(**impl_);
 }
 
-ArrayValue::ArrayValue() {
+ArrayValue::ArrayValue(Arena* arena)
+    : arena_(arena) {
 }
 
 ArrayValue::~ArrayValue() {
   for (Values::iterator it = values_.begin(); it != values_.end(); ++it)
-    delete *it;
+    Value::Release(*it);
 }
 
 size_t ArrayValue::Length() const {
@@ -694,6 +783,17 @@ void ArrayValue::Append(std::unique_ptr<Value> value) {
   values_.push_back(value.release());
 }
 
+void ArrayValue::Append(ArenaPtr<Value> value) {
+  assert(value.get() != nullptr);
+  values_.push_back(value.release());
+}
+
+void ArrayValue::AppendShared(const ValueRef& value) {
+  assert(value != nullptr);
+  value->AddRef();
+  values_.push_back(const_cast<Value*>(value.get()));
+}
+
 ArrayValue::IteratorImpl::IteratorImpl(ArrayValue::const_iterator it)
     : it_(it) {
 }
@@ -799,6 +899,15 @@ bool StructValueBase::GetFieldAsWString(
   return field->AsWString(value);
 }
 
+bool StructValueBase::GetFieldAsStringView(
+    const std::string& name, boost::string_ref* value) const {
+  assert(value != nullptr);
+  const Value* field = nullptr;
+  if (!GetField(name, &field))
+    return false;
+  return field->AsStringView(value);
+}
+
 bool StructValueBase::Equals(const Value* value) const {
   if (value == nullptr)
     return false;
@@ -813,7 +922,7 @@ bool StructValueBase::Equals(const Value* value) const {
   while (left != fields_end() && right != strct->fields_end()) {
     if (left->first.compare(right->first) != 0)
       return false;
-    if (!left->second->Equals(right->second))
+    if (!Value::AreEqual(left->second, right->second))
       return false;
 
     ++left;
@@ -879,12 +988,28 @@ const std::pair<const std::string, const Value*>*
   return &(**impl_);
 }
 
-StructValue::StructValue() {
+namespace {
+
+// Structs with up to this many fields are scanned rather than indexed.
+const size_t kMaxScannedFields = 8;
+
+size_t HashFieldName(const std::string& name) {
+  return std::hash<std::string>()(name);
+}
+
+}  // namespace
+
+StructValue::Key::Key(const std::string& name)
+    : name_(name), hash_(HashFieldName(name)) {
+}
+
+StructValue::StructValue(Arena* arena)
+    : arena_(arena) {
 }
 
 StructValue::~StructValue() {
-  for (auto it = fields_map_.begin(); it != fields_map_.end(); ++it)
-    delete it->second;
+  for (const auto& field : fields_)
+    Value::Release(field.entry.second);
 }
 
 size_t StructValue::Length() const {
@@ -892,20 +1017,25 @@ size_t StructValue::Length() const {
 }
 
 bool StructValue::HasField(const std::string& name) const {
-  return fields_map_.find(name) != fields_map_.end();
+  return FindField(HashFieldName(name), name) != fields_.size();
 }
 
 const Value* StructValue::GetField(const std::string& name) const {
-  auto look = fields_map_.find(name);
-  if (look == fields_map_.end())
-    return nullptr;
-  return look->second;
+  return at(FindField(HashFieldName(name), name));
+}
+
+bool StructValue::HasField(const Key& key) const {
+  return FindField(key.hash(), key.name()) != fields_.size();
+}
+
+const Value* StructValue::GetField(const Key& key) const {
+  return at(FindField(key.hash(), key.name()));
 }
 
 const Value* StructValue::at(size_t index) const {
   if (index >= fields_.size())
     return nullptr;
-  return fields_[index]->second;
+  return fields_[index].entry.second;
 }
 
 StructValueBase::Iterator StructValue::fields_begin() const {
@@ -918,14 +1048,92 @@ StructValueBase::Iterator StructValue::fields_end() const {
 
 bool StructValue::AddField(const std::string& name,
                            std::unique_ptr<Value> value) {
-  if (HasField(name))
+  if (!AddField(HashFieldName(name), name, value.get()))
+    return false;
+  value.release();
+  return true;
+}
+
+bool StructValue::AddField(const Key& key, std::unique_ptr<Value> value) {
+  if (!AddField(key.hash(), key.name(), value.get()))
     return false;
-  Value* raw_value = value.release();
-  auto res = fields_map_.insert(std::make_pair(name, raw_value));
-  fields_.push_back(&*res.first);
+  value.release();
   return true;
 }
 
+bool StructValue::AddField(const std::string& name, ArenaPtr<Value> value) {
+  if (!AddField(HashFieldName(name), name, value.get()))
+    return false;
+  value.release();
+  return true;
+}
+
+bool StructValue::AddField(const Key& key, ArenaPtr<Value> value) {
+  if (!AddField(key.hash(), key.name(), value.get()))
+    return false;
+  value.release();
+  return true;
+}
+
+bool StructValue::AddSharedField(const Key& key, const ValueRef& value) {
+  if (!AddField(key.hash(), key.name(), value.get()))
+    return false;
+  if (value != nullptr)
+    value->AddRef();
+  return true;
+}
+
+bool StructValue::AddField(size_t hash, const std::string& name,
+                           const Value* value) {
+  if (FindField(hash, name) != fields_.size())
+    return false;
+  // Most structs are event payloads or notifications with a few fields.
+  if (fields_.empty())
+    fields_.reserve(4);
+  fields_.emplace_back(hash, name, value);
+
+  if (fields_.size() <= kMaxScannedFields)
+    return true;
+
+  // Keep the index at most half full.
+  if (fields_.size() * 2 > index_.size()) {
+    index_.assign(index_.empty() ? 4 * kMaxScannedFields : index_.size() * 2,
+                  0);
+    for (size_t position = 0; position < fields_.size(); ++position)
+      IndexField(position);
+  } else {
+    IndexField(fields_.size() - 1);
+  }
+  return true;
+}
+
+size_t StructValue::FindField(size_t hash, const std::string& name) const {
+  if (index_.empty()) {
+    for (size_t position = 0; position < fields_.size(); ++position) {
+      const Field& field = fields_[position];
+      if (field.hash == hash && field.entry.first == name)
+        return position;
+    }
+    return fields_.size();
+  }
+
+  const size_t mask = index_.size() - 1;
+  for (size_t slot = hash & mask; index_[slot] != 0; slot = (slot + 1) & mask) {
+    const Field& field = fields_[index_[slot] - 1];
+    if (field.hash == hash && field.entry.first == name)
+      return index_[slot] - 1;
+  }
+  return fields_.size();
+}
+
+void StructValue::IndexField(size_t position) {
+  const size_t mask = index_.size() - 1;
+  size_t slot = fields_[position].hash & mask;
+  while (index_[slot] != 0)
+    slot = (slot + 1) & mask;
+  index_[slot] = static_cast<uint32_t>(position + 1);
+}
+
 StructValue::IteratorImpl::IteratorImpl(StructValue::const_iterator it)
     : it_(it) {
 }
@@ -933,7 +1141,6 @@ StructValue::IteratorImpl::IteratorImpl(StructValue::const_iterator it)
 StructValueBase::IteratorImpl&
     StructValue::IteratorImpl::operator++() {
   ++it_;
-  currentPair_.reset(nullptr);
   return *this;
 }
 
@@ -953,19 +1160,12 @@ bool StructValue::IteratorImpl::operator!=(
 
 const std::pair<const std::string, const Value*>&
     StructValue::IteratorImpl::operator*() const {
-  if (currentPair_.get() == nullptr) {
-    currentPair_.reset(
-      new std::pair<const std::string, const Value*> {
-        (**it_).first,
-        (**it_).second
-      });
-  }
-  return *currentPair_;
+  return it_->entry;
 }
 
 const std::pair<const std::string, const Value*>*
     StructValue::IteratorImpl::operator->() const {
-  return &(**this);
+  return &it_->entry;
 }
 
 // Force a template instantiation in this compilation unit. This must be at
@@ -981,6 +1181,7 @@ template class ScalarValue<int64_t, VALUE_LONG>;
 template class ScalarValue<uint64_t, VALUE_ULONG>;
 template class ScalarValue<std::string, VALUE_STRING>;
 template class ScalarValue<std::wstring, VALUE_WSTRING>;
+template class ScalarValue<boost::string_ref, VALUE_STRING_VIEW>;
 template class ScalarValue<float, VALUE_FLOAT>;
 template class ScalarValue<double, VALUE_DOUBLE>;
 
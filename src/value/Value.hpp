@@ -62,19 +62,35 @@
 #define _TIBEE_VALUE_VALUE_HPP
 
 #include <assert.h>
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <boost/utility.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "quark/Quark.hpp"
+#include "value/Arena.hpp"
 
 namespace tibee {
 namespace value {
 
+class Value;
+
+// Releases a value with Value::Release().
+struct ValueDeleter {
+  void operator()(const Value* value) const;
+};
+
+// Owning handle of a value that may be allocated in an arena.
+template<class T>
+using ArenaPtr = std::unique_ptr<T, ValueDeleter>;
+
 enum ValueType {
   VALUE_BOOL,
   VALUE_CHAR,
@@ -89,6 +105,7 @@ enum ValueType {
   VALUE_DOUBLE,
   VALUE_STRING,
   VALUE_WSTRING,
+  VALUE_STRING_VIEW,
   VALUE_STRUCT,
   VALUE_ARRAY
 };
@@ -101,8 +118,14 @@ class Value {
  public:
   typedef std::unique_ptr<Value> UP;
 
+  Value() : ref_count_(0) { }
+
+  // The reference count isn't copied: a copy is a distinct value.
+  Value(const Value& other) : ref_count_(0) { }
+  Value& operator=(const Value& other) { return *this; }
+
   // Destructor.
-  virtual ~Value() { }
+  virtual ~Value() { assert((ref_count_.load() & ~kArenaOwned) == 0); }
 
   // Returns the type of the value stored by the current Value object.
   virtual ValueType GetType() const = 0;
@@ -133,6 +156,13 @@ class Value {
   bool AsWString(std::wstring* value) const;
   // @}
 
+  // Retrieves a string without copying it. The view is only valid as long
+  // as this value: for an event field, until the end of the event.
+  // @param value receives a view on the string holded in this wrapper.
+  // @returns true when the value is a narrow string, false otherwise and
+  // |value| stays unchanged.
+  bool AsStringView(boost::string_ref* value) const;
+
   // These methods allow the convenient retrieval of a basic value.
   // If the current value can be converted into the given type,
   // the value is returned. Otherwise, an InvalidCast exception is
@@ -146,6 +176,7 @@ class Value {
   double AsFloating() const;
   std::string AsString() const;
   std::wstring AsWString() const;
+  boost::string_ref AsStringView() const;
   // @}
 
   quark::Quark AsQuark() const
@@ -167,6 +198,25 @@ class Value {
   // Creates a copy of the current value.
   virtual Value::UP Copy() const = 0;
 
+  // Reference counting, used by ValueRef. A value that isn't shared has a
+  // count of 0 and a single owner, which deletes it. A shared value is
+  // deleted with its last reference. Releasing a value allocated in an
+  // arena runs its destructor and leaves its memory to the arena; such a
+  // value is never shared.
+  // @{
+  void AddRef() const {
+    assert(!IsArenaOwned());
+    ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  static void Release(const Value* value);
+  bool IsShared() const {
+    return (ref_count_.load(std::memory_order_relaxed) & ~kArenaOwned) != 0;
+  }
+  bool IsArenaOwned() const {
+    return (ref_count_.load(std::memory_order_relaxed) & kArenaOwned) != 0;
+  }
+  // @}
+
   // Methods for dictionaries.
   // @{
 
@@ -207,8 +257,107 @@ class Value {
   }
 
   // @}
+
+ private:
+  template<class T, class... Args>
+  friend ArenaPtr<T> NewValue(Arena* arena, Args&&... args);
+
+  // Bit of |ref_count_| set on the values allocated in an arena, so that
+  // no allocation needs a header to be released.
+  static const uint32_t kArenaOwned = 1u << 31;
+
+  mutable std::atomic<uint32_t> ref_count_;
+};
+
+inline void ValueDeleter::operator()(const Value* value) const {
+  Value::Release(value);
+}
+
+// Allocates a value in |arena|, or on the heap if |arena| is null. The
+// memory of an arena value is freed with the arena, which must outlive the
+// value; releasing the value only runs its destructor.
+// Usage example:
+//   ArenaPtr<StructValue> threads = NewValue<StructValue>(&arena, &arena);
+template<class T, class... Args>
+ArenaPtr<T> NewValue(Arena* arena, Args&&... args) {
+  if (arena == nullptr)
+    return ArenaPtr<T>(new T(std::forward<Args>(args)...));
+  T* value = new (arena->Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+  value->ref_count_.store(Value::kArenaOwned, std::memory_order_relaxed);
+  return ArenaPtr<T>(value);
+}
+
+// ValueRef is a reference to an immutable value shared by several owners:
+// the attributes of a state, the notifications about them and their
+// history. It takes the ownership of a value, which is deleted with its
+// last reference. The count is atomic, so references can cross the
+// threads of a pipeline. A shared value must not be modified.
+class ValueRef {
+ public:
+  ValueRef() : value_(nullptr) { }
+  ValueRef(std::nullptr_t) : value_(nullptr) { }
+
+  // Takes the ownership of |value|.
+  template<class T>
+  ValueRef(std::unique_ptr<T> value)
+      : value_(value.release()) {
+    if (value_ != nullptr)
+      value_->AddRef();
+  }
+
+  ValueRef(const ValueRef& other)
+      : value_(other.value_) {
+    if (value_ != nullptr)
+      value_->AddRef();
+  }
+
+  ValueRef(ValueRef&& other)
+      : value_(other.value_) {
+    other.value_ = nullptr;
+  }
+
+  // Returns a new reference to |value|, which must already be owned by a
+  // ValueRef, e.g. the value of an attribute of the state.
+  static ValueRef Share(const Value* value) {
+    assert(value == nullptr || value->IsShared());
+    ValueRef ref;
+    ref.value_ = value;
+    if (value != nullptr)
+      value->AddRef();
+    return ref;
+  }
+
+  ~ValueRef() {
+    Value::Release(value_);
+  }
+
+  ValueRef& operator=(ValueRef other) {
+    std::swap(value_, other.value_);
+    return *this;
+  }
+
+  void reset() {
+    Value::Release(value_);
+    value_ = nullptr;
+  }
+
+  const Value* get() const { return value_; }
+  const Value* operator->() const { return value_; }
+  const Value& operator*() const { return *value_; }
+  explicit operator bool() const { return value_ != nullptr; }
+
+ private:
+  const Value* value_;
 };
 
+inline bool operator==(const ValueRef& ref, std::nullptr_t) {
+  return ref.get() == nullptr;
+}
+
+inline bool operator!=(const ValueRef& ref, std::nullptr_t) {
+  return ref.get() != nullptr;
+}
+
 template<class T, int TYPE>
 class ScalarValue : public Value {
  public:
@@ -293,9 +442,18 @@ typedef ScalarValue<int64_t, VALUE_LONG> LongValue;
 typedef ScalarValue<uint64_t, VALUE_ULONG> ULongValue;
 typedef ScalarValue<std::string, VALUE_STRING> StringValue;
 typedef ScalarValue<std::wstring, VALUE_WSTRING> WStringValue;
+typedef ScalarValue<boost::string_ref, VALUE_STRING_VIEW> StringViewValue;
 typedef ScalarValue<float, VALUE_FLOAT> FloatValue;
 typedef ScalarValue<double, VALUE_DOUBLE> DoubleValue;
 
+// A StringViewValue doesn't own its characters. It is used for the string
+// fields of events, which point into the trace buffers. Copying it gives
+// an owning StringValue, and it compares equal to a StringValue with the
+// same characters.
+template<> Value::UP StringViewValue::Copy() const;
+template<> bool StringViewValue::Equals(const Value* value) const;
+template<> bool StringValue::Equals(const Value* value) const;
+
 template<int TYPE>
 class AggregateValue : public Value {
  public:
@@ -367,6 +525,7 @@ class ArrayValueBase
   bool GetElementAsFloating(size_t index, double* value) const;
   bool GetElementAsString(size_t index, std::string* value) const;
   bool GetElementAsWString(size_t index, std::wstring* value) const;
+  bool GetElementAsStringView(size_t index, boost::string_ref* value) const;
   // @}
 
   // Overridden from Value:
@@ -426,9 +585,14 @@ class ArrayValue : public ArrayValueBase {
   typedef std::vector<Value*> Values;
   typedef Values::const_iterator const_iterator;
 
-  ArrayValue();
+  // @param arena the arena in which Append<T>() allocates elements, or
+  //     nullptr to allocate them on the heap.
+  explicit ArrayValue(Arena* arena = nullptr);
   ~ArrayValue();
 
+  // Returns the arena in which elements are allocated, if any.
+  Arena* arena() const { return arena_; }
+
   using ArrayValueBase::operator[];
   using ArrayValueBase::at;
 
@@ -450,15 +614,21 @@ class ArrayValue : public ArrayValueBase {
   // Appends a Value to the end of the sequence.
   // Take the ownership of |value|.
   // @param value the value to add.
+  // @{
   void Append(std::unique_ptr<Value> value);
+  void Append(ArenaPtr<Value> value);
+  // @}
+
+  // Appends a shared value to the end of the sequence, without copying it.
+  // @param value the value to add.
+  void AppendShared(const ValueRef& value);
 
   // Allocates and appends a typed value to the array.
   // @tparam T a scalar value type (i.e. CharValue, IntValue, ...).
   // @param value the value to add.
   template<class T>
   void Append(const typename T::ScalarType& value) {
-    std::unique_ptr<Value> ptr(new T(value));
-    Append(std::move(ptr));
+    Append(NewValue<T>(arena_, value));
   }
 
   // Appends to the end of the sequence a series of value.
@@ -490,6 +660,7 @@ class ArrayValue : public ArrayValueBase {
   };
 
   Values values_;
+  Arena* arena_;
 };
 
 // StructValue provides a key-value dictionary and keeps fields in a sequence.
@@ -534,6 +705,8 @@ class StructValueBase
   bool GetFieldAsFloating(const std::string& name, double* value) const;
   bool GetFieldAsString(const std::string& name, std::string* value) const;
   bool GetFieldAsWString(const std::string& name, std::wstring* value) const;
+  bool GetFieldAsStringView(const std::string& name,
+                            boost::string_ref* value) const;
   // @}
 
   // Overridden from Value:
@@ -592,16 +765,35 @@ class StructValueBase
   // @}
 };
 
+// StructValue keeps its fields in a single vector, in insertion order. A
+// field is found by comparing hashes: small structs are scanned, larger
+// ones get an open-addressing index over the vector. A Key holds a field
+// name with its hash computed once, for fields that are looked up often.
 class StructValue : public StructValueBase {
  public:
   typedef std::unique_ptr<StructValue> UP;
-  typedef std::map<std::string, Value*> ValueMap;
-  typedef std::vector<ValueMap::value_type*> ValueVector;
-  typedef ValueVector::const_iterator const_iterator;
-  
-  StructValue();
+
+  // A field name and its precomputed hash.
+  class Key {
+   public:
+    explicit Key(const std::string& name);
+
+    const std::string& name() const { return name_; }
+    size_t hash() const { return hash_; }
+
+   private:
+    std::string name_;
+    size_t hash_;
+  };
+
+  // @param arena the arena in which AddField<T>() allocates fields, or
+  //     nullptr to allocate them on the heap.
+  explicit StructValue(Arena* arena = nullptr);
   virtual ~StructValue();
 
+  // Returns the arena in which fields are allocated, if any.
+  Arena* arena() const { return arena_; }
+
   using StructValueBase::GetField;
 
   // Overridden from StructValueBase:
@@ -614,11 +806,32 @@ class StructValue : public StructValueBase {
   virtual StructValueBase::Iterator fields_end() const override;
   // @}
 
+  // Lookups with a precomputed key.
+  // @{
+  bool HasField(const Key& key) const;
+  const Value* GetField(const Key& key) const;
+  // @}
+
   // Add a field with name |name| to this structure.
   // @param name the name of the field.
   // @param value the value of the field.
   // @returns true if the field can be added, false otherwise.
   bool AddField(const std::string& name, std::unique_ptr<Value> value);
+  bool AddField(const Key& key, std::unique_ptr<Value> value);
+  bool AddField(const std::string& name, ArenaPtr<Value> value);
+  bool AddField(const Key& key, ArenaPtr<Value> value);
+  bool AddField(const std::string& name, std::nullptr_t) {
+    return AddField(name, std::unique_ptr<Value>());
+  }
+  bool AddField(const Key& key, std::nullptr_t) {
+    return AddField(key, std::unique_ptr<Value>());
+  }
+
+  // Add a field whose value is shared, without copying it.
+  // @param key the name of the field.
+  // @param value the value of the field.
+  // @returns true if the field can be added, false otherwise.
+  bool AddSharedField(const Key& key, const ValueRef& value);
 
   // Add a field with name |name| to this structure.
   // @tparam T the type of the value of the field.
@@ -627,11 +840,34 @@ class StructValue : public StructValueBase {
   // @returns true if the field can be added, false otherwise.
   template<class T>
   bool AddField(const std::string& name, const typename T::ScalarType& value) {
-    std::unique_ptr<Value> ptr(new T(value));
-    return AddField(name, std::move(ptr));
+    return AddField(name, NewValue<T>(arena_, value));
+  }
+
+  template<class T>
+  bool AddField(const Key& key, const typename T::ScalarType& value) {
+    return AddField(key, NewValue<T>(arena_, value));
   }
 
  private:
+  struct Field {
+    Field(size_t hash, const std::string& name, const Value* value)
+        : hash(hash), entry(name, value) {
+    }
+
+    size_t hash;
+    std::pair<const std::string, const Value*> entry;
+  };
+  typedef std::vector<Field> Fields;
+  typedef Fields::const_iterator const_iterator;
+
+  // Returns the position of a field in |fields_|, or Length() if absent.
+  size_t FindField(size_t hash, const std::string& name) const;
+
+  bool AddField(size_t hash, const std::string& name, const Value* value);
+
+  // Inserts a field of |fields_| in |index_|.
+  void IndexField(size_t position);
+
   // Implementation of a struct iterator.
   class IteratorImpl :
       public StructValueBase::IteratorImpl {
@@ -649,13 +885,16 @@ class StructValue : public StructValueBase {
         operator->() const override;
 
   private:
-    mutable std::unique_ptr<std::pair<const std::string, const Value*>>
-        currentPair_;
     const_iterator it_;
   };
 
-  ValueVector fields_;
-  ValueMap fields_map_;
+  Fields fields_;
+  Arena* arena_;
+
+  // Open-addressing table of positions in |fields_| plus one, 0 for an
+  // empty slot. Empty until the struct has more than kMaxScannedFields
+  // fields.
+  std::vector<uint32_t> index_;
 };
 
 }  // namespace value
@@ -592,6 +592,49 @@ TEST(ScalarValueTest, AsWString) {
   EXPECT_STREQ(L"", result_value.c_str());
 }
 
+TEST(ScalarValueTest, AsStringView) {
+  const char kBuffer[] = "sched_switch";
+  StringViewValue view_value(boost::string_ref(kBuffer, 5));
+  StringValue string_value("42");
+  WStringValue wstring_value(L"42");
+  Value* value;
+  boost::string_ref result_value;
+
+  value = &view_value;
+  EXPECT_TRUE(value->IsString());
+  EXPECT_TRUE(value->AsStringView(&result_value));
+  EXPECT_EQ(kBuffer, result_value.data());
+  EXPECT_EQ("sched", result_value.to_string());
+  EXPECT_EQ("sched", value->AsString());
+
+  value = &string_value;
+  EXPECT_TRUE(value->AsStringView(&result_value));
+  EXPECT_EQ(StringValue::GetValue(value).data(), result_value.data());
+  EXPECT_EQ("42", result_value.to_string());
+
+  value = &wstring_value;
+  result_value = boost::string_ref();
+  EXPECT_FALSE(value->AsStringView(&result_value));
+  EXPECT_TRUE(result_value.empty());
+}
+
+TEST(ScalarValueTest, StringViewCopy) {
+  std::string buffer("swapper");
+  StringViewValue view_value(buffer);
+
+  // The copy owns its characters.
+  Value::UP copy = view_value.Copy();
+  buffer[0] = 'x';
+  ASSERT_TRUE(StringValue::InstanceOf(copy.get()));
+  EXPECT_EQ("swapper", StringValue::GetValue(copy.get()));
+
+  StringValue string_value("xwapper");
+  EXPECT_TRUE(view_value.Equals(&string_value));
+  EXPECT_TRUE(string_value.Equals(&view_value));
+  EXPECT_FALSE(view_value.Equals(copy.get()));
+  EXPECT_FALSE(view_value.Equals(NULL));
+}
+
 TEST(ScalarValueTest, InstanceOf) {
   LongValue value_long(4L);
   IntValue int_long(4);
@@ -882,6 +925,47 @@ TEST(StructValueTest, Operations) {
   EXPECT_EQ(NULL, const_value->GetField("field_dummy"));
 }
 
+TEST(StructValueTest, Key) {
+  const StructValue::Key key("field");
+  const StructValue::Key other_key("other");
+  StructValue value;
+
+  EXPECT_FALSE(value.HasField(key));
+  EXPECT_TRUE(value.AddField<IntValue>(key, 42));
+  EXPECT_FALSE(value.AddField<IntValue>("field", 43));
+  EXPECT_TRUE(value.HasField(key));
+  EXPECT_FALSE(value.HasField(other_key));
+  EXPECT_EQ(value.GetField("field"), value.GetField(key));
+  EXPECT_EQ(42, value.GetField(key)->AsInteger());
+  EXPECT_EQ(NULL, value.GetField(other_key));
+}
+
+TEST(StructValueTest, ManyFields) {
+  // Enough fields to go past the scanned fields and grow the index.
+  const int kNumFields = 1000;
+  StructValue value;
+  for (int i = 0; i < kNumFields; ++i)
+    EXPECT_TRUE(value.AddField<IntValue>(std::to_string(i), i));
+  EXPECT_FALSE(value.AddField<IntValue>("500", 0));
+  EXPECT_EQ(static_cast<size_t>(kNumFields), value.Length());
+
+  for (int i = 0; i < kNumFields; ++i) {
+    const Value* field = value.GetField(StructValue::Key(std::to_string(i)));
+    ASSERT_NE(nullptr, field);
+    EXPECT_EQ(i, field->AsInteger());
+    EXPECT_EQ(field, value.at(i));
+  }
+  EXPECT_EQ(NULL, value.GetField(std::to_string(kNumFields)));
+
+  // Insertion order is kept.
+  int expected = 0;
+  for (auto it = value.fields_begin(); it != value.fields_end(); ++it) {
+    EXPECT_EQ(std::to_string(expected), it->first);
+    ++expected;
+  }
+  EXPECT_EQ(kNumFields, expected);
+}
+
 TEST(StructValueTest, AddFieldTakesOwnership) {
   StructValue value;
   EXPECT_FALSE(value.HasField("field"));
@@ -1035,5 +1119,57 @@ TEST(StructValueTest, Destructor) {
   EXPECT_EQ(3, count);
 }
 
+TEST(ValueRefTest, SharedOwnership) {
+  int count = 0;
+  {
+    ValueRef ref(std::unique_ptr<Value>(new IncrementOnDelete(42, &count)));
+    EXPECT_TRUE(ref->IsShared());
+
+    ValueRef copy = ref;
+    EXPECT_EQ(ref.get(), copy.get());
+    {
+      StructValue struct_value;
+      EXPECT_TRUE(struct_value.AddSharedField(StructValue::Key("field"), ref));
+      EXPECT_EQ(ref.get(), struct_value.GetField("field"));
+
+      ArrayValue array_value;
+      array_value.AppendShared(ref);
+      array_value.AppendShared(copy);
+      EXPECT_EQ(ref.get(), array_value.at(1));
+
+      ref.reset();
+      copy.reset();
+      EXPECT_EQ(nullptr, ref.get());
+      EXPECT_EQ(0, count);
+    }
+    EXPECT_EQ(1, count);
+  }
+  EXPECT_EQ(1, count);
+}
+
+TEST(ValueRefTest, Share) {
+  int count = 0;
+  {
+    ValueRef ref(std::unique_ptr<Value>(new IncrementOnDelete(42, &count)));
+    ValueRef shared = ValueRef::Share(ref.get());
+    EXPECT_EQ(ref.get(), shared.get());
+
+    ref.reset();
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(42, shared->AsInteger());
+  }
+  EXPECT_EQ(1, count);
+
+  EXPECT_EQ(nullptr, ValueRef::Share(nullptr).get());
+}
+
+TEST(ValueRefTest, NullField) {
+  StructValue struct_value;
+  EXPECT_TRUE(struct_value.AddSharedField(StructValue::Key("field"),
+                                          nullptr));
+  EXPECT_TRUE(struct_value.HasField("field"));
+  EXPECT_EQ(nullptr, struct_value.GetField("field"));
+}
+
 }  // namespace value
 }  // namespace tibee